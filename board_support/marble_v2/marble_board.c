@@ -38,6 +38,11 @@
 #include "i2c_fpga.h"
 #include "ltm4673.h"
 #include "watchdog.h"
+#include "pmlog.h"
+#include "busprof.h"
+#include "prof.h"
+#include "event.h"
+#include "i2c_shadow.h"
 
 #define AHBCLK_DIV        (RCC_SYSCLK_DIV1)
 #define APB1CLK_DIV       (RCC_HCLK_DIV4)
@@ -60,6 +65,10 @@
 #define XRP_BYPASS_PWRGD
 #define XRP_REBOOT_DELAY    (500)
 
+// 32-bit timer on APB1, free-running at 1 MHz (marble_get_us())
+#define US_TIMER          (TIM5)
+#define US_TIMER_PSC      (((FREQUENCY_APB1TIM)/1000000) - 1)
+
 #ifdef NUCLEO
 #define SMBA_PIN GPIO_PIN_13
 #else
@@ -96,8 +105,11 @@ static Marble_PCB_Rev_t marble_pcb_rev;
 
 static int i2cBusStatus = 0;
 static int i2c_pm_alert = 0;
+static volatile int fpga_doorbell = 0;
+static void (*volatile us_timer_callbacks[MARBLE_ONESHOT_SLOTS])(void);
 static int _over_temp = 0;
-// PWR_GOOD sets the length of the PWRGD glitch filter. Higher values means longer.
+// PWR_GOOD sets the length of the PWRGD glitch filter in SysTick periods (board_service()
+// polls the pin once per tick). Higher values means longer.
 #define PWR_GOOD 3
 #define PWR_FAIL 0
 // Assert this so that the first rising edge of PWRGOOD doesn't trigger re-init
@@ -128,11 +140,18 @@ static void CONSOLE_USART_Init(void);
 static void marble_read_pcb_rev(void);
 static int marble_MGTMUX_store(void);
 static void I2C_PM_smba_handler(void);
+static void marble_SMBA_init(void);
 static int i2c_hook(I2C_BUS I2C_bus, uint8_t addr, uint8_t rnw,
                     int cmd, const uint8_t *data, int len);
+static void i2c_prof(I2C_BUS I2C_bus, uint8_t addr, int nbytes, int rc, uint32_t t0);
+static int i2c_gate(I2C_BUS I2C_bus);
+static uint32_t i2c_timeout(I2C_BUS I2C_bus);
+static int i2c_check(I2C_BUS I2C_bus, int rc, int *tries);
+static void ssp_prof(SSP_PORT ssp, unsigned size, int rc, uint32_t t0);
 static void show_chip_ID(void);
 static void pmod_timer_interrupt_enable(void);
 static void pmod_timer_interrupt_disable(void);
+static void us_timer_init(void);
 static void pmod_config_direction(uint32_t direction);
 
 void disable_all_IRQs(void) {
@@ -147,6 +166,8 @@ void disable_all_IRQs(void) {
  *  Board-related (not MMC-related) initialization
  */
 void board_init(void) {
+  // Devices may have been reset; re-read before trusting the register shadow
+  i2c_shadow_invalidate();
   // Initialize subsystems
   I2C_PM_init();
 
@@ -192,6 +213,9 @@ void board_init(void) {
  *  Must always return 0 (otherwise execution will terminate).
  */
 int board_service(void) {
+   if (!event_take(EVENT_BOARD_TICK)) {
+      return 0;
+   }
    // Check state of OVER_TEMP pin
    int gpio = HAL_GPIO_ReadPin(OVER_TEMP_PORT, OVER_TEMP_PIN);
    if ((!_over_temp) && (gpio == OVER_TEMP_ASSERTED)) {
@@ -237,18 +261,14 @@ int board_service(void) {
          // Detect de-asserting edge
          printf("ALERT: Lost power.\r\n");
          _pwr_good = 0;
+         i2c_shadow_invalidate();
+         pmlog_capture();
        } else {
          //printf("PWR STATE CHANGE: _pwr_state = %d;  _pwr_good = %d\r\n", _pwr_state, _pwr_good);
        }
      }
    }
-#if 0
-   // This is unused at the moment.
-   if (i2c_pm_alert) {
-      printf("TODO - Respond to I2C_PM Alert\r\n");
-      i2c_pm_alert = 0;
-   }
-#endif
+   // I2C_PM alerts are handled by PM_AlertService()
    return 0;
 }
 
@@ -533,12 +553,24 @@ void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
       marble_FPGA_DONE_handler();
    } else if (GPIO_Pin == SMBA_PIN) {
       I2C_PM_smba_handler();
+   } else if (GPIO_Pin == GPIO_PIN_3) { // PA3 - FPGA_INT
+      fpga_doorbell = 1;
+      event_post(EVENT_DOORBELL);
    }
 }
 
+// Override default (weak) IRQHandler and redirect to HAL shim
+void EXTI3_IRQHandler(void) {
+   HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_3);
+}
+
 // Override default (weak) IRQHandler and redirect to HAL shim
 void EXTI15_10_IRQHandler(void) {
    HAL_GPIO_EXTI_IRQHandler(SMBA_PIN);
+   // Other lines of this vector (e.g. PB14) are not serviced; drop their
+   // edges so they can't retrigger it
+   __HAL_GPIO_EXTI_CLEAR_IT((GPIO_PIN_10 | GPIO_PIN_11 | GPIO_PIN_12 | GPIO_PIN_13 |
+                             GPIO_PIN_14 | GPIO_PIN_15) & ~SMBA_PIN);
 }
 
 void marble_GPIOint_init(void)
@@ -553,6 +585,29 @@ void marble_GPIOint_init(void)
    /* Enable interrupt in the NVIC */
    HAL_NVIC_SetPriority(EXTI0_IRQn, 0, 0);
    HAL_NVIC_EnableIRQ(EXTI0_IRQn);
+
+   /*Configure GPIO pin : PA3 - FPGA_INT (active low) mailbox doorbell */
+   GPIO_InitStruct.Pin = GPIO_PIN_3;
+   GPIO_InitStruct.Mode = GPIO_MODE_IT_FALLING;
+   GPIO_InitStruct.Pull = GPIO_NOPULL;
+   HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+   HAL_NVIC_SetPriority(EXTI3_IRQn, 7, 7);
+   HAL_NVIC_EnableIRQ(EXTI3_IRQn);
+}
+
+/* static void marble_SMBA_init(void);
+ *  Enable the LTM4673 SMBALERT edge interrupt on boards that route it
+ *  (Marble v1.4 and later).  Needs the PCB revision, so runs after
+ *  marble_read_pcb_rev().  PM_AlertService() also polls the level.
+ */
+static void marble_SMBA_init(void)
+{
+   if (marble_get_pcb_rev() > Marble_v1_3) {
+      __HAL_GPIO_EXTI_CLEAR_IT(SMBA_PIN);
+      HAL_NVIC_SetPriority(EXTI15_10_IRQn, 7, 7);
+      HAL_NVIC_EnableIRQ(EXTI15_10_IRQn);
+   }
+   return;
 }
 
 /* Register user-defined interrupt handlers */
@@ -562,10 +617,10 @@ void marble_GPIOint_handlers(void (*FPGA_DONE_handler)(void)) {
 
 static void I2C_PM_smba_handler(void) {
    i2c_pm_alert = 1;
+   event_post(EVENT_PM_ALERT);
    return;
 }
 
-/*
 int marble_I2C_PM_get_alert(void) {
    return i2c_pm_alert;
 }
@@ -574,7 +629,24 @@ void marble_I2C_PM_clear_alert(void) {
    i2c_pm_alert = 0;
    return;
 }
-*/
+
+int marble_I2C_PM_alert_asserted(void) {
+#ifdef NUCLEO
+   return HAL_GPIO_ReadPin(GPIOC, SMBA_PIN) == GPIO_PIN_SET;
+#else
+   // Low-true (open-drain) /Alert
+   return HAL_GPIO_ReadPin(GPIOC, SMBA_PIN) == GPIO_PIN_RESET;
+#endif
+}
+
+int marble_FPGAint_get_doorbell(void) {
+   return fpga_doorbell;
+}
+
+void marble_FPGAint_clear_doorbell(void) {
+   fpga_doorbell = 0;
+   return;
+}
 
 /************
 * MGT Multiplexer
@@ -693,11 +765,288 @@ static int marble_MGTMUX_store(void) {
 ************/
 #define SPEED_100KHZ 100000
 #define I2C_DELAY_MS 1000
+// I2C_FPGA transfers are a few bytes (well under 1 ms at 100 kHz)
+#define I2C_FPGA_DELAY_MS 10
+
+/* Stuck-bus recovery.  I2C_RECOVER_THRESHOLD consecutive BUSY, TIMEOUT or
+ * BERR results on a bus (a NACK does not count) run marble_I2C_recover(),
+ * but only if SDA or SCL is then held low for I2C_RECOVER_HOLD_US with no
+ * clocking; a busy bus is left to the master using it.  Right after a
+ * recovery a single such failure triggers the next one.  If SDA or SCL stays
+ * low the bus is marked stuck and every access fails at once with HAL_BUSY
+ * until the next recovery attempt, I2C_RECOVER_RETRY_MS later (doubling up
+ * to I2C_RECOVER_RETRY_MAX_MS while it stays stuck).
+ *
+ * Losing arbitration is normal on I2C_FPGA, where the FPGA is also a master:
+ * the transfer is retried up to I2C_ARLO_RETRIES times and never counts as
+ * a fault.  The polling HAL only gives up on a lost transfer when it times
+ * out, so I2C_FPGA uses I2C_FPGA_DELAY_MS: a transfer that keeps losing
+ * stalls the main loop for ~(I2C_ARLO_RETRIES + 1) * I2C_FPGA_DELAY_MS,
+ * not seconds.
+ */
+#define I2C_RECOVER_THRESHOLD          (2)
+#define I2C_RECOVER_RETRY_MS        (1000)
+#define I2C_RECOVER_RETRY_MAX_MS   (32000)
+#define I2C_RECOVER_HALF_PERIOD_US     (5)
+#define I2C_RECOVER_STRETCH_US      (1000)
+// Beyond the 25 ms SMBus clock low timeout
+#define I2C_RECOVER_HOLD_US        (30000)
+#define I2C_ARLO_RETRIES               (2)
+
+typedef struct {
+   const char *name;
+   GPIO_TypeDef *scl_port;
+   uint16_t scl_pin;
+   GPIO_TypeDef *sda_port;
+   uint16_t sda_pin;
+   uint8_t fails;       // Consecutive bus faults
+   uint8_t stuck;
+   uint32_t retry_ms;
+   uint32_t t_stuck;    // BSP_GET_SYSTICK() when last found stuck
+   marble_I2C_recovery_t stats;
+} i2c_recovery_t;
+
+// Indexed by i2c_recovery_index()
+static i2c_recovery_t i2c_recovery[2] = {
+   {"I2C_FPGA", GPIOB, GPIO_PIN_6, GPIOB, GPIO_PIN_7, 0, 0, I2C_RECOVER_RETRY_MS, 0, {0, 0}},  // I2C1
+   {"I2C_PM",   GPIOA, GPIO_PIN_8, GPIOC, GPIO_PIN_9, 0, 0, I2C_RECOVER_RETRY_MS, 0, {0, 0}},  // I2C3
+};
+
+static int i2c_recovery_index(I2C_BUS I2C_bus)
+{
+   if (I2C_bus == &hi2c1) {
+      return 0;
+   } else if (I2C_bus == &hi2c3) {
+      return 1;
+   }
+   return -1;
+}
+
+/* static void i2c_recover_scl(i2c_recovery_t *rec, GPIO_PinState state);
+ *  Drive SCL (open drain) for half a clock period; when released, let a
+ *  slave stretch it for up to I2C_RECOVER_STRETCH_US.
+ */
+static void i2c_recover_scl(i2c_recovery_t *rec, GPIO_PinState state)
+{
+   HAL_GPIO_WritePin(rec->scl_port, rec->scl_pin, state);
+   if (state == GPIO_PIN_SET) {
+      uint32_t t0 = marble_get_us();
+      while ((HAL_GPIO_ReadPin(rec->scl_port, rec->scl_pin) == GPIO_PIN_RESET) &&
+             ((uint32_t)(marble_get_us() - t0) < I2C_RECOVER_STRETCH_US)) {}
+   }
+   marble_SLEEP_us(I2C_RECOVER_HALF_PERIOD_US);
+   return;
+}
+
+/* int marble_I2C_recover(I2C_BUS I2C_bus);
+ *  Release the peripheral's pins, clock SCL up to 9 times until the slave
+ *  holding SDA lets go, generate a STOP, then reset the peripheral and
+ *  re-initialize it with MX_I2C1_Init()/MX_I2C3_Init().
+ */
+int marble_I2C_recover(I2C_BUS I2C_bus)
+{
+   int n = i2c_recovery_index(I2C_bus);
+   if (n < 0) {
+      return -1;
+   }
+   i2c_recovery_t *rec = &i2c_recovery[n];
+   GPIO_InitTypeDef GPIO_InitStruct = {0};
+   HAL_I2C_DeInit((I2C_HandleTypeDef *)I2C_bus);
+   // Released (high) before switching the pins to open-drain outputs
+   HAL_GPIO_WritePin(rec->scl_port, rec->scl_pin, GPIO_PIN_SET);
+   HAL_GPIO_WritePin(rec->sda_port, rec->sda_pin, GPIO_PIN_SET);
+   GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_OD;
+   GPIO_InitStruct.Pull = GPIO_PULLUP;
+   GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+   GPIO_InitStruct.Pin = rec->scl_pin;
+   HAL_GPIO_Init(rec->scl_port, &GPIO_InitStruct);
+   GPIO_InitStruct.Pin = rec->sda_pin;
+   HAL_GPIO_Init(rec->sda_port, &GPIO_InitStruct);
+   marble_SLEEP_us(I2C_RECOVER_HALF_PERIOD_US);
+   for (int pulse = 0; pulse < 9; pulse++) {
+      if (HAL_GPIO_ReadPin(rec->sda_port, rec->sda_pin) == GPIO_PIN_SET) {
+         break;
+      }
+      i2c_recover_scl(rec, GPIO_PIN_RESET);
+      i2c_recover_scl(rec, GPIO_PIN_SET);
+   }
+   // STOP: SDA rises while SCL is high
+   i2c_recover_scl(rec, GPIO_PIN_RESET);
+   HAL_GPIO_WritePin(rec->sda_port, rec->sda_pin, GPIO_PIN_RESET);
+   marble_SLEEP_us(I2C_RECOVER_HALF_PERIOD_US);
+   i2c_recover_scl(rec, GPIO_PIN_SET);
+   HAL_GPIO_WritePin(rec->sda_port, rec->sda_pin, GPIO_PIN_SET);
+   marble_SLEEP_us(I2C_RECOVER_HALF_PERIOD_US);
+   int released = (HAL_GPIO_ReadPin(rec->sda_port, rec->sda_pin) == GPIO_PIN_SET) &&
+                  (HAL_GPIO_ReadPin(rec->scl_port, rec->scl_pin) == GPIO_PIN_SET);
+   // Clear the peripheral's BUSY/error state; MspInit restores the pins
+   if (n == 0) {
+      __HAL_RCC_I2C1_FORCE_RESET();
+      __HAL_RCC_I2C1_RELEASE_RESET();
+      MX_I2C1_Init();
+   } else {
+      __HAL_RCC_I2C3_FORCE_RESET();
+      __HAL_RCC_I2C3_RELEASE_RESET();
+      MX_I2C3_Init();
+   }
+   // Devices on the bus may have been reset along the way
+   i2c_shadow_invalidate_bus(I2C_bus);
+   rec->stats.recoveries++;
+   if (!released) {
+      rec->stats.failures++;
+      return -1;
+   }
+   return 0;
+}
+
+int marble_I2C_get_recovery(I2C_BUS I2C_bus, marble_I2C_recovery_t *stats)
+{
+   int n = i2c_recovery_index(I2C_bus);
+   if (n < 0) {
+      return -1;
+   }
+   *stats = i2c_recovery[n].stats;
+   return 0;
+}
+
+/* static int i2c_gate(I2C_BUS I2C_bus);
+ *  Returns HAL_BUSY while the bus is stuck and its next recovery attempt is
+ *  not due, else HAL_OK.
+ */
+static int i2c_gate(I2C_BUS I2C_bus)
+{
+   int n = i2c_recovery_index(I2C_bus);
+   if ((n < 0) || !i2c_recovery[n].stuck) {
+      return HAL_OK;
+   }
+   i2c_recovery_t *rec = &i2c_recovery[n];
+   if (BSP_GET_SYSTICK() - rec->t_stuck < rec->retry_ms) {
+      return HAL_BUSY;
+   }
+   if (marble_I2C_recover(I2C_bus) != 0) {
+      rec->t_stuck = BSP_GET_SYSTICK();
+      if (rec->retry_ms < I2C_RECOVER_RETRY_MAX_MS) {
+         rec->retry_ms *= 2;
+      }
+      return HAL_BUSY;
+   }
+   printf("*** %s recovered\r\n", rec->name);
+   rec->stuck = 0;
+   rec->retry_ms = I2C_RECOVER_RETRY_MS;
+   rec->fails = I2C_RECOVER_THRESHOLD - 1;
+   return HAL_OK;
+}
+
+/* static int i2c_held_low(const i2c_recovery_t *rec);
+ *  Returns 1 if SDA or SCL is low and neither line changes for
+ *  I2C_RECOVER_HOLD_US; a transfer by another master keeps them moving.
+ */
+static int i2c_held_low(const i2c_recovery_t *rec)
+{
+   GPIO_PinState scl = HAL_GPIO_ReadPin(rec->scl_port, rec->scl_pin);
+   GPIO_PinState sda = HAL_GPIO_ReadPin(rec->sda_port, rec->sda_pin);
+   if ((scl == GPIO_PIN_SET) && (sda == GPIO_PIN_SET)) {
+      return 0;
+   }
+   uint32_t t0 = marble_get_us();
+   while ((uint32_t)(marble_get_us() - t0) < I2C_RECOVER_HOLD_US) {
+      if ((HAL_GPIO_ReadPin(rec->scl_port, rec->scl_pin) != scl) ||
+          (HAL_GPIO_ReadPin(rec->sda_port, rec->sda_pin) != sda)) {
+         return 0;
+      }
+   }
+   return 1;
+}
+
+/* static uint32_t i2c_timeout(I2C_BUS I2C_bus);
+ *  HAL timeout (ms) for one transfer on 'I2C_bus'.
+ */
+static uint32_t i2c_timeout(I2C_BUS I2C_bus)
+{
+   return I2C_bus == &hi2c1 ? I2C_FPGA_DELAY_MS : I2C_DELAY_MS;
+}
+
+/* static int i2c_arbitration_lost(I2C_BUS I2C_bus, int rc);
+ *  Returns 1, clearing the flag, if a failed transfer lost arbitration.  The
+ *  polling HAL calls don't check ARLO (they time out waiting for a flag), so
+ *  look at SR1 as well as the error code.
+ */
+static int i2c_arbitration_lost(I2C_BUS I2C_bus, int rc)
+{
+   I2C_HandleTypeDef *hi2c = (I2C_HandleTypeDef *)I2C_bus;
+   if (rc == HAL_OK) {
+      return 0;
+   }
+   if ((__HAL_I2C_GET_FLAG(hi2c, I2C_FLAG_ARLO) == RESET) &&
+       !(hi2c->ErrorCode & HAL_I2C_ERROR_ARLO)) {
+      return 0;
+   }
+   __HAL_I2C_CLEAR_FLAG(hi2c, I2C_FLAG_ARLO);
+   hi2c->ErrorCode &= ~HAL_I2C_ERROR_ARLO;
+   return 1;
+}
+
+/* static int i2c_check(I2C_BUS I2C_bus, int rc, int *tries);
+ *  Track consecutive bus faults and run the recovery when they pile up.
+ *  Returns 1 if the transfer lost arbitration and should be retried
+ *  ('*tries' counts the retries).
+ */
+static int i2c_check(I2C_BUS I2C_bus, int rc, int *tries)
+{
+   int n = i2c_recovery_index(I2C_bus);
+   if (n < 0) {
+      return 0;
+   }
+   i2c_recovery_t *rec = &i2c_recovery[n];
+   if (i2c_arbitration_lost(I2C_bus, rc)) {
+      // Another master won; the bus itself is fine
+      rec->fails = 0;
+      return (*tries)++ < I2C_ARLO_RETRIES;
+   }
+   int fault = (rc == HAL_BUSY) || (rc == HAL_TIMEOUT);
+   if (rc == HAL_ERROR) {
+      fault = (((I2C_HandleTypeDef *)I2C_bus)->ErrorCode &
+               (HAL_I2C_ERROR_BERR | HAL_I2C_ERROR_TIMEOUT)) != 0;
+   }
+   if (!fault) {
+      rec->fails = 0;
+      return 0;
+   }
+   if (++rec->fails < I2C_RECOVER_THRESHOLD) {
+      return 0;
+   }
+   if (!i2c_held_low(rec)) {
+      // Nobody is holding the bus down; check again on the next fault
+      rec->fails = I2C_RECOVER_THRESHOLD - 1;
+      return 0;
+   }
+   if (marble_I2C_recover(I2C_bus) == 0) {
+      printf("*** %s recovered\r\n", rec->name);
+      rec->fails = I2C_RECOVER_THRESHOLD - 1;
+   } else {
+      printf("*** %s stuck (SDA/SCL held low)\r\n", rec->name);
+      rec->fails = 0;
+      rec->stuck = 1;
+      rec->t_stuck = BSP_GET_SYSTICK();
+      rec->retry_ms = I2C_RECOVER_RETRY_MS;
+   }
+   return 0;
+}
 
 
 /* Non-destructive I2C probe function based on empty data command, i.e. S+[A,RW]+P */
 int marble_I2C_probe(I2C_BUS I2C_bus, uint8_t addr) {
-   int rc = HAL_I2C_IsDeviceReady(I2C_bus, addr, 2, 2);
+   // Fail fast while the bus is stuck
+   if (i2c_gate(I2C_bus) != HAL_OK) {
+      i2cBusStatus |= HAL_BUSY;
+      return HAL_BUSY;
+   }
+   uint32_t t0 = marble_get_us();
+   int rc, tries = 0;
+   do {
+      rc = HAL_I2C_IsDeviceReady(I2C_bus, addr, 2, 2);
+   } while (i2c_check(I2C_bus, rc, &tries));
+   i2c_prof(I2C_bus, addr, 0, rc, t0);
    i2cBusStatus |= rc;
    return rc;
 }
@@ -705,7 +1054,17 @@ int marble_I2C_probe(I2C_BUS I2C_bus, uint8_t addr) {
 /* Generic I2C send function with selectable I2C bus and 8-bit I2C addresses (R/W bit = 0) */
 /* 1-byte register addresses */
 int marble_I2C_send(I2C_BUS I2C_bus, uint8_t addr, const uint8_t *data, int size) {
-   int rc = HAL_I2C_Master_Transmit(I2C_bus, (uint16_t)addr, data, size, I2C_DELAY_MS);
+   // Fail fast while the bus is stuck
+   if (i2c_gate(I2C_bus) != HAL_OK) {
+      i2cBusStatus |= HAL_BUSY;
+      return HAL_BUSY;
+   }
+   uint32_t t0 = marble_get_us();
+   int rc, tries = 0;
+   do {
+      rc = HAL_I2C_Master_Transmit(I2C_bus, (uint16_t)addr, data, size, i2c_timeout(I2C_bus));
+   } while (i2c_check(I2C_bus, rc, &tries));
+   i2c_prof(I2C_bus, addr, size, rc, t0);
    if (rc == HAL_TIMEOUT) {
      printf("*** I2C_send TIMEOUT\r\n");
    } else if (rc == HAL_BUSY) {
@@ -733,7 +1092,17 @@ int marble_I2C_send(I2C_BUS I2C_bus, uint8_t addr, const uint8_t *data, int size
 }
 
 int marble_I2C_cmdsend(I2C_BUS I2C_bus, uint8_t addr, uint8_t cmd, const uint8_t *data, int size) {
-   int rc = HAL_I2C_Mem_Write(I2C_bus, (uint16_t)addr, cmd, 1, (uint8_t *)data, size, I2C_DELAY_MS);
+   // Fail fast while the bus is stuck
+   if (i2c_gate(I2C_bus) != HAL_OK) {
+      i2cBusStatus |= HAL_BUSY;
+      return HAL_BUSY;
+   }
+   uint32_t t0 = marble_get_us();
+   int rc, tries = 0;
+   do {
+      rc = HAL_I2C_Mem_Write(I2C_bus, (uint16_t)addr, cmd, 1, (uint8_t *)data, size, i2c_timeout(I2C_bus));
+   } while (i2c_check(I2C_bus, rc, &tries));
+   i2c_prof(I2C_bus, addr, 1 + size, rc, t0);
    if (rc == HAL_TIMEOUT) {
      printf("*** I2C_cmdsend TIMEOUT\r\n");
    } else if (rc == HAL_BUSY) {
@@ -748,7 +1117,17 @@ int marble_I2C_cmdsend(I2C_BUS I2C_bus, uint8_t addr, uint8_t cmd, const uint8_t
 }
 
 int marble_I2C_recv(I2C_BUS I2C_bus, uint8_t addr, uint8_t *data, int size) {
-   int rc = HAL_I2C_Master_Receive(I2C_bus, (uint16_t)addr, data, size, I2C_DELAY_MS);
+   // Fail fast while the bus is stuck
+   if (i2c_gate(I2C_bus) != HAL_OK) {
+      i2cBusStatus |= HAL_BUSY;
+      return HAL_BUSY;
+   }
+   uint32_t t0 = marble_get_us();
+   int rc, tries = 0;
+   do {
+      rc = HAL_I2C_Master_Receive(I2C_bus, (uint16_t)addr, data, size, i2c_timeout(I2C_bus));
+   } while (i2c_check(I2C_bus, rc, &tries));
+   i2c_prof(I2C_bus, addr, size, rc, t0);
    if (rc == HAL_TIMEOUT) {
      printf("*** I2C_recv TIMEOUT\r\n");
    } else if (rc == HAL_BUSY) {
@@ -763,7 +1142,17 @@ int marble_I2C_recv(I2C_BUS I2C_bus, uint8_t addr, uint8_t *data, int size) {
 }
 
 int marble_I2C_cmdrecv(I2C_BUS I2C_bus, uint8_t addr, uint8_t cmd, uint8_t *data, int size) {
-   int rc = HAL_I2C_Mem_Read(I2C_bus, (uint16_t)addr, cmd, 1, data, size, I2C_DELAY_MS);
+   // Fail fast while the bus is stuck
+   if (i2c_gate(I2C_bus) != HAL_OK) {
+      i2cBusStatus |= HAL_BUSY;
+      return HAL_BUSY;
+   }
+   uint32_t t0 = marble_get_us();
+   int rc, tries = 0;
+   do {
+      rc = HAL_I2C_Mem_Read(I2C_bus, (uint16_t)addr, cmd, 1, data, size, i2c_timeout(I2C_bus));
+   } while (i2c_check(I2C_bus, rc, &tries));
+   i2c_prof(I2C_bus, addr, 1 + size, rc, t0);
    if (rc == HAL_TIMEOUT) {
      printf("*** I2C_cmdrecv TIMEOUT\r\n");
    } else if (rc == HAL_BUSY) {
@@ -779,7 +1168,17 @@ int marble_I2C_cmdrecv(I2C_BUS I2C_bus, uint8_t addr, uint8_t cmd, uint8_t *data
 
 /* Same but 2-byte register addresses */
 int marble_I2C_cmdsend_a2(I2C_BUS I2C_bus, uint8_t addr, uint16_t cmd, const uint8_t *data, int size) {
-   int rc = HAL_I2C_Mem_Write(I2C_bus, (uint16_t)addr, cmd, 2, (uint8_t *)data, size, I2C_DELAY_MS);
+   // Fail fast while the bus is stuck
+   if (i2c_gate(I2C_bus) != HAL_OK) {
+      i2cBusStatus |= HAL_BUSY;
+      return HAL_BUSY;
+   }
+   uint32_t t0 = marble_get_us();
+   int rc, tries = 0;
+   do {
+      rc = HAL_I2C_Mem_Write(I2C_bus, (uint16_t)addr, cmd, 2, (uint8_t *)data, size, i2c_timeout(I2C_bus));
+   } while (i2c_check(I2C_bus, rc, &tries));
+   i2c_prof(I2C_bus, addr, 2 + size, rc, t0);
    if (rc == HAL_TIMEOUT) {
      printf("*** I2C_cmdsend_a2 TIMEOUT\r\n");
    } else if (rc == HAL_BUSY) {
@@ -793,7 +1192,17 @@ int marble_I2C_cmdsend_a2(I2C_BUS I2C_bus, uint8_t addr, uint16_t cmd, const uin
    return rc;
 }
 int marble_I2C_cmdrecv_a2(I2C_BUS I2C_bus, uint8_t addr, uint16_t cmd, uint8_t *data, int size) {
-   int rc = HAL_I2C_Mem_Read(I2C_bus, (uint16_t)addr, cmd, 2, data, size, I2C_DELAY_MS);
+   // Fail fast while the bus is stuck
+   if (i2c_gate(I2C_bus) != HAL_OK) {
+      i2cBusStatus |= HAL_BUSY;
+      return HAL_BUSY;
+   }
+   uint32_t t0 = marble_get_us();
+   int rc, tries = 0;
+   do {
+      rc = HAL_I2C_Mem_Read(I2C_bus, (uint16_t)addr, cmd, 2, data, size, i2c_timeout(I2C_bus));
+   } while (i2c_check(I2C_bus, rc, &tries));
+   i2c_prof(I2C_bus, addr, 2 + size, rc, t0);
    if (rc == HAL_TIMEOUT) {
      printf("*** I2C_cmdrecv_a2 TIMEOUT\r\n");
    } else if (rc == HAL_BUSY) {
@@ -839,6 +1248,22 @@ static int i2c_hook(I2C_BUS I2C_bus, uint8_t addr, uint8_t rnw,
    return 0;
 }
 
+/* static void i2c_prof(I2C_BUS I2C_bus, uint8_t addr, int nbytes, int rc, uint32_t t0);
+ *  Account a transaction that started at marble_get_us() = 't0' and returned
+ *  HAL status 'rc' in the bus-occupancy profiler (busprof.h).
+ */
+static void i2c_prof(I2C_BUS I2C_bus, uint8_t addr, int nbytes, int rc, uint32_t t0)
+{
+   busprof_status_t status = BUSPROF_OK;
+   if (rc == HAL_TIMEOUT) {
+      status = BUSPROF_TIMEOUT;
+   } else if (rc != HAL_OK) {
+      status = BUSPROF_ERROR;
+   }
+   busprof_record(I2C_bus == I2C_PM ? BUSPROF_I2C_PM : BUSPROF_I2C_FPGA, addr, nbytes, status, t0);
+   return;
+}
+
 /************
 * SSP/SPI
 ************/
@@ -846,28 +1271,49 @@ static void SPI_CSB_SET(SSP_PORT ssp, bool set);
 
 int marble_SSP_write16(SSP_PORT ssp, uint16_t *buffer, unsigned size)
 {
+   uint32_t t0 = marble_get_us();
    SPI_CSB_SET(ssp, false);
    int rc = HAL_SPI_Transmit(ssp, (uint8_t*) buffer, size, HAL_MAX_DELAY);
    SPI_CSB_SET(ssp, true);
+   ssp_prof(ssp, size, rc, t0);
    return rc;
 }
 
 int marble_SSP_read16(SSP_PORT ssp, uint16_t *buffer, unsigned size)
 {
+   uint32_t t0 = marble_get_us();
    SPI_CSB_SET(ssp, false);
    int rc = HAL_SPI_Receive(ssp, (uint8_t*) buffer, size, HAL_MAX_DELAY);
    SPI_CSB_SET(ssp, true);
+   ssp_prof(ssp, size, rc, t0);
    return rc;
 }
 
 int marble_SSP_exch16(SSP_PORT ssp, uint16_t *tx_buf, uint16_t *rx_buf, unsigned size)
 {
+   uint32_t t0 = marble_get_us();
    SPI_CSB_SET(ssp, false);
    int rc = HAL_SPI_TransmitReceive(ssp, (uint8_t*) tx_buf, (uint8_t*) rx_buf,size, HAL_MAX_DELAY);
    SPI_CSB_SET(ssp, true);
+   ssp_prof(ssp, size, rc, t0);
    return rc;
 }
 
+/* static void ssp_prof(SSP_PORT ssp, unsigned size, int rc, uint32_t t0);
+ *  Account a transfer of 'size' 16-bit frames in the bus-occupancy profiler.
+ */
+static void ssp_prof(SSP_PORT ssp, unsigned size, int rc, uint32_t t0)
+{
+   busprof_status_t status = BUSPROF_OK;
+   if (rc == HAL_TIMEOUT) {
+      status = BUSPROF_TIMEOUT;
+   } else if (rc != HAL_OK) {
+      status = BUSPROF_ERROR;
+   }
+   busprof_record(ssp == SSP_FPGA ? BUSPROF_SSP_FPGA : BUSPROF_SSP_PMOD, 0, 2*size, status, t0);
+   return;
+}
+
 /************
 * MDIO to PHY
 ************/
@@ -902,15 +1348,46 @@ void (*volatile marble_SysTick_Handler)(void) = SysTick_Handler_dummy;
 // Override default (weak) SysTick_Handler
 void SysTick_Handler(void)
 {
+   uint32_t t0 = marble_get_cycles();
    HAL_IncTick(); // Advances HAL timebase used in HAL_Delay
    if (marble_SysTick_Handler)
       marble_SysTick_Handler();
+   event_post(EVENT_BOARD_TICK);
+   prof_end(PROF_ISR_SYSTICK, t0);
 }
 
 uint32_t marble_get_tick(void) {
   return (uint32_t)HAL_GetTick();
 }
 
+uint32_t marble_get_us(void) {
+  return US_TIMER->CNT;
+}
+
+uint32_t marble_get_cycles(void) {
+  return DWT->CYCCNT;
+}
+
+uint32_t marble_cycles_per_us(void) {
+  return SystemCoreClock/1000000;
+}
+
+/* static void marble_cycle_counter_init(void);
+ *  Start the DWT cycle counter (used by marble_get_cycles()).
+ */
+static void marble_cycle_counter_init(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  return;
+}
+
+void marble_wait_for_interrupt(void) {
+  __WFI();
+  return;
+}
+
 /* Register user-defined interrupt handlers */
 void marble_SYSTIMER_handler(void (*handler)(void)) {
    marble_SysTick_Handler = handler;
@@ -920,8 +1397,8 @@ void marble_SYSTIMER_handler(void (*handler)(void)) {
 uint32_t marble_SYSTIMER_ms(uint32_t delay)
 {
    // WARNING: Hardcoded to 1 ms since this is what increments HAL_IncTick() and
-   // enables HAL_Delay
-   delay = 1; // TODO: Consider decoupling stopwatch from system timer
+   // enables HAL_Delay; finer timing comes from US_TIMER (marble_get_us())
+   delay = 1;
 
    const uint32_t MAX_TICKS = (1<<24)-1;
    const uint32_t MAX_DELAY_MS = (SystemCoreClock * 1000U) / MAX_TICKS;
@@ -941,9 +1418,97 @@ void marble_SLEEP_ms(uint32_t delay)
 
 void marble_SLEEP_us(uint32_t delay)
 {
-   (void) delay;
-   return; // XXX Not available unless HAL weak definitions are overridden
-   // Good thing nobody depends on this (yet)
+   uint32_t t0 = marble_get_us();
+   // Strictly greater: the first count may come right after t0 was read
+   while ((uint32_t)(marble_get_us() - t0) <= delay) {}
+   return;
+}
+
+/************
+* Microsecond timebase
+************/
+/* TIM5 is a 32-bit timer on APB1 (see PMOD_TIMER for the clock tree) which
+ * free-runs at 1 MHz and wraps every ~71.6 minutes.  Its four compare
+ * channels provide the one-shot slots.
+ */
+static void us_timer_init(void)
+{
+   __HAL_RCC_TIM5_CLK_ENABLE();
+   US_TIMER->CR1 = 0;
+   US_TIMER->DIER = 0;
+   US_TIMER->PSC = US_TIMER_PSC;
+   US_TIMER->ARR = 0xffffffff;
+   US_TIMER->CNT = 0;
+   US_TIMER->EGR = TIM_EGR_UG; // Load PSC
+   US_TIMER->SR = 0;
+   US_TIMER->CR1 = TIM_CR1_CEN;
+   HAL_NVIC_SetPriority(TIM5_IRQn, 7, 7);
+   HAL_NVIC_EnableIRQ(TIM5_IRQn);
+   return;
+}
+
+int marble_oneshot_us(uint32_t delay, void (*callback)(void))
+{
+   int slot;
+   uint32_t now;
+   uint32_t primask = __get_PRIMASK();
+   __disable_irq();
+   for (slot = 0; slot < MARBLE_ONESHOT_SLOTS; slot++) {
+      if (us_timer_callbacks[slot] == NULL) {
+         break;
+      }
+   }
+   if ((callback == NULL) || (slot == MARBLE_ONESHOT_SLOTS)) {
+      __set_PRIMASK(primask);
+      return -1;
+   }
+   us_timer_callbacks[slot] = callback;
+   now = US_TIMER->CNT;
+   (&US_TIMER->CCR1)[slot] = now + delay;
+   US_TIMER->SR = ~(TIM_SR_CC1IF << slot);
+   US_TIMER->DIER |= TIM_DIER_CC1IE << slot;
+   if ((uint32_t)(US_TIMER->CNT - now) >= delay) {
+      // The compare value went by before the interrupt was enabled
+      US_TIMER->EGR = TIM_EGR_CC1G << slot;
+   }
+   __set_PRIMASK(primask);
+   return slot;
+}
+
+void marble_oneshot_cancel(int slot)
+{
+   if ((slot < 0) || (slot >= MARBLE_ONESHOT_SLOTS)) {
+      return;
+   }
+   uint32_t primask = __get_PRIMASK();
+   __disable_irq();
+   US_TIMER->DIER &= ~(TIM_DIER_CC1IE << slot);
+   US_TIMER->SR = ~(TIM_SR_CC1IF << slot);
+   us_timer_callbacks[slot] = NULL;
+   __set_PRIMASK(primask);
+   return;
+}
+
+void TIM5_IRQHandler(void)
+{
+   void (*callback)(void);
+   for (int slot = 0; slot < MARBLE_ONESHOT_SLOTS; slot++) {
+      __disable_irq();
+      if (!(US_TIMER->SR & US_TIMER->DIER & (TIM_SR_CC1IF << slot))) {
+         __enable_irq();
+         continue;
+      }
+      US_TIMER->DIER &= ~(TIM_DIER_CC1IE << slot);
+      US_TIMER->SR = ~(TIM_SR_CC1IF << slot);
+      callback = us_timer_callbacks[slot];
+      // Free the slot first so the callback can re-arm itself
+      us_timer_callbacks[slot] = NULL;
+      __enable_irq();
+      if (callback != NULL) {
+         callback();
+      }
+   }
+   return;
 }
 
 
@@ -956,12 +1521,17 @@ uint32_t marble_init(void)
   // Must happen before any other clock manipulations:
   HAL_Init();
   SystemClock_Config_HSI();
+  marble_cycle_counter_init();
+  us_timer_init();
+  // Keep the debug port usable while the core sleeps in WFI
+  HAL_DBGMCU_EnableDBGSleepMode();
 
   MX_GPIO_Init();
 
   // Configure GPIO interrupts
   marble_GPIOint_init();
   marble_read_pcb_rev();
+  marble_SMBA_init();
 
   marble_PSU_pwr(true);
   MX_ETH_Init();
@@ -1383,7 +1953,7 @@ static void MX_GPIO_Init(void)
    GPIO_InitStruct.Pull = GPIO_NOPULL;
    HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
 
-   /*Configure GPIO pin : PA3 - FPGA_INT (just an input for now; not an interrupt) */
+   /*Configure GPIO pin : PA3 - FPGA_INT (EXTI set up in marble_GPIOint_init) */
    GPIO_InitStruct.Pin = GPIO_PIN_3;
    GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
    GPIO_InitStruct.Pull = GPIO_NOPULL;
@@ -1449,12 +2019,7 @@ static void MX_GPIO_Init(void)
    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
    HAL_GPIO_Init(GPIOC, &GPIO_InitStruct);
 
-   // TODO - Only on Marble v1.4
-   // This is for LTM4673 PMBus Alert IRQ
-   if (0) {
-      HAL_NVIC_SetPriority(EXTI15_10_IRQn, 7, 7);
-      HAL_NVIC_EnableIRQ(EXTI15_10_IRQn);
-   }
+   // The LTM4673 PMBus Alert IRQ is enabled by marble_SMBA_init()
    return;
 }
 
@@ -1670,9 +2235,11 @@ void marble_pmod_set_gpio(uint8_t pinnum, bool state) {
 }
 
 void TIM2_IRQHandler(void) {
+  uint32_t t0 = marble_get_cycles();
   // Clear the update interrupt flag (ok, all interrupt flags)
   PMOD_TIMER->SR = 0;
   system_pmod_led_isr();
+  prof_end(PROF_ISR_TIM2, t0);
   return;
 }
 
@@ -37,6 +37,9 @@
 #include "marble_api.h"
 #include "string.h"
 #include "console.h"
+#include "busprof.h"
+#include "prof.h"
+#include "i2c_shadow.h"
 
 /************
 * Clocking
@@ -47,6 +50,11 @@ const uint32_t OscRateIn = 25000000;
 const uint32_t RTCOscRateIn = 32768;
 static uint32_t _systick = 0;
 
+// Free-running 1 MHz timebase (TIMER1 belongs to the stopwatch)
+#define US_TIMER          (LPC_TIMER2)
+static void (*volatile us_timer_callbacks[MARBLE_ONESHOT_SLOTS])(void);
+static volatile uint8_t us_timer_due = 0;
+
 // Moved here from marble_api.h
 SSP_PORT SSP_FPGA;
 SSP_PORT SSP_PMOD;
@@ -55,6 +63,8 @@ I2C_BUS I2C_PM;
 I2C_BUS I2C_IPMB;
 
 static void pmod_config_direction(bool output);
+static void i2c_prof(I2C_BUS I2C_bus, uint8_t addr, int nbytes, int rc, uint32_t t0);
+static void us_timer_init(void);
 
 void disable_all_IRQs(void) {
    // TODO
@@ -65,6 +75,8 @@ void disable_all_IRQs(void) {
  *  Board-related (not MMC-related) initialization
  */
 void board_init(void) {
+   // Devices may have been reset; re-read before trusting the register shadow
+   i2c_shadow_invalidate();
    // TODO - Any board-specific initialization
    return;
 }
@@ -466,26 +478,34 @@ static void marble_I2C_init(I2C_ID_T id, int poll)
 */
 int marble_I2C_probe(I2C_BUS I2C_bus, uint8_t addr) {
    uint8_t data;
-   addr = addr >> 1;
-   return Chip_I2C_MasterRead(I2C_bus, addr, &data, 1) != 1;
+   uint32_t t0 = marble_get_us();
+   int rc = Chip_I2C_MasterRead(I2C_bus, addr >> 1, &data, 1) != 1;
+   i2c_prof(I2C_bus, addr, 1, rc, t0);
+   return rc;
 }
 
 /* Generic I2C send function with selectable I2C bus and 8-bit I2C addresses (R/W bit = 0) */
 /* For compatibility with STM32 code base (!?),
  * return 0 on success, 1 on failure */
 int marble_I2C_send(I2C_BUS I2C_bus, uint8_t addr, const uint8_t *data, int size) {
-   addr = addr >> 1;
-   return Chip_I2C_MasterSend(I2C_bus, addr, data, size) != size;
+   uint32_t t0 = marble_get_us();
+   int rc = Chip_I2C_MasterSend(I2C_bus, addr >> 1, data, size) != size;
+   i2c_prof(I2C_bus, addr, size, rc, t0);
+   return rc;
 }
 
 int marble_I2C_recv(I2C_BUS I2C_bus, uint8_t addr, uint8_t *data, int size) {
-   addr = addr >> 1;
-   return Chip_I2C_MasterRead(I2C_bus, addr, data, size) != size;
+   uint32_t t0 = marble_get_us();
+   int rc = Chip_I2C_MasterRead(I2C_bus, addr >> 1, data, size) != size;
+   i2c_prof(I2C_bus, addr, size, rc, t0);
+   return rc;
 }
 
 int marble_I2C_cmdrecv(I2C_BUS I2C_bus, uint8_t addr, uint8_t cmd, uint8_t *data, int size) {
-   addr = addr >> 1;
-   return Chip_I2C_MasterCmdRead(I2C_bus, addr, cmd, data, size) != size;
+   uint32_t t0 = marble_get_us();
+   int rc = Chip_I2C_MasterCmdRead(I2C_bus, addr >> 1, cmd, data, size) != size;
+   i2c_prof(I2C_bus, addr, 1 + size, rc, t0);
+   return rc;
 }
 
 int marble_I2C_cmdsend(I2C_BUS I2C_bus, uint8_t addr, uint8_t cmd, const uint8_t *data, int size) {
@@ -517,6 +537,7 @@ int marble_I2C_cmdrecv_a2(I2C_BUS I2C_bus, uint8_t addr, uint16_t cmd, uint8_t *
    // Setup low-level transfer
    // Based on Chip_I2C_MasterCmdRead in i2c_17xx_40xx.c
    I2C_XFER_T xfer = {0};
+   uint32_t t0 = marble_get_us();
    xfer.slaveAddr = addr >> 1;
    xfer.txBuff = cmd_be;
    xfer.txSz = 2;
@@ -524,9 +545,26 @@ int marble_I2C_cmdrecv_a2(I2C_BUS I2C_bus, uint8_t addr, uint16_t cmd, uint8_t *
    xfer.rxSz = size;
    while (Chip_I2C_MasterTransfer(I2C_bus, &xfer) == I2C_STATUS_ARBLOST) {}
    // printf("marble_I2C_cmdrecv_a2: %u %u\n", i2cx, xfer.rxSz);
+   i2c_prof(I2C_bus, addr, 2 + size, xfer.rxSz != 0, t0);
    return xfer.rxSz != 0;
 }
 
+/* static void i2c_prof(I2C_BUS I2C_bus, uint8_t addr, int nbytes, int rc, uint32_t t0);
+ *  Account a transaction that started at marble_get_us() = 't0' in the
+ *  bus-occupancy profiler (busprof.h).  The LPC driver has no timeouts.
+ *  marble_I2C_cmdsend*() go through marble_I2C_send() and are counted there.
+ */
+static void i2c_prof(I2C_BUS I2C_bus, uint8_t addr, int nbytes, int rc, uint32_t t0) {
+   busprof_bus_t bus = BUSPROF_I2C_FPGA;
+   if (I2C_bus == I2C_PM) {
+      bus = BUSPROF_I2C_PM;
+   } else if (I2C_bus == I2C_IPMB) {
+      bus = BUSPROF_I2C_IPMB;
+   }
+   busprof_record(bus, addr, nbytes, rc ? BUSPROF_ERROR : BUSPROF_OK, t0);
+   return;
+}
+
 int getI2CBusStatus(void) {
   // TODO - Implement
   return 0;
@@ -537,6 +575,40 @@ void resetI2CBusStatus(void) {
   return;
 }
 
+int marble_I2C_recover(I2C_BUS I2C_bus) {
+  // TODO - Implement
+  return -1;
+}
+
+int marble_I2C_get_recovery(I2C_BUS I2C_bus, marble_I2C_recovery_t *stats) {
+  // TODO - Implement
+  return -1;
+}
+
+int marble_I2C_PM_get_alert(void) {
+  // Intentional no-op for API compatibility
+  return 0;
+}
+
+void marble_I2C_PM_clear_alert(void) {
+  // Intentional no-op for API compatibility
+  return;
+}
+
+int marble_I2C_PM_alert_asserted(void) {
+  // Intentional no-op for API compatibility
+  return 0;
+}
+
+int marble_FPGAint_get_doorbell(void) {
+  // TODO - Implement (P0[19] GPIO interrupt)
+  return 0;
+}
+
+void marble_FPGAint_clear_doorbell(void) {
+  return;
+}
+
 uint8_t fsynthGetAddr(void) {
   // TODO - Implement
   return 0;
@@ -595,12 +667,20 @@ static void marble_SSP_init(LPC_SSP_T *ssp)
 
 int marble_SSP_write16(SSP_PORT ssp, uint16_t *buffer, unsigned size)
 {
-   return Chip_SSP_WriteFrames_Blocking(ssp, (uint8_t*) buffer, size*2); // API expected length in bytes
+   uint32_t t0 = marble_get_us();
+   int rc = Chip_SSP_WriteFrames_Blocking(ssp, (uint8_t*) buffer, size*2); // API expected length in bytes
+   busprof_record(ssp == SSP_FPGA ? BUSPROF_SSP_FPGA : BUSPROF_SSP_PMOD, 0, 2*size,
+                  rc == (int)(2*size) ? BUSPROF_OK : BUSPROF_ERROR, t0);
+   return rc;
 }
 
 int marble_SSP_read16(SSP_PORT ssp, uint16_t *buffer, unsigned size)
 {
-   return Chip_SSP_ReadFrames_Blocking(ssp, (uint8_t*) buffer, size*2);
+   uint32_t t0 = marble_get_us();
+   int rc = Chip_SSP_ReadFrames_Blocking(ssp, (uint8_t*) buffer, size*2);
+   busprof_record(ssp == SSP_FPGA ? BUSPROF_SSP_FPGA : BUSPROF_SSP_PMOD, 0, 2*size,
+                  rc == (int)(2*size) ? BUSPROF_OK : BUSPROF_ERROR, t0);
+   return rc;
 }
 
 int marble_SSP_exch16(SSP_PORT ssp, uint16_t *tx_buf, uint16_t *rx_buf, unsigned size)
@@ -611,7 +691,11 @@ int marble_SSP_exch16(SSP_PORT ssp, uint16_t *tx_buf, uint16_t *rx_buf, unsigned
    set.rx_data = rx_buf;
    set.rx_cnt = 0;
    set.length = size;
-   return Chip_SSP_RWFrames_Blocking(ssp, &set);
+   uint32_t t0 = marble_get_us();
+   int rc = Chip_SSP_RWFrames_Blocking(ssp, &set);
+   busprof_record(ssp == SSP_FPGA ? BUSPROF_SSP_FPGA : BUSPROF_SSP_PMOD, 0, 2*size,
+                  rc > 0 ? BUSPROF_OK : BUSPROF_ERROR, t0);
+   return rc;
 }
 
 /************
@@ -647,15 +731,45 @@ void (*volatile marble_SysTick_Handler)(void) = SysTick_Handler_dummy;
 // Override default (weak) SysTick_Handler
 void SysTick_Handler(void)
 {
+   uint32_t t0 = marble_get_cycles();
    ++_systick;
    if (marble_SysTick_Handler)
       marble_SysTick_Handler();
+   prof_end(PROF_ISR_SYSTICK, t0);
 }
 
 uint32_t marble_get_tick(void) {
   return _systick;
 }
 
+uint32_t marble_get_us(void) {
+  return Chip_TIMER_ReadCount(US_TIMER);
+}
+
+uint32_t marble_get_cycles(void) {
+  return DWT->CYCCNT;
+}
+
+uint32_t marble_cycles_per_us(void) {
+  return SystemCoreClock/1000000;
+}
+
+/* static void marble_cycle_counter_init(void);
+ *  Start the DWT cycle counter (used by marble_get_cycles()).
+ */
+static void marble_cycle_counter_init(void)
+{
+   CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+   DWT->CYCCNT = 0;
+   DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+   return;
+}
+
+void marble_wait_for_interrupt(void) {
+   __WFI();
+   return;
+}
+
 /* Register user-defined interrupt handlers */
 void marble_SYSTIMER_handler(void (*handler)(void)) {
    marble_SysTick_Handler = handler;
@@ -682,7 +796,93 @@ void marble_SLEEP_ms(uint32_t delay)
 
 void marble_SLEEP_us(uint32_t delay)
 {
-   StopWatch_DelayUs(delay);
+   uint32_t t0 = marble_get_us();
+   // Strictly greater: the first count may come right after t0 was read
+   while ((uint32_t)(marble_get_us() - t0) <= delay) {}
+   return;
+}
+
+/************
+* Microsecond timebase
+************/
+/* TIMER2 free-runs at 1 MHz and wraps every ~71.6 minutes.  Its four match
+ * registers provide the one-shot slots.
+ */
+static void us_timer_init(void)
+{
+   uint32_t pclk = Chip_Clock_GetSystemClockRate() / Chip_Clock_GetPCLKDiv();
+   Chip_TIMER_Init(US_TIMER);
+   Chip_TIMER_PrescaleSet(US_TIMER, pclk/1000000 - 1);
+   Chip_TIMER_Enable(US_TIMER);
+   NVIC_SetPriority(TIMER2_IRQn, 7);
+   NVIC_EnableIRQ(TIMER2_IRQn);
+   return;
+}
+
+int marble_oneshot_us(uint32_t delay, void (*callback)(void))
+{
+   int slot;
+   uint32_t now;
+   uint32_t primask = __get_PRIMASK();
+   __disable_irq();
+   for (slot = 0; slot < MARBLE_ONESHOT_SLOTS; slot++) {
+      if (us_timer_callbacks[slot] == NULL) {
+         break;
+      }
+   }
+   if ((callback == NULL) || (slot == MARBLE_ONESHOT_SLOTS)) {
+      __set_PRIMASK(primask);
+      return -1;
+   }
+   us_timer_callbacks[slot] = callback;
+   now = Chip_TIMER_ReadCount(US_TIMER);
+   Chip_TIMER_SetMatch(US_TIMER, (int8_t)slot, now + delay);
+   Chip_TIMER_ClearMatch(US_TIMER, (int8_t)slot);
+   Chip_TIMER_MatchEnableInt(US_TIMER, (int8_t)slot);
+   if ((uint32_t)(Chip_TIMER_ReadCount(US_TIMER) - now) >= delay) {
+      // The match value went by before the interrupt was enabled
+      us_timer_due |= (uint8_t)(1 << slot);
+      NVIC_SetPendingIRQ(TIMER2_IRQn);
+   }
+   __set_PRIMASK(primask);
+   return slot;
+}
+
+void marble_oneshot_cancel(int slot)
+{
+   if ((slot < 0) || (slot >= MARBLE_ONESHOT_SLOTS)) {
+      return;
+   }
+   uint32_t primask = __get_PRIMASK();
+   __disable_irq();
+   Chip_TIMER_MatchDisableInt(US_TIMER, (int8_t)slot);
+   Chip_TIMER_ClearMatch(US_TIMER, (int8_t)slot);
+   us_timer_due &= (uint8_t)~(1 << slot);
+   us_timer_callbacks[slot] = NULL;
+   __set_PRIMASK(primask);
+   return;
+}
+
+void TIMER2_IRQHandler(void)
+{
+   void (*callback)(void);
+   for (int slot = 0; slot < MARBLE_ONESHOT_SLOTS; slot++) {
+      __disable_irq();
+      if ((us_timer_callbacks[slot] == NULL)
+          || !(Chip_TIMER_MatchPending(US_TIMER, (int8_t)slot) || (us_timer_due & (1 << slot)))) {
+         __enable_irq();
+         continue;
+      }
+      Chip_TIMER_MatchDisableInt(US_TIMER, (int8_t)slot);
+      Chip_TIMER_ClearMatch(US_TIMER, (int8_t)slot);
+      us_timer_due &= (uint8_t)~(1 << slot);
+      callback = us_timer_callbacks[slot];
+      // Free the slot first so the callback can re-arm itself
+      us_timer_callbacks[slot] = NULL;
+      __enable_irq();
+      callback();
+   }
+   return;
 }
 
 Marble_PCB_Rev_t marble_get_pcb_rev(void) {
@@ -721,6 +921,8 @@ uint32_t marble_init(void)
 
    // Initialize system stopwatch
    StopWatch_Init();
+   marble_cycle_counter_init();
+   us_timer_init();
 
    marble_LED_init();
    marble_SW_init();
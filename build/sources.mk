@@ -13,3 +13,13 @@ $(SOURCE_DIR)/ltm4673.c \
 $(SOURCE_DIR)/watchdog.c \
 $(SOURCE_DIR)/refsip.c \
 $(SOURCE_DIR)/system.c \
+$(SOURCE_DIR)/report.c \
+$(SOURCE_DIR)/uart_frame.c \
+$(SOURCE_DIR)/pmlog.c \
+$(SOURCE_DIR)/mbox_rpc.c \
+$(SOURCE_DIR)/mbox_fifo.c \
+$(SOURCE_DIR)/busprof.c \
+$(SOURCE_DIR)/i2c_shadow.c \
+$(SOURCE_DIR)/prof.c \
+$(SOURCE_DIR)/event.c \
+$(SOURCE_DIR)/fanctl.c \
@@ -1,7 +1,7 @@
 #ifndef __MAILBOX_MAP_H
 #define __MAILBOX_MAP_H
 
-#define MAILBOX_HASH (0x2d40ee95)
+#define MAILBOX_HASH (0x0011c41a)
 
 //  Page 0
 #define MAGIC_NUMBER_ADDR (0x0)
@@ -103,4 +103,171 @@
 #define PMOD_LED_6_SIZE (1)
 #define PMOD_LED_7_ADDR (0xa7)
 #define PMOD_LED_7_SIZE (1)
+//  Page 11
+#define PM_FAULT_FLAG_ADDR (0xb0)
+#define PM_FAULT_FLAG_SIZE (1)
+#define PM_FAULT_COUNT_ADDR (0xb2)
+#define PM_FAULT_COUNT_SIZE (2)
+#define PM_STATUS_WORD0_ADDR (0xb4)
+#define PM_STATUS_WORD0_SIZE (2)
+#define PM_STATUS_WORD1_ADDR (0xb6)
+#define PM_STATUS_WORD1_SIZE (2)
+#define PM_STATUS_WORD2_ADDR (0xb8)
+#define PM_STATUS_WORD2_SIZE (2)
+#define PM_STATUS_WORD3_ADDR (0xba)
+#define PM_STATUS_WORD3_SIZE (2)
+//  Page 12
+#define PMLOG_SEL_ADDR (0xc0)
+#define PMLOG_SEL_SIZE (1)
+#define PMLOG_COUNT_ADDR (0xc1)
+#define PMLOG_COUNT_SIZE (1)
+#define PMLOG_FREE_ADDR (0xc2)
+#define PMLOG_FREE_SIZE (1)
+#define PMLOG_SEQ_ADDR (0xc4)
+#define PMLOG_SEQ_SIZE (4)
+#define PMLOG_TICK_ADDR (0xc8)
+#define PMLOG_TICK_SIZE (4)
+#define PMLOG_VIN_ADDR (0xcc)
+#define PMLOG_VIN_SIZE (2)
+#define PMLOG_IIN_ADDR (0xce)
+#define PMLOG_IIN_SIZE (2)
+//  Page 13
+#define PMLOG_VOUT_1V0_ADDR (0xd0)
+#define PMLOG_VOUT_1V0_SIZE (2)
+#define PMLOG_IOUT_1V0_ADDR (0xd2)
+#define PMLOG_IOUT_1V0_SIZE (2)
+#define PMLOG_VOUT_1V8_ADDR (0xd4)
+#define PMLOG_VOUT_1V8_SIZE (2)
+#define PMLOG_IOUT_1V8_ADDR (0xd6)
+#define PMLOG_IOUT_1V8_SIZE (2)
+#define PMLOG_VOUT_2V5_ADDR (0xd8)
+#define PMLOG_VOUT_2V5_SIZE (2)
+#define PMLOG_IOUT_2V5_ADDR (0xda)
+#define PMLOG_IOUT_2V5_SIZE (2)
+#define PMLOG_VOUT_3V3_ADDR (0xdc)
+#define PMLOG_VOUT_3V3_SIZE (2)
+#define PMLOG_IOUT_3V3_ADDR (0xde)
+#define PMLOG_IOUT_3V3_SIZE (2)
+//  Page 16
+#define RPC_REQ_SEQ_ADDR (0x100)
+#define RPC_REQ_SEQ_SIZE (1)
+#define RPC_REQ_OP_ADDR (0x101)
+#define RPC_REQ_OP_SIZE (1)
+#define RPC_REQ_LEN_ADDR (0x102)
+#define RPC_REQ_LEN_SIZE (1)
+#define RPC_REQ_ARG_A_ADDR (0x103)
+#define RPC_REQ_ARG_A_SIZE (13)
+//  Page 17
+#define RPC_REQ_ARG_B_ADDR (0x110)
+#define RPC_REQ_ARG_B_SIZE (16)
+//  Page 18
+#define RPC_RSP_SEQ_ADDR (0x120)
+#define RPC_RSP_SEQ_SIZE (1)
+#define RPC_RSP_STATUS_ADDR (0x121)
+#define RPC_RSP_STATUS_SIZE (1)
+#define RPC_RSP_LEN_ADDR (0x122)
+#define RPC_RSP_LEN_SIZE (1)
+#define RPC_RSP_DATA_A_ADDR (0x123)
+#define RPC_RSP_DATA_A_SIZE (13)
+//  Page 19
+#define RPC_RSP_DATA_B_ADDR (0x130)
+#define RPC_RSP_DATA_B_SIZE (16)
+//  Page 20
+#define FIFO_TAIL_ADDR (0x140)
+#define FIFO_TAIL_SIZE (2)
+#define FIFO_HEAD_ADDR (0x142)
+#define FIFO_HEAD_SIZE (2)
+#define FIFO_WIN_START_ADDR (0x144)
+#define FIFO_WIN_START_SIZE (2)
+#define FIFO_WIN_LEN_ADDR (0x146)
+#define FIFO_WIN_LEN_SIZE (1)
+#define FIFO_DROPPED_ADDR (0x147)
+#define FIFO_DROPPED_SIZE (2)
+//  Page 21
+#define FIFO_DATA_A_ADDR (0x150)
+#define FIFO_DATA_A_SIZE (16)
+//  Page 22
+#define FIFO_DATA_B_ADDR (0x160)
+#define FIFO_DATA_B_SIZE (16)
+//  Page 23
+#define FIFO_DATA_C_ADDR (0x170)
+#define FIFO_DATA_C_SIZE (16)
+//  Page 24
+#define BUSPROF_SEL_ADDR (0x180)
+#define BUSPROF_SEL_SIZE (1)
+#define BUSPROF_ENTRIES_ADDR (0x181)
+#define BUSPROF_ENTRIES_SIZE (1)
+#define BUSPROF_BUS_ADDR (0x182)
+#define BUSPROF_BUS_SIZE (1)
+#define BUSPROF_ADDR_ADDR (0x183)
+#define BUSPROF_ADDR_SIZE (1)
+#define BUSPROF_ERRORS_ADDR (0x184)
+#define BUSPROF_ERRORS_SIZE (2)
+#define BUSPROF_TIMEOUTS_ADDR (0x186)
+#define BUSPROF_TIMEOUTS_SIZE (2)
+#define BUSPROF_MAX_US_ADDR (0x188)
+#define BUSPROF_MAX_US_SIZE (4)
+#define BUSPROF_ELAPSED_MS_ADDR (0x18c)
+#define BUSPROF_ELAPSED_MS_SIZE (4)
+//  Page 25
+#define BUSPROF_COUNT_ADDR (0x190)
+#define BUSPROF_COUNT_SIZE (4)
+#define BUSPROF_BYTES_ADDR (0x194)
+#define BUSPROF_BYTES_SIZE (4)
+#define BUSPROF_US_ADDR (0x198)
+#define BUSPROF_US_SIZE (4)
+//  Page 26
+#define FAN_FPGA_TEMP_ADDR (0x1a0)
+#define FAN_FPGA_TEMP_SIZE (2)
+#define FAN_CTL_STATE_ADDR (0x1a2)
+#define FAN_CTL_STATE_SIZE (1)
+#define FAN_CTL_SOURCE_ADDR (0x1a3)
+#define FAN_CTL_SOURCE_SIZE (1)
+#define FAN_CTL_SETPOINT_ADDR (0x1a4)
+#define FAN_CTL_SETPOINT_SIZE (1)
+#define FAN_CTL_TEMP_ADDR (0x1a5)
+#define FAN_CTL_TEMP_SIZE (2)
+#define FAN_CTL_DUTY_ADDR (0x1a7)
+#define FAN_CTL_DUTY_SIZE (1)
+#define FAN_CTL_INTEG_ADDR (0x1a8)
+#define FAN_CTL_INTEG_SIZE (2)
+//  Page 27
+#define FMC_MON_STATUS_ADDR (0x1b0)
+#define FMC_MON_STATUS_SIZE (1)
+#define FMC1_CURRENT_ADDR (0x1b1)
+#define FMC1_CURRENT_SIZE (2)
+#define FMC2_CURRENT_ADDR (0x1b3)
+#define FMC2_CURRENT_SIZE (2)
+#define FMC1_SHUNT_ADDR (0x1b5)
+#define FMC1_SHUNT_SIZE (2)
+#define FMC2_SHUNT_ADDR (0x1b7)
+#define FMC2_SHUNT_SIZE (2)
+//  Page 15
+#define SEQ3_ADDR (0xf0)
+#define SEQ3_SIZE (1)
+#define SEQ4_ADDR (0xf1)
+#define SEQ4_SIZE (1)
+#define SEQ6_ADDR (0xf2)
+#define SEQ6_SIZE (1)
+#define SEQ7_ADDR (0xf3)
+#define SEQ7_SIZE (1)
+#define SEQ9_ADDR (0xf4)
+#define SEQ9_SIZE (1)
+#define SEQ11_ADDR (0xf5)
+#define SEQ11_SIZE (1)
+#define SEQ12_ADDR (0xf6)
+#define SEQ12_SIZE (1)
+#define SEQ13_ADDR (0xf7)
+#define SEQ13_SIZE (1)
+#define SEQ24_ADDR (0xf8)
+#define SEQ24_SIZE (1)
+#define SEQ25_ADDR (0xf9)
+#define SEQ25_SIZE (1)
+#define SEQ26_ADDR (0xfa)
+#define SEQ26_SIZE (1)
+#define SEQ27_ADDR (0xfb)
+#define SEQ27_SIZE (1)
+//  Page 14
+#define DOORBELL_ADDR (0xe0)
+#define DOORBELL_SIZE (4)
 #endif // __MAILBOX_MAP_H
@@ -1,7 +1,7 @@
 `ifndef __MAILBOX_MAP_VH
 `define __MAILBOX_MAP_VH
 
-localparam MAILBOX_HASH = 32'h2d40ee95;
+localparam MAILBOX_HASH = 32'h0011c41a;
 
 //  Page 0
 localparam MAGIC_NUMBER_ADDR = 'h0;
@@ -103,4 +103,171 @@ localparam PMOD_LED_6_ADDR = 'ha6;
 localparam PMOD_LED_6_SIZE = 1;
 localparam PMOD_LED_7_ADDR = 'ha7;
 localparam PMOD_LED_7_SIZE = 1;
+//  Page 11
+localparam PM_FAULT_FLAG_ADDR = 'hb0;
+localparam PM_FAULT_FLAG_SIZE = 1;
+localparam PM_FAULT_COUNT_ADDR = 'hb2;
+localparam PM_FAULT_COUNT_SIZE = 2;
+localparam PM_STATUS_WORD0_ADDR = 'hb4;
+localparam PM_STATUS_WORD0_SIZE = 2;
+localparam PM_STATUS_WORD1_ADDR = 'hb6;
+localparam PM_STATUS_WORD1_SIZE = 2;
+localparam PM_STATUS_WORD2_ADDR = 'hb8;
+localparam PM_STATUS_WORD2_SIZE = 2;
+localparam PM_STATUS_WORD3_ADDR = 'hba;
+localparam PM_STATUS_WORD3_SIZE = 2;
+//  Page 12
+localparam PMLOG_SEL_ADDR = 'hc0;
+localparam PMLOG_SEL_SIZE = 1;
+localparam PMLOG_COUNT_ADDR = 'hc1;
+localparam PMLOG_COUNT_SIZE = 1;
+localparam PMLOG_FREE_ADDR = 'hc2;
+localparam PMLOG_FREE_SIZE = 1;
+localparam PMLOG_SEQ_ADDR = 'hc4;
+localparam PMLOG_SEQ_SIZE = 4;
+localparam PMLOG_TICK_ADDR = 'hc8;
+localparam PMLOG_TICK_SIZE = 4;
+localparam PMLOG_VIN_ADDR = 'hcc;
+localparam PMLOG_VIN_SIZE = 2;
+localparam PMLOG_IIN_ADDR = 'hce;
+localparam PMLOG_IIN_SIZE = 2;
+//  Page 13
+localparam PMLOG_VOUT_1V0_ADDR = 'hd0;
+localparam PMLOG_VOUT_1V0_SIZE = 2;
+localparam PMLOG_IOUT_1V0_ADDR = 'hd2;
+localparam PMLOG_IOUT_1V0_SIZE = 2;
+localparam PMLOG_VOUT_1V8_ADDR = 'hd4;
+localparam PMLOG_VOUT_1V8_SIZE = 2;
+localparam PMLOG_IOUT_1V8_ADDR = 'hd6;
+localparam PMLOG_IOUT_1V8_SIZE = 2;
+localparam PMLOG_VOUT_2V5_ADDR = 'hd8;
+localparam PMLOG_VOUT_2V5_SIZE = 2;
+localparam PMLOG_IOUT_2V5_ADDR = 'hda;
+localparam PMLOG_IOUT_2V5_SIZE = 2;
+localparam PMLOG_VOUT_3V3_ADDR = 'hdc;
+localparam PMLOG_VOUT_3V3_SIZE = 2;
+localparam PMLOG_IOUT_3V3_ADDR = 'hde;
+localparam PMLOG_IOUT_3V3_SIZE = 2;
+//  Page 16
+localparam RPC_REQ_SEQ_ADDR = 'h100;
+localparam RPC_REQ_SEQ_SIZE = 1;
+localparam RPC_REQ_OP_ADDR = 'h101;
+localparam RPC_REQ_OP_SIZE = 1;
+localparam RPC_REQ_LEN_ADDR = 'h102;
+localparam RPC_REQ_LEN_SIZE = 1;
+localparam RPC_REQ_ARG_A_ADDR = 'h103;
+localparam RPC_REQ_ARG_A_SIZE = 13;
+//  Page 17
+localparam RPC_REQ_ARG_B_ADDR = 'h110;
+localparam RPC_REQ_ARG_B_SIZE = 16;
+//  Page 18
+localparam RPC_RSP_SEQ_ADDR = 'h120;
+localparam RPC_RSP_SEQ_SIZE = 1;
+localparam RPC_RSP_STATUS_ADDR = 'h121;
+localparam RPC_RSP_STATUS_SIZE = 1;
+localparam RPC_RSP_LEN_ADDR = 'h122;
+localparam RPC_RSP_LEN_SIZE = 1;
+localparam RPC_RSP_DATA_A_ADDR = 'h123;
+localparam RPC_RSP_DATA_A_SIZE = 13;
+//  Page 19
+localparam RPC_RSP_DATA_B_ADDR = 'h130;
+localparam RPC_RSP_DATA_B_SIZE = 16;
+//  Page 20
+localparam FIFO_TAIL_ADDR = 'h140;
+localparam FIFO_TAIL_SIZE = 2;
+localparam FIFO_HEAD_ADDR = 'h142;
+localparam FIFO_HEAD_SIZE = 2;
+localparam FIFO_WIN_START_ADDR = 'h144;
+localparam FIFO_WIN_START_SIZE = 2;
+localparam FIFO_WIN_LEN_ADDR = 'h146;
+localparam FIFO_WIN_LEN_SIZE = 1;
+localparam FIFO_DROPPED_ADDR = 'h147;
+localparam FIFO_DROPPED_SIZE = 2;
+//  Page 21
+localparam FIFO_DATA_A_ADDR = 'h150;
+localparam FIFO_DATA_A_SIZE = 16;
+//  Page 22
+localparam FIFO_DATA_B_ADDR = 'h160;
+localparam FIFO_DATA_B_SIZE = 16;
+//  Page 23
+localparam FIFO_DATA_C_ADDR = 'h170;
+localparam FIFO_DATA_C_SIZE = 16;
+//  Page 24
+localparam BUSPROF_SEL_ADDR = 'h180;
+localparam BUSPROF_SEL_SIZE = 1;
+localparam BUSPROF_ENTRIES_ADDR = 'h181;
+localparam BUSPROF_ENTRIES_SIZE = 1;
+localparam BUSPROF_BUS_ADDR = 'h182;
+localparam BUSPROF_BUS_SIZE = 1;
+localparam BUSPROF_ADDR_ADDR = 'h183;
+localparam BUSPROF_ADDR_SIZE = 1;
+localparam BUSPROF_ERRORS_ADDR = 'h184;
+localparam BUSPROF_ERRORS_SIZE = 2;
+localparam BUSPROF_TIMEOUTS_ADDR = 'h186;
+localparam BUSPROF_TIMEOUTS_SIZE = 2;
+localparam BUSPROF_MAX_US_ADDR = 'h188;
+localparam BUSPROF_MAX_US_SIZE = 4;
+localparam BUSPROF_ELAPSED_MS_ADDR = 'h18c;
+localparam BUSPROF_ELAPSED_MS_SIZE = 4;
+//  Page 25
+localparam BUSPROF_COUNT_ADDR = 'h190;
+localparam BUSPROF_COUNT_SIZE = 4;
+localparam BUSPROF_BYTES_ADDR = 'h194;
+localparam BUSPROF_BYTES_SIZE = 4;
+localparam BUSPROF_US_ADDR = 'h198;
+localparam BUSPROF_US_SIZE = 4;
+//  Page 26
+localparam FAN_FPGA_TEMP_ADDR = 'h1a0;
+localparam FAN_FPGA_TEMP_SIZE = 2;
+localparam FAN_CTL_STATE_ADDR = 'h1a2;
+localparam FAN_CTL_STATE_SIZE = 1;
+localparam FAN_CTL_SOURCE_ADDR = 'h1a3;
+localparam FAN_CTL_SOURCE_SIZE = 1;
+localparam FAN_CTL_SETPOINT_ADDR = 'h1a4;
+localparam FAN_CTL_SETPOINT_SIZE = 1;
+localparam FAN_CTL_TEMP_ADDR = 'h1a5;
+localparam FAN_CTL_TEMP_SIZE = 2;
+localparam FAN_CTL_DUTY_ADDR = 'h1a7;
+localparam FAN_CTL_DUTY_SIZE = 1;
+localparam FAN_CTL_INTEG_ADDR = 'h1a8;
+localparam FAN_CTL_INTEG_SIZE = 2;
+//  Page 27
+localparam FMC_MON_STATUS_ADDR = 'h1b0;
+localparam FMC_MON_STATUS_SIZE = 1;
+localparam FMC1_CURRENT_ADDR = 'h1b1;
+localparam FMC1_CURRENT_SIZE = 2;
+localparam FMC2_CURRENT_ADDR = 'h1b3;
+localparam FMC2_CURRENT_SIZE = 2;
+localparam FMC1_SHUNT_ADDR = 'h1b5;
+localparam FMC1_SHUNT_SIZE = 2;
+localparam FMC2_SHUNT_ADDR = 'h1b7;
+localparam FMC2_SHUNT_SIZE = 2;
+//  Page 15
+localparam SEQ3_ADDR = 'hf0;
+localparam SEQ3_SIZE = 1;
+localparam SEQ4_ADDR = 'hf1;
+localparam SEQ4_SIZE = 1;
+localparam SEQ6_ADDR = 'hf2;
+localparam SEQ6_SIZE = 1;
+localparam SEQ7_ADDR = 'hf3;
+localparam SEQ7_SIZE = 1;
+localparam SEQ9_ADDR = 'hf4;
+localparam SEQ9_SIZE = 1;
+localparam SEQ11_ADDR = 'hf5;
+localparam SEQ11_SIZE = 1;
+localparam SEQ12_ADDR = 'hf6;
+localparam SEQ12_SIZE = 1;
+localparam SEQ13_ADDR = 'hf7;
+localparam SEQ13_SIZE = 1;
+localparam SEQ24_ADDR = 'hf8;
+localparam SEQ24_SIZE = 1;
+localparam SEQ25_ADDR = 'hf9;
+localparam SEQ25_SIZE = 1;
+localparam SEQ26_ADDR = 'hfa;
+localparam SEQ26_SIZE = 1;
+localparam SEQ27_ADDR = 'hfb;
+localparam SEQ27_SIZE = 1;
+//  Page 14
+localparam DOORBELL_ADDR = 'he0;
+localparam DOORBELL_SIZE = 4;
 `endif // __MAILBOX_MAP_VH
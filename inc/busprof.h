@@ -0,0 +1,96 @@
+/*
+ * File: busprof.h
+ * Desc: Bus-occupancy profiler.  The marble_I2C_* and marble_SSP_* wrappers
+ *       in board support record every transaction here, so the table shows
+ *       how much time each (bus, address) pair takes out of the main loop.
+ *       Per entry: transactions, bytes, errors, timeouts, and accumulated
+ *       and worst-case time in microseconds (marble_get_us()).
+ *
+ *       The wrappers are only called from thread mode, so entries are
+ *       updated without locking.  SPI ports have no address; their traffic
+ *       is recorded with address 0.  Once the table is full, transactions to
+ *       new (bus, address) pairs are only counted in 'overflow'.
+ */
+
+#ifndef __BUSPROF_H
+#define __BUSPROF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define BUSPROF_TABLE_SIZE                          (32)
+// Written to BUSPROF_SEL to clear the table
+#define BUSPROF_SEL_RESET                         (0xff)
+
+typedef enum {
+  BUSPROF_I2C_PM = 0,
+  BUSPROF_I2C_FPGA,
+  BUSPROF_I2C_IPMB,
+  BUSPROF_SSP_FPGA,
+  BUSPROF_SSP_PMOD,
+  BUSPROF_NUM_BUSES
+} busprof_bus_t;
+
+typedef enum {
+  BUSPROF_OK = 0,
+  BUSPROF_ERROR,
+  BUSPROF_TIMEOUT
+} busprof_status_t;
+
+typedef struct {
+  uint8_t bus;          // busprof_bus_t
+  uint8_t addr;         // 8-bit I2C address (0 for SPI)
+  uint16_t errors;      // Failed transactions other than timeouts (saturating)
+  uint16_t timeouts;    // Timed-out transactions (saturating)
+  uint32_t count;       // Transactions
+  uint32_t bytes;       // Payload bytes, including register/command bytes
+  uint32_t us;          // Accumulated time in the wrapper
+  uint32_t max_us;      // Longest single transaction
+} busprof_entry_t;
+
+/* void busprof_record(busprof_bus_t bus, uint8_t addr, int nbytes,
+ *                     busprof_status_t status, uint32_t t0);
+ *  Account one transaction which started at marble_get_us() = 't0' and has
+ *  just finished.
+ */
+void busprof_record(busprof_bus_t bus, uint8_t addr, int nbytes, busprof_status_t status, uint32_t t0);
+
+/* const busprof_entry_t *busprof_get(unsigned int n);
+ *  Return the n-th entry of the table (in order of first use) or NULL.
+ */
+const busprof_entry_t *busprof_get(unsigned int n);
+
+int busprof_count(void);
+
+/* uint32_t busprof_elapsed_ms(void);
+ *  Time since the table was last cleared.
+ */
+uint32_t busprof_elapsed_ms(void);
+
+void busprof_reset(void);
+
+/* void busprof_print(void);
+ *  Print the table, with each entry's share of the time since the last clear.
+ */
+void busprof_print(void);
+
+// Mailbox access: the FPGA selects an entry, then reads it back
+void busprof_mbox_select(uint8_t n);
+uint8_t busprof_mbox_selected(void);
+uint8_t busprof_mbox_bus(void);
+uint8_t busprof_mbox_addr(void);
+uint16_t busprof_mbox_errors(void);
+uint16_t busprof_mbox_timeouts(void);
+uint32_t busprof_mbox_count(void);
+uint32_t busprof_mbox_bytes(void);
+uint32_t busprof_mbox_us(void);
+uint32_t busprof_mbox_max_us(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __BUSPROF_H
@@ -24,7 +24,15 @@ extern "C" {
  *  *   handleMsg(msg);
  */
 
-#define CONSOLE_MAX_MESSAGE_LENGTH          (128)
+#define CONSOLE_MAX_MESSAGE_LENGTH          (250)  // Should match UART_QUEUE_ITEMS
+// Multiple commands can be sent on one line, separated by this char
+#define CONSOLE_BATCH_SEPARATOR             (';')
+// A command prefixed with "@seq " is answered with exactly one line
+// "@seq OK" or "@seq ERR code" and its usual output is suppressed.
+#define CONSOLE_SEQ_TAG                     ('@')
+// Output of a command run by console_run() kept for the remote caller;
+// anything beyond this is dropped
+#define CONSOLE_CAPTURE_SIZE                (1024)
 #define PRINT_NA() printf("Function not available on this board.\r\n")
 
 #define MAC_LENGTH    (6)
@@ -41,6 +49,11 @@ void console_pend_msg(void);
 int console_push_fpga_mac_ip(void);
 void console_print_mac_ip(void);
 void console_pend_FPGA_enable(void);
+int console_quiet(void);
+int console_run(const char *cmd, int len);
+void console_capture(int ch);
+int console_output(unsigned int offset, uint8_t *data, int len);
+unsigned int console_output_size(void);
 
 void set_last_ip(const uint8_t *ip);
 uint8_t *get_last_ip(void);
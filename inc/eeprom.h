@@ -69,7 +69,12 @@ typedef struct {
   X(11,wd_key_2,  raw, 4, {' ','k','e','y'}) \
   X(12,mbox_en,   raw, 1, {1}) \
   X(13,tach_en,   raw, 1, {1}) \
-  X(14,pmod_mode, raw, 1, {0})
+  X(14,pmod_mode, raw, 1, {0}) \
+  X(15,fan_ctl_en,   raw, 1, {0}) \
+  X(16,fan_setpoint, raw, 1, {60}) \
+  X(17,fan_gains,    raw, 2, {8, 16}) \
+  X(18,fan_duty_lim, raw, 2, {24, 120}) \
+  X(19,fan_slew,     raw, 1, {12})
 
 typedef enum {
   ee_RESERVED,
@@ -95,6 +100,20 @@ int eeprom_read_ ## NAME(volatile uint8_t *pdata, int len);
 FOR_ALL_EETAGS()
 #undef X
 
+/*
+ * int eeprom_tag_size(ee_tag_t tag);
+ * int eeprom_read_tag(ee_tag_t tag, volatile uint8_t *pdata, int len);
+ * int eeprom_store_tag(ee_tag_t tag, const uint8_t *pdata, int len);
+ *    Access by numeric tag (the 'N' in FOR_ALL_EETAGS()) for generic
+ *    transports.  'len' is clipped to the size of the tag.
+ *    eeprom_tag_size() returns -1 for unknown tags; the read/store functions
+ *    return -EINVAL for unknown tags, else the same as eeprom_read_NAME()
+ *    and eeprom_store_NAME().
+ */
+int eeprom_tag_size(ee_tag_t tag);
+int eeprom_read_tag(ee_tag_t tag, volatile uint8_t *pdata, int len);
+int eeprom_store_tag(ee_tag_t tag, const uint8_t *pdata, int len);
+
 /* Hand-written functions are required for entries > 6 bytes */
 int eeprom_read_wd_key(volatile uint8_t *pdata, int len);
 int eeprom_store_wd_key(const uint8_t *pdata, int len);
@@ -0,0 +1,57 @@
+/*
+ * File: event.h
+ * Desc: Events posted from interrupt context to the main loop.  Each event
+ *       type has its own pending flag which ISRs only set and the main loop
+ *       only clears (before acting on it), so neither side needs a lock and
+ *       an event posted while its handler runs is seen on the next pass.
+ *       Repeated posts of one type coalesce; the handler drains whatever
+ *       work is queued behind it.
+ *
+ *       When nothing is pending, the main loop sleeps in event_wait() until
+ *       the next interrupt.  The system timer posts the tick events, which
+ *       drive the remaining polled work and the timed deadlines.
+ */
+
+#ifndef __EVENT_H
+#define __EVENT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+typedef enum {
+  EVENT_TICK = 0,       // System timer period; for system_service()
+  EVENT_BOARD_TICK,     // System timer period; for board_service()
+  EVENT_MBOX_UPDATE,    // Mailbox update period (MBOX_FAST_PERIOD_MS) elapsed
+  EVENT_DOORBELL,       // FPGA rang the mailbox doorbell (FPGA_INT)
+  EVENT_CONSOLE,        // Console line or binary frame received
+  EVENT_PM_ALERT,       // SMBALERT asserted on I2C_PM
+  EVENT_NUM
+} event_t;
+
+/* void event_post(event_t ev);
+ *  Mark 'ev' pending.  Safe to call from any ISR or the main loop.
+ */
+void event_post(event_t ev);
+
+/* int event_take(event_t ev);
+ *  Return 1 and clear 'ev' if it was pending, otherwise 0.  Main loop only.
+ */
+int event_take(event_t ev);
+
+int event_pending(void);
+
+/* void event_wait(void);
+ *  Sleep until an interrupt arrives unless an event is already pending.
+ *  The check and the sleep run with interrupts masked, so an event posted
+ *  in between wakes the core right away instead of being missed.
+ */
+void event_wait(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __EVENT_H
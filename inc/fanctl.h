@@ -0,0 +1,95 @@
+/*
+ * File: fanctl.h
+ * Desc: Closed-loop fan control.  A PI controller drives the MAX6639 fan
+ *       duty from the hottest of the board's temperature sensors: the two
+ *       MAX6639 channels and the LM75s (from the snapshot the mailbox takes)
+ *       and optionally the FPGA die temperature written by the FPGA to the
+ *       mailbox.  It runs every FANCTL_PERIOD_MS from system_service().
+ *
+ *       Fixed point: temperatures in 1/8 degC, the integrator in 1/256 of a
+ *       duty count (duty counts are percent*1.2, as for max6639_set_fans()).
+ *         Kp      duty counts per degC of error
+ *         Ki      1/16 duty count per degC of error per second
+ *         slew    maximum duty change in counts per period (0 = unlimited)
+ *
+ *       While disabled (the default) the static 'fan_speed' EEPROM value
+ *       applies.  With no valid sensor reading the fans run at max_duty.
+ */
+
+#ifndef __FANCTL_H
+#define __FANCTL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define FANCTL_PERIOD_MS                          (1000)
+
+typedef enum {
+  FANCTL_OFF = 0,       // Static fan_speed
+  FANCTL_RUN,
+  FANCTL_FAILSAFE       // Enabled, but no valid temperature: max_duty
+} fanctl_state_t;
+
+typedef enum {
+  FANCTL_SRC_MAX6639_CH1 = 0,
+  FANCTL_SRC_MAX6639_CH2,
+  FANCTL_SRC_LM75_0,
+  FANCTL_SRC_LM75_1,
+  FANCTL_SRC_FPGA,
+  FANCTL_NUM_SOURCES,
+  FANCTL_SRC_NONE = 0xff
+} fanctl_source_t;
+
+typedef struct {
+  uint8_t setpoint;     // degC
+  uint8_t kp;
+  uint8_t ki;
+  uint8_t min_duty;
+  uint8_t max_duty;
+  uint8_t slew;
+} fanctl_params_t;
+
+/* void fanctl_init(void);
+ *  Load the parameters from non-volatile memory and start from the duty
+ *  currently applied ('fan_speed').  Call once the MAX6639 is powered.
+ */
+void fanctl_init(void);
+
+/* void fanctl_service(void);
+ *  Call on every system tick; runs the controller every FANCTL_PERIOD_MS.
+ */
+void fanctl_service(void);
+
+/* int fanctl_set_enable(uint8_t enable);
+ *  Enable or disable (restoring 'fan_speed') the controller and store the
+ *  setting in non-volatile memory.
+ */
+int fanctl_set_enable(uint8_t enable);
+int fanctl_enabled(void);
+
+/* int fanctl_set_params(const fanctl_params_t *params);
+ *  Vet, apply and store new parameters.  Returns -1 if they are invalid.
+ */
+int fanctl_set_params(const fanctl_params_t *params);
+void fanctl_get_params(fanctl_params_t *params);
+
+void fanctl_print(void);
+
+// Mailbox access
+void fanctl_set_fpga_temp(int temp);
+int fanctl_get_fpga_temp(void);
+uint8_t fanctl_mbox_state(void);
+uint8_t fanctl_mbox_source(void);
+uint8_t fanctl_mbox_setpoint(void);
+int fanctl_mbox_temp(void);
+uint8_t fanctl_mbox_duty(void);
+int fanctl_mbox_integ(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __FANCTL_H
@@ -26,7 +26,7 @@ typedef enum {
 #define I2C_APP_NUM 5
 
 void I2C_FPGA_scan(void);
-void switch_i2c_bus(uint8_t);
+int switch_i2c_bus(uint8_t);
 void adn4600_init(void);
 void adn4600_printStatus(void);
 void ina219_init(void);
@@ -104,7 +104,52 @@ typedef enum CONFIG_SADCRES {
 #define INA_REG_CALIBRATION  (0x05)
 
 // Using the nominal value of the shunt resistors 0.082 Ohms (regval is in units of 10uV)
-#define INA219_SHUNT_VOLTAGE_TO_CURRENT(regval)       ((float)(((int16_t)regval)/82000))
+#define INA219_SHUNT_VOLTAGE_TO_CURRENT(regval)       (((float)((int16_t)(regval)))/8200.0f)
+#define INA219_SHUNT_VOLTAGE_TO_MA(regval)            ((((int32_t)((int16_t)(regval)))*10)/82)
+
+/************
+* FMC power monitor
+************/
+
+/* The FMC INA219s run continuously with 128-sample shunt averaging (68 ms
+ * per result) and are read once per FMC_MONITOR_PERIOD_MS, so every read
+ * returns a completed average.  The first read waits FMC_MONITOR_CONVERSION_US
+ * after the configuration write.  Any failure reconfigures.
+ */
+#define FMC_MONITOR_PERIOD_MS                       (1000)
+#define FMC_MONITOR_CONVERSION_US                  (70000)
+#define FMC_MONITOR_CONFIG  (CONFIG_BVOLTAGERANGE_16V | CONFIG_GAIN_4_160MV | \
+                             CONFIG_BADCRES_12BIT | CONFIG_SADCRES_12BIT_128S_69MS | \
+                             CONFIG_MODE_SVOLT_CONTINUOUS)
+
+typedef enum {
+   FMC_MONITOR_FMC1 = 0,
+   FMC_MONITOR_FMC2,
+   FMC_MONITOR_NUM
+} FMC_MONITOR_CH;
+
+/* void fmc_monitor_service(void);
+ *  Call on every system tick; reads the FMC INA219s every FMC_MONITOR_PERIOD_MS.
+ *  The TCA9548 port and INA219 register pointers are rewritten on every pass
+ *  (as on every INA219 read) since the FPGA shares the bus.
+ */
+void fmc_monitor_service(void);
+
+/* int fmc_monitor_shunt(int ch);
+ *  Last shunt voltage of FMC 'ch' in 10uV (signed); 0 until valid.
+ */
+int fmc_monitor_shunt(int ch);
+
+/* int fmc_monitor_current_mA(int ch);
+ *  Last current of FMC 'ch' in mA using the nominal 0.082 Ohm shunt.
+ */
+int fmc_monitor_current_mA(int ch);
+
+/* uint8_t fmc_monitor_status(void);
+ *  Bit 'ch' set if FMC 'ch' holds a valid reading.
+ */
+uint8_t fmc_monitor_status(void);
+void fmc_monitor_print(void);
 
 typedef enum {
    ADN4600 = 0x90
@@ -46,12 +46,60 @@ void I2C_PM_bus_display(void);
 void i2c_pm_hook(uint8_t addr, uint8_t rnw, int cmd, const uint8_t *data, int len);
 int PM_GetTelem(PM_telem_enum_t elem);
 void PM_UpdateTelem(void);
+
+// Interval between captures while SMBALERT stays asserted
+#define PM_ALERT_RETRY_MS                        (1000)
+
+/* void PM_AlertService(void);
+ *  Call from the main loop on EVENT_PM_ALERT and on every tick.  Captures
+ *  power supply faults when SMBALERT has been asserted since the last call,
+ *  and again every PM_ALERT_RETRY_MS for as long as it stays asserted.
+ */
+void PM_AlertService(void);
+
+// PMBus Packet Error Checking on the I2C_PM bus
+// Set to 0 to talk to PMBus devices without PEC by default
+#ifndef I2C_PM_PEC_DEFAULT
+#define I2C_PM_PEC_DEFAULT                (1)
+#endif
+// Failed PMBus transactions are retried up to PM_RETRIES times, waiting
+// PM_RETRY_BACKOFF_MS, then twice that, etc. before each retry.
+#define PM_RETRIES                        (3)
+#define PM_RETRY_BACKOFF_MS               (1)
+// Longest data payload (excluding PEC) for PM_cmdrecv/PM_cmdsend
+#define PM_MAX_DATA                      (32)
+// Number of distinct devices tracked by the error counters
+#define PM_ERR_MAX_DEVS                   (8)
+
+/* int PM_cmdrecv(uint8_t dev, uint8_t cmd, uint8_t *data, int len);
+ *  PMBus read of 'len' bytes from command 'cmd' of device 'dev' (8-bit addr).
+ *  With PEC enabled, one more byte is read and checked.  Failed reads are
+ *  retried with exponential backoff; 'data' is only written on success.
+ *  Returns 0 on success, non-zero otherwise.
+ */
+int PM_cmdrecv(uint8_t dev, uint8_t cmd, uint8_t *data, int len);
+
+/* int PM_cmdsend(uint8_t dev, uint8_t cmd, const uint8_t *data, int len);
+ *  PMBus write, appending PEC if enabled.  Retried as with PM_cmdrecv.
+ */
+int PM_cmdsend(uint8_t dev, uint8_t cmd, const uint8_t *data, int len);
+void PM_set_pec(int enable);
+int PM_get_pec(void);
+void PM_print_errors(void);
+
 int max6639_set_tach_en(uint8_t tach_en);
 uint8_t max6639_get_tach_en(void);
 void print_max6639_decoded(void);
 int get_max6639_reg(int regno, unsigned int *value);
-int return_max6639_reg(int regno);
-int max6639_get_cached_temp(int regno);
+// Monitored registers (temperatures, tachometers, duties) lie below this
+#define MAX6639_SNAPSHOT_REGS   (MAX6639_FAN2_DUTY+1)
+int max6639_snapshot_update(void);
+int max6639_snapshot_reg(int regno);
+
+/* int I2C_PM_monitor_update(void);
+ *  Refresh the MAX6639 register snapshot and the LM75 temperatures.
+ */
+int I2C_PM_monitor_update(void);
 
 #define LM75_FOR_EACH_REGISTER() \
   X(LM75_TEMP, 0) \
@@ -99,6 +147,13 @@ void xrp_boot(void);
 int xrp_ch_status(uint8_t dev, uint8_t chn);
 void xrp_dump(uint8_t dev);
 void xrp_flash(uint8_t dev);
+/* void xrp_flash_service(void);
+ *  Advance flash programming started by xrp_flash() by at most one step.
+ *  Called from the main loop; does nothing when no programming is underway.
+ */
+void xrp_flash_service(void);
+int xrp_flash_busy(void);
+void xrp_flash_progress(void);
 void xrp_go(uint8_t dev);
 void xrp_hex_in(uint8_t dev);
 
@@ -123,7 +178,17 @@ int xrp_file(uint8_t dev);
 #define PMBRIDGE_XACT_READ_ONE       (0x101)
 // Read one byte; use it as N. Then read N more bytes.
 #define PMBRIDGE_XACT_READ_BLOCK     (0x102)
+// Ends one transaction and starts the next (PMBridge_xact_batch only)
+#define PMBRIDGE_XACT_SEPARATOR      (0x103)
+// PMBus block transfers carry at most 255 bytes after the byte count
+#define PMBRIDGE_BLOCK_MAX             (255)
+// Limits for PMBridge_xact_batch
+#define PMBRIDGE_BATCH_MAX_ITEMS       (128)
+#define PMBRIDGE_BATCH_MAX_XACTS        (16)
+#define PMBRIDGE_BATCH_RDATA_MAX       (512)
 
 int PMBridge_xact(uint16_t *xact, int len);
+int PMBridge_xact_recv(uint16_t *xact, int len, uint8_t *rdata);
+int PMBridge_xact_batch(uint16_t *items, int len);
 
 #endif /* I2C_PM_H_ */
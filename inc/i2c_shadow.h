@@ -0,0 +1,63 @@
+/*
+ * File: i2c_shadow.h
+ * Desc: Write-through register shadow cache for slow-changing I2C devices.
+ *       The i2c_shadow_* calls take the same arguments as the marble_I2C_*
+ *       calls they stand in for.  For the devices listed in i2c_shadow.c
+ *       (the MAX6639) the last value written to or read from each register
+ *       is kept per (bus, address, register):
+ *         - a write whose every byte matches the shadow is skipped
+ *         - a read whose every byte is shadowed is served from the shadow
+ *       Registers that change on their own or have side effects (inputs,
+ *       status, temperatures, command strobes) are marked volatile per
+ *       device and always go to the bus.  Traffic to any other device
+ *       passes straight through.
+ *
+ *       Only devices on I2C_PM, where the MMC is the sole master, are
+ *       listed.  The FPGA also masters I2C_FPGA, so the TCA9548, PCA9555s
+ *       and ADN4600 there are always accessed directly.
+ *
+ *       Multi-byte transfers address consecutive registers (auto-increment).
+ *
+ *       The shadow is dropped by board_init(), on loss of power good and by
+ *       a failed write; i2c_shadow_invalidate_bus() drops a bus after a
+ *       stuck-bus recovery.  Only called from thread mode.
+ */
+
+#ifndef __I2C_SHADOW_H
+#define __I2C_SHADOW_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "marble_api.h"
+
+#define I2C_SHADOW_ENTRIES                          (64)
+
+int i2c_shadow_send(I2C_BUS I2C_bus, uint8_t addr, const uint8_t *data, int size);
+int i2c_shadow_cmdsend(I2C_BUS I2C_bus, uint8_t addr, uint8_t cmd, const uint8_t *data, int size);
+int i2c_shadow_cmdrecv(I2C_BUS I2C_bus, uint8_t addr, uint8_t cmd, uint8_t *data, int size);
+
+/* void i2c_shadow_invalidate(void);
+ *  Drop every shadowed register (devices reset or power cycled).
+ */
+void i2c_shadow_invalidate(void);
+
+/* void i2c_shadow_invalidate_bus(I2C_BUS I2C_bus);
+ *  Drop the shadowed registers of every device on 'I2C_bus'.
+ */
+void i2c_shadow_invalidate_bus(I2C_BUS I2C_bus);
+
+/* void i2c_shadow_invalidate_dev(I2C_BUS I2C_bus, uint8_t addr);
+ *  Drop the shadowed registers of the device at 'addr' on 'I2C_bus'.
+ */
+void i2c_shadow_invalidate_dev(I2C_BUS I2C_bus, uint8_t addr);
+
+void i2c_shadow_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __I2C_SHADOW_H
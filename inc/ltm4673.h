@@ -152,6 +152,93 @@ int ltm4673_pmbridge_hook_read(uint8_t addr, int cmd, const uint8_t *data, int l
 void ltm4673_update_telem(uint8_t dev, volatile uint16_t *pdata);
 
 void ltm4673_print_limits(void);
+
+// ============================ SMBALERT Fault Capture ============================
+// SMBus Alert Response Address (7-bit 0x0c) in 8-bit format
+#define SMBUS_ARA_ADDR_8BIT                      (0x18)
+// Number of fault snapshots kept (oldest is overwritten)
+#define LTM4673_FAULT_RING_SIZE                     (8)
+// Mailbox fault flag: set bit, and the value the FPGA writes to acknowledge
+#define LTM4673_FAULT_FLAG_PENDING               (0x80)
+#define LTM4673_FAULT_FLAG_ACK                   (0x01)
+
+typedef struct {
+  uint32_t tick;                // marble_get_tick() at capture
+  uint8_t ara_addr;             // Address returned by ARA (0 = no response)
+  uint8_t status_input;         // STATUS_INPUT (not paged)
+  uint8_t status_cml;           // STATUS_CML (not paged)
+  uint8_t read_ok;              // Bit n set if page n was read successfully
+  uint16_t status_word[4];      // STATUS_WORD per page
+  uint8_t status_vout[4];       // STATUS_VOUT per page
+  uint8_t status_iout[4];       // STATUS_IOUT per page
+  uint8_t status_temp[4];       // STATUS_TEMPERATURE per page
+  uint8_t status_mfr[4];        // STATUS_MFR_SPECIFIC per page
+} ltm4673_fault_t;
+
+/* int ltm4673_fault_capture(uint8_t dev);
+ *  Respond to SMBALERT: read the ARA, then the STATUS_* registers of every
+ *  page, and store a timestamped snapshot in the fault ring.
+ *  Returns 0 on success, non-zero if any status read failed.
+ */
+int ltm4673_fault_capture(uint8_t dev);
+
+/* int ltm4673_get_fault(unsigned int n, ltm4673_fault_t *fault);
+ *  Copy the n-th most recent snapshot (0 = newest) to 'fault'.
+ *  Returns 0 on success, -1 if there is no such snapshot.
+ */
+int ltm4673_get_fault(unsigned int n, ltm4673_fault_t *fault);
+uint16_t ltm4673_fault_count(void);
+uint8_t ltm4673_fault_flag(void);
+void ltm4673_fault_ack(uint8_t val);
+uint16_t ltm4673_fault_status_word(unsigned int page);
+void ltm4673_fault_clear(void);
+void ltm4673_print_faults(void);
+
+/* int ltm4673_read_fault_log(uint8_t dev, uint8_t *data, int len);
+ *  Block read of MFR_FAULT_LOG into 'data' (byte count first), at most 'len'
+ *  bytes.  Returns the number of bytes stored or -1 on failure.
+ */
+int ltm4673_read_fault_log(uint8_t dev, uint8_t *data, int len);
+
+// ========================= Bulk Configuration Image =========================
+// A configuration image is a list of records, in the order they are written:
+//   | page | command_code | len (1 or 2) | data[len] (LSB first) |
+// Consecutive records on the same page share one PAGE write.
+#define LTM4673_IMAGE_MAX                     (1024)
+#define LTM4673_IMAGE_REC_HEADER                 (3)
+#define LTM4673_IMAGE_MAX_RECORDS  (LTM4673_IMAGE_MAX/(LTM4673_IMAGE_REC_HEADER + 1))
+// ltm4673_image_program() flags
+#define LTM4673_IMAGE_STORE                   (0x01)  // STORE_USER_ALL when done
+#define LTM4673_IMAGE_DRY_RUN                 (0x02)  // Only compare; write nothing
+
+typedef struct {
+  uint16_t records;
+  uint16_t changed;             // Differed from the device (written unless dry run)
+  uint16_t failed;              // Protected, or failed to read, write or verify
+  uint8_t stored;               // STORE_USER_ALL was sent
+} ltm4673_image_result_t;
+
+void ltm4673_image_clear(void);
+
+/* int ltm4673_image_put(unsigned int offset, const uint8_t *data, int len);
+ *  Copy 'len' bytes of image to 'offset', which may not lie beyond the end
+ *  of what has been received so far (so a repeated chunk is harmless).
+ *  Returns the image length or -1 if it would not fit.
+ */
+int ltm4673_image_put(unsigned int offset, const uint8_t *data, int len);
+
+/* int ltm4673_image_program(uint8_t dev, uint8_t flags, ltm4673_image_result_t *result);
+ *  Apply the image to 'dev': for each run of records on one page, select the
+ *  page and read every register back, then write only those whose value
+ *  (after the PMBridge limits) differs and read those again to verify.
+ *  Records for protected registers are rejected and counted as failed.
+ *  With LTM4673_IMAGE_STORE, STORE_USER_ALL follows if anything changed and
+ *  nothing failed.  The device's PAGE is restored afterwards.
+ *  Returns 0 on success, -1 if the image is malformed (nothing is sent) or
+ *  1 if any register failed.
+ */
+int ltm4673_image_program(uint8_t dev, uint8_t flags, ltm4673_image_result_t *result);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,330 @@
+/* Auto-generated by mkltm4673.py from ltm4673.def.  Do not edit. */
+
+#ifndef __LTM4673_DEF_H
+#define __LTM4673_DEF_H
+
+#include <stdint.h>
+
+#define LTM4673_ENCODING_RAW  (0)
+#define LTM4673_ENCODING_L11  (1)
+#define LTM4673_ENCODING_L16  (2)
+#define LTM4673_UNUSED     (0xff)
+
+// Pages 0..3 plus one index for PAGE 0xff
+#define LTM4673_NCHANNELS                        (4)
+#define LTM4673_NPAGES                           (5)
+#define LTM4673_PAGE_INDEX(page) \
+  ((page) >= LTM4673_NCHANNELS ? LTM4673_NCHANNELS : (page))
+
+typedef struct {
+  uint16_t mask;    // Writable bits; 0 vetoes the write
+  uint16_t min;     // Encoded limits
+  uint16_t max;
+  uint8_t active;   // 0 if the command is not limited on this page
+} ltm4673_limit_t;
+
+static const uint8_t ltm4673_encodings[256] = {
+  LTM4673_ENCODING_RAW, // LTM4673_PAGE
+  LTM4673_ENCODING_RAW, // LTM4673_OPERATION
+  LTM4673_ENCODING_RAW, // LTM4673_ON_OFF_CONFIG
+  LTM4673_ENCODING_RAW, // LTM4673_CLEAR_FAULTS
+  LTM4673_UNUSED, // 0x04
+  LTM4673_UNUSED, // 0x05
+  LTM4673_UNUSED, // 0x06
+  LTM4673_UNUSED, // 0x07
+  LTM4673_UNUSED, // 0x08
+  LTM4673_UNUSED, // 0x09
+  LTM4673_UNUSED, // 0x0a
+  LTM4673_UNUSED, // 0x0b
+  LTM4673_UNUSED, // 0x0c
+  LTM4673_UNUSED, // 0x0d
+  LTM4673_UNUSED, // 0x0e
+  LTM4673_UNUSED, // 0x0f
+  LTM4673_ENCODING_RAW, // LTM4673_WRITE_PROTECT
+  LTM4673_UNUSED, // 0x11
+  LTM4673_UNUSED, // 0x12
+  LTM4673_UNUSED, // 0x13
+  LTM4673_UNUSED, // 0x14
+  LTM4673_ENCODING_RAW, // LTM4673_STORE_USER_ALL
+  LTM4673_ENCODING_RAW, // LTM4673_RESTORE_USER_ALL
+  LTM4673_UNUSED, // 0x17
+  LTM4673_UNUSED, // 0x18
+  LTM4673_ENCODING_RAW, // LTM4673_CAPABILITY
+  LTM4673_UNUSED, // 0x1a
+  LTM4673_UNUSED, // 0x1b
+  LTM4673_UNUSED, // 0x1c
+  LTM4673_UNUSED, // 0x1d
+  LTM4673_UNUSED, // 0x1e
+  LTM4673_UNUSED, // 0x1f
+  LTM4673_ENCODING_RAW, // LTM4673_VOUT_MODE
+  LTM4673_ENCODING_L16, // LTM4673_VOUT_COMMAND
+  LTM4673_UNUSED, // 0x22
+  LTM4673_UNUSED, // 0x23
+  LTM4673_ENCODING_L16, // LTM4673_VOUT_MAX
+  LTM4673_ENCODING_L16, // LTM4673_VOUT_MARGIN_HIGH
+  LTM4673_ENCODING_L16, // LTM4673_VOUT_MARGIN_LOW
+  LTM4673_UNUSED, // 0x27
+  LTM4673_UNUSED, // 0x28
+  LTM4673_UNUSED, // 0x29
+  LTM4673_UNUSED, // 0x2a
+  LTM4673_UNUSED, // 0x2b
+  LTM4673_UNUSED, // 0x2c
+  LTM4673_UNUSED, // 0x2d
+  LTM4673_UNUSED, // 0x2e
+  LTM4673_UNUSED, // 0x2f
+  LTM4673_UNUSED, // 0x30
+  LTM4673_UNUSED, // 0x31
+  LTM4673_UNUSED, // 0x32
+  LTM4673_UNUSED, // 0x33
+  LTM4673_UNUSED, // 0x34
+  LTM4673_ENCODING_L11, // LTM4673_VIN_ON
+  LTM4673_ENCODING_L11, // LTM4673_VIN_OFF
+  LTM4673_UNUSED, // 0x37
+  LTM4673_ENCODING_L11, // LTM4673_IOUT_CAL_GAIN
+  LTM4673_UNUSED, // 0x39
+  LTM4673_UNUSED, // 0x3a
+  LTM4673_UNUSED, // 0x3b
+  LTM4673_UNUSED, // 0x3c
+  LTM4673_UNUSED, // 0x3d
+  LTM4673_UNUSED, // 0x3e
+  LTM4673_UNUSED, // 0x3f
+  LTM4673_ENCODING_L16, // LTM4673_VOUT_OV_FAULT_LIMIT
+  LTM4673_ENCODING_RAW, // LTM4673_VOUT_OV_FAULT_RESPONSE
+  LTM4673_ENCODING_L16, // LTM4673_VOUT_OV_WARN_LIMIT
+  LTM4673_ENCODING_L16, // LTM4673_VOUT_UV_WARN_LIMIT
+  LTM4673_ENCODING_L16, // LTM4673_VOUT_UV_FAULT_LIMIT
+  LTM4673_ENCODING_RAW, // LTM4673_VOUT_UV_FAULT_RESPONSE
+  LTM4673_ENCODING_L11, // LTM4673_IOUT_OC_FAULT_LIMIT
+  LTM4673_ENCODING_RAW, // LTM4673_IOUT_OC_FAULT_RESPONSE
+  LTM4673_UNUSED, // 0x48
+  LTM4673_UNUSED, // 0x49
+  LTM4673_ENCODING_L11, // LTM4673_IOUT_OC_WARN_LIMIT
+  LTM4673_ENCODING_L11, // LTM4673_IOUT_UC_FAULT_LIMIT
+  LTM4673_ENCODING_RAW, // LTM4673_IOUT_UC_FAULT_RESPONSE
+  LTM4673_UNUSED, // 0x4d
+  LTM4673_UNUSED, // 0x4e
+  LTM4673_ENCODING_L11, // LTM4673_OT_FAULT_LIMIT
+  LTM4673_ENCODING_RAW, // LTM4673_OT_FAULT_RESPONSE
+  LTM4673_ENCODING_L11, // LTM4673_OT_WARN_LIMIT
+  LTM4673_ENCODING_L11, // LTM4673_UT_WARN_LIMIT
+  LTM4673_ENCODING_L11, // LTM4673_UT_FAULT_LIMIT
+  LTM4673_ENCODING_RAW, // LTM4673_UT_FAULT_RESPONSE
+  LTM4673_ENCODING_L11, // LTM4673_VIN_OV_FAULT_LIMIT
+  LTM4673_ENCODING_RAW, // LTM4673_VIN_OV_FAULT_RESPONSE
+  LTM4673_ENCODING_L11, // LTM4673_VIN_OV_WARN_LIMIT
+  LTM4673_ENCODING_L11, // LTM4673_VIN_UV_WARN_LIMIT
+  LTM4673_ENCODING_L11, // LTM4673_VIN_UV_FAULT_LIMIT
+  LTM4673_ENCODING_RAW, // LTM4673_VIN_UV_FAULT_RESPONSE
+  LTM4673_UNUSED, // 0x5b
+  LTM4673_UNUSED, // 0x5c
+  LTM4673_UNUSED, // 0x5d
+  LTM4673_ENCODING_L16, // LTM4673_POWER_GOOD_ON
+  LTM4673_ENCODING_L16, // LTM4673_POWER_GOOD_OFF
+  LTM4673_ENCODING_L11, // LTM4673_TON_DELAY
+  LTM4673_ENCODING_L11, // LTM4673_TON_RISE
+  LTM4673_ENCODING_L11, // LTM4673_TON_MAX_FAULT_LIMIT
+  LTM4673_ENCODING_RAW, // LTM4673_TON_MAX_FAULT_RESPONSE
+  LTM4673_ENCODING_L11, // LTM4673_TOFF_DELAY
+  LTM4673_UNUSED, // 0x65
+  LTM4673_UNUSED, // 0x66
+  LTM4673_UNUSED, // 0x67
+  LTM4673_UNUSED, // 0x68
+  LTM4673_UNUSED, // 0x69
+  LTM4673_UNUSED, // 0x6a
+  LTM4673_UNUSED, // 0x6b
+  LTM4673_UNUSED, // 0x6c
+  LTM4673_UNUSED, // 0x6d
+  LTM4673_UNUSED, // 0x6e
+  LTM4673_UNUSED, // 0x6f
+  LTM4673_UNUSED, // 0x70
+  LTM4673_UNUSED, // 0x71
+  LTM4673_UNUSED, // 0x72
+  LTM4673_UNUSED, // 0x73
+  LTM4673_UNUSED, // 0x74
+  LTM4673_UNUSED, // 0x75
+  LTM4673_UNUSED, // 0x76
+  LTM4673_UNUSED, // 0x77
+  LTM4673_ENCODING_RAW, // LTM4673_STATUS_BYTE
+  LTM4673_ENCODING_RAW, // LTM4673_STATUS_WORD
+  LTM4673_ENCODING_RAW, // LTM4673_STATUS_VOUT
+  LTM4673_ENCODING_RAW, // LTM4673_STATUS_IOUT
+  LTM4673_ENCODING_RAW, // LTM4673_STATUS_INPUT
+  LTM4673_ENCODING_RAW, // LTM4673_STATUS_TEMPERATURE
+  LTM4673_ENCODING_RAW, // LTM4673_STATUS_CML
+  LTM4673_UNUSED, // 0x7f
+  LTM4673_ENCODING_RAW, // LTM4673_STATUS_MFR_SPECIFIC
+  LTM4673_UNUSED, // 0x81
+  LTM4673_UNUSED, // 0x82
+  LTM4673_UNUSED, // 0x83
+  LTM4673_UNUSED, // 0x84
+  LTM4673_UNUSED, // 0x85
+  LTM4673_UNUSED, // 0x86
+  LTM4673_UNUSED, // 0x87
+  LTM4673_ENCODING_L11, // LTM4673_READ_VIN
+  LTM4673_ENCODING_L11, // LTM4673_READ_IIN
+  LTM4673_UNUSED, // 0x8a
+  LTM4673_ENCODING_L16, // LTM4673_READ_VOUT
+  LTM4673_ENCODING_L11, // LTM4673_READ_IOUT
+  LTM4673_ENCODING_L11, // LTM4673_READ_TEMPERATURE_1
+  LTM4673_ENCODING_L11, // LTM4673_READ_TEMPERATURE_2
+  LTM4673_UNUSED, // 0x8f
+  LTM4673_UNUSED, // 0x90
+  LTM4673_UNUSED, // 0x91
+  LTM4673_UNUSED, // 0x92
+  LTM4673_UNUSED, // 0x93
+  LTM4673_UNUSED, // 0x94
+  LTM4673_UNUSED, // 0x95
+  LTM4673_ENCODING_L11, // LTM4673_READ_POUT
+  LTM4673_ENCODING_L11, // LTM4673_READ_PIN
+  LTM4673_ENCODING_RAW, // LTM4673_PMBUS_REVISION
+  LTM4673_UNUSED, // 0x99
+  LTM4673_UNUSED, // 0x9a
+  LTM4673_UNUSED, // 0x9b
+  LTM4673_UNUSED, // 0x9c
+  LTM4673_UNUSED, // 0x9d
+  LTM4673_UNUSED, // 0x9e
+  LTM4673_UNUSED, // 0x9f
+  LTM4673_UNUSED, // 0xa0
+  LTM4673_UNUSED, // 0xa1
+  LTM4673_UNUSED, // 0xa2
+  LTM4673_UNUSED, // 0xa3
+  LTM4673_UNUSED, // 0xa4
+  LTM4673_UNUSED, // 0xa5
+  LTM4673_UNUSED, // 0xa6
+  LTM4673_UNUSED, // 0xa7
+  LTM4673_UNUSED, // 0xa8
+  LTM4673_UNUSED, // 0xa9
+  LTM4673_UNUSED, // 0xaa
+  LTM4673_UNUSED, // 0xab
+  LTM4673_UNUSED, // 0xac
+  LTM4673_UNUSED, // 0xad
+  LTM4673_UNUSED, // 0xae
+  LTM4673_UNUSED, // 0xaf
+  LTM4673_ENCODING_RAW, // LTM4673_USER_DATA_00
+  LTM4673_ENCODING_RAW, // LTM4673_USER_DATA_01
+  LTM4673_ENCODING_RAW, // LTM4673_USER_DATA_02
+  LTM4673_ENCODING_RAW, // LTM4673_USER_DATA_03
+  LTM4673_ENCODING_RAW, // LTM4673_USER_DATA_04
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_LTC_RESERVED_1
+  LTM4673_UNUSED, // 0xb6
+  LTM4673_UNUSED, // 0xb7
+  LTM4673_ENCODING_L11, // LTM4673_MFR_T_SELF_HEAT
+  LTM4673_ENCODING_L11, // LTM4673_MFR_IOUT_CAL_GAIN_TAU_INV
+  LTM4673_ENCODING_L11, // LTM4673_MFR_IOUT_CAL_GAIN_THETA
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_READ_IOUT
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_LTC_RESERVED_2
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_EE_UNLOCK
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_EE_ERASE
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_EE_DATA
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_EIN
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_EIN_CONFIG
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_SPECIAL_LOT
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_IIN_CAL_GAIN_TC
+  LTM4673_ENCODING_L11, // LTM4673_MFR_IIN_PEAK
+  LTM4673_ENCODING_L11, // LTM4673_MFR_IIN_MIN
+  LTM4673_ENCODING_L11, // LTM4673_MFR_PIN_PEAK
+  LTM4673_ENCODING_L11, // LTM4673_MFR_PIN_MIN
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_COMMAND_PLUS
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_DATA_PLUS0
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_DATA_PLUS1
+  LTM4673_UNUSED, // 0xcb
+  LTM4673_UNUSED, // 0xcc
+  LTM4673_UNUSED, // 0xcd
+  LTM4673_UNUSED, // 0xce
+  LTM4673_UNUSED, // 0xcf
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_CONFIG_LTM4673
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_CONFIG_ALL_LTM4673
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_FAULTB0_PROPAGATE
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_FAULTB1_PROPAGATE
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_PWRGD_EN
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_FAULTB0_RESPONSE
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_FAULTB1_RESPONSE
+  LTM4673_ENCODING_L11, // LTM4673_MFR_IOUT_PEAK
+  LTM4673_ENCODING_L11, // LTM4673_MFR_IOUT_MIN
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_CONFIG2_LTM4673
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_CONFIG3_LTM4673
+  LTM4673_ENCODING_L11, // LTM4673_MFR_RETRY_DELAY
+  LTM4673_ENCODING_L11, // LTM4673_MFR_RESTART_DELAY
+  LTM4673_ENCODING_L16, // LTM4673_MFR_VOUT_PEAK
+  LTM4673_ENCODING_L11, // LTM4673_MFR_VIN_PEAK
+  LTM4673_ENCODING_L11, // LTM4673_MFR_TEMPERATURE_1_PEAK
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_DAC
+  LTM4673_ENCODING_L11, // LTM4673_MFR_POWERGOOD_ASSERTION_DELAY
+  LTM4673_ENCODING_L11, // LTM4673_MFR_WATCHDOG_T_FIRST
+  LTM4673_ENCODING_L11, // LTM4673_MFR_WATCHDOG_T
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_PAGE_FF_MASK
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_PADS
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_I2C_BASE_ADDRESS
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_SPECIAL_ID
+  LTM4673_ENCODING_L11, // LTM4673_MFR_IIN_CAL_GAIN
+  LTM4673_ENCODING_L11, // LTM4673_MFR_VOUT_DISCHARGE_THRESHOLD
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_FAULT_LOG_STORE
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_FAULT_LOG_RESTORE
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_FAULT_LOG_CLEAR
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_FAULT_LOG_STATUS
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_FAULT_LOG
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_COMMON
+  LTM4673_UNUSED, // 0xf0
+  LTM4673_UNUSED, // 0xf1
+  LTM4673_UNUSED, // 0xf2
+  LTM4673_UNUSED, // 0xf3
+  LTM4673_UNUSED, // 0xf4
+  LTM4673_UNUSED, // 0xf5
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_IOUT_CAL_GAIN_TC
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_RETRY_COUNT
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_TEMP_1_GAIN
+  LTM4673_ENCODING_L11, // LTM4673_MFR_TEMP_1_OFFSET
+  LTM4673_ENCODING_RAW, // LTM4673_MFR_IOUT_SENSE_VOLTAGE
+  LTM4673_ENCODING_L16, // LTM4673_MFR_VOUT_MIN
+  LTM4673_ENCODING_L11, // LTM4673_MFR_VIN_MIN
+  LTM4673_ENCODING_L11, // LTM4673_MFR_TEMPERATURE_1_MIN
+  LTM4673_UNUSED, // 0xfe
+  LTM4673_UNUSED, // 0xff
+};
+
+// Row of ltm4673_limit_table (plus 1) for each command; 0 = never limited
+static const uint8_t ltm4673_limit_slot[256] = {
+  1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x00
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x10
+  0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x20
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x30
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x40
+  0, 0, 0, 0, 0, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x50
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x60
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x70
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x80
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x90
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0xa0
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0xb0
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0xc0
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0xd0
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0xe0
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0xf0
+};
+
+#define LTM4673_LIMIT_SLOTS                      (3)
+static const ltm4673_limit_t ltm4673_limit_table[LTM4673_LIMIT_SLOTS][LTM4673_NPAGES] = {
+  { // LTM4673_PAGE
+    {0x0000, 0x0000, 0x0000, 0},
+    {0x0000, 0x0000, 0x0000, 0},
+    {0x0000, 0x0000, 0x0000, 0},
+    {0x0000, 0x0000, 0x0000, 0},
+    {0x00ff, 0x0000, 0x00ff, 1}, // page 0xff
+  },
+  { // LTM4673_VOUT_COMMAND
+    {0xffff, 0x1e66, 0x2199, 1}, // page 0x0, 0.95 to 1.05
+    {0xffff, 0x3800, 0x3b33, 1}, // page 0x1, 1.75 to 1.85
+    {0xffff, 0x4e66, 0x5199, 1}, // page 0x2, 2.45 to 2.55
+    {0xffff, 0x6800, 0x6b33, 1}, // page 0x3, 3.25 to 3.35
+    {0x0000, 0x0000, 0x0000, 0},
+  },
+  { // LTM4673_VIN_OV_FAULT_LIMIT
+    {0x0000, 0x0000, 0x0000, 0},
+    {0x0000, 0x0000, 0x0000, 0},
+    {0x0000, 0x0000, 0x0000, 0},
+    {0x0000, 0x0000, 0x0000, 0},
+    {0xffff, 0xd320, 0xda00, 1}, // page 0xff, 12.5 to 16.0
+  },
+};
+
+#endif // __LTM4673_DEF_H
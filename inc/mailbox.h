@@ -8,6 +8,10 @@
 #include "console.h"
 #include "mailbox_def.h"
 
+// Must agree with PAGE_SIZE and NPAGES in scripts/mkmbox.py
+#define MBOX_PAGE_SIZE      (16)
+#define MBOX_NPAGES        (128)
+
 #define MBOX_PRINT_PAGE(npage) do { \
   printf("Page %d\r\n", npage); \
   for (int n = 0; n < MB ## npage ## _SIZE; n++) { \
@@ -21,10 +25,23 @@ void mbox_disable(void);
 int mbox_get_enable(void);
 void mbox_set_enable(int enabled);
 void mbox_update(bool verbose);
+/* void mbox_request_boot_update(void);
+ *  Schedule the "boot" rate class pages (build identifiers, etc) to be
+ *  written on the next mailbox update, e.g. after the FPGA is configured.
+ */
+void mbox_request_boot_update(void);
+/* uint32_t mbox_doorbell_service(void);
+ *  Read the input pages the FPGA flagged in the DOORBELL mask if it has
+ *  pulsed FPGA_INT since the last call.  Returns the mask of pages read.
+ */
+uint32_t mbox_doorbell_service(void);
 uint16_t mbox_get_update_count(void);
 void mbox_reset_update_count(void);
 void mbox_read_page(uint8_t page_no, uint8_t page_sz, uint8_t *page);
 void mbox_write_page(uint8_t page_no, uint8_t page_sz, const uint8_t page[]);
+// Write/read 'count' entries starting at 'first' to/from page[first]...
+void mbox_write_entries(uint8_t page_no, uint8_t first, uint8_t count, const uint8_t page[]);
+void mbox_read_entries(uint8_t page_no, uint8_t first, uint8_t count, uint8_t *page);
 // The below write/read to/from the currently selected page
 void mbox_write_entry(uint8_t entry_no, uint8_t data);
 uint8_t mbox_read_entry(uint8_t entry_no);
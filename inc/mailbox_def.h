@@ -0,0 +1,461 @@
+/*
+ * File: mailbox_def.h
+ * Desc: Header file for inc/mailbox_def. Auto-generated by scripts/mkmbox.py.
+ */
+
+#ifndef __MAILBOX_DEF_H_
+#define __MAILBOX_DEF_H_
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* ============= DO NOT EDIT THIS AUTO-GENERATED FILE DIRECTLY ============== */
+/* ============== Define mailbox structure in scripts/mbox.def ============== */
+
+typedef enum {
+  MB0_MAGIC_NUMBER_1,
+  MB0_MAGIC_NUMBER_0,
+  MB0_VERSION_MAJOR,
+  MB0_VERSION_MINOR,
+  MB0_SIZE // 4
+} PAGE0_ENUM;
+
+typedef enum {
+  MB2_FMC_MGT_CTL,
+  MB2_SIZE // 1
+} PAGE2_ENUM;
+
+typedef enum {
+  MB3_COUNT_1,
+  MB3_COUNT_0,
+  MB3_WD_STATE,
+  MB3_PAD3,
+  MB3_LM75_0_1,
+  MB3_LM75_0_0,
+  MB3_LM75_1_1,
+  MB3_LM75_1_0,
+  MB3_FMC_ST,
+  MB3_PWR_ST,
+  MB3_MGTMUX_ST,
+  MB3_PAD11,
+  MB3_GIT32_3,
+  MB3_GIT32_2,
+  MB3_GIT32_1,
+  MB3_GIT32_0,
+  MB3_SIZE // 16
+} PAGE3_ENUM;
+
+typedef enum {
+  MB4_MAX_T1_HI,
+  MB4_MAX_T1_LO,
+  MB4_MAX_T2_HI,
+  MB4_MAX_T2_LO,
+  MB4_MAX_F1_TACH,
+  MB4_MAX_F2_TACH,
+  MB4_MAX_F1_DUTY,
+  MB4_MAX_F2_DUTY,
+  MB4_PCB_REV,
+  MB4_PAD11,
+  MB4_COUNT_1,
+  MB4_COUNT_0,
+  MB4_HASH_3,
+  MB4_HASH_2,
+  MB4_HASH_1,
+  MB4_HASH_0,
+  MB4_SIZE // 16
+} PAGE4_ENUM;
+
+typedef enum {
+  MB5_I2C_BUS_STATUS,
+  MB5_SIZE // 1
+} PAGE5_ENUM;
+
+typedef enum {
+  MB6_FSYNTH_I2C_ADDR,
+  MB6_FSYNTH_CONFIG,
+  MB6_FSYNTH_FREQ_3,
+  MB6_FSYNTH_FREQ_2,
+  MB6_FSYNTH_FREQ_1,
+  MB6_FSYNTH_FREQ_0,
+  MB6_SIZE // 6
+} PAGE6_ENUM;
+
+typedef enum {
+  MB7_WD_NONCE_7,
+  MB7_WD_NONCE_6,
+  MB7_WD_NONCE_5,
+  MB7_WD_NONCE_4,
+  MB7_WD_NONCE_3,
+  MB7_WD_NONCE_2,
+  MB7_WD_NONCE_1,
+  MB7_WD_NONCE_0,
+  MB7_SIZE // 8
+} PAGE7_ENUM;
+
+typedef enum {
+  MB8_WD_HASH_7,
+  MB8_WD_HASH_6,
+  MB8_WD_HASH_5,
+  MB8_WD_HASH_4,
+  MB8_WD_HASH_3,
+  MB8_WD_HASH_2,
+  MB8_WD_HASH_1,
+  MB8_WD_HASH_0,
+  MB8_SIZE // 8
+} PAGE8_ENUM;
+
+typedef enum {
+  MB9_VOUT_1V0_1,
+  MB9_VOUT_1V0_0,
+  MB9_IOUT_1V0_1,
+  MB9_IOUT_1V0_0,
+  MB9_VOUT_1V8_1,
+  MB9_VOUT_1V8_0,
+  MB9_IOUT_1V8_1,
+  MB9_IOUT_1V8_0,
+  MB9_VOUT_2V5_1,
+  MB9_VOUT_2V5_0,
+  MB9_IOUT_2V5_1,
+  MB9_IOUT_2V5_0,
+  MB9_VOUT_3V3_1,
+  MB9_VOUT_3V3_0,
+  MB9_IOUT_3V3_1,
+  MB9_IOUT_3V3_0,
+  MB9_SIZE // 16
+} PAGE9_ENUM;
+
+typedef enum {
+  MB10_PMOD_LED_0,
+  MB10_PMOD_LED_1,
+  MB10_PMOD_LED_2,
+  MB10_PMOD_LED_3,
+  MB10_PMOD_LED_4,
+  MB10_PMOD_LED_5,
+  MB10_PMOD_LED_6,
+  MB10_PMOD_LED_7,
+  MB10_SIZE // 8
+} PAGE10_ENUM;
+
+typedef enum {
+  MB11_PM_FAULT_FLAG,
+  MB11_PAD1,
+  MB11_PM_FAULT_COUNT_1,
+  MB11_PM_FAULT_COUNT_0,
+  MB11_PM_STATUS_WORD0_1,
+  MB11_PM_STATUS_WORD0_0,
+  MB11_PM_STATUS_WORD1_1,
+  MB11_PM_STATUS_WORD1_0,
+  MB11_PM_STATUS_WORD2_1,
+  MB11_PM_STATUS_WORD2_0,
+  MB11_PM_STATUS_WORD3_1,
+  MB11_PM_STATUS_WORD3_0,
+  MB11_SIZE // 12
+} PAGE11_ENUM;
+
+typedef enum {
+  MB12_PMLOG_SEL,
+  MB12_PMLOG_COUNT,
+  MB12_PMLOG_FREE,
+  MB12_PAD3,
+  MB12_PMLOG_SEQ_3,
+  MB12_PMLOG_SEQ_2,
+  MB12_PMLOG_SEQ_1,
+  MB12_PMLOG_SEQ_0,
+  MB12_PMLOG_TICK_3,
+  MB12_PMLOG_TICK_2,
+  MB12_PMLOG_TICK_1,
+  MB12_PMLOG_TICK_0,
+  MB12_PMLOG_VIN_1,
+  MB12_PMLOG_VIN_0,
+  MB12_PMLOG_IIN_1,
+  MB12_PMLOG_IIN_0,
+  MB12_SIZE // 16
+} PAGE12_ENUM;
+
+typedef enum {
+  MB13_PMLOG_VOUT_1V0_1,
+  MB13_PMLOG_VOUT_1V0_0,
+  MB13_PMLOG_IOUT_1V0_1,
+  MB13_PMLOG_IOUT_1V0_0,
+  MB13_PMLOG_VOUT_1V8_1,
+  MB13_PMLOG_VOUT_1V8_0,
+  MB13_PMLOG_IOUT_1V8_1,
+  MB13_PMLOG_IOUT_1V8_0,
+  MB13_PMLOG_VOUT_2V5_1,
+  MB13_PMLOG_VOUT_2V5_0,
+  MB13_PMLOG_IOUT_2V5_1,
+  MB13_PMLOG_IOUT_2V5_0,
+  MB13_PMLOG_VOUT_3V3_1,
+  MB13_PMLOG_VOUT_3V3_0,
+  MB13_PMLOG_IOUT_3V3_1,
+  MB13_PMLOG_IOUT_3V3_0,
+  MB13_SIZE // 16
+} PAGE13_ENUM;
+
+typedef enum {
+  MB16_RPC_REQ_SEQ,
+  MB16_RPC_REQ_OP,
+  MB16_RPC_REQ_LEN,
+  MB16_RPC_REQ_ARG_A_12,
+  MB16_RPC_REQ_ARG_A_11,
+  MB16_RPC_REQ_ARG_A_10,
+  MB16_RPC_REQ_ARG_A_9,
+  MB16_RPC_REQ_ARG_A_8,
+  MB16_RPC_REQ_ARG_A_7,
+  MB16_RPC_REQ_ARG_A_6,
+  MB16_RPC_REQ_ARG_A_5,
+  MB16_RPC_REQ_ARG_A_4,
+  MB16_RPC_REQ_ARG_A_3,
+  MB16_RPC_REQ_ARG_A_2,
+  MB16_RPC_REQ_ARG_A_1,
+  MB16_RPC_REQ_ARG_A_0,
+  MB16_SIZE // 16
+} PAGE16_ENUM;
+
+typedef enum {
+  MB17_RPC_REQ_ARG_B_15,
+  MB17_RPC_REQ_ARG_B_14,
+  MB17_RPC_REQ_ARG_B_13,
+  MB17_RPC_REQ_ARG_B_12,
+  MB17_RPC_REQ_ARG_B_11,
+  MB17_RPC_REQ_ARG_B_10,
+  MB17_RPC_REQ_ARG_B_9,
+  MB17_RPC_REQ_ARG_B_8,
+  MB17_RPC_REQ_ARG_B_7,
+  MB17_RPC_REQ_ARG_B_6,
+  MB17_RPC_REQ_ARG_B_5,
+  MB17_RPC_REQ_ARG_B_4,
+  MB17_RPC_REQ_ARG_B_3,
+  MB17_RPC_REQ_ARG_B_2,
+  MB17_RPC_REQ_ARG_B_1,
+  MB17_RPC_REQ_ARG_B_0,
+  MB17_SIZE // 16
+} PAGE17_ENUM;
+
+typedef enum {
+  MB18_RPC_RSP_SEQ,
+  MB18_RPC_RSP_STATUS,
+  MB18_RPC_RSP_LEN,
+  MB18_RPC_RSP_DATA_A_12,
+  MB18_RPC_RSP_DATA_A_11,
+  MB18_RPC_RSP_DATA_A_10,
+  MB18_RPC_RSP_DATA_A_9,
+  MB18_RPC_RSP_DATA_A_8,
+  MB18_RPC_RSP_DATA_A_7,
+  MB18_RPC_RSP_DATA_A_6,
+  MB18_RPC_RSP_DATA_A_5,
+  MB18_RPC_RSP_DATA_A_4,
+  MB18_RPC_RSP_DATA_A_3,
+  MB18_RPC_RSP_DATA_A_2,
+  MB18_RPC_RSP_DATA_A_1,
+  MB18_RPC_RSP_DATA_A_0,
+  MB18_SIZE // 16
+} PAGE18_ENUM;
+
+typedef enum {
+  MB19_RPC_RSP_DATA_B_15,
+  MB19_RPC_RSP_DATA_B_14,
+  MB19_RPC_RSP_DATA_B_13,
+  MB19_RPC_RSP_DATA_B_12,
+  MB19_RPC_RSP_DATA_B_11,
+  MB19_RPC_RSP_DATA_B_10,
+  MB19_RPC_RSP_DATA_B_9,
+  MB19_RPC_RSP_DATA_B_8,
+  MB19_RPC_RSP_DATA_B_7,
+  MB19_RPC_RSP_DATA_B_6,
+  MB19_RPC_RSP_DATA_B_5,
+  MB19_RPC_RSP_DATA_B_4,
+  MB19_RPC_RSP_DATA_B_3,
+  MB19_RPC_RSP_DATA_B_2,
+  MB19_RPC_RSP_DATA_B_1,
+  MB19_RPC_RSP_DATA_B_0,
+  MB19_SIZE // 16
+} PAGE19_ENUM;
+
+typedef enum {
+  MB20_FIFO_TAIL_1,
+  MB20_FIFO_TAIL_0,
+  MB20_FIFO_HEAD_1,
+  MB20_FIFO_HEAD_0,
+  MB20_FIFO_WIN_START_1,
+  MB20_FIFO_WIN_START_0,
+  MB20_FIFO_WIN_LEN,
+  MB20_FIFO_DROPPED_1,
+  MB20_FIFO_DROPPED_0,
+  MB20_SIZE // 9
+} PAGE20_ENUM;
+
+typedef enum {
+  MB21_FIFO_DATA_A_15,
+  MB21_FIFO_DATA_A_14,
+  MB21_FIFO_DATA_A_13,
+  MB21_FIFO_DATA_A_12,
+  MB21_FIFO_DATA_A_11,
+  MB21_FIFO_DATA_A_10,
+  MB21_FIFO_DATA_A_9,
+  MB21_FIFO_DATA_A_8,
+  MB21_FIFO_DATA_A_7,
+  MB21_FIFO_DATA_A_6,
+  MB21_FIFO_DATA_A_5,
+  MB21_FIFO_DATA_A_4,
+  MB21_FIFO_DATA_A_3,
+  MB21_FIFO_DATA_A_2,
+  MB21_FIFO_DATA_A_1,
+  MB21_FIFO_DATA_A_0,
+  MB21_SIZE // 16
+} PAGE21_ENUM;
+
+typedef enum {
+  MB22_FIFO_DATA_B_15,
+  MB22_FIFO_DATA_B_14,
+  MB22_FIFO_DATA_B_13,
+  MB22_FIFO_DATA_B_12,
+  MB22_FIFO_DATA_B_11,
+  MB22_FIFO_DATA_B_10,
+  MB22_FIFO_DATA_B_9,
+  MB22_FIFO_DATA_B_8,
+  MB22_FIFO_DATA_B_7,
+  MB22_FIFO_DATA_B_6,
+  MB22_FIFO_DATA_B_5,
+  MB22_FIFO_DATA_B_4,
+  MB22_FIFO_DATA_B_3,
+  MB22_FIFO_DATA_B_2,
+  MB22_FIFO_DATA_B_1,
+  MB22_FIFO_DATA_B_0,
+  MB22_SIZE // 16
+} PAGE22_ENUM;
+
+typedef enum {
+  MB23_FIFO_DATA_C_15,
+  MB23_FIFO_DATA_C_14,
+  MB23_FIFO_DATA_C_13,
+  MB23_FIFO_DATA_C_12,
+  MB23_FIFO_DATA_C_11,
+  MB23_FIFO_DATA_C_10,
+  MB23_FIFO_DATA_C_9,
+  MB23_FIFO_DATA_C_8,
+  MB23_FIFO_DATA_C_7,
+  MB23_FIFO_DATA_C_6,
+  MB23_FIFO_DATA_C_5,
+  MB23_FIFO_DATA_C_4,
+  MB23_FIFO_DATA_C_3,
+  MB23_FIFO_DATA_C_2,
+  MB23_FIFO_DATA_C_1,
+  MB23_FIFO_DATA_C_0,
+  MB23_SIZE // 16
+} PAGE23_ENUM;
+
+typedef enum {
+  MB24_BUSPROF_SEL,
+  MB24_BUSPROF_ENTRIES,
+  MB24_BUSPROF_BUS,
+  MB24_BUSPROF_ADDR,
+  MB24_BUSPROF_ERRORS_1,
+  MB24_BUSPROF_ERRORS_0,
+  MB24_BUSPROF_TIMEOUTS_1,
+  MB24_BUSPROF_TIMEOUTS_0,
+  MB24_BUSPROF_MAX_US_3,
+  MB24_BUSPROF_MAX_US_2,
+  MB24_BUSPROF_MAX_US_1,
+  MB24_BUSPROF_MAX_US_0,
+  MB24_BUSPROF_ELAPSED_MS_3,
+  MB24_BUSPROF_ELAPSED_MS_2,
+  MB24_BUSPROF_ELAPSED_MS_1,
+  MB24_BUSPROF_ELAPSED_MS_0,
+  MB24_SIZE // 16
+} PAGE24_ENUM;
+
+typedef enum {
+  MB25_BUSPROF_COUNT_3,
+  MB25_BUSPROF_COUNT_2,
+  MB25_BUSPROF_COUNT_1,
+  MB25_BUSPROF_COUNT_0,
+  MB25_BUSPROF_BYTES_3,
+  MB25_BUSPROF_BYTES_2,
+  MB25_BUSPROF_BYTES_1,
+  MB25_BUSPROF_BYTES_0,
+  MB25_BUSPROF_US_3,
+  MB25_BUSPROF_US_2,
+  MB25_BUSPROF_US_1,
+  MB25_BUSPROF_US_0,
+  MB25_SIZE // 12
+} PAGE25_ENUM;
+
+typedef enum {
+  MB26_FAN_FPGA_TEMP_1,
+  MB26_FAN_FPGA_TEMP_0,
+  MB26_FAN_CTL_STATE,
+  MB26_FAN_CTL_SOURCE,
+  MB26_FAN_CTL_SETPOINT,
+  MB26_FAN_CTL_TEMP_1,
+  MB26_FAN_CTL_TEMP_0,
+  MB26_FAN_CTL_DUTY,
+  MB26_FAN_CTL_INTEG_1,
+  MB26_FAN_CTL_INTEG_0,
+  MB26_SIZE // 10
+} PAGE26_ENUM;
+
+typedef enum {
+  MB27_FMC_MON_STATUS,
+  MB27_FMC1_CURRENT_1,
+  MB27_FMC1_CURRENT_0,
+  MB27_FMC2_CURRENT_1,
+  MB27_FMC2_CURRENT_0,
+  MB27_FMC1_SHUNT_1,
+  MB27_FMC1_SHUNT_0,
+  MB27_FMC2_SHUNT_1,
+  MB27_FMC2_SHUNT_0,
+  MB27_SIZE // 9
+} PAGE27_ENUM;
+
+typedef enum {
+  MB15_SEQ3,
+  MB15_SEQ4,
+  MB15_SEQ6,
+  MB15_SEQ7,
+  MB15_SEQ9,
+  MB15_SEQ11,
+  MB15_SEQ12,
+  MB15_SEQ13,
+  MB15_SEQ24,
+  MB15_SEQ25,
+  MB15_SEQ26,
+  MB15_SEQ27,
+  MB15_SIZE // 12
+} PAGE15_ENUM;
+
+typedef enum {
+  MB14_DOORBELL_3,
+  MB14_DOORBELL_2,
+  MB14_DOORBELL_1,
+  MB14_DOORBELL_0,
+  MB14_SIZE // 4
+} PAGE14_ENUM;
+
+
+uint32_t mailbox_get_hash(void);
+#define MBOX_SEQ_PAGE (15)
+#define MBOX_DOORBELL_PAGE (14)
+#define MBOX_INPUT_PAGES (0x5111d24UL)
+#define MBOX_RATE_FAST     (1 << 0)
+#define MBOX_RATE_MEDIUM   (1 << 1)
+#define MBOX_RATE_SLOW     (1 << 2)
+#define MBOX_RATE_BOOT     (1 << 3)
+void mailbox_update_input_fast(void);
+void mailbox_update_output_fast(void);
+void mailbox_update_input_medium(void);
+void mailbox_update_output_medium(void);
+void mailbox_update_input_slow(void);
+void mailbox_update_output_slow(void);
+void mailbox_update_input_boot(void);
+void mailbox_update_output_boot(void);
+int mailbox_update_input_page(uint8_t npage);
+void mailbox_read_print_all(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MAILBOX_DEF_H_ */
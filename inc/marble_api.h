@@ -29,6 +29,9 @@ extern "C" {
     #define DEMO_STRING           "Marble Mini UART Simulation\r\n"
   #endif
   #define BSP_GET_SYSTICK()        (uint32_t)((uint64_t)clock()/40)
+  // Simulated interrupts run from board_service() in the main loop
+  #define INTERRUPTS_DISABLE()
+  #define INTERRUPTS_ENABLE()
 
   #define MGT_MAX_PINS 0
 
@@ -128,8 +131,12 @@ extern "C" {
 #define BOARD_TYPE_MARBLE           (0x10)
 #define BOARD_TYPE_MARBLE_MINI      (0x20)
 
-// FPGA pseudo-SPI mailbox update period (in ms)
+// FPGA pseudo-SPI mailbox update period (in ms) of the "slow" (default) rate
+// class.  The watchdog timeout counts in units of this period.
 #define SPI_MAILBOX_PERIOD_MS       (2000)
+// Periods of the faster rate classes (see "period" in mbox.def)
+#define MBOX_FAST_PERIOD_MS           (50)
+#define MBOX_MEDIUM_PERIOD_MS       (1000)
 
 // Enum for identifying Marble PCB revisions
 typedef enum {
@@ -189,6 +196,26 @@ Board_Status_t marble_get_status(void);
 
 uint32_t marble_get_tick(void);
 
+/* uint32_t marble_get_us(void);
+ *  Free-running microsecond count from a dedicated 32-bit hardware timer
+ *  (wraps every ~71.6 minutes); only differences are meaningful.
+ */
+uint32_t marble_get_us(void);
+
+/* uint32_t marble_get_cycles(void);
+ *  Free-running CPU cycle counter (DWT CYCCNT; nanoseconds in simulation)
+ *  for execution-time profiling (prof.h).  Wraps; only differences are
+ *  meaningful.
+ */
+uint32_t marble_get_cycles(void);
+uint32_t marble_cycles_per_us(void);
+
+/* void marble_wait_for_interrupt(void);
+ *  Sleep (WFI) until an interrupt is pending.  Returns right away if one
+ *  already is, even with interrupts masked.  A short sleep in simulation.
+ */
+void marble_wait_for_interrupt(void);
+
 // Only used in simulation
 void cleanup(void);
 
@@ -241,6 +268,9 @@ void marble_pmod_timer_config(void);
 * FPGA int
 ****/
 bool marble_FPGAint_get(void);
+/* FPGA_INT mailbox doorbell (falling edge); latched by the GPIO interrupt until cleared */
+int marble_FPGAint_get_doorbell(void);
+void marble_FPGAint_clear_doorbell(void);
 
 /****
 * FMC & PSU
@@ -336,8 +366,27 @@ int marble_I2C_cmdrecv(I2C_BUS I2C_bus, uint8_t addr, uint8_t cmd, uint8_t *data
 int marble_I2C_cmdsend_a2(I2C_BUS I2C_bus, uint8_t addr, uint16_t cmd, const uint8_t *data, int size);
 int marble_I2C_cmdrecv_a2(I2C_BUS I2C_bus, uint8_t addr, uint16_t cmd, uint8_t *data, int size);
 int getI2CBusStatus(void);
+/* SMBALERT on the I2C_PM bus; latched by the GPIO interrupt until cleared */
+int marble_I2C_PM_get_alert(void);
+void marble_I2C_PM_clear_alert(void);
+/* Current level of SMBALERT: 1 while some device holds it asserted */
+int marble_I2C_PM_alert_asserted(void);
 void resetI2CBusStatus(void);
 
+typedef struct {
+  uint32_t recoveries;  // Stuck-bus recovery sequences run
+  uint32_t failures;    // ... after which SDA or SCL was still held low
+} marble_I2C_recovery_t;
+
+/* int marble_I2C_recover(I2C_BUS I2C_bus);
+ *  Clock a stuck bus free (up to 9 SCL pulses and a STOP) and re-initialize
+ *  its peripheral.  Also run automatically on repeated BUSY/TIMEOUT/BERR while
+ *  SDA or SCL is held low; a lost arbitration is retried instead.
+ *  Returns 0 if the bus lines are released, -1 otherwise or if unsupported.
+ */
+int marble_I2C_recover(I2C_BUS I2C_bus);
+int marble_I2C_get_recovery(I2C_BUS I2C_bus, marble_I2C_recovery_t *stats);
+
 /************
 * Freq. Synthesizer (si570)
 ************/
@@ -370,8 +419,28 @@ uint32_t marble_SYSTIMER_ms(uint32_t delay);
 void marble_SYSTIMER_handler(void (*handler)(void));
 
 void marble_SLEEP_ms(uint32_t delay);
+
+/* void marble_SLEEP_us(uint32_t delay);
+ *  Busy-wait for at least 'delay' microseconds.
+ */
 void marble_SLEEP_us(uint32_t delay);
 
+// One per compare channel of the microsecond timer
+#define MARBLE_ONESHOT_SLOTS                           (4)
+
+/* int marble_oneshot_us(uint32_t delay, void (*callback)(void));
+ *  Call 'callback' from interrupt context once 'delay' microseconds have
+ *  elapsed.  Returns the slot used, or -1 if all MARBLE_ONESHOT_SLOTS are
+ *  busy.  May be called from an ISR, including the callback itself.
+ */
+int marble_oneshot_us(uint32_t delay, void (*callback)(void));
+
+/* void marble_oneshot_cancel(int slot);
+ *  Cancel a pending one-shot.  The slot is freed before its callback runs,
+ *  so only cancel a slot whose callback is known not to have run yet.
+ */
+void marble_oneshot_cancel(int slot);
+
 /************
 * FPGA Watchdog Support
 ************/
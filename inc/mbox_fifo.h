@@ -0,0 +1,85 @@
+/*
+ * File: mbox_fifo.h
+ * Desc: Byte-stream FIFO streamed to the FPGA through a window in the
+ *       mailbox, for event records and telemetry history that do not fit
+ *       the fixed page map (the mailbox otherwise only holds the latest
+ *       values).  The MMC appends records to a RAM ring; the FPGA (or a
+ *       host reaching it over the network) consumes them through the
+ *       window and acknowledges by advancing FIFO_TAIL.
+ *
+ *       Record:  | TYPE | LEN | PAYLOAD[LEN] |
+ *
+ *       Header (MBOX_FIFO_PAGE):
+ *         FIFO_TAIL       FPGA=>MMC  Stream offset consumed by the reader
+ *         FIFO_HEAD       MMC=>FPGA  Stream offset of the end of the data
+ *         FIFO_WIN_START  MMC=>FPGA  Stream offset of the first window byte
+ *         FIFO_WIN_LEN    MMC=>FPGA  Bytes in the window (whole records only)
+ *         FIFO_DROPPED    MMC=>FPGA  Records lost to overflow (wraps)
+ *       Window (MBOX_FIFO_WIN_PAGE and the next pages, MMC=>FPGA)
+ *
+ *       Offsets count bytes since boot, modulo 2^16.  The MMC writes the
+ *       window before the header, and only rewrites it when the header
+ *       changes, so a reader that gets the same header before and after
+ *       reading the window has a consistent copy.  The reader acknowledges
+ *       the window by writing FIFO_TAIL = FIFO_WIN_START + FIFO_WIN_LEN; any
+ *       other value is ignored.  When the ring is full the oldest records
+ *       are dropped, so FIFO_WIN_START jumping past the reader's FIFO_TAIL
+ *       marks a gap (as does the first read after an MMC reset).
+ *       See MboxFifo in scripts/mboxexchange.py for the reader.
+ */
+
+#ifndef __MBOX_FIFO_H
+#define __MBOX_FIFO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+// Must agree with inc/mbox.def
+#define MBOX_FIFO_PAGE                              (20)
+#define MBOX_FIFO_WIN_PAGE                          (21)
+#define MBOX_FIFO_WIN_PAGES                          (3)
+#define MBOX_FIFO_WIN_SIZE       (MBOX_FIFO_WIN_PAGES*16)
+
+// Header entries of MBOX_FIFO_PAGE (multi-byte values MSB first)
+#define MBOX_FIFO_TAIL                               (0)
+#define MBOX_FIFO_HEAD                               (2)
+#define MBOX_FIFO_WIN_START                          (4)
+#define MBOX_FIFO_WIN_LEN                            (6)
+#define MBOX_FIFO_DROPPED                            (7)
+#define MBOX_FIFO_HEADER_END                         (9)
+
+// Size of the RAM ring; must be a power of 2
+#define MBOX_FIFO_RING_SIZE                       (2048)
+#define MBOX_FIFO_REC_HEADER                         (2)
+// Every record must fit the window
+#define MBOX_FIFO_MAX_PAYLOAD   (MBOX_FIFO_WIN_SIZE - MBOX_FIFO_REC_HEADER)
+#define MBOX_FIFO_TELEM_PERIOD_MS                 (1000)
+
+typedef enum {
+  MBOX_FIFO_REC_TELEM = 0x01,   // tick (u32 LE), FRAME_OP_TELEM response
+  MBOX_FIFO_REC_FAULT = 0x02,   // ltm4673_fault_t (SMBALERT snapshot)
+  MBOX_FIFO_REC_PMLOG = 0x03,   // First PMLOG_HEADER_SIZE bytes of a pmlog_record_t
+} mbox_fifo_rec_t;
+
+/* int mbox_fifo_put(uint8_t type, const uint8_t *data, int len);
+ *  Append a record, dropping the oldest records if the ring is full.
+ *  Returns 0 on success, -1 if 'len' exceeds MBOX_FIFO_MAX_PAYLOAD.
+ */
+int mbox_fifo_put(uint8_t type, const uint8_t *data, int len);
+
+/* void mbox_fifo_update(uint16_t tail);
+ *  Input handler of FIFO_TAIL (called from the generated mailbox update
+ *  code).  Frees the published window if 'tail' acknowledges it, appends a
+ *  telemetry record every MBOX_FIFO_TELEM_PERIOD_MS and republishes the
+ *  window and header if they changed.
+ */
+void mbox_fifo_update(uint16_t tail);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __MBOX_FIFO_H
@@ -0,0 +1,54 @@
+/*
+ * File: mbox_rpc.h
+ * Desc: Request/response channel in the FPGA mailbox so the FPGA (or a host
+ *       reaching it over the network) can run MMC operations without the
+ *       console UART.  Operations, arguments and status codes are those of
+ *       the binary UART frame protocol (see uart_frame.h); FRAME_OP_CONSOLE
+ *       runs a console command and returns the start of its output, and
+ *       FRAME_OP_CONSOLE_OUTPUT reads the rest.
+ *
+ *       Request  (MBOX_RPC_REQ_PAGE and the next page, FPGA=>MMC):
+ *         | SEQ | OP     | LEN | ARG[LEN]    |
+ *       Response (MBOX_RPC_RSP_PAGE and the next page, MMC=>FPGA):
+ *         | SEQ | STATUS | LEN | RESULT[LEN] |
+ *
+ *       A request is pending while the request SEQ differs from the
+ *       response SEQ.  The host writes OP, LEN and ARG first and SEQ last;
+ *       the MMC writes STATUS, LEN and RESULT first and SEQ last.  Requests
+ *       are picked up by the "fast" mailbox update, or right away if the
+ *       FPGA rings the doorbell for MBOX_RPC_REQ_PAGE.
+ *       See MboxRPC in scripts/mboxexchange.py for the host side.
+ */
+
+#ifndef __MBOX_RPC_H
+#define __MBOX_RPC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+// Must agree with inc/mbox.def
+#define MBOX_RPC_REQ_PAGE                           (16)
+#define MBOX_RPC_RSP_PAGE                           (18)
+
+#define MBOX_RPC_SEQ                                 (0)
+#define MBOX_RPC_OP                                  (1)  // STATUS in the response
+#define MBOX_RPC_LEN                                 (2)
+#define MBOX_RPC_HEADER_SIZE                         (3)
+// Two pages per direction
+#define MBOX_RPC_MAX_PAYLOAD     (2*16 - MBOX_RPC_HEADER_SIZE)
+
+/* int mbox_rpc_service(uint8_t seq);
+ *  Input handler of the request SEQ entry (called from the generated
+ *  mailbox update code).  Runs the request and writes the response if
+ *  'seq' differs from the response SEQ.  Returns 1 if a request was run.
+ */
+int mbox_rpc_service(uint8_t seq);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __MBOX_RPC_H
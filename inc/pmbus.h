@@ -66,161 +66,161 @@
 // Linear16 (L16) unsigned type
 #define _L16_EXPONENT                                                      (13)
 
-#define V_TO_L16(v)                                      (v*(1<<_L16_EXPONENT))
-#define L16_TO_V(l)                                      (l/(1<<_L16_EXPONENT))
+#define V_TO_L16(v)                                    ((v)*(1<<_L16_EXPONENT))
+#define L16_TO_V(l)                                    ((l)/(1<<_L16_EXPONENT))
 
-#define MV_TO_L16(v)                                (v*(1<<_L16_EXPONENT)/1000)
-#define L16_TO_MV(l)                                (1000*l/(1<<_L16_EXPONENT))
+#define MV_TO_L16(v)                              ((v)*(1<<_L16_EXPONENT)/1000)
+#define L16_TO_MV(l)                              (1000*(l)/(1<<_L16_EXPONENT))
 
-#define UV_TO_L16(v)                             (v*(1<<_L16_EXPONENT)/1000000)
-#define L16_TO_UV(l)                             (1000000*l/(1<<_L16_EXPONENT))
+#define UV_TO_L16(v)                           ((v)*(1<<_L16_EXPONENT)/1000000)
+#define L16_TO_UV(l)                           (1000000*(l)/(1<<_L16_EXPONENT))
 
 // Linear11 (L11) signed type
 // Unity-scaled units (i.e. Volts, Amps, degC, etc) to L11 encoding
 #define V_TO_L11(v) \
-  ((v*(1<<16)) < 1024) && ((v*(1<<16)) > -1025) ? ((0x10 << 11) | ((uint16_t)(v*(1<<16)) & 0x7ff)) : \
-  ((v*(1<<15)) < 1024) && ((v*(1<<15)) > -1025) ? ((0x11 << 11) | ((uint16_t)(v*(1<<15)) & 0x7ff)) : \
-  ((v*(1<<14)) < 1024) && ((v*(1<<14)) > -1025) ? ((0x12 << 11) | ((uint16_t)(v*(1<<14)) & 0x7ff)) : \
-  ((v*(1<<13)) < 1024) && ((v*(1<<13)) > -1025) ? ((0x13 << 11) | ((uint16_t)(v*(1<<13)) & 0x7ff)) : \
-  ((v*(1<<12)) < 1024) && ((v*(1<<12)) > -1025) ? ((0x14 << 11) | ((uint16_t)(v*(1<<12)) & 0x7ff)) : \
-  ((v*(1<<11)) < 1024) && ((v*(1<<11)) > -1025) ? ((0x15 << 11) | ((uint16_t)(v*(1<<11)) & 0x7ff)) : \
-  ((v*(1<<10)) < 1024) && ((v*(1<<10)) > -1025) ? ((0x16 << 11) | ((uint16_t)(v*(1<<10)) & 0x7ff)) : \
-  ((v*(1<< 9)) < 1024) && ((v*(1<< 9)) > -1025) ? ((0x17 << 11) | ((uint16_t)(v*(1<< 9)) & 0x7ff)) : \
-  ((v*(1<< 8)) < 1024) && ((v*(1<< 8)) > -1025) ? ((0x18 << 11) | ((uint16_t)(v*(1<< 8)) & 0x7ff)) : \
-  ((v*(1<< 7)) < 1024) && ((v*(1<< 7)) > -1025) ? ((0x19 << 11) | ((uint16_t)(v*(1<< 7)) & 0x7ff)) : \
-  ((v*(1<< 6)) < 1024) && ((v*(1<< 6)) > -1025) ? ((0x1a << 11) | ((uint16_t)(v*(1<< 6)) & 0x7ff)) : \
-  ((v*(1<< 5)) < 1024) && ((v*(1<< 5)) > -1025) ? ((0x1b << 11) | ((uint16_t)(v*(1<< 5)) & 0x7ff)) : \
-  ((v*(1<< 4)) < 1024) && ((v*(1<< 4)) > -1025) ? ((0x1c << 11) | ((uint16_t)(v*(1<< 4)) & 0x7ff)) : \
-  ((v*(1<< 3)) < 1024) && ((v*(1<< 3)) > -1025) ? ((0x1d << 11) | ((uint16_t)(v*(1<< 3)) & 0x7ff)) : \
-  ((v*(1<< 2)) < 1024) && ((v*(1<< 2)) > -1025) ? ((0x1e << 11) | ((uint16_t)(v*(1<< 2)) & 0x7ff)) : \
-  ((v*(1<< 1)) < 1024) && ((v*(1<< 1)) > -1025) ? ((0x1f << 11) | ((uint16_t)(v*(1<< 1)) & 0x7ff)) : \
-  ((v*(1<< 0)) < 1024) && ((v/(1<< 0)) > -1025) ? ((0x10 << 11) | ((uint16_t)(v*(1<< 0)) & 0x7ff)) : \
-  ((v/(1<< 1)) < 1024) && ((v/(1<< 1)) > -1025) ? ((0x11 << 11) | ((uint16_t)(v/(1<< 1)) & 0x7ff)) : \
-  ((v/(1<< 2)) < 1024) && ((v/(1<< 2)) > -1025) ? ((0x12 << 11) | ((uint16_t)(v/(1<< 2)) & 0x7ff)) : \
-  ((v/(1<< 3)) < 1024) && ((v/(1<< 3)) > -1025) ? ((0x13 << 11) | ((uint16_t)(v/(1<< 3)) & 0x7ff)) : \
-  ((v/(1<< 4)) < 1024) && ((v/(1<< 4)) > -1025) ? ((0x14 << 11) | ((uint16_t)(v/(1<< 4)) & 0x7ff)) : \
-  ((v/(1<< 5)) < 1024) && ((v/(1<< 5)) > -1025) ? ((0x15 << 11) | ((uint16_t)(v/(1<< 5)) & 0x7ff)) : \
-  ((v/(1<< 6)) < 1024) && ((v/(1<< 6)) > -1025) ? ((0x16 << 11) | ((uint16_t)(v/(1<< 6)) & 0x7ff)) : \
-  ((v/(1<< 7)) < 1024) && ((v/(1<< 7)) > -1025) ? ((0x17 << 11) | ((uint16_t)(v/(1<< 7)) & 0x7ff)) : \
-  ((v/(1<< 8)) < 1024) && ((v/(1<< 8)) > -1025) ? ((0x18 << 11) | ((uint16_t)(v/(1<< 8)) & 0x7ff)) : \
-  ((v/(1<< 9)) < 1024) && ((v/(1<< 9)) > -1025) ? ((0x19 << 11) | ((uint16_t)(v/(1<< 9)) & 0x7ff)) : \
-  ((v/(1<<10)) < 1024) && ((v/(1<<10)) > -1025) ? ((0x1a << 11) | ((uint16_t)(v/(1<<10)) & 0x7ff)) : \
-  ((v/(1<<11)) < 1024) && ((v/(1<<11)) > -1025) ? ((0x1b << 11) | ((uint16_t)(v/(1<<11)) & 0x7ff)) : \
-  ((v/(1<<12)) < 1024) && ((v/(1<<12)) > -1025) ? ((0x1c << 11) | ((uint16_t)(v/(1<<12)) & 0x7ff)) : \
-  ((v/(1<<13)) < 1024) && ((v/(1<<13)) > -1025) ? ((0x1d << 11) | ((uint16_t)(v/(1<<13)) & 0x7ff)) : \
-  ((v/(1<<14)) < 1024) && ((v/(1<<14)) > -1025) ? ((0x1e << 11) | ((uint16_t)(v/(1<<14)) & 0x7ff)) : \
-                                                  ((0x0f << 11) | ((uint16_t)(v/(1<<15)) & 0x7ff))
+  ((((v)*(1<<16)) <= 1023) && (((v)*(1<<16)) >= -1024) ? ((0x10 << 11) | ((int16_t)((v)*(1<<16)) & 0x7ff)) : \
+  (((v)*(1<<15)) <= 1023) && (((v)*(1<<15)) >= -1024) ? ((0x11 << 11) | ((int16_t)((v)*(1<<15)) & 0x7ff)) : \
+  (((v)*(1<<14)) <= 1023) && (((v)*(1<<14)) >= -1024) ? ((0x12 << 11) | ((int16_t)((v)*(1<<14)) & 0x7ff)) : \
+  (((v)*(1<<13)) <= 1023) && (((v)*(1<<13)) >= -1024) ? ((0x13 << 11) | ((int16_t)((v)*(1<<13)) & 0x7ff)) : \
+  (((v)*(1<<12)) <= 1023) && (((v)*(1<<12)) >= -1024) ? ((0x14 << 11) | ((int16_t)((v)*(1<<12)) & 0x7ff)) : \
+  (((v)*(1<<11)) <= 1023) && (((v)*(1<<11)) >= -1024) ? ((0x15 << 11) | ((int16_t)((v)*(1<<11)) & 0x7ff)) : \
+  (((v)*(1<<10)) <= 1023) && (((v)*(1<<10)) >= -1024) ? ((0x16 << 11) | ((int16_t)((v)*(1<<10)) & 0x7ff)) : \
+  (((v)*(1<< 9)) <= 1023) && (((v)*(1<< 9)) >= -1024) ? ((0x17 << 11) | ((int16_t)((v)*(1<< 9)) & 0x7ff)) : \
+  (((v)*(1<< 8)) <= 1023) && (((v)*(1<< 8)) >= -1024) ? ((0x18 << 11) | ((int16_t)((v)*(1<< 8)) & 0x7ff)) : \
+  (((v)*(1<< 7)) <= 1023) && (((v)*(1<< 7)) >= -1024) ? ((0x19 << 11) | ((int16_t)((v)*(1<< 7)) & 0x7ff)) : \
+  (((v)*(1<< 6)) <= 1023) && (((v)*(1<< 6)) >= -1024) ? ((0x1a << 11) | ((int16_t)((v)*(1<< 6)) & 0x7ff)) : \
+  (((v)*(1<< 5)) <= 1023) && (((v)*(1<< 5)) >= -1024) ? ((0x1b << 11) | ((int16_t)((v)*(1<< 5)) & 0x7ff)) : \
+  (((v)*(1<< 4)) <= 1023) && (((v)*(1<< 4)) >= -1024) ? ((0x1c << 11) | ((int16_t)((v)*(1<< 4)) & 0x7ff)) : \
+  (((v)*(1<< 3)) <= 1023) && (((v)*(1<< 3)) >= -1024) ? ((0x1d << 11) | ((int16_t)((v)*(1<< 3)) & 0x7ff)) : \
+  (((v)*(1<< 2)) <= 1023) && (((v)*(1<< 2)) >= -1024) ? ((0x1e << 11) | ((int16_t)((v)*(1<< 2)) & 0x7ff)) : \
+  (((v)*(1<< 1)) <= 1023) && (((v)*(1<< 1)) >= -1024) ? ((0x1f << 11) | ((int16_t)((v)*(1<< 1)) & 0x7ff)) : \
+  (((v)*(1<< 0)) <= 1023) && (((v)*(1<< 0)) >= -1024) ? ((0x00 << 11) | ((int16_t)((v)*(1<< 0)) & 0x7ff)) : \
+  (((v)/(1<< 1)) <= 1023) && (((v)/(1<< 1)) >= -1024) ? ((0x01 << 11) | ((int16_t)((v)/(1<< 1)) & 0x7ff)) : \
+  (((v)/(1<< 2)) <= 1023) && (((v)/(1<< 2)) >= -1024) ? ((0x02 << 11) | ((int16_t)((v)/(1<< 2)) & 0x7ff)) : \
+  (((v)/(1<< 3)) <= 1023) && (((v)/(1<< 3)) >= -1024) ? ((0x03 << 11) | ((int16_t)((v)/(1<< 3)) & 0x7ff)) : \
+  (((v)/(1<< 4)) <= 1023) && (((v)/(1<< 4)) >= -1024) ? ((0x04 << 11) | ((int16_t)((v)/(1<< 4)) & 0x7ff)) : \
+  (((v)/(1<< 5)) <= 1023) && (((v)/(1<< 5)) >= -1024) ? ((0x05 << 11) | ((int16_t)((v)/(1<< 5)) & 0x7ff)) : \
+  (((v)/(1<< 6)) <= 1023) && (((v)/(1<< 6)) >= -1024) ? ((0x06 << 11) | ((int16_t)((v)/(1<< 6)) & 0x7ff)) : \
+  (((v)/(1<< 7)) <= 1023) && (((v)/(1<< 7)) >= -1024) ? ((0x07 << 11) | ((int16_t)((v)/(1<< 7)) & 0x7ff)) : \
+  (((v)/(1<< 8)) <= 1023) && (((v)/(1<< 8)) >= -1024) ? ((0x08 << 11) | ((int16_t)((v)/(1<< 8)) & 0x7ff)) : \
+  (((v)/(1<< 9)) <= 1023) && (((v)/(1<< 9)) >= -1024) ? ((0x09 << 11) | ((int16_t)((v)/(1<< 9)) & 0x7ff)) : \
+  (((v)/(1<<10)) <= 1023) && (((v)/(1<<10)) >= -1024) ? ((0x0a << 11) | ((int16_t)((v)/(1<<10)) & 0x7ff)) : \
+  (((v)/(1<<11)) <= 1023) && (((v)/(1<<11)) >= -1024) ? ((0x0b << 11) | ((int16_t)((v)/(1<<11)) & 0x7ff)) : \
+  (((v)/(1<<12)) <= 1023) && (((v)/(1<<12)) >= -1024) ? ((0x0c << 11) | ((int16_t)((v)/(1<<12)) & 0x7ff)) : \
+  (((v)/(1<<13)) <= 1023) && (((v)/(1<<13)) >= -1024) ? ((0x0d << 11) | ((int16_t)((v)/(1<<13)) & 0x7ff)) : \
+  (((v)/(1<<14)) <= 1023) && (((v)/(1<<14)) >= -1024) ? ((0x0e << 11) | ((int16_t)((v)/(1<<14)) & 0x7ff)) : \
+                                                  ((0x0f << 11) | ((int16_t)((v)/(1<<15)) & 0x7ff)))
 
 // L11 encoding to unity-scaled units (i.e. Volts, Amps, degC, etc)
 #define L11_TO_V(l) \
-  ((l & 0x400) ? \
-    (l & 0x8000) ? \
-      (-1*((~l & 0x3ff) + 1) >> ((~(l >> 11) & 0xf) + 1)) \
+  (((l) & 0x400) ? \
+    ((l) & 0x8000) ? \
+      (-1*((~(l) & 0x3ff) + 1) >> ((~((l) >> 11) & 0xf) + 1)) \
     : \
-      (-1*((~l & 0x3ff) + 1) << ((l >> 11) & 0xf)) \
+      (-1*((~(l) & 0x3ff) + 1) << (((l) >> 11) & 0xf)) \
   : \
-    (l & 0x8000) ? \
-      ((l & 0x3ff) >> (~(l >> 11) & 0xf) + 1) \
+    ((l) & 0x8000) ? \
+      (((l) & 0x3ff) >> (~((l) >> 11) & 0xf) + 1) \
     : \
-      ((l & 0x3ff) << ((l >> 11) & 0xf)) \
+      (((l) & 0x3ff) << (((l) >> 11) & 0xf)) \
   )
 
 // Units scaled by 10^3 (i.e. millivolts, milliamps, milliseconds, etc) to L11 encoding
 #define MV_TO_L11(v) \
-  ((v*(1<<16)/(1000 <<  0)) < 1024) && ((v*(1<<16)/(1000 <<  0)) > -1025) ? ((0x10 << 11) | ((uint16_t)(v*(1<<16)/(1000 <<  0)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000 <<  1)) < 1024) && ((v*(1<<16)/(1000 <<  1)) > -1025) ? ((0x11 << 11) | ((uint16_t)(v*(1<<16)/(1000 <<  1)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000 <<  2)) < 1024) && ((v*(1<<16)/(1000 <<  2)) > -1025) ? ((0x12 << 11) | ((uint16_t)(v*(1<<16)/(1000 <<  2)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000 <<  3)) < 1024) && ((v*(1<<16)/(1000 <<  3)) > -1025) ? ((0x13 << 11) | ((uint16_t)(v*(1<<16)/(1000 <<  3)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000 <<  4)) < 1024) && ((v*(1<<16)/(1000 <<  4)) > -1025) ? ((0x14 << 11) | ((uint16_t)(v*(1<<16)/(1000 <<  4)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000 <<  5)) < 1024) && ((v*(1<<16)/(1000 <<  5)) > -1025) ? ((0x15 << 11) | ((uint16_t)(v*(1<<16)/(1000 <<  5)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000 <<  6)) < 1024) && ((v*(1<<16)/(1000 <<  6)) > -1025) ? ((0x16 << 11) | ((uint16_t)(v*(1<<16)/(1000 <<  6)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000 <<  7)) < 1024) && ((v*(1<<16)/(1000 <<  7)) > -1025) ? ((0x17 << 11) | ((uint16_t)(v*(1<<16)/(1000 <<  7)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000 <<  8)) < 1024) && ((v*(1<<16)/(1000 <<  8)) > -1025) ? ((0x18 << 11) | ((uint16_t)(v*(1<<16)/(1000 <<  8)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000 <<  9)) < 1024) && ((v*(1<<16)/(1000 <<  9)) > -1025) ? ((0x19 << 11) | ((uint16_t)(v*(1<<16)/(1000 <<  9)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000 << 10)) < 1024) && ((v*(1<<16)/(1000 << 10)) > -1025) ? ((0x1a << 11) | ((uint16_t)(v*(1<<16)/(1000 << 10)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000 << 11)) < 1024) && ((v*(1<<16)/(1000 << 11)) > -1025) ? ((0x1b << 11) | ((uint16_t)(v*(1<<16)/(1000 << 11)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000 << 12)) < 1024) && ((v*(1<<16)/(1000 << 12)) > -1025) ? ((0x1c << 11) | ((uint16_t)(v*(1<<16)/(1000 << 12)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000 << 13)) < 1024) && ((v*(1<<16)/(1000 << 13)) > -1025) ? ((0x1d << 11) | ((uint16_t)(v*(1<<16)/(1000 << 13)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000 << 14)) < 1024) && ((v*(1<<16)/(1000 << 14)) > -1025) ? ((0x1e << 11) | ((uint16_t)(v*(1<<16)/(1000 << 14)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000 << 15)) < 1024) && ((v*(1<<16)/(1000 << 15)) > -1025) ? ((0x1f << 11) | ((uint16_t)(v*(1<<16)/(1000 << 15)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000 << 16)) < 1024) && ((v*(1<<16)/(1000 << 16)) > -1025) ? ((0x00 << 11) | ((uint16_t)(v*(1<<16)/(1000 << 16)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000 << 17)) < 1024) && ((v*(1<<16)/(1000 << 17)) > -1025) ? ((0x01 << 11) | ((uint16_t)(v*(1<<16)/(1000 << 17)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000 << 18)) < 1024) && ((v*(1<<16)/(1000 << 18)) > -1025) ? ((0x02 << 11) | ((uint16_t)(v*(1<<16)/(1000 << 18)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000 << 19)) < 1024) && ((v*(1<<16)/(1000 << 19)) > -1025) ? ((0x03 << 11) | ((uint16_t)(v*(1<<16)/(1000 << 19)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000 << 20)) < 1024) && ((v*(1<<16)/(1000 << 20)) > -1025) ? ((0x04 << 11) | ((uint16_t)(v*(1<<16)/(1000 << 20)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000 << 21)) < 1024) && ((v*(1<<16)/(1000 << 21)) > -1025) ? ((0x05 << 11) | ((uint16_t)(v*(1<<16)/(1000 << 21)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000 << 22)) < 1024) && ((v*(1<<16)/(1000 << 22)) > -1025) ? ((0x06 << 11) | ((uint16_t)(v*(1<<16)/(1000 << 22)) & 0x7ff)) : \
-  ((v*(1<<15)/(1000 << 22)) < 1024) && ((v*(1<<15)/(1000 << 22)) > -1025) ? ((0x07 << 11) | ((uint16_t)(v*(1<<15)/(1000 << 22)) & 0x7ff)) : \
-  ((v*(1<<14)/(1000 << 22)) < 1024) && ((v*(1<<14)/(1000 << 22)) > -1025) ? ((0x08 << 11) | ((uint16_t)(v*(1<<14)/(1000 << 22)) & 0x7ff)) : \
-  ((v*(1<<13)/(1000 << 22)) < 1024) && ((v*(1<<13)/(1000 << 22)) > -1025) ? ((0x09 << 11) | ((uint16_t)(v*(1<<13)/(1000 << 22)) & 0x7ff)) : \
-  ((v*(1<<12)/(1000 << 22)) < 1024) && ((v*(1<<12)/(1000 << 22)) > -1025) ? ((0x0a << 11) | ((uint16_t)(v*(1<<12)/(1000 << 22)) & 0x7ff)) : \
-  ((v*(1<<11)/(1000 << 22)) < 1024) && ((v*(1<<11)/(1000 << 22)) > -1025) ? ((0x0b << 11) | ((uint16_t)(v*(1<<11)/(1000 << 22)) & 0x7ff)) : \
-  ((v*(1<<10)/(1000 << 22)) < 1024) && ((v*(1<<10)/(1000 << 22)) > -1025) ? ((0x0c << 11) | ((uint16_t)(v*(1<<10)/(1000 << 22)) & 0x7ff)) : \
-  ((v*(1<< 9)/(1000 << 22)) < 1024) && ((v*(1<< 9)/(1000 << 22)) > -1025) ? ((0x0d << 11) | ((uint16_t)(v*(1<< 9)/(1000 << 22)) & 0x7ff)) : \
-  ((v*(1<< 8)/(1000 << 22)) < 1024) && ((v*(1<< 8)/(1000 << 22)) > -1025) ? ((0x0e << 11) | ((uint16_t)(v*(1<< 8)/(1000 << 22)) & 0x7ff)) : \
-                                                                            ((0x0f << 11) | ((uint16_t)(v*(1<< 7)/(1000 << 22)) & 0x7ff))
+  ((((v)*(1<<16)/(1000 <<  0)) < 1024) && (((v)*(1<<16)/(1000 <<  0)) > -1025) ? ((0x10 << 11) | ((uint16_t)((v)*(1<<16)/(1000 <<  0)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000 <<  1)) < 1024) && (((v)*(1<<16)/(1000 <<  1)) > -1025) ? ((0x11 << 11) | ((uint16_t)((v)*(1<<16)/(1000 <<  1)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000 <<  2)) < 1024) && (((v)*(1<<16)/(1000 <<  2)) > -1025) ? ((0x12 << 11) | ((uint16_t)((v)*(1<<16)/(1000 <<  2)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000 <<  3)) < 1024) && (((v)*(1<<16)/(1000 <<  3)) > -1025) ? ((0x13 << 11) | ((uint16_t)((v)*(1<<16)/(1000 <<  3)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000 <<  4)) < 1024) && (((v)*(1<<16)/(1000 <<  4)) > -1025) ? ((0x14 << 11) | ((uint16_t)((v)*(1<<16)/(1000 <<  4)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000 <<  5)) < 1024) && (((v)*(1<<16)/(1000 <<  5)) > -1025) ? ((0x15 << 11) | ((uint16_t)((v)*(1<<16)/(1000 <<  5)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000 <<  6)) < 1024) && (((v)*(1<<16)/(1000 <<  6)) > -1025) ? ((0x16 << 11) | ((uint16_t)((v)*(1<<16)/(1000 <<  6)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000 <<  7)) < 1024) && (((v)*(1<<16)/(1000 <<  7)) > -1025) ? ((0x17 << 11) | ((uint16_t)((v)*(1<<16)/(1000 <<  7)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000 <<  8)) < 1024) && (((v)*(1<<16)/(1000 <<  8)) > -1025) ? ((0x18 << 11) | ((uint16_t)((v)*(1<<16)/(1000 <<  8)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000 <<  9)) < 1024) && (((v)*(1<<16)/(1000 <<  9)) > -1025) ? ((0x19 << 11) | ((uint16_t)((v)*(1<<16)/(1000 <<  9)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000 << 10)) < 1024) && (((v)*(1<<16)/(1000 << 10)) > -1025) ? ((0x1a << 11) | ((uint16_t)((v)*(1<<16)/(1000 << 10)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000 << 11)) < 1024) && (((v)*(1<<16)/(1000 << 11)) > -1025) ? ((0x1b << 11) | ((uint16_t)((v)*(1<<16)/(1000 << 11)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000 << 12)) < 1024) && (((v)*(1<<16)/(1000 << 12)) > -1025) ? ((0x1c << 11) | ((uint16_t)((v)*(1<<16)/(1000 << 12)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000 << 13)) < 1024) && (((v)*(1<<16)/(1000 << 13)) > -1025) ? ((0x1d << 11) | ((uint16_t)((v)*(1<<16)/(1000 << 13)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000 << 14)) < 1024) && (((v)*(1<<16)/(1000 << 14)) > -1025) ? ((0x1e << 11) | ((uint16_t)((v)*(1<<16)/(1000 << 14)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000 << 15)) < 1024) && (((v)*(1<<16)/(1000 << 15)) > -1025) ? ((0x1f << 11) | ((uint16_t)((v)*(1<<16)/(1000 << 15)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000 << 16)) < 1024) && (((v)*(1<<16)/(1000 << 16)) > -1025) ? ((0x00 << 11) | ((uint16_t)((v)*(1<<16)/(1000 << 16)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000 << 17)) < 1024) && (((v)*(1<<16)/(1000 << 17)) > -1025) ? ((0x01 << 11) | ((uint16_t)((v)*(1<<16)/(1000 << 17)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000 << 18)) < 1024) && (((v)*(1<<16)/(1000 << 18)) > -1025) ? ((0x02 << 11) | ((uint16_t)((v)*(1<<16)/(1000 << 18)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000 << 19)) < 1024) && (((v)*(1<<16)/(1000 << 19)) > -1025) ? ((0x03 << 11) | ((uint16_t)((v)*(1<<16)/(1000 << 19)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000 << 20)) < 1024) && (((v)*(1<<16)/(1000 << 20)) > -1025) ? ((0x04 << 11) | ((uint16_t)((v)*(1<<16)/(1000 << 20)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000 << 21)) < 1024) && (((v)*(1<<16)/(1000 << 21)) > -1025) ? ((0x05 << 11) | ((uint16_t)((v)*(1<<16)/(1000 << 21)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000 << 22)) < 1024) && (((v)*(1<<16)/(1000 << 22)) > -1025) ? ((0x06 << 11) | ((uint16_t)((v)*(1<<16)/(1000 << 22)) & 0x7ff)) : \
+  (((v)*(1<<15)/(1000 << 22)) < 1024) && (((v)*(1<<15)/(1000 << 22)) > -1025) ? ((0x07 << 11) | ((uint16_t)((v)*(1<<15)/(1000 << 22)) & 0x7ff)) : \
+  (((v)*(1<<14)/(1000 << 22)) < 1024) && (((v)*(1<<14)/(1000 << 22)) > -1025) ? ((0x08 << 11) | ((uint16_t)((v)*(1<<14)/(1000 << 22)) & 0x7ff)) : \
+  (((v)*(1<<13)/(1000 << 22)) < 1024) && (((v)*(1<<13)/(1000 << 22)) > -1025) ? ((0x09 << 11) | ((uint16_t)((v)*(1<<13)/(1000 << 22)) & 0x7ff)) : \
+  (((v)*(1<<12)/(1000 << 22)) < 1024) && (((v)*(1<<12)/(1000 << 22)) > -1025) ? ((0x0a << 11) | ((uint16_t)((v)*(1<<12)/(1000 << 22)) & 0x7ff)) : \
+  (((v)*(1<<11)/(1000 << 22)) < 1024) && (((v)*(1<<11)/(1000 << 22)) > -1025) ? ((0x0b << 11) | ((uint16_t)((v)*(1<<11)/(1000 << 22)) & 0x7ff)) : \
+  (((v)*(1<<10)/(1000 << 22)) < 1024) && (((v)*(1<<10)/(1000 << 22)) > -1025) ? ((0x0c << 11) | ((uint16_t)((v)*(1<<10)/(1000 << 22)) & 0x7ff)) : \
+  (((v)*(1<< 9)/(1000 << 22)) < 1024) && (((v)*(1<< 9)/(1000 << 22)) > -1025) ? ((0x0d << 11) | ((uint16_t)((v)*(1<< 9)/(1000 << 22)) & 0x7ff)) : \
+  (((v)*(1<< 8)/(1000 << 22)) < 1024) && (((v)*(1<< 8)/(1000 << 22)) > -1025) ? ((0x0e << 11) | ((uint16_t)((v)*(1<< 8)/(1000 << 22)) & 0x7ff)) : \
+                                                                            ((0x0f << 11) | ((uint16_t)((v)*(1<< 7)/(1000 << 22)) & 0x7ff)))
 
 // L11 encoding to units scaled by 10^3 (i.e. millivolts, milliamps, milliseconds, etc)
 #define L11_TO_MV(l) \
-  ((l & 0x400) ? \
-    (l & 0x8000) ? \
-      (-1000*((~l & 0x3ff) + 1) >> ((~(l >> 11) & 0xf) + 1)) \
+  (((l) & 0x400) ? \
+    ((l) & 0x8000) ? \
+      (-1000*((~(l) & 0x3ff) + 1) >> ((~((l) >> 11) & 0xf) + 1)) \
     : \
-      (-1000*((~l & 0x3ff) + 1) << ((l >> 11) & 0xf)) \
+      (-1000*((~(l) & 0x3ff) + 1) << (((l) >> 11) & 0xf)) \
   : \
-    (l & 0x8000) ? \
-      (1000*(l & 0x3ff) >> (~(l >> 11) & 0xf) + 1) \
+    ((l) & 0x8000) ? \
+      (1000*((l) & 0x3ff) >> (~((l) >> 11) & 0xf) + 1) \
     : \
-      (1000*(l & 0x3ff) << ((l >> 11) & 0xf)) \
+      (1000*((l) & 0x3ff) << (((l) >> 11) & 0xf)) \
   )
 
 // Units scaled by 10^6 (i.e. microvolts, microamps, microseconds, etc) to L11 encoding
 #define UV_TO_L11(v) \
-  ((v*(1<<16)/(1000000 <<  0)) < 1024) && ((v*(1<<16)/(1000000 <<  0)) > -1025) ? ((0x10 << 11) | ((uint16_t)(v*(1<<16)/(1000000 <<  0)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000000 <<  1)) < 1024) && ((v*(1<<16)/(1000000 <<  1)) > -1025) ? ((0x11 << 11) | ((uint16_t)(v*(1<<16)/(1000000 <<  1)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000000 <<  2)) < 1024) && ((v*(1<<16)/(1000000 <<  2)) > -1025) ? ((0x12 << 11) | ((uint16_t)(v*(1<<16)/(1000000 <<  2)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000000 <<  3)) < 1024) && ((v*(1<<16)/(1000000 <<  3)) > -1025) ? ((0x13 << 11) | ((uint16_t)(v*(1<<16)/(1000000 <<  3)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000000 <<  4)) < 1024) && ((v*(1<<16)/(1000000 <<  4)) > -1025) ? ((0x14 << 11) | ((uint16_t)(v*(1<<16)/(1000000 <<  4)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000000 <<  5)) < 1024) && ((v*(1<<16)/(1000000 <<  5)) > -1025) ? ((0x15 << 11) | ((uint16_t)(v*(1<<16)/(1000000 <<  5)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000000 <<  6)) < 1024) && ((v*(1<<16)/(1000000 <<  6)) > -1025) ? ((0x16 << 11) | ((uint16_t)(v*(1<<16)/(1000000 <<  6)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000000 <<  7)) < 1024) && ((v*(1<<16)/(1000000 <<  7)) > -1025) ? ((0x17 << 11) | ((uint16_t)(v*(1<<16)/(1000000 <<  7)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000000 <<  8)) < 1024) && ((v*(1<<16)/(1000000 <<  8)) > -1025) ? ((0x18 << 11) | ((uint16_t)(v*(1<<16)/(1000000 <<  8)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000000 <<  9)) < 1024) && ((v*(1<<16)/(1000000 <<  9)) > -1025) ? ((0x19 << 11) | ((uint16_t)(v*(1<<16)/(1000000 <<  9)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000000 << 10)) < 1024) && ((v*(1<<16)/(1000000 << 10)) > -1025) ? ((0x1a << 11) | ((uint16_t)(v*(1<<16)/(1000000 << 10)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000000 << 11)) < 1024) && ((v*(1<<16)/(1000000 << 11)) > -1025) ? ((0x1b << 11) | ((uint16_t)(v*(1<<16)/(1000000 << 11)) & 0x7ff)) : \
-  ((v*(1<<16)/(1000000 << 12)) < 1024) && ((v*(1<<16)/(1000000 << 12)) > -1025) ? ((0x1c << 11) | ((uint16_t)(v*(1<<16)/(1000000 << 12)) & 0x7ff)) : \
-  ((v*(1<<15)/(1000000 << 12)) < 1024) && ((v*(1<<15)/(1000000 << 12)) > -1025) ? ((0x1d << 11) | ((uint16_t)(v*(1<<15)/(1000000 << 12)) & 0x7ff)) : \
-  ((v*(1<<14)/(1000000 << 12)) < 1024) && ((v*(1<<14)/(1000000 << 12)) > -1025) ? ((0x1e << 11) | ((uint16_t)(v*(1<<14)/(1000000 << 12)) & 0x7ff)) : \
-  ((v*(1<<13)/(1000000 << 12)) < 1024) && ((v*(1<<13)/(1000000 << 12)) > -1025) ? ((0x1f << 11) | ((uint16_t)(v*(1<<13)/(1000000 << 12)) & 0x7ff)) : \
-  ((v*(1<<12)/(1000000 << 12)) < 1024) && ((v*(1<<12)/(1000000 << 12)) > -1025) ? ((0x00 << 11) | ((uint16_t)(v*(1<<12)/(1000000 << 12)) & 0x7ff)) : \
-  ((v*(1<<11)/(1000000 << 12)) < 1024) && ((v*(1<<11)/(1000000 << 12)) > -1025) ? ((0x01 << 11) | ((uint16_t)(v*(1<<11)/(1000000 << 12)) & 0x7ff)) : \
-  ((v*(1<<10)/(1000000 << 12)) < 1024) && ((v*(1<<10)/(1000000 << 12)) > -1025) ? ((0x02 << 11) | ((uint16_t)(v*(1<<10)/(1000000 << 12)) & 0x7ff)) : \
-  ((v*(1<< 9)/(1000000 << 12)) < 1024) && ((v*(1<< 9)/(1000000 << 12)) > -1025) ? ((0x03 << 11) | ((uint16_t)(v*(1<< 9)/(1000000 << 12)) & 0x7ff)) : \
-  ((v*(1<< 8)/(1000000 << 12)) < 1024) && ((v*(1<< 8)/(1000000 << 12)) > -1025) ? ((0x04 << 11) | ((uint16_t)(v*(1<< 8)/(1000000 << 12)) & 0x7ff)) : \
-  ((v*(1<< 7)/(1000000 << 12)) < 1024) && ((v*(1<< 7)/(1000000 << 12)) > -1025) ? ((0x05 << 11) | ((uint16_t)(v*(1<< 7)/(1000000 << 12)) & 0x7ff)) : \
-  ((v*(1<< 6)/(1000000 << 12)) < 1024) && ((v*(1<< 6)/(1000000 << 12)) > -1025) ? ((0x06 << 11) | ((uint16_t)(v*(1<< 6)/(1000000 << 12)) & 0x7ff)) : \
-  ((v*(1<< 5)/(1000000 << 12)) < 1024) && ((v*(1<< 5)/(1000000 << 12)) > -1025) ? ((0x07 << 11) | ((uint16_t)(v*(1<< 5)/(1000000 << 12)) & 0x7ff)) : \
-  ((v*(1<< 4)/(1000000 << 12)) < 1024) && ((v*(1<< 4)/(1000000 << 12)) > -1025) ? ((0x08 << 11) | ((uint16_t)(v*(1<< 4)/(1000000 << 12)) & 0x7ff)) : \
-  ((v*(1<< 3)/(1000000 << 12)) < 1024) && ((v*(1<< 3)/(1000000 << 12)) > -1025) ? ((0x09 << 11) | ((uint16_t)(v*(1<< 3)/(1000000 << 12)) & 0x7ff)) : \
-  ((v*(1<< 2)/(1000000 << 12)) < 1024) && ((v*(1<< 2)/(1000000 << 12)) > -1025) ? ((0x0a << 11) | ((uint16_t)(v*(1<< 2)/(1000000 << 12)) & 0x7ff)) : \
-  ((v*(1<< 1)/(1000000 << 12)) < 1024) && ((v*(1<< 1)/(1000000 << 12)) > -1025) ? ((0x0b << 11) | ((uint16_t)(v*(1<< 1)/(1000000 << 12)) & 0x7ff)) : \
-  ((v*(1<< 0)/(1000000 << 12)) < 1024) && ((v*(1<< 0)/(1000000 << 12)) > -1025) ? ((0x0c << 11) | ((uint16_t)(v*(1<< 0)/(1000000 << 12)) & 0x7ff)) : \
-  ((v/(1<< 1)/(1000000 << 12)) < 1024) && ((v/(1<< 1)/(1000000 << 12)) > -1025) ? ((0x0d << 11) | ((uint16_t)(v/(1<< 1)/(1000000 << 12)) & 0x7ff)) : \
-  ((v/(1<< 2)/(1000000 << 12)) < 1024) && ((v/(1<< 2)/(1000000 << 12)) > -1025) ? ((0x0e << 11) | ((uint16_t)(v/(1<< 2)/(1000000 << 12)) & 0x7ff)) : \
-                                                                                  ((0x0f << 11) | ((uint16_t)(v/(1<< 3)/(1000000 << 12)) & 0x7ff))
+  ((((v)*(1<<16)/(1000000 <<  0)) < 1024) && (((v)*(1<<16)/(1000000 <<  0)) > -1025) ? ((0x10 << 11) | ((uint16_t)((v)*(1<<16)/(1000000 <<  0)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000000 <<  1)) < 1024) && (((v)*(1<<16)/(1000000 <<  1)) > -1025) ? ((0x11 << 11) | ((uint16_t)((v)*(1<<16)/(1000000 <<  1)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000000 <<  2)) < 1024) && (((v)*(1<<16)/(1000000 <<  2)) > -1025) ? ((0x12 << 11) | ((uint16_t)((v)*(1<<16)/(1000000 <<  2)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000000 <<  3)) < 1024) && (((v)*(1<<16)/(1000000 <<  3)) > -1025) ? ((0x13 << 11) | ((uint16_t)((v)*(1<<16)/(1000000 <<  3)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000000 <<  4)) < 1024) && (((v)*(1<<16)/(1000000 <<  4)) > -1025) ? ((0x14 << 11) | ((uint16_t)((v)*(1<<16)/(1000000 <<  4)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000000 <<  5)) < 1024) && (((v)*(1<<16)/(1000000 <<  5)) > -1025) ? ((0x15 << 11) | ((uint16_t)((v)*(1<<16)/(1000000 <<  5)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000000 <<  6)) < 1024) && (((v)*(1<<16)/(1000000 <<  6)) > -1025) ? ((0x16 << 11) | ((uint16_t)((v)*(1<<16)/(1000000 <<  6)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000000 <<  7)) < 1024) && (((v)*(1<<16)/(1000000 <<  7)) > -1025) ? ((0x17 << 11) | ((uint16_t)((v)*(1<<16)/(1000000 <<  7)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000000 <<  8)) < 1024) && (((v)*(1<<16)/(1000000 <<  8)) > -1025) ? ((0x18 << 11) | ((uint16_t)((v)*(1<<16)/(1000000 <<  8)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000000 <<  9)) < 1024) && (((v)*(1<<16)/(1000000 <<  9)) > -1025) ? ((0x19 << 11) | ((uint16_t)((v)*(1<<16)/(1000000 <<  9)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000000 << 10)) < 1024) && (((v)*(1<<16)/(1000000 << 10)) > -1025) ? ((0x1a << 11) | ((uint16_t)((v)*(1<<16)/(1000000 << 10)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000000 << 11)) < 1024) && (((v)*(1<<16)/(1000000 << 11)) > -1025) ? ((0x1b << 11) | ((uint16_t)((v)*(1<<16)/(1000000 << 11)) & 0x7ff)) : \
+  (((v)*(1<<16)/(1000000 << 12)) < 1024) && (((v)*(1<<16)/(1000000 << 12)) > -1025) ? ((0x1c << 11) | ((uint16_t)((v)*(1<<16)/(1000000 << 12)) & 0x7ff)) : \
+  (((v)*(1<<15)/(1000000 << 12)) < 1024) && (((v)*(1<<15)/(1000000 << 12)) > -1025) ? ((0x1d << 11) | ((uint16_t)((v)*(1<<15)/(1000000 << 12)) & 0x7ff)) : \
+  (((v)*(1<<14)/(1000000 << 12)) < 1024) && (((v)*(1<<14)/(1000000 << 12)) > -1025) ? ((0x1e << 11) | ((uint16_t)((v)*(1<<14)/(1000000 << 12)) & 0x7ff)) : \
+  (((v)*(1<<13)/(1000000 << 12)) < 1024) && (((v)*(1<<13)/(1000000 << 12)) > -1025) ? ((0x1f << 11) | ((uint16_t)((v)*(1<<13)/(1000000 << 12)) & 0x7ff)) : \
+  (((v)*(1<<12)/(1000000 << 12)) < 1024) && (((v)*(1<<12)/(1000000 << 12)) > -1025) ? ((0x00 << 11) | ((uint16_t)((v)*(1<<12)/(1000000 << 12)) & 0x7ff)) : \
+  (((v)*(1<<11)/(1000000 << 12)) < 1024) && (((v)*(1<<11)/(1000000 << 12)) > -1025) ? ((0x01 << 11) | ((uint16_t)((v)*(1<<11)/(1000000 << 12)) & 0x7ff)) : \
+  (((v)*(1<<10)/(1000000 << 12)) < 1024) && (((v)*(1<<10)/(1000000 << 12)) > -1025) ? ((0x02 << 11) | ((uint16_t)((v)*(1<<10)/(1000000 << 12)) & 0x7ff)) : \
+  (((v)*(1<< 9)/(1000000 << 12)) < 1024) && (((v)*(1<< 9)/(1000000 << 12)) > -1025) ? ((0x03 << 11) | ((uint16_t)((v)*(1<< 9)/(1000000 << 12)) & 0x7ff)) : \
+  (((v)*(1<< 8)/(1000000 << 12)) < 1024) && (((v)*(1<< 8)/(1000000 << 12)) > -1025) ? ((0x04 << 11) | ((uint16_t)((v)*(1<< 8)/(1000000 << 12)) & 0x7ff)) : \
+  (((v)*(1<< 7)/(1000000 << 12)) < 1024) && (((v)*(1<< 7)/(1000000 << 12)) > -1025) ? ((0x05 << 11) | ((uint16_t)((v)*(1<< 7)/(1000000 << 12)) & 0x7ff)) : \
+  (((v)*(1<< 6)/(1000000 << 12)) < 1024) && (((v)*(1<< 6)/(1000000 << 12)) > -1025) ? ((0x06 << 11) | ((uint16_t)((v)*(1<< 6)/(1000000 << 12)) & 0x7ff)) : \
+  (((v)*(1<< 5)/(1000000 << 12)) < 1024) && (((v)*(1<< 5)/(1000000 << 12)) > -1025) ? ((0x07 << 11) | ((uint16_t)((v)*(1<< 5)/(1000000 << 12)) & 0x7ff)) : \
+  (((v)*(1<< 4)/(1000000 << 12)) < 1024) && (((v)*(1<< 4)/(1000000 << 12)) > -1025) ? ((0x08 << 11) | ((uint16_t)((v)*(1<< 4)/(1000000 << 12)) & 0x7ff)) : \
+  (((v)*(1<< 3)/(1000000 << 12)) < 1024) && (((v)*(1<< 3)/(1000000 << 12)) > -1025) ? ((0x09 << 11) | ((uint16_t)((v)*(1<< 3)/(1000000 << 12)) & 0x7ff)) : \
+  (((v)*(1<< 2)/(1000000 << 12)) < 1024) && (((v)*(1<< 2)/(1000000 << 12)) > -1025) ? ((0x0a << 11) | ((uint16_t)((v)*(1<< 2)/(1000000 << 12)) & 0x7ff)) : \
+  (((v)*(1<< 1)/(1000000 << 12)) < 1024) && (((v)*(1<< 1)/(1000000 << 12)) > -1025) ? ((0x0b << 11) | ((uint16_t)((v)*(1<< 1)/(1000000 << 12)) & 0x7ff)) : \
+  (((v)*(1<< 0)/(1000000 << 12)) < 1024) && (((v)*(1<< 0)/(1000000 << 12)) > -1025) ? ((0x0c << 11) | ((uint16_t)((v)*(1<< 0)/(1000000 << 12)) & 0x7ff)) : \
+  (((v)/(1<< 1)/(1000000 << 12)) < 1024) && (((v)/(1<< 1)/(1000000 << 12)) > -1025) ? ((0x0d << 11) | ((uint16_t)((v)/(1<< 1)/(1000000 << 12)) & 0x7ff)) : \
+  (((v)/(1<< 2)/(1000000 << 12)) < 1024) && (((v)/(1<< 2)/(1000000 << 12)) > -1025) ? ((0x0e << 11) | ((uint16_t)((v)/(1<< 2)/(1000000 << 12)) & 0x7ff)) : \
+                                                                                  ((0x0f << 11) | ((uint16_t)((v)/(1<< 3)/(1000000 << 12)) & 0x7ff)))
 
 // L11 encoding to units scaled by 10^6 (i.e. microvolts, microamps, microseconds, etc)
 #define L11_TO_UV(l) \
-  (l & 0x400) ? \
-    (l & 0x8000) ? \
-      (-1000000*((~l & 0x3ff) + 1) >> ((~(l >> 11) & 0xf) + 1)) \
+  ((l) & 0x400) ? \
+    ((l) & 0x8000) ? \
+      (-1000000*((~(l) & 0x3ff) + 1) >> ((~((l) >> 11) & 0xf) + 1)) \
     : \
-      (-1000000*((~l & 0x3ff) + 1) << ((l >> 11) & 0xf)) \
+      (-1000000*((~(l) & 0x3ff) + 1) << (((l) >> 11) & 0xf)) \
   : \
-    (l & 0x8000) ? \
-      (1000000*(l & 0x3ff) >> (~(l >> 11) & 0xf) + 1) \
+    ((l) & 0x8000) ? \
+      (1000000*((l) & 0x3ff) >> (~((l) >> 11) & 0xf) + 1) \
     : \
-      (1000000*(l & 0x3ff) << ((l >> 11) & 0xf))
+      (1000000*((l) & 0x3ff) << (((l) >> 11) & 0xf))
 
 // =========================== Runtime Conversion =============================
 /* These runtime functions should be used in the program body instead of the macros.
@@ -231,6 +231,8 @@
  * below is really just a 4D matrix of 2 encodings (L11/L16), 2 directions (to/from)
  * 3 types (int/float/double), and 3 unit scales (V/mV/uV), yielding 2*2*3*3 = 36
  * functions.
+ * The int variants use integer arithmetic only.  Decoders round toward
+ * -infinity and saturate at INT_MIN/INT_MAX; L16 encoders clip to [0, 0xffff].
  */
 
 // To L11 encoding
@@ -277,6 +279,22 @@ int l16_to_uv_int(uint16_t l);
 float l16_to_uv_float(uint16_t l);
 double l16_to_uv_double(uint16_t l);
 
+// ============================== Fixed Point =================================
+/* Value*2^16 as a signed 64-bit integer.  Exact for every L11 and L16 code,
+ * so encoded values can be compared (e.g. against limits) without decoding
+ * to float or losing resolution.
+ */
+int64_t l11_to_q16(uint16_t l);
+int64_t l16_to_q16(uint16_t l);
+
+// ======================== Packet Error Checking (PEC) =======================
+/* PEC is a CRC-8 (poly x^8 + x^2 + x + 1, init 0) over every byte of the
+ * transaction including the address bytes, e.g. for READ_WORD:
+ *   | addr + wr | command code | addr + rd | data low | data high | PEC |
+ * Pass crc = 0 to start a new PEC or a previous result to continue one.
+ */
+uint8_t pmbus_pec(uint8_t crc, const uint8_t *data, int len);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,85 @@
+/*
+ * File: pmlog.h
+ * Desc: Power-loss event log in a dedicated flash sector (separate from the
+ *       EEPROM emulation).  When PWRGD drops, the LTM4673 MFR_FAULT_LOG and
+ *       the latest power supply telemetry are appended as one fixed-size
+ *       record.  Appending only programs an already-erased slot, so it takes
+ *       bounded time; the sector is only erased on request ('z 0').  When
+ *       the log is full, new events are dropped until it is cleared.
+ *
+ *       Each record's first word (seq) is programmed with the body and its
+ *       last word (commit) after it, so a record torn by a brown-out is
+ *       recognized and skipped.
+ */
+
+#ifndef __PMLOG_H
+#define __PMLOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "i2c_pm.h"
+
+#define PMLOG_RECORD_SIZE                         (320)
+#define PMLOG_COMMIT                       (0x504d4c47)  // "PMLG"
+#define PMLOG_FREE                         (0xffffffff)
+// PMBus block read: byte count + up to 255 bytes
+#define PMLOG_FAULT_LOG_MAX                       (256)
+#define PMLOG_HEADER_SIZE   (12 + 2*PM_NUM_TELEM_ENUM)
+
+typedef struct {
+  uint32_t seq;                         // Programmed first; PMLOG_FREE = empty slot
+  uint32_t tick;                        // marble_get_tick() at capture (ms since boot)
+  uint16_t telem[PM_NUM_TELEM_ENUM];    // PM_GetTelem() snapshot
+  uint16_t fault_log_len;               // Valid bytes in fault_log (0 = read failed)
+  uint16_t reserved;
+  uint8_t fault_log[PMLOG_FAULT_LOG_MAX];   // MFR_FAULT_LOG block, count byte first
+  uint8_t pad[PMLOG_RECORD_SIZE - PMLOG_HEADER_SIZE - PMLOG_FAULT_LOG_MAX - 4];
+  uint32_t commit;                      // PMLOG_COMMIT, programmed last
+} pmlog_record_t;
+
+/* int pmlog_init(void);
+ *  Scan the log region for the next free slot.  Call once after the
+ *  EEPROM emulation is up.  Returns the number of valid records.
+ */
+int pmlog_init(void);
+
+/* int pmlog_capture(void);
+ *  Append a record for a power-loss event.  Call on the PWRGD falling edge.
+ *  Returns 0 on success, -1 if the log is full or programming failed.
+ */
+int pmlog_capture(void);
+
+/* const pmlog_record_t *pmlog_get(unsigned int n);
+ *  Return the n-th most recent valid record (0 = newest) or NULL.
+ *  The pointer refers directly to flash.
+ */
+const pmlog_record_t *pmlog_get(unsigned int n);
+
+int pmlog_count(void);
+int pmlog_free_slots(void);
+
+/* int pmlog_erase(void);
+ *  Erase the log sector (slow; never called from the power-loss path).
+ */
+int pmlog_erase(void);
+
+/* void pmlog_print(unsigned int n);
+ *  Print a summary of the log, plus the n most recent records in full.
+ */
+void pmlog_print(unsigned int n);
+
+// Mailbox access: the FPGA selects a record (0 = newest), then reads it back
+void pmlog_mbox_select(uint8_t n);
+uint8_t pmlog_mbox_selected(void);
+uint32_t pmlog_mbox_seq(void);
+uint32_t pmlog_mbox_tick(void);
+uint16_t pmlog_mbox_telem(PM_telem_enum_t elem);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __PMLOG_H
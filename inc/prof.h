@@ -0,0 +1,64 @@
+/*
+ * File: prof.h
+ * Desc: Main-loop and ISR execution-time profiler based on the Cortex-M DWT
+ *       cycle counter (marble_get_cycles(); nanoseconds in simulation).
+ *       Each task keeps min/avg/max and a log2 histogram of its run time:
+ *       bin n counts runs of [2^(n-1), 2^n) cycles (bin 0: zero cycles),
+ *       and the last bin also holds anything longer.
+ *
+ *       Each task is only recorded from one context (main loop or its own
+ *       ISR), so entries are updated without locking; a dump taken while
+ *       an ISR runs may show that ISR's entry mid-update.
+ */
+
+#ifndef __PROF_H
+#define __PROF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define PROF_HIST_BINS                              (24)
+
+typedef enum {
+  PROF_MAIN_LOOP = 0,   // One main() loop iteration, excluding event_wait()
+  PROF_SYSTEM_SERVICE,
+  PROF_BOARD_SERVICE,
+  PROF_MBOX_UPDATE,
+  PROF_CONSOLE_SERVICE,
+  PROF_PMOD_SERVICE,
+  PROF_EEPROM_UPDATE,
+  PROF_ISR_USART_RX,    // USART_RXNE_ISR()
+  PROF_ISR_SYSTICK,     // SysTick_Handler()
+  PROF_ISR_TIM2,        // TIM2_IRQHandler() (Pmod LED timer, Marble only)
+  PROF_NUM_TASKS
+} prof_task_t;
+
+typedef struct {
+  uint32_t count;
+  uint32_t min;
+  uint32_t max;
+  uint64_t sum;
+  uint32_t hist[PROF_HIST_BINS];
+} prof_entry_t;
+
+/* void prof_end(prof_task_t task, uint32_t t0);
+ *  Record one run of 'task' which started at marble_get_cycles() = 't0'.
+ */
+void prof_end(prof_task_t task, uint32_t t0);
+
+const prof_entry_t *prof_get(prof_task_t task);
+void prof_reset(void);
+
+/* void prof_print(void);
+ *  Print min/avg/max (in us) and the histogram of every task that ran.
+ */
+void prof_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __PROF_H
@@ -0,0 +1,50 @@
+/*
+ * File: report.h
+ * Desc: Shared emitter for console reports.  In text mode reports print their
+ *       usual hand-formatted output; in the structured modes each report is
+ *       emitted as single-line records for host-side parsing:
+ *         REPORT_MODE_KV:   name key=val key="str" ...
+ *         REPORT_MODE_JSON: {"report":"name","key":val,"key":"str",...}
+ */
+
+#ifndef __REPORT_H
+#define __REPORT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+typedef enum {
+  REPORT_MODE_TEXT = 0,
+  REPORT_MODE_KV,
+  REPORT_MODE_JSON,
+  REPORT_MODE_SIZE
+} report_mode_t;
+
+void report_set_mode(report_mode_t mode);
+report_mode_t report_get_mode(void);
+const char *report_mode_string(report_mode_t mode);
+
+/* int report_structured(void);
+ *  Returns non-zero if reports should go through the record API below
+ *  rather than printing text.
+ */
+int report_structured(void);
+
+/* Emit one record: report_begin(), any number of fields, report_end() */
+void report_begin(const char *name);
+void report_int(const char *key, int val);
+void report_uint(const char *key, unsigned int val);
+void report_hex(const char *key, unsigned int val);
+void report_float(const char *key, float val);
+void report_str(const char *key, const char *val);
+void report_bytes(const char *key, const uint8_t *data, int len);
+void report_end(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __REPORT_H
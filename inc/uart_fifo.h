@@ -14,7 +14,7 @@ extern "C" {
 #include <stdint.h>
 
 // ============================== Exported Macros ==============================
-#define UART_QUEUE_ITEMS                            (100)
+#define UART_QUEUE_ITEMS                            (250)
 #define UART_QUEUE_OK                              (0x00)
 #define UART_QUEUE_FULL                            (0x01)
 #define UART_QUEUE_EMPTY                           (0x02)
@@ -0,0 +1,108 @@
+/*
+ * File: uart_frame.h
+ * Desc: Binary framed request/response protocol sharing the console UART.
+ *
+ *       A frame starts with FRAME_MAGIC, which is not a printable character,
+ *       so a frame is only recognized at the start of a line (console RX
+ *       queue empty).  Requests and responses share the same layout:
+ *
+ *         | MAGIC | SEQ | OP | STATUS | LEN | PAYLOAD[LEN] | CRC_H | CRC_L |
+ *
+ *       SEQ is chosen by the host and echoed in the response.  Responses set
+ *       FRAME_OP_RESPONSE in OP and report the result in STATUS (requests
+ *       send STATUS = 0).  CRC is CRC-16/CCITT-FALSE over SEQ..PAYLOAD.
+ *       See scripts/mmcframe.py for the host side.
+ */
+
+#ifndef __UART_FRAME_H
+#define __UART_FRAME_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define FRAME_MAGIC                               (0xa5)
+#define FRAME_HEADER_SIZE                            (5)
+#define FRAME_CRC_SIZE                               (2)
+#define FRAME_MAX_PAYLOAD                           (64)
+#define FRAME_MAX_SIZE  (FRAME_HEADER_SIZE + FRAME_MAX_PAYLOAD + FRAME_CRC_SIZE)
+// Partial frames are discarded if the rest doesn't arrive in time
+#define FRAME_RX_TIMEOUT_MS                        (200)
+// FRAME_OP_TELEM response: 2*(PM_NUM_TELEM_ENUM + 2)
+#define FRAME_TELEM_SIZE                            (24)
+
+#define FRAME_OP_RESPONSE                         (0x80)
+
+typedef enum {
+  FRAME_OP_PING = 0x00,           // Echo payload
+  FRAME_OP_PMBUS_XACT = 0x01,     // addr_wr cmd nread [wdata...] -> [rdata...]
+  FRAME_OP_MBOX_READ = 0x02,      // page -> data[16]
+  FRAME_OP_MBOX_WRITE = 0x03,     // page data[1-16]
+  FRAME_OP_EEPROM_READ = 0x04,    // tag -> data[size]
+  FRAME_OP_EEPROM_WRITE = 0x05,   // tag data[size]
+  FRAME_OP_TELEM = 0x06,          // -> PM telemetry (u16 LE) + LM75 temps (s16 LE)
+  FRAME_OP_PMLOG_READ = 0x07,     // n offset_hi offset_lo -> raw power-loss record bytes
+  FRAME_OP_CONSOLE = 0x08,        // console command text -> return code (int8) size (u16 BE) output
+  FRAME_OP_LTM4673_IMAGE = 0x09,  // FRAME_IMAGE_* [args] (see below)
+  FRAME_OP_CONSOLE_OUTPUT = 0x0a, // offset_hi offset_lo -> more output of the last FRAME_OP_CONSOLE
+} frame_op_t;
+
+// FRAME_OP_LTM4673_IMAGE sub-operations (first payload byte); see ltm4673.h
+//   FRAME_IMAGE_CLEAR                        ->
+//   FRAME_IMAGE_DATA offset_hi offset_lo data -> length_hi length_lo
+//   FRAME_IMAGE_PROGRAM flags                -> records changed failed (u16 BE) stored
+#define FRAME_IMAGE_CLEAR                         (0x00)
+#define FRAME_IMAGE_DATA                          (0x01)
+#define FRAME_IMAGE_PROGRAM                       (0x02)
+
+typedef enum {
+  FRAME_STATUS_OK = 0,
+  FRAME_STATUS_BAD_CRC,
+  FRAME_STATUS_BAD_OP,
+  FRAME_STATUS_BAD_LEN,
+  FRAME_STATUS_BAD_ARG,
+  FRAME_STATUS_DENIED,
+  FRAME_STATUS_FAIL,              // Operation attempted but failed
+} frame_status_t;
+
+/* int frame_rx_byte(uint8_t c);
+ *  Called from the UART RX path for every received byte before any line
+ *  processing.  Returns 1 if the byte was consumed as part of a frame.
+ *  Bytes received while a frame awaits frame_service() are dropped, as is
+ *  the rest of a frame whose LEN exceeds FRAME_MAX_PAYLOAD (answered with
+ *  FRAME_STATUS_BAD_LEN).
+ */
+int frame_rx_byte(uint8_t c);
+
+/* int frame_service(void);
+ *  Handle a completed frame (if any) from the main loop.
+ *  Returns 1 if a frame was handled, 0 otherwise.
+ */
+int frame_service(void);
+
+/* frame_status_t frame_dispatch(uint8_t op, const uint8_t *req, int len,
+ *                                uint8_t *rsp, int *rsp_len, int rsp_max);
+ *  Run operation 'op' with the 'len' byte payload 'req'.  The response
+ *  payload goes to 'rsp' (FRAME_MAX_PAYLOAD bytes) and its length to
+ *  'rsp_len'.  Also used by the mailbox RPC channel (mbox_rpc.h), whose
+ *  responses are limited to 'rsp_max' bytes.
+ */
+frame_status_t frame_dispatch(uint8_t op, const uint8_t *req, int len, uint8_t *rsp, int *rsp_len, int rsp_max);
+
+/* int frame_telem(uint8_t *rsp);
+ *  Snapshot of cached telemetry (FRAME_TELEM_SIZE bytes): the raw PMBus
+ *  words in PM_telem_enum_t order followed by the LM75_0 and LM75_1
+ *  temperatures, all little-endian.  Also recorded in the mailbox FIFO
+ *  (mbox_fifo.h).  Returns the number of bytes written to 'rsp'.
+ */
+int frame_telem(uint8_t *rsp);
+
+uint16_t frame_crc16(const uint8_t *data, int len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __UART_FRAME_H
@@ -32,6 +32,37 @@ def getFromLeep(ipAddr, port=803):
     dev.sock.close()
     return mbox
 
+def read_consistent(read, seq_addrs, retries=8):
+    """Seqlock reader.  'read' is a function returning the whole mailbox (e.g. getFromLeep);
+    'seq_addrs' is {npage: address of the page's sequence counter} for the "seqlock" pages
+    (see MailboxInterface.getSeqlockAddrs()).  The mailbox is read in address order and the
+    sequence page comes after the pages it covers, so a page from one read is consistent if
+    its counter is even and unchanged from the previous read.  Inconsistent pages are re-read
+    up to 'retries' times.
+    Returns (contents, torn) where 'torn' lists the pages that never read consistently."""
+    prev = read()
+    if prev is None:
+        return None, []
+    prev = list(prev)
+    contents = list(prev)
+    pending = list(seq_addrs.keys())
+    for n in range(retries):
+        if len(pending) == 0:
+            break
+        cur = read()
+        if cur is None:
+            break
+        cur = list(cur)
+        for npage in list(pending):
+            addr = seq_addrs[npage]
+            if (prev[addr] == cur[addr]) and ((cur[addr] & 1) == 0):
+                base = npage*mkmbox.PAGE_SIZE
+                contents[base:base+mkmbox.PAGE_SIZE] = cur[base:base+mkmbox.PAGE_SIZE]
+                contents[addr] = cur[addr]
+                pending.remove(npage)
+        prev = cur
+    return contents, sorted(pending)
+
 def get_MSB(l, offset, size):
     ll = [(x & 0xff) for x in l[offset:offset+size]]
     return int.from_bytes(bytes(ll))
@@ -132,6 +163,8 @@ def decodeMbox(argv):
     parser.add_argument('-d', '--def_file', default=None, help='File name for mailbox definition file to be loaded')
     parser.add_argument('-s', '--store_file', default=None, help='File name to store binary data read from mailbox')
     parser.add_argument('-r', '--raw', action='store_true', default=False, help='Print the raw contents of the mailbox memory.')
+    parser.add_argument('-c', '--consistent', action='store_true', default=False,
+                        help='Re-read the device until the "seqlock" pages are consistent (see mbox.def)')
     inputHelp = "Can be IP address to read device via LEEP or file name to read mailbox data from a binary file"
     parser.add_argument('-i', '--input', default=None, help=inputHelp)
     args = parser.parse_args()
@@ -148,6 +181,17 @@ def decodeMbox(argv):
         inFilename = args.input
     if fromFile:
         mboxContents = getFromFile(inFilename)
+    elif args.consistent:
+        defFile = args.def_file
+        if defFile is None:
+            defFile = defaultDefFile
+        mi = mkmbox.MailboxInterface(inFilename=defFile)
+        mi.interpret()
+        mboxContents, torn = read_consistent(lambda: getFromLeep(ipAddr, port), mi.getSeqlockAddrs())
+        if mboxContents is None:
+            return 1
+        for npage in torn:
+            print("Warning: page {} was being updated on every read".format(npage))
     else:
         mboxContents = getFromLeep(ipAddr, port)
         if mboxContents is None:
@@ -11,12 +11,22 @@
 import argparse
 import serial
 import os
+import re
 import time
 from concurrent.futures import ThreadPoolExecutor as Executor
 
 INTERCOMMAND_SLEEP = 0.01 # seconds
 POST_SLEEP = 1.0 # seconds
 
+# Pipelined (sequence-tagged) mode; see CONSOLE_SEQ_TAG in inc/console.h
+SEQ_TAG = '@'
+BATCH_SEPARATOR = ';'
+CONSOLE_MAX_LINE = 250  # CONSOLE_MAX_MESSAGE_LENGTH in inc/console.h
+RX_QUEUE_BYTES = 250    # UART_QUEUE_ITEMS in inc/uart_fifo.h
+PIPELINE_DEPTH = 8
+ACK_TIMEOUT = 10.0 # seconds
+_ack_re = re.compile(SEQ_TAG + r"(\d+) (OK|ERR (-?\d+))")
+
 # A global log of read lines
 _log = []
 _done = False
@@ -142,6 +152,89 @@ def serveCommands(sdev, *commands):
     print(f">   Wrote {nlines} lines")
     return
 
+def _nextLine(commands, start, seq, room, batch):
+    """Tag commands[start:] with sequence numbers starting at 'seq' and pack up
+    to 'room' of them into one console line.  Without 'batch', each line carries
+    a single command.  Returns (line, number_of_commands)."""
+    parts = []
+    n = start
+    while n < len(commands) and len(parts) < room:
+        tagged = "{}{} {}".format(SEQ_TAG, seq + len(parts), commands[n])
+        if len(parts) > 0:
+            if not batch:
+                break
+            if len(BATCH_SEPARATOR.join(parts + [tagged])) + 2 > CONSOLE_MAX_LINE:
+                break
+        parts.append(tagged)
+        n += 1
+    return BATCH_SEPARATOR.join(parts) + '\r\n', len(parts)
+
+def servePipelined(sdev, commands, depth=PIPELINE_DEPTH, batch=False, do_print=False):
+    """Send sequence-tagged commands, keeping up to 'depth' commands (and no more
+    than RX_QUEUE_BYTES bytes) unacknowledged.  Each tagged command is answered
+    by the firmware with exactly one '@seq OK' or '@seq ERR code' line.
+    With 'batch', several commands are packed into each line.
+    Returns a list of (command, code) in command order; code is 0 on success and
+    None if no acknowledgement arrived."""
+    commands = [c.strip() for c in commands if len(c.strip()) > 0 and not c.strip().startswith('#')]
+    codes = [None]*len(commands)
+    pending = {}    # seq -> number of line bytes released when acknowledged
+    inflight = 0    # bytes possibly still sitting in the MMC's RX queue
+    nsent = 0
+    last = time.time()
+    while nsent < len(commands) or len(pending) > 0:
+        room = depth - len(pending)
+        if nsent < len(commands) and room > 0:
+            line, count = _nextLine(commands, nsent, nsent, room, batch)
+            if len(pending) == 0 or inflight + len(line) <= RX_QUEUE_BYTES:
+                if not sdev.writeline(line):
+                    break
+                for n in range(count):
+                    # The whole line is released once its last command is acknowledged
+                    pending[nsent + n] = len(line) if n == count-1 else 0
+                inflight += len(line)
+                nsent += count
+                continue
+        line = sdev.readline()
+        # readline returns None on device open fail
+        # Returns empty string on timeout
+        if line is None:
+            break
+        if len(line) == 0:
+            if time.time() - last > ACK_TIMEOUT:
+                print(">   Timeout waiting on acknowledgement")
+                break
+            continue
+        acks = _ack_re.findall(line)
+        if len(acks) == 0:
+            if do_print:
+                print(line.strip())
+            continue
+        last = time.time()
+        for seq, status, code in acks:
+            seq = int(seq)
+            if seq in pending:
+                inflight -= pending.pop(seq)
+                codes[seq] = 0 if status == "OK" else int(code)
+                if do_print:
+                    print("{}: {}".format(commands[seq], status))
+    nfail = len([code for code in codes if code != 0])
+    print(f">   Sent {nsent} commands; {nfail} failed")
+    return list(zip(commands, codes))
+
+def loadPipelined(dev, baud=115200, commands=None, depth=PIPELINE_DEPTH, batch=False, do_print=False):
+    if commands is None:
+        print("Missing mandatory commands")
+        return 1
+    sdev = StreamSerial(dev, baud)
+    if sdev.failed():
+        return 1
+    results = servePipelined(sdev, commands, depth, batch, do_print)
+    sdev.close()
+    if len([code for cmd, code in results if code != 0]) > 0:
+        return 1
+    return 0
+
 def testReadLines(argv):
     USAGE = "python3 {} scriptname".format(argv[0])
     if len(argv) < 2:
@@ -200,12 +293,21 @@ def doLoad(argv):
     # Unused 'argv' since argparse is handling everything
     parser = ArgParser()
     parser.add_argument('-f', '--filename', default=None, help='File name for command script to be loaded')
+    parser.add_argument('-p', '--pipeline', default=0, type=int,
+                        help='Use sequence-tagged commands with up to N unacknowledged at once')
+    parser.add_argument('--batch', default=False, action='store_true',
+                        help="With --pipeline, pack several ';'-separated commands per line")
     # Any ordered args will be assumed to be commands to pass to device
     parser.add_argument("commands", nargs=argparse.REMAINDER, help="Strings to be sent directly to device")
     args = parser.parse_args()
     if args.filename is None and len(args.commands) == 0:
         print("Missing mandatory filename or ordered args")
         return 1
+    if args.pipeline > 0:
+        commands = args.commands
+        if args.filename is not None:
+            commands = getLines(args.filename)
+        return loadPipelined(args.dev, args.baud, commands, args.pipeline, args.batch, do_print=True)
     if args.filename is not None:
         loadFile(args.dev, args.baud, args.filename)
     elif len(args.commands) > 0:
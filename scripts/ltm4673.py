@@ -3,6 +3,7 @@
 # LTM4673 PMBus protocol definitions
 
 import re
+import time
 
 # SMBus
 # Legend:
@@ -61,155 +62,16 @@ addr_base   = 0xb8  # 8-bit (0x5c 7-bit)(note this can be changed via MFR_I2C_BA
 pin_offset  = 4
 addr_dev    = addr_base + 2*pin_offset
 
-# nbytes = 0: send_byte command
-# nbytes = 1: write_byte/read_byte command
-# nbytes = 2: write_word/read_word command
-# nbytes = 3: write_block/read_block command
-MODE_SEND   = 0
-MODE_BYTE   = 1
-MODE_WORD   = 2
-MODE_BLOCK  = 3
-
 RD = 1
 WR = 0
 
-ENCODING_RAW = 0
-ENCODING_L11 = 1
-ENCODING_L16 = 2
-
 _L16_EXPONENT=13
 
-commands = {
-    # name : (addr, nbytes)
-    "PAGE":                          (0x00, MODE_BYTE, ENCODING_RAW),
-    "OPERATION":                     (0x01, MODE_BYTE, ENCODING_RAW),
-    "ON_OFF_CONFIG":                 (0x02, MODE_BYTE, ENCODING_RAW),
-    "CLEAR_FAULTS":                  (0x03, MODE_SEND, ENCODING_RAW),
-    "WRITE_PROTECT":                 (0x10, MODE_BYTE, ENCODING_RAW),
-    "STORE_USER_ALL":                (0x15, MODE_SEND, ENCODING_RAW),
-    "RESTORE_USER_ALL":              (0x16, MODE_SEND, ENCODING_RAW),
-    "CAPABILITY":                    (0x19, MODE_BYTE, ENCODING_RAW),
-    "VOUT_MODE":                     (0x20, MODE_BYTE, ENCODING_RAW),
-    "VOUT_COMMAND":                  (0x21, MODE_WORD, ENCODING_L16),
-    "VOUT_MAX":                      (0x24, MODE_WORD, ENCODING_L16),
-    "VOUT_MARGIN_HIGH":              (0x25, MODE_WORD, ENCODING_L16),
-    "VOUT_MARGIN_LOW":               (0x26, MODE_WORD, ENCODING_L16),
-    "VIN_ON":                        (0x35, MODE_WORD, ENCODING_L11),
-    "VIN_OFF":                       (0x36, MODE_WORD, ENCODING_L11),
-    "IOUT_CAL_GAIN":                 (0x38, MODE_WORD, ENCODING_L11),
-    "VOUT_OV_FAULT_LIMIT":           (0x40, MODE_WORD, ENCODING_L16),
-    "VOUT_OV_FAULT_RESPONSE":        (0x41, MODE_BYTE, ENCODING_RAW),
-    "VOUT_OV_WARN_LIMIT":            (0x42, MODE_WORD, ENCODING_L16),
-    "VOUT_UV_WARN_LIMIT":            (0x43, MODE_WORD, ENCODING_L16),
-    "VOUT_UV_FAULT_LIMIT":           (0x44, MODE_WORD, ENCODING_L16),
-    "VOUT_UV_FAULT_RESPONSE":        (0x45, MODE_BYTE, ENCODING_RAW),
-    "IOUT_OC_FAULT_LIMIT":           (0x46, MODE_WORD, ENCODING_L11),
-    "IOUT_OC_FAULT_RESPONSE":        (0x47, MODE_BYTE, ENCODING_RAW),
-    "IOUT_OC_WARN_LIMIT":            (0x4a, MODE_WORD, ENCODING_L11),
-    "IOUT_UC_FAULT_LIMIT":           (0x4b, MODE_WORD, ENCODING_L11),
-    "IOUT_UC_FAULT_RESPONSE":        (0x4c, MODE_BYTE, ENCODING_RAW),
-    "OT_FAULT_LIMIT":                (0x4f, MODE_WORD, ENCODING_L11),
-    "OT_FAULT_RESPONSE":             (0x50, MODE_BYTE, ENCODING_RAW),
-    "OT_WARN_LIMIT":                 (0x51, MODE_WORD, ENCODING_L11),
-    "UT_WARN_LIMIT":                 (0x52, MODE_WORD, ENCODING_L11),
-    "UT_FAULT_LIMIT":                (0x53, MODE_WORD, ENCODING_L11),
-    "UT_FAULT_RESPONSE":             (0x54, MODE_BYTE, ENCODING_RAW),
-    "VIN_OV_FAULT_LIMIT":            (0x55, MODE_WORD, ENCODING_L11),
-    "VIN_OV_FAULT_RESPONSE":         (0x56, MODE_BYTE, ENCODING_RAW),
-    "VIN_OV_WARN_LIMIT":             (0x57, MODE_WORD, ENCODING_L11),
-    "VIN_UV_WARN_LIMIT":             (0x58, MODE_WORD, ENCODING_L11),
-    "VIN_UV_FAULT_LIMIT":            (0x59, MODE_WORD, ENCODING_L11),
-    "VIN_UV_FAULT_RESPONSE":         (0x5a, MODE_BYTE, ENCODING_RAW),
-    "POWER_GOOD_ON":                 (0x5e, MODE_WORD, ENCODING_L16),
-    "POWER_GOOD_OFF":                (0x5f, MODE_WORD, ENCODING_L16),
-    "TON_DELAY":                     (0x60, MODE_WORD, ENCODING_L11),
-    "TON_RISE":                      (0x61, MODE_WORD, ENCODING_L11),
-    "TON_MAX_FAULT_LIMIT":           (0x62, MODE_WORD, ENCODING_L11),
-    "TON_MAX_FAULT_RESPONSE":        (0x63, MODE_BYTE, ENCODING_RAW),
-    "TOFF_DELAY":                    (0x64, MODE_WORD, ENCODING_L11),
-    "STATUS_BYTE":                   (0x78, MODE_BYTE, ENCODING_RAW),
-    "STATUS_WORD":                   (0x79, MODE_WORD, ENCODING_RAW),
-    "STATUS_VOUT":                   (0x7a, MODE_BYTE, ENCODING_RAW),
-    "STATUS_IOUT":                   (0x7b, MODE_BYTE, ENCODING_RAW),
-    "STATUS_INPUT":                  (0x7c, MODE_BYTE, ENCODING_RAW),
-    "STATUS_TEMPERATURE":            (0x7d, MODE_BYTE, ENCODING_RAW),
-    "STATUS_CML":                    (0x7e, MODE_BYTE, ENCODING_RAW),
-    "STATUS_MFR_SPECIFIC":           (0x80, MODE_BYTE, ENCODING_RAW),
-    "READ_VIN":                      (0x88, MODE_WORD, ENCODING_L11),
-    "READ_IIN":                      (0x89, MODE_WORD, ENCODING_L11),
-    "READ_VOUT":                     (0x8b, MODE_WORD, ENCODING_L16),
-    "READ_IOUT":                     (0x8c, MODE_WORD, ENCODING_L11),
-    "READ_TEMPERATURE_1":            (0x8d, MODE_WORD, ENCODING_L11),
-    "READ_TEMPERATURE_2":            (0x8e, MODE_WORD, ENCODING_L11),
-    "READ_POUT":                     (0x96, MODE_WORD, ENCODING_L11),
-    "READ_PIN":                      (0x97, MODE_WORD, ENCODING_L11),
-    "PMBUS_REVISION":                (0x98, MODE_BYTE, ENCODING_RAW),
-    "USER_DATA_00":                  (0xb0, MODE_WORD, ENCODING_RAW),
-    "USER_DATA_01":                  (0xb1, MODE_WORD, ENCODING_RAW),
-    "USER_DATA_02":                  (0xb2, MODE_WORD, ENCODING_RAW),
-    "USER_DATA_03":                  (0xb3, MODE_WORD, ENCODING_RAW),
-    "USER_DATA_04":                  (0xb4, MODE_WORD, ENCODING_RAW),
-    "MFR_LTC_RESERVED_1":            (0xb5, MODE_WORD, ENCODING_RAW),
-    "MFR_T_SELF_HEAT":               (0xb8, MODE_WORD, ENCODING_L11),
-    "MFR_IOUT_CAL_GAIN_TAU_INV":     (0xb9, MODE_WORD, ENCODING_L11),
-    "MFR_IOUT_CAL_GAIN_THETA":       (0xba, MODE_WORD, ENCODING_L11),
-    "MFR_READ_IOUT":                 (0xbb, MODE_WORD, ENCODING_RAW),
-    "MFR_LTC_RESERVED_2":            (0xbc, MODE_WORD, ENCODING_RAW),
-    "MFR_EE_UNLOCK":                 (0xbd, MODE_BYTE, ENCODING_RAW),
-    "MFR_EE_ERASE":                  (0xbe, MODE_BYTE, ENCODING_RAW),
-    "MFR_EE_DATA":                   (0xbf, MODE_WORD, ENCODING_RAW),
-    "MFR_EIN":                       (0xc0, MODE_BLOCK, ENCODING_RAW),
-    "MFR_EIN_CONFIG":                (0xc1, MODE_BYTE, ENCODING_RAW),
-    "MFR_SPECIAL_LOT":               (0xc2, MODE_BYTE, ENCODING_RAW),
-    "MFR_IIN_CAL_GAIN_TC":           (0xc3, MODE_WORD, ENCODING_RAW),
-    "MFR_IIN_PEAK":                  (0xc4, MODE_WORD, ENCODING_L11),
-    "MFR_IIN_MIN":                   (0xc5, MODE_WORD, ENCODING_L11),
-    "MFR_PIN_PEAK":                  (0xc6, MODE_WORD, ENCODING_L11),
-    "MFR_PIN_MIN":                   (0xc7, MODE_WORD, ENCODING_L11),
-    "MFR_COMMAND_PLUS":              (0xc8, MODE_WORD, ENCODING_RAW),
-    "MFR_DATA_PLUS0":                (0xc9, MODE_WORD, ENCODING_RAW),
-    "MFR_DATA_PLUS1":                (0xca, MODE_WORD, ENCODING_RAW),
-    "MFR_CONFIG_LTM4673":            (0xd0, MODE_WORD, ENCODING_RAW),
-    "MFR_CONFIG_ALL_LTM4673":        (0xd1, MODE_WORD, ENCODING_RAW),
-    "MFR_FAULTB0_PROPAGATE":         (0xd2, MODE_BYTE, ENCODING_RAW),
-    "MFR_FAULTB1_PROPAGATE":         (0xd3, MODE_BYTE, ENCODING_RAW),
-    "MFR_PWRGD_EN":                  (0xd4, MODE_WORD, ENCODING_RAW),
-    "MFR_FAULTB0_RESPONSE":          (0xd5, MODE_BYTE, ENCODING_RAW),
-    "MFR_FAULTB1_RESPONSE":          (0xd6, MODE_BYTE, ENCODING_RAW),
-    "MFR_IOUT_PEAK":                 (0xd7, MODE_WORD, ENCODING_L11),
-    "MFR_IOUT_MIN":                  (0xd8, MODE_WORD, ENCODING_L11),
-    "MFR_CONFIG2_LTM4673":           (0xd9, MODE_BYTE, ENCODING_RAW),
-    "MFR_CONFIG3_LTM4673":           (0xda, MODE_BYTE, ENCODING_RAW),
-    "MFR_RETRY_DELAY":               (0xdb, MODE_WORD, ENCODING_L11),
-    "MFR_RESTART_DELAY":             (0xdc, MODE_WORD, ENCODING_L11),
-    "MFR_VOUT_PEAK":                 (0xdd, MODE_WORD, ENCODING_L16),
-    "MFR_VIN_PEAK":                  (0xde, MODE_WORD, ENCODING_L11),
-    "MFR_TEMPERATURE_1_PEAK":        (0xdf, MODE_WORD, ENCODING_L11),
-    "MFR_DAC":                       (0xe0, MODE_WORD, ENCODING_RAW),
-    "MFR_POWERGOOD_ASSERTION_DELAY": (0xe1, MODE_WORD, ENCODING_L11),
-    "MFR_WATCHDOG_T_FIRST":          (0xe2, MODE_WORD, ENCODING_L11),
-    "MFR_WATCHDOG_T":                (0xe3, MODE_WORD, ENCODING_L11),
-    "MFR_PAGE_FF_MASK":              (0xe4, MODE_BYTE, ENCODING_RAW),
-    "MFR_PADS":                      (0xe5, MODE_WORD, ENCODING_RAW),
-    "MFR_I2C_BASE_ADDRESS":          (0xe6, MODE_BYTE, ENCODING_RAW),
-    "MFR_SPECIAL_ID":                (0xe7, MODE_WORD, ENCODING_RAW),
-    "MFR_IIN_CAL_GAIN":              (0xe8, MODE_WORD, ENCODING_L11),
-    "MFR_VOUT_DISCHARGE_THRESHOLD":  (0xe9, MODE_WORD, ENCODING_L11),
-    "MFR_FAULT_LOG_STORE":           (0xea, MODE_SEND, ENCODING_RAW),
-    "MFR_FAULT_LOG_RESTORE":         (0xeb, MODE_SEND, ENCODING_RAW),
-    "MFR_FAULT_LOG_CLEAR":           (0xec, MODE_SEND, ENCODING_RAW),
-    "MFR_FAULT_LOG_STATUS":          (0xed, MODE_BYTE, ENCODING_RAW),
-    "MFR_FAULT_LOG":                 (0xee, MODE_BLOCK, ENCODING_RAW),
-    "MFR_COMMON":                    (0xef, MODE_BYTE, ENCODING_RAW),
-    "MFR_IOUT_CAL_GAIN_TC":          (0xf6, MODE_WORD, ENCODING_RAW),
-    "MFR_RETRY_COUNT":               (0xf7, MODE_BYTE, ENCODING_RAW),
-    "MFR_TEMP_1_GAIN":               (0xf8, MODE_WORD, ENCODING_RAW),
-    "MFR_TEMP_1_OFFSET":             (0xf9, MODE_WORD, ENCODING_L11),
-    "MFR_IOUT_SENSE_VOLTAGE":        (0xfa, MODE_WORD, ENCODING_RAW),
-    "MFR_VOUT_MIN":                  (0xfb, MODE_WORD, ENCODING_L16),
-    "MFR_VIN_MIN":                   (0xfc, MODE_WORD, ENCODING_L11),
-    "MFR_TEMPERATURE_1_MIN":         (0xfd, MODE_WORD, ENCODING_L11),
-}
+# Command table, encodings and limits are generated from inc/ltm4673.def
+# (see mkltm4673.py); regenerate with 'make doc'
+from ltm4673_def import MODE_SEND, MODE_BYTE, MODE_WORD, MODE_BLOCK
+from ltm4673_def import ENCODING_RAW, ENCODING_L11, ENCODING_L16
+from ltm4673_def import commands, ltm4673_limits
 
 for name, arg in commands.items():
     globals()[name] = arg[0]
@@ -362,34 +224,6 @@ def _int(x):
     return int(x, 16)
 
 
-def print_commands_c():
-    for name, arg in commands.items():
-        cmd = arg[0]
-        print(f"#define LTM4673_{name:32s} (0x{cmd:02x})")
-    encodings = [None]*0x100
-    for name, arg in commands.items():
-        cmd = arg[0]
-        enc = arg[2]
-        if enc == ENCODING_RAW:
-            s = "LTM4673_ENCODING_RAW"
-        elif enc == ENCODING_L11:
-            s = "LTM4673_ENCODING_L11"
-        elif enc == ENCODING_L16:
-            s = "LTM4673_ENCODING_L16"
-        else:
-            s = "UNKNOWN_ENCODING"
-        encodings[cmd] = f"  {s}, // LTM4673_{name}"
-    print("uint8_t encodings[256] = {")
-    for n in range(len(encodings)):
-        enc = encodings[n]
-        if enc is None:
-            print(f"  LTM4673_UNUSED, // 0x{n:02x}");
-        else:
-            print(enc)
-    print("};")
-    return
-
-
 def _tc(val, bits=5):
     """Interpret 'val' as two's complement integer of width 'bits'."""
     if val & (1<<(bits-1)):
@@ -443,10 +277,20 @@ def L16_TO_V(l):
 
 
 def calc_pec(*args):
-    # TODO We can allow hardware to calculate packet error checking byte
-    # or we can calculate it manually here.
-    # Use the polynomial x^8 + x^2 + x + 1 = 0b100000111 = 0x107
-    return 0
+    # CRC-8 with polynomial x^8 + x^2 + x + 1 = 0b100000111 = 0x107, init 0
+    # Must match pmbus_pec() in src/pmbus.c
+    crc = 0
+    for arg in args:
+        if not hasattr(arg, '__len__'):
+            arg = (arg,)
+        for byte in arg:
+            crc ^= byte & 0xff
+            for _ in range(8):
+                if crc & 0x80:
+                    crc = ((crc << 1) ^ 0x07) & 0xff
+                else:
+                    crc = (crc << 1) & 0xff
+    return crc
 
 
 def write_byte(cmd, val):
@@ -721,9 +565,11 @@ def translate_xact_mmc(xact):
     for msg in xact:
         if not first:
             line.append(MMC_REPEAT_START)
-        for mbyte in msg:
+        for n, mbyte in enumerate(msg):
             if mbyte is None:
-                line.append(MMC_READ_ONE)
+                # The byte count of a block read is implied by MMC_READ_BLOCK
+                if not (n+1 < len(msg) and hasattr(msg[n+1], '__len__')):
+                    line.append(MMC_READ_ONE)
             elif hasattr(mbyte, '__len__'):
                 line.append(MMC_READ_BLOCK)
             else:
@@ -740,6 +586,51 @@ def translate_mmc(xacts):
     return lines
 
 
+def translate_mmc_batch(xacts, max_xacts=None, max_line=None):
+    """Like translate_mmc() but packs several transactions per console line,
+    separated by MMC_XACT_SEPARATOR.  Each line is answered by one compact
+    response (see parse_batch_response())."""
+    if max_xacts is None:
+        max_xacts = MMC_BATCH_MAX_XACTS
+    if max_line is None:
+        max_line = MMC_MAX_LINE
+    lines = []
+    batch = []
+    for xact in xacts:
+        items = translate_xact_mmc(xact)[1:]
+        line = ' '.join([MMC_COMMAND_CHAR_PMBRIDGE] + batch + [MMC_XACT_SEPARATOR] + items)
+        if len(batch) > 0 and (batch.count(MMC_XACT_SEPARATOR) + 2 > max_xacts or len(line) >= max_line):
+            lines.append(' '.join([MMC_COMMAND_CHAR_PMBRIDGE] + batch))
+            batch = []
+        if len(batch) > 0:
+            batch.append(MMC_XACT_SEPARATOR)
+        batch += items
+    if len(batch) > 0:
+        lines.append(' '.join([MMC_COMMAND_CHAR_PMBRIDGE] + batch))
+    return lines
+
+
+def parse_batch_response(line):
+    """Parse the compact response to a batched PMBridge command:
+        "PMB r0 r1 ... OK" or "PMB r0 ... ERR index code"
+    Returns (results, error) where results is a list with None for each
+    write and a list of bytes for each read, and error is None on success or
+    (index, code) otherwise.  Returns None if 'line' is not a batch response."""
+    _match = re.match(r"PMB((?: [0-9a-fA-F-]+)*) (OK|ERR (\d+) (-?\d+))", line)
+    if not _match:
+        return None
+    results = []
+    for item in _match.group(1).split():
+        if item == '-':
+            results.append(None)
+        else:
+            results.append([int(item[n:n+2], 16) for n in range(0, len(item), 2)])
+    error = None
+    if _match.group(3) is not None:
+        error = (int(_match.group(3)), int(_match.group(4)))
+    return results, error
+
+
 def translate_xact_i2cbridge(xact):
     # TODO
     return []
@@ -756,12 +647,16 @@ def translate_i2cbridge(xacts):
 MMC_REPEAT_START    = '!'
 MMC_READ_ONE        = '?'
 MMC_READ_BLOCK      = '*'
+MMC_XACT_SEPARATOR  = ','
+MMC_BATCH_MAX_XACTS = 16    # PMBRIDGE_BATCH_MAX_XACTS in inc/i2c_pm.h
+MMC_MAX_LINE        = 250   # CONSOLE_MAX_MESSAGE_LENGTH in inc/console.h
 
 # MMC console syntax
 # Each line is a list of any of the following (whitespace-separated)
 #   ! : Repeated start
 #   ? : Read 1 byte from the target device
 #   * : Read 1 byte, then use that as N and read the next N bytes
+#   , : Separate transactions of a batch (one compact response per line)
 #   0xHH: Use hex value 0xHH as the next transaction byte
 #   DDD : Use decimal value DDD as the next transaction byte
 
@@ -992,25 +887,6 @@ _test_program = (
 )
 
 
-# Must be synchronized with const _ltm4673_limits_t ltm4673_limits[]; in ltm4673.c
-ltm4673_limits = {
-    # page: limit_dict
-    0 : {
-        # cmd: (mask, min, max)
-        VOUT_COMMAND: (0xffff, V_TO_L16(0.95), V_TO_L16(1.05)),  # 0.95V to 1.05V
-    },
-    1 : {
-        VOUT_COMMAND: (0xffff, V_TO_L16(1.75), V_TO_L16(1.85)),  # 1.75V to 1.85V
-    },
-    2 : {
-        VOUT_COMMAND: (0xffff, V_TO_L16(2.45), V_TO_L16(2.55)),  # 2.45V to 2.55V
-    },
-    3 : {
-        VOUT_COMMAND: (0xffff, V_TO_L16(3.25), V_TO_L16(3.35)),  # 3.25V to 3.35V
-    },
-}
-
-
 def translate_program(program, rnw=True):
     """Program derived from LTC PMBus Project Text File Version:1.1"""
     xacts = []
@@ -1252,11 +1128,19 @@ def attempt_limit_break(factor=0.1):
         xacts.append(write(PAGE, page))
         for cmd, arg in limit_dict.items():
             mask, _min, _max = arg[:3]
+            enc = get_encoding(cmd)
+            if enc == ENCODING_L11:
+                _min, _max, to_enc = L11_TO_V(_min), L11_TO_V(_max), V_TO_L11
+            elif enc == ENCODING_L16:
+                _min, _max, to_enc = L16_TO_V(_min), L16_TO_V(_max), V_TO_L16
+            else:
+                # Scaling a raw value (e.g. PAGE) is meaningless
+                continue
             if factor > 0:
                 val = _max*(1+factor)
             else:
                 val = _min*(1+factor)
-            xacts.append(write(cmd, val))
+            xacts.append(write(cmd, to_enc(val)))
             if mask < 0xffff:
                 # Try to write to masked-out bits
                 xacts.append(write(cmd, (~mask & 0xffff)))
@@ -1524,8 +1408,7 @@ def get_program_from_file(filename):
                     prog.append((_page, pagelist))
                     pagelist = []
                     _page = page
-                else:
-                    pagelist.append((reg, val))
+                pagelist.append((reg, val))
             else:
                 raise ParserSyntaxError("Syntax error on line {}: {}".format(nline, line) + \
                                         "Expected format: 0xHH,[-]D,(WB|WW|RB|RW),0xHH,0xHH,NAME")
@@ -1548,6 +1431,22 @@ def _count_ops(program):
     return ops
 
 
+def build_image(program):
+    """Compact image for the MMC's bulk programming (FRAME_OP_LTM4673_IMAGE).
+    One record per register (see inc/ltm4673.h):
+        | page | command_code | len | data[len] (LSB first) |"""
+    image = bytearray()
+    for page, prog in program:
+        for reg, val in prog:
+            params = get_cmd_params(reg)
+            if params is None or params[2] not in (MODE_BYTE, MODE_WORD):
+                raise ValueError("Cannot program register {} in bulk".format(reg))
+            nbytes = 1 if params[2] == MODE_BYTE else 2
+            image += bytes((page & 0xff, params[1], nbytes))
+            image += (val & ((1 << 8*nbytes) - 1)).to_bytes(nbytes, 'little')
+    return bytes(image)
+
+
 def get_limits_from_file(filename):
     print("TODO")
     # Return nested dict
@@ -1566,6 +1465,8 @@ def handle_write(args):
     else:
         print("Writing default program")
         program = _program
+    if args.bulk:
+        return _handle_write_bulk(args, program)
     lines = translate_program(program, rnw=False)
     if args.dev is not None:
         import load
@@ -1583,6 +1484,24 @@ def handle_write(args):
     return load_rval
 
 
+def _handle_write_bulk(args, program):
+    import mmcframe
+    image = build_image(program)
+    print("Image: {} bytes".format(len(image)))
+    mmc = mmcframe.open_serial(args.dev, args.baud)
+    t0 = time.time()
+    try:
+        res = mmc.ltm4673_program(image, store=args.store, dry_run=args.dry_run)
+    except mmcframe.FrameError as e:
+        print(e)
+        return 1
+    verb = "differ" if args.dry_run else "written"
+    print("{} registers, {} {}, {} failed{} in {:.1f}s".format(
+        res["records"], res["changed"], verb, res["failed"],
+        ", stored" if res["stored"] else "", time.time() - t0))
+    return 1 if res["failed"] else 0
+
+
 def handle_read(args):
     load_rval = 1
     if args.test:
@@ -1816,6 +1735,12 @@ def main(argv):
     write_group = parser_write.add_mutually_exclusive_group()
     write_group.add_argument("--test", default=False, action="store_true", help='Test; write just a few registers')
     write_group.add_argument("-f", "--file", help="File to use for program values to write")
+    parser_write.add_argument("--bulk", default=False, action="store_true",
+                              help="Send the program as one image; the MMC writes only registers that differ")
+    parser_write.add_argument("--store", default=False, action="store_true",
+                              help="With --bulk, STORE_USER_ALL if anything changed ('store' always stores)")
+    parser_write.add_argument("--dry-run", default=False, action="store_true",
+                              help="With --bulk, only count the registers that differ")
     parser_write.set_defaults(handler=handle_write)
 
     parser_read = subparsers.add_parser("read", help="Read current value of registers in program")
@@ -1869,7 +1794,6 @@ if __name__ == "__main__":
     import sys
     main(sys.argv)
     #testV_TO_L11(sys.argv)
-    #print_commands_c()
     #_init_sim_mem()
     #_init_sim_telem()
     #test_get_program_from_file(sys.argv)
@@ -0,0 +1,162 @@
+# Auto-generated by mkltm4673.py from ltm4673.def.  Do not edit.
+
+MODE_SEND   = 0
+MODE_BYTE   = 1
+MODE_WORD   = 2
+MODE_BLOCK  = 3
+
+ENCODING_RAW = 0
+ENCODING_L11 = 1
+ENCODING_L16 = 2
+
+commands = {
+    # name : (addr, mode, encoding)
+    "PAGE":                          (0x00, MODE_BYTE, ENCODING_RAW),
+    "OPERATION":                     (0x01, MODE_BYTE, ENCODING_RAW),
+    "ON_OFF_CONFIG":                 (0x02, MODE_BYTE, ENCODING_RAW),
+    "CLEAR_FAULTS":                  (0x03, MODE_SEND, ENCODING_RAW),
+    "WRITE_PROTECT":                 (0x10, MODE_BYTE, ENCODING_RAW),
+    "STORE_USER_ALL":                (0x15, MODE_SEND, ENCODING_RAW),
+    "RESTORE_USER_ALL":              (0x16, MODE_SEND, ENCODING_RAW),
+    "CAPABILITY":                    (0x19, MODE_BYTE, ENCODING_RAW),
+    "VOUT_MODE":                     (0x20, MODE_BYTE, ENCODING_RAW),
+    "VOUT_COMMAND":                  (0x21, MODE_WORD, ENCODING_L16),
+    "VOUT_MAX":                      (0x24, MODE_WORD, ENCODING_L16),
+    "VOUT_MARGIN_HIGH":              (0x25, MODE_WORD, ENCODING_L16),
+    "VOUT_MARGIN_LOW":               (0x26, MODE_WORD, ENCODING_L16),
+    "VIN_ON":                        (0x35, MODE_WORD, ENCODING_L11),
+    "VIN_OFF":                       (0x36, MODE_WORD, ENCODING_L11),
+    "IOUT_CAL_GAIN":                 (0x38, MODE_WORD, ENCODING_L11),
+    "VOUT_OV_FAULT_LIMIT":           (0x40, MODE_WORD, ENCODING_L16),
+    "VOUT_OV_FAULT_RESPONSE":        (0x41, MODE_BYTE, ENCODING_RAW),
+    "VOUT_OV_WARN_LIMIT":            (0x42, MODE_WORD, ENCODING_L16),
+    "VOUT_UV_WARN_LIMIT":            (0x43, MODE_WORD, ENCODING_L16),
+    "VOUT_UV_FAULT_LIMIT":           (0x44, MODE_WORD, ENCODING_L16),
+    "VOUT_UV_FAULT_RESPONSE":        (0x45, MODE_BYTE, ENCODING_RAW),
+    "IOUT_OC_FAULT_LIMIT":           (0x46, MODE_WORD, ENCODING_L11),
+    "IOUT_OC_FAULT_RESPONSE":        (0x47, MODE_BYTE, ENCODING_RAW),
+    "IOUT_OC_WARN_LIMIT":            (0x4a, MODE_WORD, ENCODING_L11),
+    "IOUT_UC_FAULT_LIMIT":           (0x4b, MODE_WORD, ENCODING_L11),
+    "IOUT_UC_FAULT_RESPONSE":        (0x4c, MODE_BYTE, ENCODING_RAW),
+    "OT_FAULT_LIMIT":                (0x4f, MODE_WORD, ENCODING_L11),
+    "OT_FAULT_RESPONSE":             (0x50, MODE_BYTE, ENCODING_RAW),
+    "OT_WARN_LIMIT":                 (0x51, MODE_WORD, ENCODING_L11),
+    "UT_WARN_LIMIT":                 (0x52, MODE_WORD, ENCODING_L11),
+    "UT_FAULT_LIMIT":                (0x53, MODE_WORD, ENCODING_L11),
+    "UT_FAULT_RESPONSE":             (0x54, MODE_BYTE, ENCODING_RAW),
+    "VIN_OV_FAULT_LIMIT":            (0x55, MODE_WORD, ENCODING_L11),
+    "VIN_OV_FAULT_RESPONSE":         (0x56, MODE_BYTE, ENCODING_RAW),
+    "VIN_OV_WARN_LIMIT":             (0x57, MODE_WORD, ENCODING_L11),
+    "VIN_UV_WARN_LIMIT":             (0x58, MODE_WORD, ENCODING_L11),
+    "VIN_UV_FAULT_LIMIT":            (0x59, MODE_WORD, ENCODING_L11),
+    "VIN_UV_FAULT_RESPONSE":         (0x5a, MODE_BYTE, ENCODING_RAW),
+    "POWER_GOOD_ON":                 (0x5e, MODE_WORD, ENCODING_L16),
+    "POWER_GOOD_OFF":                (0x5f, MODE_WORD, ENCODING_L16),
+    "TON_DELAY":                     (0x60, MODE_WORD, ENCODING_L11),
+    "TON_RISE":                      (0x61, MODE_WORD, ENCODING_L11),
+    "TON_MAX_FAULT_LIMIT":           (0x62, MODE_WORD, ENCODING_L11),
+    "TON_MAX_FAULT_RESPONSE":        (0x63, MODE_BYTE, ENCODING_RAW),
+    "TOFF_DELAY":                    (0x64, MODE_WORD, ENCODING_L11),
+    "STATUS_BYTE":                   (0x78, MODE_BYTE, ENCODING_RAW),
+    "STATUS_WORD":                   (0x79, MODE_WORD, ENCODING_RAW),
+    "STATUS_VOUT":                   (0x7a, MODE_BYTE, ENCODING_RAW),
+    "STATUS_IOUT":                   (0x7b, MODE_BYTE, ENCODING_RAW),
+    "STATUS_INPUT":                  (0x7c, MODE_BYTE, ENCODING_RAW),
+    "STATUS_TEMPERATURE":            (0x7d, MODE_BYTE, ENCODING_RAW),
+    "STATUS_CML":                    (0x7e, MODE_BYTE, ENCODING_RAW),
+    "STATUS_MFR_SPECIFIC":           (0x80, MODE_BYTE, ENCODING_RAW),
+    "READ_VIN":                      (0x88, MODE_WORD, ENCODING_L11),
+    "READ_IIN":                      (0x89, MODE_WORD, ENCODING_L11),
+    "READ_VOUT":                     (0x8b, MODE_WORD, ENCODING_L16),
+    "READ_IOUT":                     (0x8c, MODE_WORD, ENCODING_L11),
+    "READ_TEMPERATURE_1":            (0x8d, MODE_WORD, ENCODING_L11),
+    "READ_TEMPERATURE_2":            (0x8e, MODE_WORD, ENCODING_L11),
+    "READ_POUT":                     (0x96, MODE_WORD, ENCODING_L11),
+    "READ_PIN":                      (0x97, MODE_WORD, ENCODING_L11),
+    "PMBUS_REVISION":                (0x98, MODE_BYTE, ENCODING_RAW),
+    "USER_DATA_00":                  (0xb0, MODE_WORD, ENCODING_RAW),
+    "USER_DATA_01":                  (0xb1, MODE_WORD, ENCODING_RAW),
+    "USER_DATA_02":                  (0xb2, MODE_WORD, ENCODING_RAW),
+    "USER_DATA_03":                  (0xb3, MODE_WORD, ENCODING_RAW),
+    "USER_DATA_04":                  (0xb4, MODE_WORD, ENCODING_RAW),
+    "MFR_LTC_RESERVED_1":            (0xb5, MODE_WORD, ENCODING_RAW),
+    "MFR_T_SELF_HEAT":               (0xb8, MODE_WORD, ENCODING_L11),
+    "MFR_IOUT_CAL_GAIN_TAU_INV":     (0xb9, MODE_WORD, ENCODING_L11),
+    "MFR_IOUT_CAL_GAIN_THETA":       (0xba, MODE_WORD, ENCODING_L11),
+    "MFR_READ_IOUT":                 (0xbb, MODE_WORD, ENCODING_RAW),
+    "MFR_LTC_RESERVED_2":            (0xbc, MODE_WORD, ENCODING_RAW),
+    "MFR_EE_UNLOCK":                 (0xbd, MODE_BYTE, ENCODING_RAW),
+    "MFR_EE_ERASE":                  (0xbe, MODE_BYTE, ENCODING_RAW),
+    "MFR_EE_DATA":                   (0xbf, MODE_WORD, ENCODING_RAW),
+    "MFR_EIN":                       (0xc0, MODE_BLOCK, ENCODING_RAW),
+    "MFR_EIN_CONFIG":                (0xc1, MODE_BYTE, ENCODING_RAW),
+    "MFR_SPECIAL_LOT":               (0xc2, MODE_BYTE, ENCODING_RAW),
+    "MFR_IIN_CAL_GAIN_TC":           (0xc3, MODE_WORD, ENCODING_RAW),
+    "MFR_IIN_PEAK":                  (0xc4, MODE_WORD, ENCODING_L11),
+    "MFR_IIN_MIN":                   (0xc5, MODE_WORD, ENCODING_L11),
+    "MFR_PIN_PEAK":                  (0xc6, MODE_WORD, ENCODING_L11),
+    "MFR_PIN_MIN":                   (0xc7, MODE_WORD, ENCODING_L11),
+    "MFR_COMMAND_PLUS":              (0xc8, MODE_WORD, ENCODING_RAW),
+    "MFR_DATA_PLUS0":                (0xc9, MODE_WORD, ENCODING_RAW),
+    "MFR_DATA_PLUS1":                (0xca, MODE_WORD, ENCODING_RAW),
+    "MFR_CONFIG_LTM4673":            (0xd0, MODE_WORD, ENCODING_RAW),
+    "MFR_CONFIG_ALL_LTM4673":        (0xd1, MODE_WORD, ENCODING_RAW),
+    "MFR_FAULTB0_PROPAGATE":         (0xd2, MODE_BYTE, ENCODING_RAW),
+    "MFR_FAULTB1_PROPAGATE":         (0xd3, MODE_BYTE, ENCODING_RAW),
+    "MFR_PWRGD_EN":                  (0xd4, MODE_WORD, ENCODING_RAW),
+    "MFR_FAULTB0_RESPONSE":          (0xd5, MODE_BYTE, ENCODING_RAW),
+    "MFR_FAULTB1_RESPONSE":          (0xd6, MODE_BYTE, ENCODING_RAW),
+    "MFR_IOUT_PEAK":                 (0xd7, MODE_WORD, ENCODING_L11),
+    "MFR_IOUT_MIN":                  (0xd8, MODE_WORD, ENCODING_L11),
+    "MFR_CONFIG2_LTM4673":           (0xd9, MODE_BYTE, ENCODING_RAW),
+    "MFR_CONFIG3_LTM4673":           (0xda, MODE_BYTE, ENCODING_RAW),
+    "MFR_RETRY_DELAY":               (0xdb, MODE_WORD, ENCODING_L11),
+    "MFR_RESTART_DELAY":             (0xdc, MODE_WORD, ENCODING_L11),
+    "MFR_VOUT_PEAK":                 (0xdd, MODE_WORD, ENCODING_L16),
+    "MFR_VIN_PEAK":                  (0xde, MODE_WORD, ENCODING_L11),
+    "MFR_TEMPERATURE_1_PEAK":        (0xdf, MODE_WORD, ENCODING_L11),
+    "MFR_DAC":                       (0xe0, MODE_WORD, ENCODING_RAW),
+    "MFR_POWERGOOD_ASSERTION_DELAY": (0xe1, MODE_WORD, ENCODING_L11),
+    "MFR_WATCHDOG_T_FIRST":          (0xe2, MODE_WORD, ENCODING_L11),
+    "MFR_WATCHDOG_T":                (0xe3, MODE_WORD, ENCODING_L11),
+    "MFR_PAGE_FF_MASK":              (0xe4, MODE_BYTE, ENCODING_RAW),
+    "MFR_PADS":                      (0xe5, MODE_WORD, ENCODING_RAW),
+    "MFR_I2C_BASE_ADDRESS":          (0xe6, MODE_BYTE, ENCODING_RAW),
+    "MFR_SPECIAL_ID":                (0xe7, MODE_WORD, ENCODING_RAW),
+    "MFR_IIN_CAL_GAIN":              (0xe8, MODE_WORD, ENCODING_L11),
+    "MFR_VOUT_DISCHARGE_THRESHOLD":  (0xe9, MODE_WORD, ENCODING_L11),
+    "MFR_FAULT_LOG_STORE":           (0xea, MODE_SEND, ENCODING_RAW),
+    "MFR_FAULT_LOG_RESTORE":         (0xeb, MODE_SEND, ENCODING_RAW),
+    "MFR_FAULT_LOG_CLEAR":           (0xec, MODE_SEND, ENCODING_RAW),
+    "MFR_FAULT_LOG_STATUS":          (0xed, MODE_BYTE, ENCODING_RAW),
+    "MFR_FAULT_LOG":                 (0xee, MODE_BLOCK, ENCODING_RAW),
+    "MFR_COMMON":                    (0xef, MODE_BYTE, ENCODING_RAW),
+    "MFR_IOUT_CAL_GAIN_TC":          (0xf6, MODE_WORD, ENCODING_RAW),
+    "MFR_RETRY_COUNT":               (0xf7, MODE_BYTE, ENCODING_RAW),
+    "MFR_TEMP_1_GAIN":               (0xf8, MODE_WORD, ENCODING_RAW),
+    "MFR_TEMP_1_OFFSET":             (0xf9, MODE_WORD, ENCODING_L11),
+    "MFR_IOUT_SENSE_VOLTAGE":        (0xfa, MODE_WORD, ENCODING_RAW),
+    "MFR_VOUT_MIN":                  (0xfb, MODE_WORD, ENCODING_L16),
+    "MFR_VIN_MIN":                   (0xfc, MODE_WORD, ENCODING_L11),
+    "MFR_TEMPERATURE_1_MIN":         (0xfd, MODE_WORD, ENCODING_L11),
+}
+
+ltm4673_limits = {
+    # page: {cmd: (mask, min, max)}
+    0x00: {
+        0x21: (0xffff, 0x1e66, 0x2199),  # VOUT_COMMAND
+    },
+    0x01: {
+        0x21: (0xffff, 0x3800, 0x3b33),  # VOUT_COMMAND
+    },
+    0x02: {
+        0x21: (0xffff, 0x4e66, 0x5199),  # VOUT_COMMAND
+    },
+    0x03: {
+        0x21: (0xffff, 0x6800, 0x6b33),  # VOUT_COMMAND
+    },
+    0xff: {
+        0x00: (0x00ff, 0x0000, 0x00ff),  # PAGE
+        0x55: (0xffff, 0xd320, 0xda00),  # VIN_OV_FAULT_LIMIT
+    },
+}
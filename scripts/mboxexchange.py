@@ -1,20 +1,40 @@
 #! /usr/bin/python3
 
-# Read from or write to a mailbox item via LBUS_ACCESS
+# Read from or write to a mailbox item via LBUS_ACCESS, run MMC operations over the
+# mailbox RPC channel (see inc/mbox_rpc.h) or drain the mailbox FIFO (see inc/mbox_fifo.h)
 
 import argparse
 import re
 import os
+import struct
+import time
 
 LBUS_ACCESS_FOUND = True
 SPI_MBOX_ADDR = 0x200000
 
 import mkmbox
+import mmcframe
 try:
     from lbus_access import lbus_access
 except ModuleNotFoundError:
     LBUS_ACCESS_FOUND = False
 
+# RPC channel layout; must agree with inc/mbox_rpc.h
+RPC_REQ_PAGE = 16
+RPC_RSP_PAGE = 18
+RPC_HEADER_SIZE = 3
+RPC_MAX_PAYLOAD = 2*mkmbox.PAGE_SIZE - RPC_HEADER_SIZE
+RPC_TIMEOUT = 2.0 # seconds
+
+# FIFO layout; must agree with inc/mbox_fifo.h
+FIFO_PAGE = 20
+FIFO_WIN_PAGE = 21
+FIFO_WIN_SIZE = 3*mkmbox.PAGE_SIZE
+FIFO_REC_TELEM = 0x01
+FIFO_REC_FAULT = 0x02
+FIFO_REC_PMLOG = 0x03
+FIFO_RETRIES = 8
+
 
 def getPageAndName(s):
     """
@@ -100,10 +120,220 @@ def mailboxReadWrite(ipAddr, address, value, size=1, verbose=False, port=803):
     return rets
 
 
-def doMailboxReadWrite(argv):
-    if not LBUS_ACCESS_FOUND:
-        print("Please append path to lbus_access module to PYTHONPATH")
+class MboxRPC(mmcframe.MMCFrame):
+    """Client for the mailbox RPC channel (see inc/mbox_rpc.h).  Offers the same operations as
+    mmcframe.MMCFrame (ping, telem, pmbus_read, eeprom_read, console, ...) but reaches the MMC
+    through the FPGA's mailbox, so only network access to the FPGA is needed.
+    'mi' is an interpreted mkmbox.MailboxInterface.  If 'doorbell' is True, the FPGA doorbell is
+    rung after each request so the MMC picks it up right away (otherwise within MBOX_FAST_PERIOD_MS)."""
+    def __init__(self, ipAddr, mi, port=803, doorbell=True, timeout=RPC_TIMEOUT):
+        super().__init__(lbus_access(ipAddr, port=port, allow_burst=False))
+        self._req = SPI_MBOX_ADDR + mi.getElementOffsetAddressAndSize(RPC_REQ_PAGE, "RPC_REQ_SEQ")[0]
+        self._rsp = SPI_MBOX_ADDR + mi.getElementOffsetAddressAndSize(RPC_RSP_PAGE, "RPC_RSP_SEQ")[0]
+        self._doorbell = None
+        if doorbell:
+            addr = mi.getDoorbellAddr()
+            if addr is not None:
+                self._doorbell = SPI_MBOX_ADDR + addr
+        self.timeout = timeout
+
+    def _read(self, addr, size):
+        return [int(x) & 0xff for x in self.dev.exchange(list(range(addr, addr+size)), [None]*size)]
+
+    def _write(self, addr, data):
+        self.dev.exchange(list(range(addr, addr+len(data))), list(data))
+        return
+
+    def request(self, op, payload=b''):
+        """Send one request and return the response payload; raises FrameError on failure."""
+        if len(payload) > RPC_MAX_PAYLOAD:
+            raise mmcframe.FrameError("Payload too long ({} > {})".format(len(payload), RPC_MAX_PAYLOAD))
+        seq = (self._read(self._rsp, 1)[0] + 1) & 0xff
+        # Arguments first, sequence number last
+        self._write(self._req + 1, [op & 0xff, len(payload)] + list(payload))
+        self._write(self._req, [seq])
+        if self._doorbell is not None:
+            self._write(self._doorbell, _splitBytes(1 << RPC_REQ_PAGE, 4))
+        t0 = time.time()
+        while self._read(self._rsp, 1)[0] != seq:
+            if time.time() - t0 > self.timeout:
+                raise mmcframe.FrameError("No response to request 0x{:02x}".format(op))
+            time.sleep(0.01)
+        status, size = self._read(self._rsp + 1, 2)
+        rpayload = bytes(self._read(self._rsp + RPC_HEADER_SIZE, size))
+        if status != mmcframe.STATUS_OK:
+            raise mmcframe.FrameError("Request 0x{:02x} failed: status {}".format(op, status), status, rpayload)
+        return rpayload
+
+
+class MboxFifo():
+    """Reader of the mailbox FIFO (see inc/mbox_fifo.h).  'read(addr, size)' returns a list of
+    'size' mailbox bytes and 'write(addr, data)' writes a list of bytes, where 'addr' is the
+    offset into the mailbox (see fifoFromLbus() and fifoFromLeep()).  'mi' is an interpreted
+    mkmbox.MailboxInterface."""
+    def __init__(self, read, write, mi):
+        self._rd = read
+        self._wr = write
+        self._tail = mi.getElementOffsetAddressAndSize(FIFO_PAGE, "FIFO_TAIL")[0]
+        self._win = mi.getElementOffsetAddressAndSize(FIFO_WIN_PAGE, "FIFO_DATA_A")[0]
+        self._expect = None
+        # Bytes skipped between reads, and FIFO_DROPPED (records lost to overflow since boot)
+        self.lost = 0
+        self.dropped = 0
+
+    def _header(self):
+        """Returns (head, win_start, win_len, dropped) read from the FIFO page."""
+        h = self._rd(self._tail, 9)
+        return ((h[2] << 8) | h[3], (h[4] << 8) | h[5], h[6], (h[7] << 8) | h[8])
+
+    def poll(self):
+        """Read and acknowledge the current window.  Returns a list of (type, payload) records,
+        empty if the FIFO is empty or the MMC has not yet replaced the last acknowledged window."""
+        for n in range(FIFO_RETRIES):
+            hdr = self._header()
+            data = self._rd(self._win, hdr[2])
+            # The MMC writes the window before the header, so an unchanged header means a
+            # consistent window
+            if self._header() == hdr:
+                break
+        else:
+            raise Exception("FIFO window kept changing")
+        head, start, size, self.dropped = hdr
+        if (size == 0) or ((start + size) & 0xffff == self._expect):
+            return []
+        if (self._expect is not None) and (start != self._expect):
+            # Gap (or MMC reset)
+            self.lost += (start - self._expect) & 0xffff
+        records = []
+        offset = 0
+        while offset + 2 <= size:
+            rtype, rlen = data[offset], data[offset+1]
+            records.append((rtype, bytes(data[offset+2:offset+2+rlen])))
+            offset += 2 + rlen
+        self._expect = (start + size) & 0xffff
+        self._wr(self._tail, _splitBytes(self._expect, 2))
+        return records
+
+    def drain(self, timeout=RPC_TIMEOUT):
+        """Read records until everything buffered when the last window was read is consumed.
+        The MMC republishes the window within MBOX_FAST_PERIOD_MS of an acknowledge; gives up
+        if it does not within 'timeout' seconds."""
+        records = []
+        t0 = time.time()
+        while time.time() - t0 < timeout:
+            new = self.poll()
+            if len(new) > 0:
+                records += new
+                t0 = time.time()
+                continue
+            head, start, size, dropped = self._header()
+            if (size == 0) or (head == self._expect):
+                break
+            time.sleep(0.02)
+        return records
+
+    @staticmethod
+    def decode(rtype, payload):
+        """Returns a dict describing record (rtype, payload)."""
+        nwords = len(mmcframe.TELEM_NAMES)
+        if rtype == FIFO_REC_TELEM:
+            vals = struct.unpack_from("<I{}H2h".format(nwords), payload)
+            d = {"type": "telem", "tick": vals[0]}
+            d.update(zip(mmcframe.TELEM_NAMES, vals[1:nwords+1]))
+            d["LM75_0"] = vals[nwords+1]
+            d["LM75_1"] = vals[nwords+2]
+            return d
+        if rtype == FIFO_REC_FAULT:
+            # ltm4673_fault_t in inc/ltm4673.h
+            vals = struct.unpack_from("<IBBBB4H4B4B4B4B", payload)
+            return {"type": "fault", "tick": vals[0], "ara_addr": vals[1], "status_input": vals[2],
+                    "status_cml": vals[3], "read_ok": vals[4], "status_word": vals[5:9],
+                    "status_vout": vals[9:13], "status_iout": vals[13:17],
+                    "status_temp": vals[17:21], "status_mfr": vals[21:25]}
+        if rtype == FIFO_REC_PMLOG:
+            # Header of pmlog_record_t in inc/pmlog.h
+            vals = struct.unpack_from("<II{}HH".format(nwords), payload)
+            d = {"type": "pmlog", "seq": vals[0], "tick": vals[1]}
+            d.update(zip(mmcframe.TELEM_NAMES, vals[2:nwords+2]))
+            d["fault_log_len"] = vals[nwords+2]
+            return d
+        return {"type": "0x{:02x}".format(rtype), "data": payload.hex()}
+
+
+def fifoFromLbus(ipAddr, mi, port=803):
+    """MboxFifo using the lbus_access low-level protocol"""
+    dev = lbus_access(ipAddr, port=port, allow_burst=False)
+
+    def read(addr, size):
+        if size == 0:
+            return []
+        return [int(x) & 0xff for x in dev.exchange(list(range(SPI_MBOX_ADDR+addr, SPI_MBOX_ADDR+addr+size)),
+                                                  [None]*size)]
+
+    def write(addr, data):
+        dev.exchange(list(range(SPI_MBOX_ADDR+addr, SPI_MBOX_ADDR+addr+len(data))), list(data))
+        return
+    return MboxFifo(read, write, mi)
+
+
+def fifoFromLeep(ipAddr, mi, port=803):
+    """MboxFifo using LEEP; the mailbox is located by name in the device's register map
+    (see decodembox.getFromLeep())"""
+    import leep
+    from decodembox import MBOX_REGNAMES
+    dev = leep.open("leep://{}:{}".format(ipAddr, port), timeout=5.0)
+    base = None
+    for regname in MBOX_REGNAMES:
+        if regname in dev.regmap.keys():
+            base = dev.regmap[regname]['base_addr']
+            break
+    if base is None:
+        raise Exception("Could not find mailbox in memory map.")
+
+    def read(addr, size):
+        if size == 0:
+            return []
+        return [int(x) & 0xff for x in dev.exchange(list(range(base+addr, base+addr+size)))]
+
+    def write(addr, data):
+        dev.exchange(list(range(base+addr, base+addr+len(data))), list(data))
+        return
+    return MboxFifo(read, write, mi)
+
+
+def doFifo(args, mi):
+    if args.leep:
+        fifo = fifoFromLeep(args.ipAddr, mi, port=int(args.port))
+    elif LBUS_ACCESS_FOUND:
+        fifo = fifoFromLbus(args.ipAddr, mi, port=int(args.port))
+    else:
+        print("Please append path to lbus_access module to PYTHONPATH (or use --leep)")
+        return 1
+    for rtype, payload in fifo.drain():
+        d = MboxFifo.decode(rtype, payload)
+        print(", ".join(["{} = {}".format(key, val) for key, val in d.items()]))
+    if fifo.lost > 0:
+        print("{} bytes skipped since the first read".format(fifo.lost))
+    print("{} records dropped by the MMC since boot".format(fifo.dropped))
+    return 0
+
+
+def doRPC(args, mi):
+    rpc = MboxRPC(args.ipAddr, mi, port=int(args.port))
+    try:
+        if args.console is not None:
+            print(rpc.console(args.console), end='')
+        if args.telem:
+            for key, val in rpc.telem().items():
+                print("{} = 0x{:04x}".format(key, val & 0xffff))
+    except mmcframe.FrameError as e:
+        print(getattr(e, 'output', ''), end='')
+        print(e)
         return 1
+    return 0
+
+
+def doMailboxReadWrite(argv):
     scriptPath = os.path.split(argv[0])[0]
     defaultDefFile = os.path.join(scriptPath, "../inc/mbox.def")
     parser = argparse.ArgumentParser(description="Mailbox write interface")
@@ -113,16 +343,38 @@ def doMailboxReadWrite(argv):
     parser.add_argument('-i', '--ipAddr', default=None, help='IP Address of marble board')
     parser.add_argument('--port', default=803, help='UDP port number')
     parser.add_argument('-x', '--hex', default=False, action="store_true",  help="Print output as hex")
-    parser.add_argument('name', default=None, help='Mailbox entry name (and optionally value for write)')
+    parser.add_argument('-c', '--console', default=None,
+                        help='Run a console command on the MMC via the mailbox RPC channel')
+    parser.add_argument('-t', '--telem', default=False, action="store_true",
+                        help='Read raw telemetry via the mailbox RPC channel')
+    parser.add_argument('-f', '--fifo', default=False, action="store_true",
+                        help='Drain and print the records in the mailbox FIFO')
+    parser.add_argument('--leep', default=False, action="store_true",
+                        help='Use LEEP rather than lbus_access (only with --fifo)')
+    parser.add_argument('name', nargs='?', default=None, help='Mailbox entry name (and optionally value for write)')
     args = parser.parse_args()
+    if args.ipAddr is None:
+        print("Please specify IP address with '-i'")
+        return 1
+    if args.fifo:
+        mi = mkmbox.MailboxInterface(inFilename=args.def_file)
+        mi.interpret()
+        return doFifo(args, mi)
+    if not LBUS_ACCESS_FOUND:
+        print("Please append path to lbus_access module to PYTHONPATH")
+        return 1
+    if (args.console is not None) or args.telem:
+        mi = mkmbox.MailboxInterface(inFilename=args.def_file)
+        mi.interpret()
+        return doRPC(args, mi)
+    if args.name is None:
+        print("Please specify a mailbox entry name")
+        return 1
     value = None
     if "=" in args.name:
         rname, value = args.name.split('=')
     else:
         rname = args.name
-    if args.ipAddr is None:
-        print("Please specify IP address with '-i'")
-        return 1
     nPage, name = getPageAndName(rname)
     if nPage is None and args.page is None:
         print("Please specify page number with '-p' or with fully-resolved mailbox enum constant.")
@@ -0,0 +1,254 @@
+#! /usr/bin/python3
+
+# Make the LTM4673 command encoding and limit tables (C header and Python module)
+# from the LTM4673 definition file (JSON with comments, see inc/ltm4673.def)
+
+import os
+import sys
+import argparse
+
+from mkmbox import JSONHack
+
+MODES = ("send", "byte", "word", "block")
+ENCODINGS = ("raw", "l11", "l16")
+PAGE_ALL = 0xff
+_L16_EXPONENT = 13
+
+
+def _int(x):
+    try:
+        return int(x)
+    except ValueError:
+        return int(x, 16)
+
+
+def V_TO_L11(val):
+    """Must match V_TO_L11() in ltm4673.py and inc/pmbus.h"""
+    n = -16
+    val = val*(2**16)
+    while (val > 1023) or (val < -1024):
+        val /= 2
+        n += 1
+    return ((int(n) & 0x1f) << 11) + (int(val) & 0x7ff)
+
+
+def V_TO_L16(val):
+    """Must match V_TO_L16() in ltm4673.py and inc/pmbus.h"""
+    return int(val*(1 << _L16_EXPONENT)) & 0xffff
+
+
+class LTM4673Def():
+    def __init__(self, filename):
+        self.filename = filename
+        self.channels = 0
+        # name: (cmd, mode, encoding)
+        self.commands = {}
+        # page: {cmd: (mask, min, max, min_src, max_src)}
+        self.limits = {}
+
+    def load(self):
+        jdict = JSONHack(self.filename).load()
+        if len(jdict) == 0:
+            raise Exception("Failed to load {}".format(self.filename))
+        self.channels = int(jdict.get("channels", 4))
+        codes = {}
+        for name, arg in jdict.get("commands", {}).items():
+            cmd = _int(arg[0])
+            if cmd in codes:
+                raise Exception("{}: command code 0x{:02x} used by {} and {}".format(
+                    self.filename, cmd, codes[cmd], name))
+            if arg[1] not in MODES:
+                raise Exception("{}: {} has invalid mode {}".format(self.filename, name, arg[1]))
+            if arg[2] not in ENCODINGS:
+                raise Exception("{}: {} has invalid encoding {}".format(self.filename, name, arg[2]))
+            codes[cmd] = name
+            self.commands[name] = (cmd, MODES.index(arg[1]), ENCODINGS.index(arg[2]))
+        for spage, ldict in jdict.get("limits", {}).items():
+            page = _int(spage)
+            if (page >= self.channels) and (page != PAGE_ALL):
+                raise Exception("{}: invalid page {}".format(self.filename, spage))
+            self.limits[page] = {}
+            for name, lim in ldict.items():
+                if name not in self.commands:
+                    raise Exception("{}: limit on unknown command {}".format(self.filename, name))
+                cmd, mode, enc = self.commands[name]
+                mask = _int(lim["mask"])
+                if mask == 0:
+                    # Write-protected
+                    self.limits[page][cmd] = (0, 0, 0, None, None)
+                    continue
+                _min = self._encode(enc, lim["min"])
+                _max = self._encode(enc, lim["max"])
+                self.limits[page][cmd] = (mask, _min, _max, lim["min"], lim["max"])
+        return
+
+    @staticmethod
+    def _encode(enc, val):
+        if isinstance(val, str):
+            return _int(val)
+        if enc == ENCODINGS.index("l11"):
+            return V_TO_L11(val)
+        if enc == ENCODINGS.index("l16"):
+            return V_TO_L16(val)
+        return int(val)
+
+    def _pageIndex(self, page):
+        return page if page < self.channels else self.channels
+
+    def _cmdName(self, cmd):
+        for name, arg in self.commands.items():
+            if arg[0] == cmd:
+                return name
+        return "0x{:02x}".format(cmd)
+
+    def _limitedCommands(self):
+        """Commands with a limit on any page, in order of command code"""
+        cmds = set()
+        for ldict in self.limits.values():
+            cmds.update(ldict.keys())
+        return sorted(cmds)
+
+    def makeHeader(self, filename):
+        base = os.path.basename(filename).replace('.', '_').upper()
+        npages = self.channels + 1
+        encnames = ("LTM4673_ENCODING_RAW", "LTM4673_ENCODING_L11", "LTM4673_ENCODING_L16")
+        out = []
+        out.append("/* Auto-generated by {} from {}.  Do not edit. */".format(
+            os.path.basename(sys.argv[0]), os.path.basename(self.filename)))
+        out.append("")
+        out.append("#ifndef __{}".format(base))
+        out.append("#define __{}".format(base))
+        out.append("")
+        out.append("#include <stdint.h>")
+        out.append("")
+        out.append("#define LTM4673_ENCODING_RAW  (0)")
+        out.append("#define LTM4673_ENCODING_L11  (1)")
+        out.append("#define LTM4673_ENCODING_L16  (2)")
+        out.append("#define LTM4673_UNUSED     (0xff)")
+        out.append("")
+        out.append("// Pages 0..{} plus one index for PAGE 0xff".format(self.channels - 1))
+        out.append("#define LTM4673_NCHANNELS                        ({})".format(self.channels))
+        out.append("#define LTM4673_NPAGES                           ({})".format(npages))
+        out.append("#define LTM4673_PAGE_INDEX(page) \\")
+        out.append("  ((page) >= LTM4673_NCHANNELS ? LTM4673_NCHANNELS : (page))")
+        out.append("")
+        out.append("typedef struct {")
+        out.append("  uint16_t mask;    // Writable bits; 0 vetoes the write")
+        out.append("  uint16_t min;     // Encoded limits")
+        out.append("  uint16_t max;")
+        out.append("  uint8_t active;   // 0 if the command is not limited on this page")
+        out.append("} ltm4673_limit_t;")
+        out.append("")
+        # Encodings
+        encodings = ["  LTM4673_UNUSED, // 0x{:02x}".format(n) for n in range(0x100)]
+        for name, arg in self.commands.items():
+            cmd, mode, enc = arg
+            encodings[cmd] = "  {}, // LTM4673_{}".format(encnames[enc], name)
+        out.append("static const uint8_t ltm4673_encodings[256] = {")
+        out.extend(encodings)
+        out.append("};")
+        out.append("")
+        # Limits: one row of LTM4673_NPAGES entries per limited command
+        cmds = self._limitedCommands()
+        slots = [0]*0x100
+        for n, cmd in enumerate(cmds):
+            slots[cmd] = n + 1
+        out.append("// Row of ltm4673_limit_table (plus 1) for each command; 0 = never limited")
+        out.append("static const uint8_t ltm4673_limit_slot[256] = {")
+        for row0 in range(0, 0x100, 16):
+            row = ' '.join(["{},".format(x) for x in slots[row0:row0+16]])
+            out.append("  {} // 0x{:02x}".format(row, row0))
+        out.append("};")
+        out.append("")
+        out.append("#define LTM4673_LIMIT_SLOTS                      ({})".format(len(cmds)))
+        out.append("static const ltm4673_limit_t ltm4673_limit_table[LTM4673_LIMIT_SLOTS][LTM4673_NPAGES] = {")
+        for cmd in cmds:
+            out.append("  { // LTM4673_" + self._cmdName(cmd))
+            row = [None]*npages
+            for page, ldict in self.limits.items():
+                if cmd in ldict:
+                    row[self._pageIndex(page)] = (page, ldict[cmd])
+            for entry in row:
+                if entry is None:
+                    out.append("    {0x0000, 0x0000, 0x0000, 0},")
+                    continue
+                page, (mask, _min, _max, min_src, max_src) = entry
+                comment = "page 0x{:x}".format(page)
+                if mask == 0:
+                    comment += ", protected"
+                elif not isinstance(min_src, str):
+                    comment += ", {} to {}".format(min_src, max_src)
+                out.append("    {{0x{:04x}, 0x{:04x}, 0x{:04x}, 1}}, // {}".format(mask, _min, _max, comment))
+            out.append("  },")
+        out.append("};")
+        out.append("")
+        out.append("#endif // __{}".format(base))
+        return '\n'.join(out) + '\n'
+
+    def makePython(self, filename):
+        out = []
+        out.append("# Auto-generated by {} from {}.  Do not edit.".format(
+            os.path.basename(sys.argv[0]), os.path.basename(self.filename)))
+        out.append("")
+        for n, mode in enumerate(MODES):
+            out.append("MODE_{:6s} = {}".format(mode.upper(), n))
+        out.append("")
+        for n, enc in enumerate(ENCODINGS):
+            out.append("ENCODING_{} = {}".format(enc.upper(), n))
+        out.append("")
+        out.append("commands = {")
+        out.append("    # name : (addr, mode, encoding)")
+        for name, arg in self.commands.items():
+            cmd, mode, enc = arg
+            key = '"{}":'.format(name)
+            out.append("    {:33s}(0x{:02x}, MODE_{}, ENCODING_{}),".format(
+                key, cmd, MODES[mode].upper(), ENCODINGS[enc].upper()))
+        out.append("}")
+        out.append("")
+        out.append("ltm4673_limits = {")
+        out.append("    # page: {cmd: (mask, min, max)}")
+        for page in sorted(self.limits.keys()):
+            out.append("    0x{:02x}: {{".format(page))
+            for cmd, lim in sorted(self.limits[page].items()):
+                mask, _min, _max = lim[:3]
+                out.append("        0x{:02x}: (0x{:04x}, 0x{:04x}, 0x{:04x}),  # {}".format(
+                    cmd, mask, _min, _max, self._cmdName(cmd)))
+            out.append("    },")
+        out.append("}")
+        return '\n'.join(out) + '\n'
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description="LTM4673 command and limit table generator")
+    parser.add_argument('-d', '--def_file', required=True, help='LTM4673 definition file to be loaded')
+    parser.add_argument('-o', '--output_file', required=True,
+                        help="Generated file.  Makes a C header if it ends in '.h', a Python module if '.py'")
+    parser.add_argument('--check', action="store_true", default=False,
+                        help="Don't write; exit non-zero if the output file is out of date")
+    args = parser.parse_args()
+    ltm = LTM4673Def(args.def_file)
+    ltm.load()
+    ext = os.path.splitext(args.output_file)[1]
+    if ext == ".h":
+        s = ltm.makeHeader(args.output_file)
+    elif ext == ".py":
+        s = ltm.makePython(args.output_file)
+    else:
+        print("Unknown output file type {}".format(args.output_file))
+        return 1
+    if args.check:
+        old = ""
+        if os.path.exists(args.output_file):
+            with open(args.output_file, 'r') as fd:
+                old = fd.read()
+        if old != s:
+            print("{} is out of date with {}".format(args.output_file, args.def_file))
+            return 1
+        return 0
+    with open(args.output_file, 'w') as fd:
+        fd.write(s)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -19,6 +19,13 @@ PAGE_SIZE=16
 NPAGES=128
 MAILBOX_SIZE = PAGE_SIZE * NPAGES
 
+# Update rate classes, fastest first.  The periods are defined in inc/marble_api.h
+RATE_CLASSES = ("fast", "medium", "slow", "boot")
+RATE_DEFAULT = "slow"
+
+# MBOX_INPUT_PAGES and the DOORBELL mask have one bit per input page
+INPUT_PAGES_MAX = 32
+
 def _int(x):
     try:
         return int(x)
@@ -142,6 +149,9 @@ class MailboxInterface():
         self._includes = []
         self._fd = None # For _fp method
         self._control = {}
+        self._seqPage = None
+        self._seqNames = {} # npage: name of its sequence counter in self._seqPage
+        self._doorbellPage = None
 
     def load(self):
         return self._reader.load()
@@ -212,6 +222,47 @@ class MailboxInterface():
             return None
         return paramdict.get("write_if", None)
 
+    def _period(self, npage, paramDict=None):
+        """Return the update rate class of an element (if 'paramDict' is given) or of page 'npage'.
+        An element's "period" overrides its page's which defaults to RATE_DEFAULT."""
+        period = None
+        if paramDict is not None:
+            period = paramDict.get("period", None)
+        if period is None:
+            period = self._control.get(npage, {}).get("period", RATE_DEFAULT)
+        if period not in RATE_CLASSES:
+            raise Exception("Invalid period \"{}\" on page {}. Must be one of {}".format(
+                period, npage, ', '.join(RATE_CLASSES)))
+        return period
+
+    @staticmethod
+    def _getRuns(elementList):
+        """Return [(first, count),...] contiguous byte ranges covered by 'elementList'."""
+        runs = []
+        for name, paramDict in sorted(elementList, key=lambda x: x[1].get('index', 0)):
+            first = paramDict.get('index', 0)
+            size = paramDict.get('size', 1)
+            if len(runs) > 0 and (runs[-1][0] + runs[-1][1] == first):
+                runs[-1] = (runs[-1][0], runs[-1][1] + size)
+            else:
+                runs.append((first, size))
+        return runs
+
+    def _selectElements(self, npage, elementList, key, rate):
+        """Return (selected, whole) where 'selected' is the list of elements of page 'npage' with
+        parameter 'key' ("input" or "output") in rate class 'rate', and 'whole' is True if those are
+        all such elements on the page (i.e. the whole page can be transferred at once)."""
+        selected = []
+        whole = True
+        for name, paramDict in elementList:
+            if paramDict.get(key, None) is None:
+                continue
+            if self._period(npage, paramDict) == rate:
+                selected.append((name, paramDict))
+            else:
+                whole = False
+        return selected, whole
+
     def interpret(self):
         jdict = self.load()
         self._pageNumbers = []
@@ -223,6 +274,12 @@ class MailboxInterface():
             if page == "control":
                 self._handleControl(mlist) # 'mlist' is actually a dict, but who cares
                 continue
+            if page == "seqlock_page":
+                self._seqPage = int(mlist)
+                continue
+            if page == "doorbell_page":
+                self._doorbellPage = int(mlist)
+                continue
             npage = self._extractNumber(page)
             if npage == None:
                 print("Skipping page {}".format(page))
@@ -248,9 +305,94 @@ class MailboxInterface():
                     raise MailboxError("Encountered mailbox page element {} which has no 'name' entry.".format(nelement))
                 elementList.append((name, paramDict))
             self._pageList.append((npage, elementList))
+        # Vet the update rate classes (raises on error)
+        for npage, elementList in self._pageList:
+            for name, paramDict in elementList:
+                self._period(npage, paramDict)
+        self._makeSeqPage()
+        self._makeDoorbellPage()
         self._ready = True
         return
 
+    def _seqlock(self, npage):
+        paramdict = self._control.get(npage, None)
+        if paramdict is None:
+            return False
+        return bool(paramdict.get("seqlock", False))
+
+    def _makeSeqPage(self):
+        """Synthesize the page holding one sequence counter per "seqlock" page.
+        The MMC increments a page's counter before (making it odd) and after (making it even)
+        writing the page so a host can detect a torn read (see decodembox.py)."""
+        seqPages = [npage for npage, elementList in self._pageList if self._seqlock(npage)]
+        if len(seqPages) == 0:
+            return
+        if self._seqPage is None:
+            raise Exception("\"seqlock\" pages require a \"seqlock_page\" entry")
+        if self._hasPage(self._seqPage):
+            raise Exception("seqlock_page {} is also defined as a mailbox page".format(self._seqPage))
+        if len(seqPages) > PAGE_SIZE:
+            raise Exception("At most {} pages can have \"seqlock\" enabled".format(PAGE_SIZE))
+        elementList = []
+        for n, npage in enumerate(seqPages):
+            name = f"SEQ{npage}"
+            paramDict = self._getDefaultParams()
+            paramDict['desc'] = f"Page {npage} sequence counter; odd while the MMC is writing the page"
+            paramDict['index'] = n
+            paramDict['seq'] = npage
+            elementList.append((name, paramDict))
+            self._seqNames[npage] = name
+        self._pageNumbers.append(self._seqPage)
+        self._pageList.append((self._seqPage, elementList))
+        return
+
+    def _makeDoorbellPage(self):
+        """Synthesize the page holding the doorbell mask.  The FPGA sets bit N of DOORBELL and
+        asserts FPGA_INT to have the MMC read input page N immediately (rather than at the next
+        mailbox update of its rate class).  The MMC clears the mask before reading the pages."""
+        if self._doorbellPage is None:
+            return
+        if self._hasPage(self._doorbellPage):
+            raise Exception("doorbell_page {} is also defined as a mailbox page".format(self._doorbellPage))
+        paramDict = self._getDefaultParams()
+        paramDict['size'] = 4
+        paramDict['desc'] = "Bit N requests an immediate read of input page N (set by FPGA, cleared by MMC)"
+        paramDict['index'] = 0
+        paramDict['doorbell'] = True
+        self._pageNumbers.append(self._doorbellPage)
+        self._pageList.append((self._doorbellPage, [("DOORBELL", paramDict)]))
+        return
+
+    def _inputPageMask(self):
+        mask = 0
+        for npage, elementList in self._pageList:
+            for name, paramDict in elementList:
+                if paramDict.get('input', None) is not None:
+                    if npage >= INPUT_PAGES_MAX:
+                        raise Exception("Input page {} is out of range; input pages must be below {}".format(
+                            npage, INPUT_PAGES_MAX))
+                    mask |= 1 << npage
+        return mask
+
+    def getDoorbellAddr(self):
+        """Return the address of the DOORBELL mask, or None if there is no "doorbell_page"."""
+        if self._pageList is None:
+            self.interpret()
+        if self._doorbellPage is None:
+            return None
+        addr, size = self.getElementOffsetAddressAndSize(self._doorbellPage, "DOORBELL")
+        return addr
+
+    def getSeqlockAddrs(self):
+        """Return {npage: address of the page's sequence counter} for all "seqlock" pages."""
+        if self._pageList is None:
+            self.interpret()
+        addrs = {}
+        for npage, name in self._seqNames.items():
+            addr, size = self.getElementOffsetAddressAndSize(self._seqPage, name)
+            addrs[npage] = addr
+        return addrs
+
     def _vetSize(self, size):
         if size == "":
             size = 1
@@ -391,8 +533,17 @@ class MailboxInterface():
 
     def makeProtos(self):
         self._fp("uint32_t mailbox_get_hash(void);")
-        self._fp("void mailbox_update_input(void);")
-        self._fp("void mailbox_update_output(void);")
+        if self._seqPage is not None:
+            self._fp(f"#define MBOX_SEQ_PAGE ({self._seqPage})")
+        if self._doorbellPage is not None:
+            self._fp(f"#define MBOX_DOORBELL_PAGE ({self._doorbellPage})")
+        self._fp(f"#define MBOX_INPUT_PAGES (0x{self._inputPageMask():x}UL)")
+        for n, rate in enumerate(RATE_CLASSES):
+            self._fp(f"#define MBOX_RATE_{rate.upper():8s} (1 << {n})")
+        for rate in RATE_CLASSES:
+            self._fp(f"void mailbox_update_input_{rate}(void);")
+            self._fp(f"void mailbox_update_output_{rate}(void);")
+        self._fp("int mailbox_update_input_page(uint8_t npage);")
         self._fp("void mailbox_read_print_all(void);")
         return
 
@@ -404,93 +555,121 @@ class MailboxInterface():
         self._fp("")
         return
 
-    def makeUpdateInput(self):
-        self._fp("void mailbox_update_input(void) {")
+    def makeUpdateInput(self, rate):
+        self._fp(f"void mailbox_update_input_{rate}(void) {{")
         for npage, elementList in self._pageList: # Each entry is (npage, [(name, paramDict),...])
-            hasInputs = False
-            hasBigval = False
-            hasAck = False
-            mbprefix = f"MB{npage}_"
-            for n in range(len(elementList)):
-                name, paramDict = elementList[n]
-                pinput = paramDict.get('input', None)
-                if pinput is not None:
-                    if not hasInputs:
-                        # Delay opening the code block until we know it has inputs.
-                        # If the page doesn't have inputs, will not generate the block
-                        read_if = self._read_if(npage)
-                        if read_if is None:
-                            self._fp("  {")
-                        else:
-                            self._fp(f"  if ({read_if}) {{")
-                        self._fp(f"    // Page {npage}")
-                        self._fp(f"    uint8_t page[MB{npage}_SIZE];")
+            selected, whole = self._selectElements(npage, elementList, 'input', rate)
+            self._makeInputBlock(npage, selected, whole)
+        self._fp("  return;\n}")
+
+    def makeUpdateInputPage(self):
+        """Read all inputs of one page (regardless of rate class); used by the doorbell."""
+        self._fp("int mailbox_update_input_page(uint8_t npage) {")
+        for npage, elementList in self._pageList: # Each entry is (npage, [(name, paramDict),...])
+            selected = [x for x in elementList if x[1].get('input', None) is not None]
+            self._makeInputBlock(npage, selected, True, cond=f"npage == {npage}", ret="return 0;")
+        self._fp("  return -1;\n}")
+
+    def _makeInputBlock(self, npage, selected, whole, cond=None, ret=None):
+        """Generate the code block reading the elements 'selected' of page 'npage' and passing them
+        to their 'input' handlers.  If 'cond' is given, the block is only entered if it holds.
+        If 'ret' is given, it is the last statement of the block."""
+        hasInputs = False
+        hasBigval = False
+        hasAck = False
+        mbprefix = f"MB{npage}_"
+        for n in range(len(selected)):
+            name, paramDict = selected[n]
+            pinput = paramDict.get('input', None)
+            if pinput is not None:
+                if not hasInputs:
+                    # Delay opening the code block until we know it has inputs.
+                    # If the page doesn't have inputs, will not generate the block
+                    read_if = self._read_if(npage)
+                    if cond is not None and read_if is not None:
+                        self._fp(f"  if (({cond}) && ({read_if})) {{")
+                    elif cond is not None:
+                        self._fp(f"  if ({cond}) {{")
+                    elif read_if is None:
+                        self._fp("  {")
+                    else:
+                        self._fp(f"  if ({read_if}) {{")
+                    self._fp(f"    // Page {npage}")
+                    self._fp(f"    uint8_t page[MB{npage}_SIZE];")
+                    if whole:
                         self._fp(f"    mbox_read_page({npage}, MB{npage}_SIZE, page);")
-                    hasInputs = True
-                    if not hasattr(pinput, 'replace'):
-                        print("{} is not a valid string")
-                        continue
-                    enumName = f"{mbprefix}{name}"
-                    size = paramDict.get('size', 1)
-                    # TODO - Add 'aspointer' boolean option to mbox.def?
-                    aspointer = paramDict.get('aspointer', False)
-                    if (size > 4) or aspointer:    # Use array-mode for sizes > 4
-                        s = "    {};".format(pinput.replace('@', f"&page[{enumName}_{size-1}]"))
-                        s = s.replace("&&", '&')  # Replace any double-ampersands
-                        self._fp(s)
-                    elif size > 1:
-                        if not hasBigval:
-                            # We need to instantiate an int
-                            self._fp(f"    int val;")
-                            hasBigval = True
-                        # Break up into bytes
-                        # First, get value
-                        # TODO - What to do here?
-                        #        I think val = (int)((page[N_3] << 24) | (page[N_2} << 16) | (page[N_1] << 8) | page[N_0])
-                        fmt = f"page[{enumName}_" + "{}]"
-                        v = self._getShiftOR(fmt, size)
-                        # Assign shifted and OR'd value to temporary variable 'val'
-                        self._fp("    val = (int)({});".format(v))
-                        # Use the 'input' param string to return 'val' wherever it needs to go
-                        s = "    {};".format(pinput.replace('@', 'val'))
-                        s = s.replace("&&", '&')  # Replace any double-ampersands
-                        self._fp(s)
                     else:
-                        # size = 1 (nice and easy)
-                        s = "    {};".format(pinput.replace('@', f"page[{enumName}]"))
-                        s = s.replace("&&", '&')  # Replace any double-ampersands
-                        self._fp(s)
-                    # Handle acks if needed
-                    ack = paramDict.get('ack', None)
-                    if ack is None:
-                        # try alternate keyword
-                        ack = paramDict.get('respond', None)
-                    if ack is not None:
-                        hasAck = True
-                        if size > 1:
-                            # Apply the ack operation to the full-sized value
-                            self._fp("    val = {};".format(ack.replace('@', 'val')))
-                            for n in range(size):
-                                member = f"page[{enumName}_{n}]"
-                                #self._fp("    {} = {};".format(member, ack.replace('@', member)))
-                                self._fp("    mbox_write_entry({}_{}, {});".format(
-                                         enumName, n, f"(uint8_t)((val >> {8*n}) & 0xFF)"))
-                        else:
-                            #self._fp("    page[{}] = {};".format(enumName, ack.replace('@', f'(page[{enumName}])')))
-                            member = f"page[{enumName}]"
-                            self._fp("    mbox_write_entry({}, {});".format(enumName, ack.replace('@', member)))
-            if hasInputs:
-                self._fp("  }")
-        self._fp("  return;\n}")
+                        # Only read the entries in this rate class
+                        for first, count in self._getRuns(selected):
+                            self._fp(f"    mbox_read_entries({npage}, {first}, {count}, page);")
+                hasInputs = True
+                if not hasattr(pinput, 'replace'):
+                    print("{} is not a valid string")
+                    continue
+                enumName = f"{mbprefix}{name}"
+                size = paramDict.get('size', 1)
+                # TODO - Add 'aspointer' boolean option to mbox.def?
+                aspointer = paramDict.get('aspointer', False)
+                if (size > 4) or aspointer:    # Use array-mode for sizes > 4
+                    s = "    {};".format(pinput.replace('@', f"&page[{enumName}_{size-1}]"))
+                    s = s.replace("&&", '&')  # Replace any double-ampersands
+                    self._fp(s)
+                elif size > 1:
+                    if not hasBigval:
+                        # We need to instantiate an int
+                        self._fp(f"    int val;")
+                        hasBigval = True
+                    # Break up into bytes
+                    # First, get value
+                    # TODO - What to do here?
+                    #        I think val = (int)((page[N_3] << 24) | (page[N_2} << 16) | (page[N_1] << 8) | page[N_0])
+                    fmt = f"page[{enumName}_" + "{}]"
+                    v = self._getShiftOR(fmt, size)
+                    # Assign shifted and OR'd value to temporary variable 'val'
+                    self._fp("    val = (int)({});".format(v))
+                    # Use the 'input' param string to return 'val' wherever it needs to go
+                    s = "    {};".format(pinput.replace('@', 'val'))
+                    s = s.replace("&&", '&')  # Replace any double-ampersands
+                    self._fp(s)
+                else:
+                    # size = 1 (nice and easy)
+                    s = "    {};".format(pinput.replace('@', f"page[{enumName}]"))
+                    s = s.replace("&&", '&')  # Replace any double-ampersands
+                    self._fp(s)
+                # Handle acks if needed
+                ack = paramDict.get('ack', None)
+                if ack is None:
+                    # try alternate keyword
+                    ack = paramDict.get('respond', None)
+                if ack is not None:
+                    hasAck = True
+                    if size > 1:
+                        # Apply the ack operation to the full-sized value
+                        self._fp("    val = {};".format(ack.replace('@', 'val')))
+                        for n in range(size):
+                            member = f"page[{enumName}_{n}]"
+                            #self._fp("    {} = {};".format(member, ack.replace('@', member)))
+                            self._fp("    mbox_write_entry({}_{}, {});".format(
+                                     enumName, n, f"(uint8_t)((val >> {8*n}) & 0xFF)"))
+                    else:
+                        #self._fp("    page[{}] = {};".format(enumName, ack.replace('@', f'(page[{enumName}])')))
+                        member = f"page[{enumName}]"
+                        self._fp("    mbox_write_entry({}, {});".format(enumName, ack.replace('@', member)))
+        if hasInputs:
+            if ret is not None:
+                self._fp(f"    {ret}")
+            self._fp("  }")
+        return
 
-    def makeUpdateOutput(self):
-        self._fp("void mailbox_update_output(void) {")
+    def makeUpdateOutput(self, rate):
+        self._fp(f"void mailbox_update_output_{rate}(void) {{")
         for npage, elementList in self._pageList: # Each entry is (npage, [(name, paramDict),...])
             hasOutputs = False
             hasBigval = False
             mbprefix = f"MB{npage}_"
-            for n in range(len(elementList)):
-                name, paramDict = elementList[n]
+            selected, whole = self._selectElements(npage, elementList, 'output', rate)
+            for n in range(len(selected)):
+                name, paramDict = selected[n]
                 output = paramDict.get('output', None)
                 if output is not None:
                     if not hasOutputs:
@@ -537,7 +716,40 @@ class MailboxInterface():
                         self._fp(s)
             if hasOutputs:
                 self._fp("    // Write page data")
-                self._fp(f"    mbox_write_page({npage}, MB{npage}_SIZE, page);")
+                seqName = self._seqNames.get(npage, None)
+                if whole:
+                    runs = [(0, f"MB{npage}_SIZE")]
+                else:
+                    # Only write the entries in this rate class
+                    runs = self._getRuns(selected)
+                indent = "    "
+                inputRuns = []
+                if seqName is not None:
+                    # Unchanged pages are not rewritten so the counter only moves on a change.
+                    # Elements with an input handler may have been overwritten by the FPGA, so
+                    # they are left out of the comparison and always rewritten.
+                    seqEntry = f"MB{self._seqPage}_{seqName}"
+                    inputRuns = self._getRuns([x for x in selected if x[1].get('input', None) is not None])
+                    cmpRuns = self._getRuns([x for x in selected if x[1].get('input', None) is None])
+                    if len(cmpRuns) > 0:
+                        changed = " | ".join([f"mbox_seq_changed({seqEntry}, {first}, {count}, page)"
+                                              for first, count in cmpRuns])
+                        self._fp(f"    if ({changed}) {{")
+                        indent = "      "
+                    self._fp(f"{indent}mbox_seq_begin({seqEntry});")
+                if whole:
+                    self._fp(f"{indent}mbox_write_page({npage}, MB{npage}_SIZE, page);")
+                else:
+                    for first, count in runs:
+                        self._fp(f"{indent}mbox_write_entries({npage}, {first}, {count}, page);")
+                if seqName is not None:
+                    self._fp(f"{indent}mbox_seq_end({seqEntry});")
+                    if indent != "    ":
+                        if len(inputRuns) > 0:
+                            self._fp("    } else {")
+                            for first, count in inputRuns:
+                                self._fp(f"      mbox_write_entries({npage}, {first}, {count}, page);")
+                        self._fp("    }")
                 self._fp("  }")
         self._fp("  return;\n}")
 
@@ -594,9 +806,12 @@ class MailboxInterface():
         self.makeIncludes()
         self.makeGetHash()
         self._fp("")
-        self.makeUpdateOutput()
-        self._fp("")
-        self.makeUpdateInput()
+        for rate in RATE_CLASSES:
+            self.makeUpdateOutput(rate)
+            self._fp("")
+            self.makeUpdateInput(rate)
+            self._fp("")
+        self.makeUpdateInputPage()
         self._fp("")
         self.makePrintAll()
         if self._fd is not None:
@@ -624,8 +839,8 @@ class MailboxInterface():
             printf("# Mailbox Documentation\n\n(autogenerated by mkmbox.py)\n")
             for npage, elementList in self._pageList: # Each entry is (npage, [(name, paramDict),...])
                 printf(f"# Page {npage}\n")
-                printf("Offset|Name|Size|Direction|Desc|Note")
-                printf("------|----|----|---------|----|----")
+                printf("Offset|Name|Size|Direction|Rate|Desc|Note")
+                printf("------|----|----|---------|----|----|----")
                 index = 0
                 offset = 0
                 size = 1
@@ -641,8 +856,13 @@ class MailboxInterface():
                     desc = self._mdSanitize(paramDict.get('desc', ''))
                     inp = paramDict.get('input', None)
                     out = paramDict.get('output', None)
-                    if (inp is None) and (out is None):
-                        direction = "Invalid!"
+                    if paramDict.get('seq', None) is not None:
+                        direction = "MCC=>FPGA"
+                    elif paramDict.get('doorbell', False):
+                        direction = "FPGA=>MMC"
+                    elif (inp is None) and (out is None):
+                        # Elements transferred by custom code may state their direction
+                        direction = {"in": "FPGA=>MMC", "out": "MCC=>FPGA"}.get(paramDict.get('dir', None), "Invalid!")
                     elif (inp is None):
                         direction = "MCC=>FPGA"
                     elif (out is None):
@@ -656,7 +876,12 @@ class MailboxInterface():
                     else:
                         note = ""
                     note = self._mdSanitize(note)
-                    printf(f"{offset}|{name}|{size}|{direction}|{desc}|{note}")
+                    if (inp is None) and (out is None):
+                        # Not transferred by the periodic updates
+                        rate = "-"
+                    else:
+                        rate = self._period(npage, paramDict)
+                    printf(f"{offset}|{name}|{size}|{direction}|{rate}|{desc}|{note}")
                     offset += size
                 printf("")
         return
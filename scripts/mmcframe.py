@@ -0,0 +1,293 @@
+#! /usr/bin/python3
+
+# Client for the binary framed protocol on the marble_mmc console UART
+# (see inc/uart_frame.h).  Frames share the UART with the text console; a
+# frame may only be sent when no partial text line is pending.
+#
+#   | MAGIC | SEQ | OP | STATUS | LEN | PAYLOAD[LEN] | CRC_H | CRC_L |
+
+import struct
+import time
+
+FRAME_MAGIC = 0xa5
+FRAME_HEADER_SIZE = 5
+FRAME_MAX_PAYLOAD = 64
+FRAME_OP_RESPONSE = 0x80
+
+OP_PING = 0x00
+OP_PMBUS_XACT = 0x01
+OP_MBOX_READ = 0x02
+OP_MBOX_WRITE = 0x03
+OP_EEPROM_READ = 0x04
+OP_EEPROM_WRITE = 0x05
+OP_TELEM = 0x06
+OP_PMLOG_READ = 0x07
+OP_CONSOLE = 0x08
+OP_LTM4673_IMAGE = 0x09
+OP_CONSOLE_OUTPUT = 0x0a
+
+# OP_LTM4673_IMAGE sub-operations
+IMAGE_CLEAR = 0x00
+IMAGE_DATA = 0x01
+IMAGE_PROGRAM = 0x02
+# ltm4673_image_program() flags in inc/ltm4673.h
+IMAGE_STORE = 0x01
+IMAGE_DRY_RUN = 0x02
+
+STATUS_OK = 0
+STATUS_BAD_CRC = 1
+STATUS_FAIL = 6
+_status_names = ("OK", "BAD_CRC", "BAD_OP", "BAD_LEN", "BAD_ARG", "DENIED", "FAIL")
+
+# PM_telem_enum_t order in inc/i2c_pm.h
+TELEM_NAMES = ("VOUT_1V0", "IOUT_1V0", "VOUT_1V8", "IOUT_1V8", "VOUT_2V5", "IOUT_2V5",
+               "VOUT_3V3", "IOUT_3V3", "VIN", "IIN")
+
+MBOX_PAGE_SIZE = 16
+# sizeof(pmlog_record_t) in inc/pmlog.h
+PMLOG_RECORD_SIZE = 320
+RESPONSE_TIMEOUT = 2.0 # seconds
+RETRIES = 3
+
+
+class FrameError(Exception):
+    def __init__(self, s, status=None, payload=None):
+        super().__init__(s)
+        self.status = status
+        self.payload = payload
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE; must match frame_crc16() in src/uart_frame.c"""
+    crc = 0xffff
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            if crc & 0x8000:
+                crc = ((crc << 1) ^ 0x1021) & 0xffff
+            else:
+                crc = (crc << 1) & 0xffff
+    return crc
+
+
+def encode(seq, op, payload=b'', status=0):
+    if len(payload) > FRAME_MAX_PAYLOAD:
+        raise FrameError("Payload too long ({} > {})".format(len(payload), FRAME_MAX_PAYLOAD))
+    body = bytes((seq & 0xff, op & 0xff, status & 0xff, len(payload))) + bytes(payload)
+    return bytes((FRAME_MAGIC,)) + body + struct.pack(">H", crc16(body))
+
+
+class MMCFrame():
+    """Talk to marble_mmc over its binary framed protocol.
+    'dev' is anything with pyserial-like read(n) and write(data) methods."""
+    def __init__(self, dev):
+        self.dev = dev
+        self._seq = 0
+        self._rx = bytearray()
+
+    def _read_frame(self, timeout=RESPONSE_TIMEOUT):
+        """Return (seq, op, status, payload) of the next valid frame.
+        Text console output before the frame is discarded."""
+        deadline = time.time() + timeout
+        while time.time() < deadline:
+            start = self._rx.find(FRAME_MAGIC)
+            if start < 0:
+                self._rx.clear()
+            else:
+                del self._rx[:start]
+                if len(self._rx) >= FRAME_HEADER_SIZE:
+                    size = FRAME_HEADER_SIZE + self._rx[4] + 2
+                    if len(self._rx) >= size:
+                        frame = bytes(self._rx[:size])
+                        body = frame[1:-2]
+                        if struct.unpack(">H", frame[-2:])[0] == crc16(body):
+                            del self._rx[:size]
+                            return body[0], body[1], body[2], body[FRAME_HEADER_SIZE-1:]
+                        # Not a frame after all (or corrupted); resync past this magic
+                        del self._rx[:1]
+                        continue
+            r = self.dev.read(max(1, FRAME_HEADER_SIZE - len(self._rx)))
+            if r:
+                self._rx.extend(r)
+        return None
+
+    def request(self, op, payload=b''):
+        """Send one request and return the response payload.
+        Retries on timeouts and CRC errors; raises FrameError on failure."""
+        for _ in range(RETRIES):
+            seq = self._seq
+            self._seq = (self._seq + 1) & 0xff
+            self.dev.write(encode(seq, op, payload))
+            while True:
+                rsp = self._read_frame()
+                if rsp is None or rsp[0] == seq:
+                    break
+                # Stale response to an earlier (retried) request
+            if rsp is None:
+                continue
+            _seq, rop, status, rpayload = rsp
+            if status == STATUS_BAD_CRC:
+                continue
+            if rop != (op | FRAME_OP_RESPONSE):
+                raise FrameError("Response opcode 0x{:02x} to request 0x{:02x}".format(rop, op))
+            if status != STATUS_OK:
+                name = _status_names[status] if status < len(_status_names) else str(status)
+                raise FrameError("Request 0x{:02x} failed: {}".format(op, name), status, rpayload)
+            return rpayload
+        raise FrameError("No valid response to request 0x{:02x}".format(op))
+
+    def ping(self, data=b''):
+        return self.request(OP_PING, data)
+
+    def pmbus_write(self, addr, cmd, data=()):
+        """Write 'data' (may be empty for SEND_BYTE) to command 'cmd'"""
+        self.request(OP_PMBUS_XACT, bytes((addr & 0xfe, cmd, 0)) + bytes(data))
+
+    def pmbus_read(self, addr, cmd, nbytes):
+        return self.request(OP_PMBUS_XACT, bytes((addr & 0xfe, cmd, nbytes)))
+
+    def run_xact(self, xact):
+        """Run a transaction as built by ltm4673.read()/ltm4673.write().
+        Returns the bytes read (empty for writes)."""
+        msg = xact[0]
+        if len(xact) == 1:
+            self.pmbus_write(msg[0], msg[1], msg[2:])
+            return b''
+        rsp = xact[1]
+        nread = 0
+        for mbyte in rsp[1:]:
+            if hasattr(mbyte, '__len__'):
+                raise FrameError("Block reads are not supported")
+            nread += 1
+        return self.pmbus_read(msg[0], msg[1], nread)
+
+    def run_xacts(self, xacts):
+        return [self.run_xact(xact) for xact in xacts]
+
+    def mbox_read(self, page):
+        return self.request(OP_MBOX_READ, bytes((page,)))
+
+    def mbox_write(self, page, data):
+        data = bytes(data)
+        if len(data) == 0 or len(data) > MBOX_PAGE_SIZE:
+            raise FrameError("Mailbox write must be 1-{} bytes".format(MBOX_PAGE_SIZE))
+        self.request(OP_MBOX_WRITE, bytes((page,)) + data)
+
+    def eeprom_read(self, tag):
+        return self.request(OP_EEPROM_READ, bytes((tag,)))
+
+    def eeprom_write(self, tag, data):
+        self.request(OP_EEPROM_WRITE, bytes((tag,)) + bytes(data))
+
+    def telem(self):
+        """Returns dict of raw PMBus telemetry words and LM75 temperatures"""
+        data = self.request(OP_TELEM)
+        nwords = len(TELEM_NAMES)
+        words = struct.unpack("<{}H2h".format(nwords), data[:2*nwords+4])
+        d = dict(zip(TELEM_NAMES, words[:nwords]))
+        d["LM75_0"] = words[nwords]
+        d["LM75_1"] = words[nwords+1]
+        return d
+
+    def console(self, cmd):
+        """Run console command 'cmd' (e.g. "p 50%") and return its output.
+        Raises FrameError (status FAIL, output in 'output') if the command returns non-zero."""
+        err = None
+        try:
+            rsp = self.request(OP_CONSOLE, cmd.encode('ascii'))
+        except FrameError as e:
+            if e.status != STATUS_FAIL or e.payload is None or len(e.payload) < 3:
+                raise
+            err = e
+            rsp = e.payload
+        size = struct.unpack(">H", rsp[1:3])[0]
+        out = rsp[3:]
+        while len(out) < size:
+            chunk = self.request(OP_CONSOLE_OUTPUT, struct.pack(">H", len(out)))
+            if len(chunk) == 0:
+                break
+            out += chunk
+        output = out.decode('ascii', errors='replace')
+        if err is not None:
+            err.output = output
+            raise err
+        return output
+
+    def ltm4673_program(self, image, store=False, dry_run=False):
+        """Send a configuration image (see ltm4673.build_image()) and have the
+        MMC write the registers which differ.  Returns a dict of counts."""
+        image = bytes(image)
+        chunk = FRAME_MAX_PAYLOAD - 3
+        self.request(OP_LTM4673_IMAGE, bytes((IMAGE_CLEAR,)))
+        for offset in range(0, len(image), chunk):
+            self.request(OP_LTM4673_IMAGE, bytes((IMAGE_DATA,)) + struct.pack(">H", offset)
+                         + image[offset:offset+chunk])
+        flags = (IMAGE_STORE if store else 0) | (IMAGE_DRY_RUN if dry_run else 0)
+        rsp = self.request(OP_LTM4673_IMAGE, bytes((IMAGE_PROGRAM, flags)))
+        records, changed, failed, stored = struct.unpack(">HHHB", rsp[:7])
+        return {"records": records, "changed": changed, "failed": failed, "stored": bool(stored)}
+
+    def pmlog_read(self, n=0):
+        """Returns the n-th most recent power-loss record (0 = newest) as a dict"""
+        raw = b''
+        while len(raw) < PMLOG_RECORD_SIZE:
+            raw += self.request(OP_PMLOG_READ, struct.pack(">BH", n, len(raw)))
+        nwords = len(TELEM_NAMES)
+        fields = struct.unpack_from("<II{}HH".format(nwords), raw)
+        hdr = struct.calcsize("<II{}HHH".format(nwords))
+        flen = fields[-1]
+        return {"seq": fields[0], "tick": fields[1],
+                "telem": dict(zip(TELEM_NAMES, fields[2:2+nwords])),
+                "fault_log": raw[hdr:hdr+flen]}
+
+
+def open_serial(port, baud=115200):
+    import serial
+    return MMCFrame(serial.Serial(port=port, baudrate=baud, timeout=0.1))
+
+
+def _int(s):
+    return int(s, 0)
+
+
+def main():
+    import load
+    parser = load.ArgParser()
+    parser.add_argument('op', choices=("ping", "telem", "mbox", "eeprom", "pmlog"), help="Operation")
+    parser.add_argument('args', nargs='*', type=_int,
+                        help="mbox: page [data...]; eeprom: tag [data...]; pmlog: [n]")
+    args = parser.parse_args()
+    mmc = open_serial(args.dev, args.baud)
+    try:
+        if args.op == "ping":
+            t0 = time.time()
+            mmc.ping(b"marble")
+            print("Round trip {:.1f} ms".format(1000*(time.time() - t0)))
+        elif args.op == "telem":
+            for key, val in mmc.telem().items():
+                print("{} = 0x{:04x}".format(key, val & 0xffff))
+        elif args.op == "mbox":
+            if len(args.args) > 1:
+                mmc.mbox_write(args.args[0], args.args[1:])
+            else:
+                print(" ".join(["0x{:02x}".format(x) for x in mmc.mbox_read(args.args[0])]))
+        elif args.op == "eeprom":
+            if len(args.args) > 1:
+                mmc.eeprom_write(args.args[0], args.args[1:])
+            else:
+                print(" ".join(["0x{:02x}".format(x) for x in mmc.eeprom_read(args.args[0])]))
+        elif args.op == "pmlog":
+            rec = mmc.pmlog_read(args.args[0] if args.args else 0)
+            print("Event {} at {} ms".format(rec["seq"], rec["tick"]))
+            for key, val in rec["telem"].items():
+                print("{} = 0x{:04x}".format(key, val))
+            print("MFR_FAULT_LOG: " + rec["fault_log"].hex())
+    except (FrameError, IndexError) as e:
+        print(e)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    import sys
+    sys.exit(main())
@@ -1,12 +1,13 @@
 #!/bin/sh
 
-# USAGE: program_ltm4673.sh [-f program_file.txt] [/dev/ttyUSB3] [-s] [-h|--help]
+# USAGE: program_ltm4673.sh [-f program_file.txt] [/dev/ttyUSB3] [-s] [-b] [-h|--help]
 
 # Set environment variable TTY_MMC to point to whatever /dev/ttyUSBx
 # the marble_mmc enumerated as.
 
 filenext=0
 doStore=0
+doBulk=0
 doHelp=0
 filename=
 dev=
@@ -18,6 +19,8 @@ for arg in "$@"; do
     filenext=1
   elif [ "$arg" = "-s" ]; then
     doStore=1
+  elif [ "$arg" = "-b" ]; then
+    doBulk=1
   elif [ "$arg" = "-h" ]; then
     doHelp=1
   elif [ "$arg" = "--help" ]; then
@@ -44,15 +47,26 @@ if [ -z "$filename" ] && [ $doStore = 0 ]; then
 fi
 
 if [ $doHelp != 0 ]; then
-  echo "USAGE: program_ltm4673.sh [device] [-f program_file.txt] [-s] [-h|--help]"
+  echo "USAGE: program_ltm4673.sh [device] [-f program_file.txt] [-s] [-b] [-h|--help]"
   echo "  -f        : Register programming list (format from LTC PMBus)"
   echo "  -s        : Store register programming to flash."
+  echo "  -b        : Bulk: send the whole program at once; the MMC writes only registers"
+  echo "            : that differ, and with -s stores only if anything changed."
   echo "  -h|--help : Print this help and exit."
   echo "  device    : Character device file (e.g. /dev/ttyUSB3) of the MMC channel on the FTDI USB-to-UART."
   echo "            : If 'device' is not supplied, tries to use the value of the environment variable 'TTY_MMC'."
   exit 1
 fi
 
+if [ -n "$filename" ] && [ $doBulk != 0 ]; then
+  if [ $doStore != 0 ]; then
+    python3 "$SCRIPT_DIR/ltm4673.py" -d "$dev" write --bulk --store -f "$filename"
+  else
+    python3 "$SCRIPT_DIR/ltm4673.py" -d "$dev" write --bulk -f "$filename"
+  fi
+  exit $?
+fi
+
 if [ -n "$filename" ]; then
   python3 "$SCRIPT_DIR/ltm4673.py" -d "$dev" write -f "$filename"
 fi
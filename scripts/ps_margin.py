@@ -73,6 +73,8 @@ def handle_args(args):
             val = get_voltage(sarg, page)
             xacts.append(ltm4673.write(ltm4673.PAGE, page))
             xacts.append(ltm4673.write(ltm4673.VOUT_COMMAND, ltm4673.V_TO_L16(val)))
+    if args.binary:
+        return handle_args_binary(args, xacts)
     import load
     # I'll give it a bit more time for writes.
     load.INTERCOMMAND_SLEEP = 0.1
@@ -106,6 +108,32 @@ def handle_args(args):
     return load_rval
 
 
+def handle_args_binary(args, xacts):
+    """Same as handle_args() but over the binary framed protocol (mmcframe.py),
+    which returns readback values directly instead of console text."""
+    import mmcframe
+    mmc = mmcframe.open_serial(args.dev, args.baud)
+    try:
+        if len(xacts) > 0:
+            print("Attempting voltage override. Ensure write-protect switch (SW4) is off.")
+            mmc.run_xacts(xacts)
+            print("Success")
+        else:
+            print("No voltages provided. No writes will be performed.")
+        if not args.confirm:
+            return 0
+        for page in range(4):
+            mmc.run_xact(ltm4673.write(ltm4673.PAGE, page))
+            vout = int.from_bytes(mmc.run_xact(ltm4673.read(ltm4673.READ_VOUT)), 'little')
+            iout = int.from_bytes(mmc.run_xact(ltm4673.read(ltm4673.READ_IOUT)), 'little')
+            print("Page {}: READ_VOUT = {:.3f}V, READ_IOUT = {:.3f}A".format(
+                page, ltm4673.L16_TO_V(vout), ltm4673.L11_TO_V(iout)))
+    except mmcframe.FrameError as e:
+        print("Failed to load transaction to MMC: {}".format(e))
+        return 1
+    return 0
+
+
 def main(argv):
     import load
     # 100ms between commands for conservative program timing constraints
@@ -122,6 +150,8 @@ def main(argv):
                         help="Set 3.3V rail voltage (voltage or percent with '%%').")
     parser.add_argument('-c', '--confirm', default=False, action="store_true",
                         help="Confirm voltages after programing by reading back telemetry.")
+    parser.add_argument('--binary', default=False, action="store_true",
+                        help="Use the binary framed protocol instead of console text.")
     args = parser.parse_args()
     return handle_args(args)
 
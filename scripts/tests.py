@@ -1,4 +1,7 @@
+import struct
 from mboxexchange import getPageAndName
+from ltm4673 import build_image
+import mmcframe
 
 
 def test_getPageAndName(verbose=False):
@@ -22,9 +25,65 @@ def test_getPageAndName(verbose=False):
     return 1
 
 
+def test_build_image(verbose=False):
+    # WRITE_PROTECT is a byte, VIN_ON a word and VOUT_COMMAND a paged word
+    program = ((0xff, ((0x10, 0x00), (0x35, 0xCA40))), (0, ((0x21, 0x2000),)))
+    expected = bytes((0xff, 0x10, 1, 0x00,
+                      0xff, 0x35, 2, 0x40, 0xca,
+                      0x00, 0x21, 2, 0x00, 0x20))
+    result = build_image(program)
+    if verbose:
+        print(f"build_image() = {result.hex()}")
+    if result != expected:
+        print(f"FAIL: {result.hex()} != {expected.hex()}")
+        return 1
+    print("PASS")
+    return 0
+
+
+class _ConsoleFrame(mmcframe.MMCFrame):
+    """Answers OP_CONSOLE/OP_CONSOLE_OUTPUT like uart_frame.c with 'output' as the captured text"""
+    def __init__(self, output, rc=0, rsp_max=mmcframe.FRAME_MAX_PAYLOAD):
+        super().__init__(None)
+        self.output = output
+        self.rc = rc
+        self.rsp_max = rsp_max
+
+    def request(self, op, payload=b''):
+        if op == mmcframe.OP_CONSOLE:
+            rsp = struct.pack(">bH", self.rc, len(self.output)) + self.output[:self.rsp_max-3]
+            if self.rc != 0:
+                raise mmcframe.FrameError("FAIL", mmcframe.STATUS_FAIL, rsp)
+            return rsp
+        offset = struct.unpack(">H", payload)[0]
+        return self.output[offset:offset+self.rsp_max]
+
+
+def test_console_output(verbose=False):
+    text = b"".join([b"line %d\r\n" % n for n in range(40)])
+    fails = 0
+    for rc in (0, -1):
+        dev = _ConsoleFrame(text, rc=rc, rsp_max=29)
+        try:
+            result = dev.console("?")
+        except mmcframe.FrameError as e:
+            result = e.output if rc != 0 else None
+        if verbose:
+            print(f"console(rc={rc}) = {len(result)} bytes")
+        if result != text.decode('ascii'):
+            print(f"FAIL: console output (rc={rc}) = {result!r}")
+            fails += 1
+    if fails == 0:
+        print("PASS")
+        return 0
+    return 1
+
+
 def do_tests(verbose=False):
     tests = (
         test_getPageAndName,
+        test_build_image,
+        test_console_output,
     )
     rval = 0
     for test in tests:
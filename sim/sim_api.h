@@ -12,9 +12,13 @@ extern "C" {
 #define SIM_FLASH_FILENAME            "flash.bin"
 #define FLASH_SECTOR_SIZE             (256)
 #define EEPROM_COUNT                  ((size_t)FLASH_SECTOR_SIZE/sizeof(ee_frame))
+// Slots in the simulated power-loss log sector
+#define SIM_PMLOG_SLOTS               (8)
 
 int sim_spi_init(void);
+void sim_console_capture(int enable);
 void init_sim_ltm4673(void);
+void init_sim_max6639(void);
 
 // LPC EEPROM driver emulation
 #define EEPROM_PAGE_SIZE (64)
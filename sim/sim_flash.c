@@ -9,6 +9,7 @@
 #include "sim_api.h"
 #include "flash.h"
 #include "eeprom.h"
+#include "pmlog.h"
 
 //#define DEBUG_PRINT
 #include "dbg.h"
@@ -19,6 +20,7 @@ static int store_flash(void);
 size_t eeprom_count = EEPROM_COUNT;
 ee_frame eeprom0_base[EEPROM_COUNT];
 ee_frame eeprom1_base[EEPROM_COUNT];
+pmlog_record_t pmlog_base[SIM_PMLOG_SLOTS];
 
 bool need_flush = false;
 
@@ -40,6 +42,8 @@ int fmc_flash_erase_sector(unsigned sectorn)
     memset(eeprom0_base, 0xff, sizeof(eeprom0_base));
   } else if(sectorn==2) {
     memset(eeprom1_base, 0xff, sizeof(eeprom1_base));
+  } else if(sectorn==3) {
+    memset(pmlog_base, 0xff, sizeof(pmlog_base));
   } else {
     return -1;
   }
@@ -66,6 +70,8 @@ static int store_flash(void) {
   size_t rval = fwrite((const void *)eeprom0_base, sizeof(ee_frame), EEPROM_COUNT, pFile);
   // Then eeprom1
   rval += fwrite((const void *)eeprom1_base, sizeof(ee_frame), EEPROM_COUNT, pFile);
+  // Then the power-loss log
+  rval += fwrite((const void *)pmlog_base, sizeof(pmlog_record_t), SIM_PMLOG_SLOTS, pFile);
   fclose(pFile);
   //printf("Num writes = %ld\r\n", rval);
   return 0;
@@ -76,6 +82,7 @@ int restore_flash(void) {
   FILE *pFile = fopen(SIM_FLASH_FILENAME, "rb");
   if (!pFile) {
     printf("Cannot open %s for reading.\r\n", SIM_FLASH_FILENAME);
+    memset(pmlog_base, 0xff, sizeof(pmlog_base));
     return -1;
   }
   // Read by ee_frame
@@ -83,6 +90,9 @@ int restore_flash(void) {
   size_t rval = fread((void *)eeprom0_base, sizeof(ee_frame), EEPROM_COUNT, pFile);
   // Then eeprom1
   rval += fread((void *)eeprom1_base, sizeof(ee_frame), EEPROM_COUNT, pFile);
+  // Then the power-loss log (erased if missing from an older file)
+  size_t nlog = fread((void *)pmlog_base, sizeof(pmlog_record_t), SIM_PMLOG_SLOTS, pFile);
+  memset(&pmlog_base[nlog], 0xff, (SIM_PMLOG_SLOTS - nlog)*sizeof(pmlog_record_t));
   fclose(pFile);
   //printf("Num reads = %ld\r\n", rval);
   return 0;
@@ -6,12 +6,18 @@
 #include "sim_api.h"
 #include "i2c_pm.h"
 #include "ltm4673.h"
+#include "max6639.h"
+#include "pmbus.h"
+#include "busprof.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
 
 I2C_BUS I2C_PM = 0;
 I2C_BUS I2C_FPGA = 1;
 
 #define NREGS     (0x100)
+#define SIM_BLOCK_SIZE  (255)
 typedef struct {
   uint32_t *page0;
   uint32_t *page1;
@@ -93,14 +99,30 @@ uint32_t _page3[] = {
 };
 
 static four_page_periph_t ltm4673 = {_page0, _page1, _page2, _page3};
+
+// MAX6639 register file; 40.125 and 50.250 degC on channels 1 and 2
+static uint8_t max6639_regs[0x40] = {
+  [MAX6639_TEMP_CH1] = 0x28, [MAX6639_TEMP_CH2] = 0x32,
+  [MAX6639_TEMP_EXT_CH1] = 0x20, [MAX6639_TEMP_EXT_CH2] = 0x40,
+  [MAX6639_FAN1_PULSE_PER_REV] = 0x40, [MAX6639_FAN2_PULSE_PER_REV] = 0x40,
+  [MAX6639_DEV_ID] = 0x58, [MAX6639_MFG_ID] = 0x4d,
+};
+static uint8_t max6639_pointer = 0;
+// SMBALERT, raised by SIGUSR1
+static volatile sig_atomic_t sim_smbalert = 0;
+static int max6639_autoinc = 1;
 static uint8_t ltm4673_addrs[] = {0xb8, 0xba, 0xbc, 0xbe, 0xc0, 0xc2, 0xc4, 0xc6, 0xc8};
 #define LTM4673_MATCH_ADDRS     (sizeof(ltm4673_addrs)/sizeof(uint8_t))
 
 static int i2c_emu(I2C_BUS I2C_bus, uint8_t addr, uint8_t rnw,
                     int cmd, uint8_t *data, int len);
+static int i2c_emu_reg_size(int reg);
+static int i2c_emu_pec(uint8_t addr, uint8_t rnw, int cmd, uint8_t *data, int len);
 static int i2c_emu_ltm4673(uint8_t rnw, int reg, uint8_t *data, int len);
+static int i2c_emu_max6639(uint8_t rnw, int cmd, uint8_t *data, int len);
 static void init_sim_ltm4673_telem(void);
 static void init_sim_ltm4673_config(void);
+static void sim_smbalert_handler(int sig);
 
 /* static int i2c_emu(I2C_BUS I2C_bus, uint8_t addr, uint8_t rnw,
  *                     int cmd, uint8_t *data, int len);
@@ -119,6 +141,9 @@ static int i2c_emu(I2C_BUS I2C_bus, uint8_t addr, uint8_t rnw,
   if (I2C_bus != I2C_PM) {
     return 1;
   }
+  if (addr == MAX6639) {
+    return i2c_emu_max6639(rnw, cmd, data, len);
+  }
   for (unsigned int n = 0; n < LTM4673_MATCH_ADDRS; n++) {
     if (addr == ltm4673_addrs[n]) {
       matched = 1;
@@ -132,6 +157,73 @@ static int i2c_emu(I2C_BUS I2C_bus, uint8_t addr, uint8_t rnw,
     ltm4673_hook_write(addr, cmd, data, len);
   }
   // Device emulator hooks
+  return i2c_emu_pec(addr, rnw, cmd, data, len);
+}
+
+/* static int i2c_emu_max6639(uint8_t rnw, int cmd, uint8_t *data, int len);
+ *  Multi-byte transfers address consecutive registers unless the register
+ *  pointer auto-increment is disabled with SIM_MAX6639_NO_AUTOINC in the
+ *  environment, in which case every byte goes to the same register.
+ */
+static int i2c_emu_max6639(uint8_t rnw, int cmd, uint8_t *data, int len) {
+  if (cmd >= 0) {
+    max6639_pointer = (uint8_t)cmd;
+  } else if (!rnw && (len > 0)) {
+    // Register pointer in the first byte
+    max6639_pointer = data[0];
+    data++;
+    len--;
+  }
+  for (int n = 0; n < len; n++) {
+    uint8_t reg = max6639_pointer & (sizeof(max6639_regs)-1);
+    if (rnw) {
+      data[n] = max6639_regs[reg];
+    } else {
+      max6639_regs[reg] = data[n];
+    }
+    if (max6639_autoinc) {
+      max6639_pointer++;
+    }
+  }
+  return 0;
+}
+
+/* static int i2c_emu_reg_size(int reg);
+ *  Width of LTM4673 register 'reg' (byte commands per scripts/ltm4673.py).
+ */
+static int i2c_emu_reg_size(int reg) {
+  static const uint8_t byte_cmds[] = {
+    0x00, 0x01, 0x02, 0x10, 0x19, 0x20, 0x41, 0x45, 0x47, 0x4c, 0x50, 0x54, 0x56,
+    0x5a, 0x63, 0x78, 0x7a, 0x7b, 0x7c, 0x7d, 0x7e, 0x80, 0x98, 0xbd, 0xbe, 0xc1,
+    0xc2, 0xd2, 0xd3, 0xd5, 0xd6, 0xd9, 0xda, 0xe4, 0xe6, 0xed, 0xef, 0xf7
+  };
+  for (unsigned int n = 0; n < sizeof(byte_cmds); n++) {
+    if (reg == byte_cmds[n]) {
+      return 1;
+    }
+  }
+  return 2;
+}
+
+/* static int i2c_emu_pec(uint8_t addr, uint8_t rnw, int cmd, uint8_t *data, int len);
+ *  Rough PMBus PEC emulation around i2c_emu_ltm4673().  A read one byte
+ *  longer than the register is answered with a PEC, and a write whose last
+ *  byte is a valid PEC is taken to carry one.
+ */
+static int i2c_emu_pec(uint8_t addr, uint8_t rnw, int cmd, uint8_t *data, int len) {
+  uint8_t hdr[3] = {addr & 0xfe, (uint8_t)(cmd & 0xff), addr | 1};
+  if ((cmd < 0) || (len < 2)) {
+    return i2c_emu_ltm4673(rnw, cmd, data, len);
+  }
+  int size = i2c_emu_reg_size(cmd);
+  if (rnw && (len == size + 1)) {
+    int rc = i2c_emu_ltm4673(rnw, cmd, data, size);
+    data[size] = pmbus_pec(pmbus_pec(0, hdr, 3), data, size);
+    return rc;
+  }
+  if (!rnw && (data[len-1] == pmbus_pec(pmbus_pec(0, hdr, 2), data, len-1))) {
+    return i2c_emu_ltm4673(rnw, cmd, data, len-1);
+  }
   return i2c_emu_ltm4673(rnw, cmd, data, len);
 }
 
@@ -155,6 +247,13 @@ static int i2c_emu_ltm4673(uint8_t rnw, int reg, uint8_t *data, int len) {
       ppage = ltm4673.page0;
       break;
   }
+  if (rnw && (reg == LTM4673_MFR_FAULT_LOG)) {
+    // Block read: byte count followed by a ramp (worst-case length)
+    for (int n = 0; n < len; n++) {
+      data[n] = n == 0 ? SIM_BLOCK_SIZE : (uint8_t)(n-1);
+    }
+    return 0;
+  }
   if (rnw) {
     regval = ppage[(uint8_t)(reg & 0xff)];
     //printf("Reading from page %d, reg 0x%x = 0x%x\r\n", page, reg, regval);
@@ -191,32 +290,48 @@ static int i2c_emu_ltm4673(uint8_t rnw, int reg, uint8_t *data, int len) {
   return 0;
 }
 
+/*
+ * static int i2c_emu_prof(I2C_BUS I2C_bus, uint8_t addr, uint8_t rnw,
+ *                         int cmd, int ncmd, uint8_t *data, int len);
+ *  i2c_emu() accounted in the bus-occupancy profiler; 'ncmd' is the number
+ *  of command bytes.
+ */
+static int i2c_emu_prof(I2C_BUS I2C_bus, uint8_t addr, uint8_t rnw,
+                        int cmd, int ncmd, uint8_t *data, int len)
+{
+  uint32_t t0 = marble_get_us();
+  int rc = i2c_emu(I2C_bus, addr, rnw, cmd, data, len);
+  busprof_record(I2C_bus == I2C_PM ? BUSPROF_I2C_PM : BUSPROF_I2C_FPGA, addr, ncmd + len,
+                 rc ? BUSPROF_ERROR : BUSPROF_OK, t0);
+  return rc;
+}
+
 int marble_I2C_probe(I2C_BUS I2C_bus, uint8_t addr) {
   return 0;
 }
 
 int marble_I2C_send(I2C_BUS I2C_bus, uint8_t addr, const uint8_t *data, int size) {
-  return i2c_emu(I2C_bus, addr, 0, -1, (uint8_t *)data, size);
+  return i2c_emu_prof(I2C_bus, addr, 0, -1, 0, (uint8_t *)data, size);
 }
 
 int marble_I2C_cmdsend(I2C_BUS I2C_bus, uint8_t addr, uint8_t cmd, const uint8_t *data, int size) {
-  return i2c_emu(I2C_bus, addr, 0, cmd, (uint8_t *)data, size);
+  return i2c_emu_prof(I2C_bus, addr, 0, cmd, 1, (uint8_t *)data, size);
 }
 
 int marble_I2C_recv(I2C_BUS I2C_bus, uint8_t addr, uint8_t *data, int size) {
-  return i2c_emu(I2C_bus, addr, 1, 0, data, size);
+  return i2c_emu_prof(I2C_bus, addr, 1, 0, 0, data, size);
 }
 
 int marble_I2C_cmdrecv(I2C_BUS I2C_bus, uint8_t addr, uint8_t cmd, uint8_t *data, int size) {
-  return i2c_emu(I2C_bus, addr, 1, cmd, data, size);
+  return i2c_emu_prof(I2C_bus, addr, 1, cmd, 1, data, size);
 }
 
 int marble_I2C_cmdsend_a2(I2C_BUS I2C_bus, uint8_t addr, uint16_t cmd, const uint8_t *data, int size) {
-  return i2c_emu(I2C_bus, addr, 0, cmd, (uint8_t *)data, size);
+  return i2c_emu_prof(I2C_bus, addr, 0, cmd, 2, (uint8_t *)data, size);
 }
 
 int marble_I2C_cmdrecv_a2(I2C_BUS I2C_bus, uint8_t addr, uint16_t cmd, uint8_t *data, int size) {
-  return i2c_emu(I2C_bus, addr, 1, cmd, data, size);
+  return i2c_emu_prof(I2C_bus, addr, 1, cmd, 2, data, size);
 }
 
 int getI2CBusStatus(void) {
@@ -227,9 +342,47 @@ void resetI2CBusStatus(void) {
   return;
 }
 
+int marble_I2C_recover(I2C_BUS I2C_bus) {
+  // Emulated buses never get stuck
+  return 0;
+}
+
+int marble_I2C_get_recovery(I2C_BUS I2C_bus, marble_I2C_recovery_t *stats) {
+  stats->recoveries = 0;
+  stats->failures = 0;
+  return 0;
+}
+
+int marble_I2C_PM_get_alert(void) {
+  return sim_smbalert;
+}
+
+void marble_I2C_PM_clear_alert(void) {
+  sim_smbalert = 0;
+  return;
+}
+
+int marble_I2C_PM_alert_asserted(void) {
+  return 0;
+}
+
 void init_sim_ltm4673(void) {
   if (0) init_sim_ltm4673_config();
   init_sim_ltm4673_telem();
+  signal(SIGUSR1, sim_smbalert_handler);
+  return;
+}
+
+/* static void sim_smbalert_handler(int sig);
+ *  'kill -USR1' the simulator to signal an LTM4673 fault on SMBALERT.
+ */
+static void sim_smbalert_handler(int sig) {
+  sim_smbalert = 1;
+  return;
+}
+
+void init_sim_max6639(void) {
+  max6639_autoinc = getenv("SIM_MAX6639_NO_AUTOINC") ? 0 : 1;
   return;
 }
 
@@ -8,15 +8,20 @@
 #include <stdio.h>
 #include <signal.h>
 #include <sys/time.h> // Needed for struct timeval
+#include <time.h>     // For clock_gettime()
 #include <unistd.h>   // For STDIN_FILENO
 #include <stdlib.h>   // For posix_openpt et al
 #include <fcntl.h>    // For fcntl()
 #include "marble_api.h"
 #include "console.h"
 #include "uart_fifo.h"
+#include "uart_frame.h"
 #include "eeprom.h"
 #include "sim_api.h"
 #include "sim_lass.h"
+#include "prof.h"
+#include "event.h"
+#include "i2c_shadow.h"
 
 /*
  * On the simulated platform, the "UART" console process will be the following:
@@ -51,10 +56,13 @@ static void (*volatile marble_SysTick_Handler)(void) = dummy_handler;
 static uint32_t sim_systick_period_ms = 1;
 static int fpga_resets = 0;
 static int fpga_enabled = 1;
+static void (*oneshot_callbacks[MARBLE_ONESHOT_SLOTS])(void);
+static uint32_t oneshot_deadlines[MARBLE_ONESHOT_SLOTS];
 
 // Static Prototypes
 static int shiftMessage(void);
 static void _sigHandler(int c);
+static void oneshot_service(void);
 
 void disable_all_IRQs(void) {
   return;
@@ -70,6 +78,7 @@ uint32_t marble_init(void) {
   sim_console_state.toExit = 0;
   sim_console_state.msgReady = 0;
   init_sim_ltm4673();
+  init_sim_max6639();
   if (lass_init(MAILBOX_PORT) < 0) {
     return 1;
   }
@@ -79,6 +88,7 @@ uint32_t marble_init(void) {
 }
 
 void board_init(void) {
+  i2c_shadow_invalidate();
   return;
 }
 
@@ -104,8 +114,8 @@ int board_service(void) {
     console_pend_msg();
     sim_console_state.msgReady = 0;
   }
-  // If char queue not empty
-  if (UARTTXQUEUE_Get(&outByte) != UARTTX_QUEUE_EMPTY) {
+  // Drain the char queue; the main loop may sleep until the next call
+  while (UARTTXQUEUE_Get(&outByte) != UARTTX_QUEUE_EMPTY) {
     putchar((char)outByte);
   }
   // If enough time has elapsed, simulate the FPGA_DONE signal arrival
@@ -123,10 +133,17 @@ int board_service(void) {
   }
   if (now - _systickIrqTimeStart >= sim_systick_period_ms) {
     //printf("now-start = %d\r\n", now - _systickIrqTimeStart);
+    uint32_t t0 = marble_get_cycles();
     marble_SysTick_Handler();
+    prof_end(PROF_ISR_SYSTICK, t0);
     _systickIrqTimeStart = now;
   }
+  oneshot_service();
   lass_service();
+  // The simulated FPGA_INT follows the DOORBELL mask
+  if (marble_FPGAint_get_doorbell()) {
+    event_post(EVENT_DOORBELL);
+  }
 
   // Keep the system responsive, but don't hog resources
   sleep(BOARD_SERVICE_SLEEP_MS/1000);
@@ -158,10 +175,16 @@ static int shiftMessage(void) {
   if (rval) {
     while (n--) {
       ri = fgetc(stdin);
-      if ((ri == EOF) || (ri == 0)) {
+      if (ri == EOF) {
         break;
       }
       rc = (char)(ri & 0xff);
+      if (frame_rx_byte((uint8_t)rc)) {
+        continue;
+      }
+      if (ri == 0) {
+        break;
+      }
       UARTQUEUE_Add((uint8_t *)&rc);
       if (rc == UART_MSG_TERMINATOR) {
         sim_console_state.msgReady = 1;
@@ -198,6 +221,38 @@ void marble_UART_init(void) {
   return;
 }
 
+/* void sim_console_capture(int enable);
+ *  On the host printf() goes straight to stdout rather than through
+ *  __io_putchar(), so console_run() swaps stdout for a memory stream while
+ *  a command runs and hands what it printed to console_capture().
+ */
+void sim_console_capture(int enable) {
+  static FILE *saved = NULL;
+  static char *buf = NULL;
+  static size_t size = 0;
+  if (enable) {
+    FILE *fd = (saved == NULL) ? open_memstream(&buf, &size) : NULL;
+    if (fd != NULL) {
+      saved = stdout;
+      stdout = fd;
+    }
+    return;
+  }
+  if (saved == NULL) {
+    return;
+  }
+  fclose(stdout);
+  stdout = saved;
+  saved = NULL;
+  for (size_t n = 0; n < size; n++) {
+    console_capture(buf[n]);
+  }
+  free(buf);
+  buf = NULL;
+  size = 0;
+  return;
+}
+
 /*
 int marble_UART_send(const char *str, int size) {
 #ifdef DEBUG_TX_OUT
@@ -337,7 +392,45 @@ void marble_SLEEP_ms(uint32_t delay) {
 }
 
 void marble_SLEEP_us(uint32_t delay) {
-  // TODO - Implement sleep function?
+  uint32_t t0 = marble_get_us();
+  while ((uint32_t)(marble_get_us() - t0) <= delay) {}
+  return;
+}
+
+int marble_oneshot_us(uint32_t delay, void (*callback)(void)) {
+  if (callback == NULL) {
+    return -1;
+  }
+  for (int slot = 0; slot < MARBLE_ONESHOT_SLOTS; slot++) {
+    if (oneshot_callbacks[slot] == NULL) {
+      oneshot_deadlines[slot] = marble_get_us() + delay;
+      oneshot_callbacks[slot] = callback;
+      return slot;
+    }
+  }
+  return -1;
+}
+
+void marble_oneshot_cancel(int slot) {
+  if ((slot >= 0) && (slot < MARBLE_ONESHOT_SLOTS)) {
+    oneshot_callbacks[slot] = NULL;
+  }
+  return;
+}
+
+/* static void oneshot_service(void);
+ *  Emulate the one-shot timer interrupt; resolution is one board_service() pass.
+ */
+static void oneshot_service(void) {
+  void (*callback)(void);
+  uint32_t now = marble_get_us();
+  for (int slot = 0; slot < MARBLE_ONESHOT_SLOTS; slot++) {
+    callback = oneshot_callbacks[slot];
+    if ((callback != NULL) && ((int32_t)(now - oneshot_deadlines[slot]) >= 0)) {
+      oneshot_callbacks[slot] = NULL;
+      callback();
+    }
+  }
   return;
 }
 
@@ -345,6 +438,28 @@ uint32_t marble_get_tick(void) {
   return BSP_GET_SYSTICK();
 }
 
+uint32_t marble_get_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)((uint64_t)ts.tv_sec*1000000 + (uint64_t)ts.tv_nsec/1000);
+}
+
+uint32_t marble_get_cycles(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)((uint64_t)ts.tv_sec*1000000000 + (uint64_t)ts.tv_nsec);
+}
+
+uint32_t marble_cycles_per_us(void) {
+  return 1000;
+}
+
+// Simulated interrupts are raised from board_service(); just yield the host
+void marble_wait_for_interrupt(void) {
+  usleep(1000);
+  return;
+}
+
 uint8_t fsynthGetAddr(void) {
   return 0;
 }
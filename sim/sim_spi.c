@@ -8,6 +8,8 @@
 #include "sim_lass.h"
 #include "sim_api.h"
 #include "marble_api.h"
+#include "mailbox_def.h"
+#include "busprof.h"
 #include "dbg.h"
 
 typedef void *SSP_PORT;
@@ -23,6 +25,10 @@ static unsigned int npage = 0;
 // GLOBALS
 SSP_PORT SSP_FPGA;
 
+static int sim_SSP_write16(SSP_PORT ssp, uint16_t *buffer, unsigned size);
+static int sim_SSP_read16(SSP_PORT ssp, uint16_t *buffer, unsigned size);
+static int sim_SSP_exch16(SSP_PORT ssp, uint16_t *tx_buf, uint16_t *rx_buf, unsigned size);
+
 int sim_spi_init(void) {
   // Build LASS memory map
   int rval = lass_mem_add(MAILBOX_BASE, MAILBOX_SIZE, (void *)mailbox, ACCESS_BYTES);
@@ -34,7 +40,7 @@ int sim_spi_init(void) {
   return rval;
 }
 
-int marble_SSP_write16(SSP_PORT ssp, uint16_t *buffer, unsigned size) {
+static int sim_SSP_write16(SSP_PORT ssp, uint16_t *buffer, unsigned size) {
   if (ssp != SSP_FPGA) {
     return 0;
   }
@@ -48,7 +54,7 @@ int marble_SSP_write16(SSP_PORT ssp, uint16_t *buffer, unsigned size) {
   return 0;
 }
 
-int marble_SSP_read16(SSP_PORT ssp, uint16_t *buffer, unsigned size) {
+static int sim_SSP_read16(SSP_PORT ssp, uint16_t *buffer, unsigned size) {
   // Unused in application as of writing
   if (ssp != SSP_FPGA) {
     return 0;
@@ -60,7 +66,28 @@ int marble_SSP_read16(SSP_PORT ssp, uint16_t *buffer, unsigned size) {
   return 0;
 }
 
-int marble_SSP_exch16(SSP_PORT ssp, uint16_t *tx_buf, uint16_t *rx_buf, unsigned size) {
+/* int marble_FPGAint_get_doorbell(void);
+ *  The simulated FPGA rings the doorbell whenever the DOORBELL mask (written
+ *  via LASS) is non-zero; the MMC clears the mask when it services it.
+ */
+int marble_FPGAint_get_doorbell(void) {
+#ifdef MBOX_DOORBELL_PAGE
+  for (int n = 0; n < 4; n++) {
+    if (mailbox[MBOX_DOORBELL_PAGE][n]) {
+      return 1;
+    }
+  }
+  return 0;
+#else
+  return 0;
+#endif
+}
+
+void marble_FPGAint_clear_doorbell(void) {
+  return;
+}
+
+static int sim_SSP_exch16(SSP_PORT ssp, uint16_t *tx_buf, uint16_t *rx_buf, unsigned size) {
   if (ssp != SSP_FPGA) {
     return 0;
   }
@@ -70,3 +97,25 @@ int marble_SSP_exch16(SSP_PORT ssp, uint16_t *tx_buf, uint16_t *rx_buf, unsigned
   }
   return 0;
 }
+
+/* The marble_SSP_* wrappers are accounted in the bus-occupancy profiler */
+int marble_SSP_write16(SSP_PORT ssp, uint16_t *buffer, unsigned size) {
+  uint32_t t0 = marble_get_us();
+  int rc = sim_SSP_write16(ssp, buffer, size);
+  busprof_record(BUSPROF_SSP_FPGA, 0, 2*size, rc ? BUSPROF_ERROR : BUSPROF_OK, t0);
+  return rc;
+}
+
+int marble_SSP_read16(SSP_PORT ssp, uint16_t *buffer, unsigned size) {
+  uint32_t t0 = marble_get_us();
+  int rc = sim_SSP_read16(ssp, buffer, size);
+  busprof_record(BUSPROF_SSP_FPGA, 0, 2*size, rc ? BUSPROF_ERROR : BUSPROF_OK, t0);
+  return rc;
+}
+
+int marble_SSP_exch16(SSP_PORT ssp, uint16_t *tx_buf, uint16_t *rx_buf, unsigned size) {
+  uint32_t t0 = marble_get_us();
+  int rc = sim_SSP_exch16(ssp, tx_buf, rx_buf, size);
+  busprof_record(BUSPROF_SSP_FPGA, 0, 2*size, rc ? BUSPROF_ERROR : BUSPROF_OK, t0);
+  return rc;
+}
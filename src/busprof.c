@@ -0,0 +1,204 @@
+/*
+ * File: busprof.c
+ * Desc: Bus-occupancy profiler.  See busprof.h.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "busprof.h"
+#include "marble_api.h"
+#include "report.h"
+
+static busprof_entry_t _table[BUSPROF_TABLE_SIZE];
+static unsigned int _entries = 0;
+static unsigned int _last = 0;        // Most recently hit entry
+static uint32_t _overflow = 0;
+static uint32_t _reset_tick = 0;
+static uint8_t _mbox_sel = 0;
+
+static const char *busprof_bus_name(uint8_t bus);
+static busprof_entry_t *busprof_find(busprof_bus_t bus, uint8_t addr);
+
+static const char *busprof_bus_name(uint8_t bus) {
+  switch (bus) {
+    case BUSPROF_I2C_PM:
+      return "I2C_PM";
+    case BUSPROF_I2C_FPGA:
+      return "I2C_FPGA";
+    case BUSPROF_I2C_IPMB:
+      return "I2C_IPMB";
+    case BUSPROF_SSP_FPGA:
+      return "SSP_FPGA";
+    case BUSPROF_SSP_PMOD:
+      return "SSP_PMOD";
+    default:
+      break;
+  }
+  return "?";
+}
+
+/*
+ * static busprof_entry_t *busprof_find(busprof_bus_t bus, uint8_t addr);
+ *  Return the entry for (bus, addr), adding it if there is room.
+ *  Consecutive transactions mostly go to the same device, so the last
+ *  entry hit is tried first.
+ */
+static busprof_entry_t *busprof_find(busprof_bus_t bus, uint8_t addr) {
+  busprof_entry_t *entry = &_table[_last];
+  if ((_last < _entries) && (entry->bus == bus) && (entry->addr == addr)) {
+    return entry;
+  }
+  for (unsigned int n = 0; n < _entries; n++) {
+    if ((_table[n].bus == bus) && (_table[n].addr == addr)) {
+      _last = n;
+      return &_table[n];
+    }
+  }
+  if (_entries >= BUSPROF_TABLE_SIZE) {
+    return NULL;
+  }
+  _last = _entries++;
+  entry = &_table[_last];
+  memset(entry, 0, sizeof(busprof_entry_t));
+  entry->bus = (uint8_t)bus;
+  entry->addr = addr;
+  return entry;
+}
+
+void busprof_record(busprof_bus_t bus, uint8_t addr, int nbytes, busprof_status_t status, uint32_t t0) {
+  uint32_t dt = marble_get_us() - t0;
+  busprof_entry_t *entry = busprof_find(bus, addr);
+  if (entry == NULL) {
+    _overflow++;
+    return;
+  }
+  entry->count++;
+  entry->bytes += nbytes > 0 ? (uint32_t)nbytes : 0;
+  entry->us += dt;
+  if (dt > entry->max_us) {
+    entry->max_us = dt;
+  }
+  if ((status == BUSPROF_TIMEOUT) && (entry->timeouts < 0xffff)) {
+    entry->timeouts++;
+  } else if ((status == BUSPROF_ERROR) && (entry->errors < 0xffff)) {
+    entry->errors++;
+  }
+  return;
+}
+
+const busprof_entry_t *busprof_get(unsigned int n) {
+  return n < _entries ? &_table[n] : NULL;
+}
+
+int busprof_count(void) {
+  return (int)_entries;
+}
+
+uint32_t busprof_elapsed_ms(void) {
+  return marble_get_tick() - _reset_tick;
+}
+
+void busprof_reset(void) {
+  _entries = 0;
+  _last = 0;
+  _overflow = 0;
+  _reset_tick = marble_get_tick();
+  return;
+}
+
+void busprof_print(void) {
+  uint32_t elapsed = busprof_elapsed_ms();
+  const busprof_entry_t *entry;
+  if (report_structured()) {
+    report_begin("busprof");
+    report_uint("elapsed_ms", elapsed);
+    report_uint("entries", _entries);
+    report_uint("overflow", _overflow);
+    report_end();
+  } else {
+    printf("Bus occupancy over the last %lu ms (%u entries, %lu untracked)\r\n",
+           (unsigned long)elapsed, _entries, (unsigned long)_overflow);
+    printf("bus       addr  count      bytes      errors timeouts us         max_us   share\r\n");
+  }
+  for (unsigned int n = 0; n < _entries; n++) {
+    entry = &_table[n];
+    // Share of the elapsed time in units of 0.01%
+    uint32_t share = elapsed > 0 ? (uint32_t)(((uint64_t)entry->us*10)/elapsed) : 0;
+    if (report_structured()) {
+      report_begin("busprof_entry");
+      report_str("bus", busprof_bus_name(entry->bus));
+      report_uint("addr", entry->addr);
+      report_uint("count", entry->count);
+      report_uint("bytes", entry->bytes);
+      report_uint("errors", entry->errors);
+      report_uint("timeouts", entry->timeouts);
+      report_uint("us", entry->us);
+      report_uint("max_us", entry->max_us);
+      report_end();
+      continue;
+    }
+    printf("%-9s 0x%02x  %-10lu %-10lu %-6u %-8u %-10lu %-8lu %lu.%02lu%%\r\n",
+           busprof_bus_name(entry->bus), entry->addr, (unsigned long)entry->count,
+           (unsigned long)entry->bytes, entry->errors, entry->timeouts,
+           (unsigned long)entry->us, (unsigned long)entry->max_us,
+           (unsigned long)(share/100), (unsigned long)(share % 100));
+  }
+  return;
+}
+
+/* void busprof_mbox_select(uint8_t n);
+ *  Mailbox input.  BUSPROF_SEL_RESET clears the table; any other value
+ *  selects the entry shown on the mailbox.
+ */
+void busprof_mbox_select(uint8_t n) {
+  if (n == BUSPROF_SEL_RESET) {
+    busprof_reset();
+    n = 0;
+  }
+  _mbox_sel = n;
+  return;
+}
+
+uint8_t busprof_mbox_selected(void) {
+  return _mbox_sel;
+}
+
+uint8_t busprof_mbox_bus(void) {
+  const busprof_entry_t *entry = busprof_get(_mbox_sel);
+  return entry ? entry->bus : 0xff;
+}
+
+uint8_t busprof_mbox_addr(void) {
+  const busprof_entry_t *entry = busprof_get(_mbox_sel);
+  return entry ? entry->addr : 0;
+}
+
+uint16_t busprof_mbox_errors(void) {
+  const busprof_entry_t *entry = busprof_get(_mbox_sel);
+  return entry ? entry->errors : 0;
+}
+
+uint16_t busprof_mbox_timeouts(void) {
+  const busprof_entry_t *entry = busprof_get(_mbox_sel);
+  return entry ? entry->timeouts : 0;
+}
+
+uint32_t busprof_mbox_count(void) {
+  const busprof_entry_t *entry = busprof_get(_mbox_sel);
+  return entry ? entry->count : 0;
+}
+
+uint32_t busprof_mbox_bytes(void) {
+  const busprof_entry_t *entry = busprof_get(_mbox_sel);
+  return entry ? entry->bytes : 0;
+}
+
+uint32_t busprof_mbox_us(void) {
+  const busprof_entry_t *entry = busprof_get(_mbox_sel);
+  return entry ? entry->us : 0;
+}
+
+uint32_t busprof_mbox_max_us(void) {
+  const busprof_entry_t *entry = busprof_get(_mbox_sel);
+  return entry ? entry->max_us : 0;
+}
@@ -19,6 +19,17 @@
 #include "eeprom.h"
 #include "ltm4673.h"
 #include "watchdog.h"
+#include "report.h"
+#include "uart_frame.h"
+#include "pmlog.h"
+#include "busprof.h"
+#include "i2c_shadow.h"
+#include "prof.h"
+#include "event.h"
+#include "fanctl.h"
+#ifdef SIMULATION
+#include "sim_api.h"
+#endif
 
 #define AUTOPUSH
 // TODO - Put this in a better place
@@ -75,20 +86,39 @@ const char *menu_str[] = {"\r\n",
   "s addr_hex freq_hz config_hex - Set Si570 configuration\r\n",
 #endif
 #ifdef APP_MARBLE
-  "t pmbus_msg - Forward PMBus transaction to LTM4673\r\n",
+  "t pmbus_msg [, pmbus_msg ...] - Forward PMBus transaction(s) to LTM4673\r\n",
 #endif
   "u period - Set/get watchdog timeout period (in seconds)\r\n",
   "v key - Set a new 128-bit secret key (non-volatile, write only).\r\n",
   "w enable - Set fan tachometer enable/disable (1/0, on/off)\r\n",
   "x mode - Set MMC Pmod usage mode\r\n",
+  "y format - Set report output format (0=text, 1=key=value, 2=JSON)\r\n",
+#ifdef APP_MARBLE
+  "z [N] - Show power supply faults (SMBALERT) and N power-loss events; 0 clears both\r\n",
+#endif
+  "B [0] - Show I2C/SPI bus occupancy; 0 clears it\r\n",
+  "F [en [setpoint kp ki min max slew]] - Show/set closed-loop fan control\r\n",
+  "P [0] - Show main-loop/ISR execution-time profile; 0 clears it\r\n",
+  "cmd;cmd;... - Run several commands from one line\r\n",
+  "@seq cmd - Run command quietly; reply '@seq OK' or '@seq ERR code'\r\n",
 };
 #define MENU_LEN (sizeof(menu_str)/sizeof(*menu_str))
 
 static uint8_t _msgCount;
 static uint8_t _fpgaEnable;
+static uint8_t _quiet;
+// Output of the last command run by console_run()
+static uint8_t _capturing;
+static uint8_t _capture[CONSOLE_CAPTURE_SIZE];
+static unsigned int _capture_len;
+
+extern I2C_BUS I2C_PM;
+extern I2C_BUS I2C_FPGA;
 
 // TODO - find a better home for these
 static int console_handle_msg(char *rx_msg, int len);
+static int console_handle_batch(char *rx_msg, int len);
+static int console_handle_tagged(char *rx_msg, int len);
 //static int console_shift_all(uint8_t *pData);
 static int console_shift_msg(uint8_t *pData);
 static void ina219_test(void);
@@ -105,6 +135,11 @@ static int handle_msg_key(const char *rx_msg, int len);
 static int handle_mailbox_enable(const char *rx_msg, int len);
 static int handle_tach_enable(const char *rx_msg, int len);
 static int handle_pmod_mode(const char *rx_msg, int len);
+static int handle_report_mode(const char *rx_msg, int len);
+static int handle_msg_busprof(const char *rx_msg, int len);
+static void print_i2c_recovery(void);
+static int handle_msg_prof(const char *rx_msg, int len);
+static int handle_msg_fanctl(const char *rx_msg, int len);
 //static void print_mac_ip(mac_ip_data_t *pmac_ip_data);
 static void print_mac(uint8_t *pdata);
 static void print_ip(uint8_t *pdata);
@@ -127,6 +162,7 @@ static int handle_msg_fsynth(const char *s, int len);
 static void console_print_fsynth(void);
 static int handle_msg_pmbridge(const char *s, int len);
 static int PMBridgeConsumeArg(const char *s, int len, volatile int *arg);
+static int handle_msg_faults(const char *rx_msg, int len);
 #endif
 static int xatoi(char c);
 static int htoi(char c);
@@ -135,13 +171,18 @@ static const char *pmod_mode_string(pmod_mode_t mode);
 int console_init(void) {
   _msgCount = 0;
   _fpgaEnable = 0;
+  _quiet = 0;
   return 0;
 }
 
+/*
+ * static int console_handle_msg(char *rx_msg, int len);
+ *  Dispatch a single command based on its first char.
+ *  Returns 0 on success, non-zero on failure (reported in compact acks).
+ */
 static int console_handle_msg(char *rx_msg, int len)
 {
-  // TODO all these should return 0 on success, 1 on failure
-  //      then we should print a simple global help string on failure
+  int rval = 0;
   // Switch behavior based on first char
   switch (*rx_msg) {
         case '?':
@@ -153,7 +194,7 @@ static int console_handle_msg(char *rx_msg, int len)
            marble_print_pcb_rev();
            break;
         case '1':
-           handle_mdio_phy_print(rx_msg, len);
+           rval = handle_mdio_phy_print(rx_msg, len);
            break;
         case '2':
            I2C_PM_probe();
@@ -170,7 +211,7 @@ static int console_handle_msg(char *rx_msg, int len)
            break;
         case '6':
            console_print_mac_ip();
-           console_push_fpga_mac_ip();
+           rval = console_push_fpga_mac_ip();
            printf("DONE\r\n");
            break;
         case '7':
@@ -212,6 +253,7 @@ static int console_handle_msg(char *rx_msg, int len)
 #ifdef APP_MINI
         case 'f':
            printf("XRP flash\r\n");
+           // Starts programming in the background; while busy, prints progress
            xrp_flash(XRP7724);
            break;
 #endif
@@ -221,7 +263,7 @@ static int console_handle_msg(char *rx_msg, int len)
            break;
 #ifdef APP_MARBLE
         case 'h':
-           handle_msg_MGTMUX(rx_msg, len);
+           rval = handle_msg_MGTMUX(rx_msg, len);
            break;
 #endif
         case 'i':
@@ -241,10 +283,10 @@ static int console_handle_msg(char *rx_msg, int len)
            pca9555_config();
            break;
         case 'm':
-           handle_msg_IP(rx_msg, len);
+           rval = handle_msg_IP(rx_msg, len);
            break;
         case 'n':
-           handle_msg_MAC(rx_msg, len);
+           rval = handle_msg_MAC(rx_msg, len);
            break;
 #ifdef APP_MARBLE
         case 'o':
@@ -252,41 +294,188 @@ static int console_handle_msg(char *rx_msg, int len)
            break;
 #endif
         case 'p':
-           handle_msg_fan_speed(rx_msg, len);
+           rval = handle_msg_fan_speed(rx_msg, len);
            break;
         case 'q':
-           handle_msg_overtemp(rx_msg, len);
+           rval = handle_msg_overtemp(rx_msg, len);
            break;
         case 'r':
-           handle_mailbox_enable(rx_msg, len);
+           rval = handle_mailbox_enable(rx_msg, len);
            break;
 #ifdef APP_MARBLE
         case 's':
-           handle_msg_fsynth(rx_msg, len);
+           rval = handle_msg_fsynth(rx_msg, len);
            break;
 #endif
 #ifdef APP_MARBLE
         case 't':
-           handle_msg_pmbridge(rx_msg, len);
+           rval = handle_msg_pmbridge(rx_msg, len);
            break;
 #endif
         case 'u':
-           handle_msg_watchdog(rx_msg, len);
+           rval = handle_msg_watchdog(rx_msg, len);
            break;
         case 'v':
-           handle_msg_key(rx_msg, len);
+           rval = handle_msg_key(rx_msg, len);
            break;
         case 'w':
-           handle_tach_enable(rx_msg, len);
+           rval = handle_tach_enable(rx_msg, len);
            break;
         case 'x':
-           handle_pmod_mode(rx_msg, len);
+           rval = handle_pmod_mode(rx_msg, len);
+           break;
+        case 'y':
+           rval = handle_report_mode(rx_msg, len);
+           break;
+#ifdef APP_MARBLE
+        case 'z':
+           rval = handle_msg_faults(rx_msg, len);
+           break;
+#endif
+        case 'B':
+           rval = handle_msg_busprof(rx_msg, len);
+           break;
+        case 'F':
+           rval = handle_msg_fanctl(rx_msg, len);
+           break;
+        case 'P':
+           rval = handle_msg_prof(rx_msg, len);
            break;
         default:
            printf(unk_str);
+           rval = -1;
            break;
      }
-  return 0;
+  return rval;
+}
+
+/*
+ * static int console_handle_batch(char *rx_msg, int len);
+ *  Split a received line at CONSOLE_BATCH_SEPARATOR and dispatch each
+ *  command in order.  Empty commands are skipped.
+ *  Returns the number of commands that failed.
+ */
+static int console_handle_batch(char *rx_msg, int len) {
+  int start = 0;
+  int nfail = 0;
+  int offset;
+  for (int n = 0; n <= len; n++) {
+    if ((n == len) || (rx_msg[n] == CONSOLE_BATCH_SEPARATOR)) {
+      offset = sscanfNonSpace(rx_msg + start, n - start);
+      if (offset >= 0) {
+        start += offset;
+        if (console_handle_tagged(rx_msg + start, n - start)) {
+          nfail++;
+        }
+      }
+      start = n + 1;
+    }
+  }
+  return nfail;
+}
+
+/*
+ * static int console_handle_tagged(char *rx_msg, int len);
+ *  Dispatch one command, which may be prefixed by a sequence tag
+ *  (CONSOLE_SEQ_TAG followed by a decimal number and whitespace).
+ *  Tagged commands run with console output suppressed and answer with a
+ *  single line "@seq OK" or "@seq ERR code" so a host can pipeline them.
+ */
+static int console_handle_tagged(char *rx_msg, int len) {
+  int seq;
+  int index;
+  int rval;
+  if (rx_msg[0] != CONSOLE_SEQ_TAG) {
+    return console_handle_msg(rx_msg, len);
+  }
+  seq = sscanfUnsignedDecimal(rx_msg + 1, len - 1);
+  index = sscanfNext(rx_msg, len);
+  if ((seq < 0) || (index < 0)) {
+    printf("%c? ERR -1\r\n", CONSOLE_SEQ_TAG);
+    return -1;
+  }
+  _quiet = 1;
+  rval = console_handle_msg(rx_msg + index, len - index);
+  _quiet = 0;
+  if (rval) {
+    printf("%c%d ERR %d\r\n", CONSOLE_SEQ_TAG, seq, rval);
+  } else {
+    printf("%c%d OK\r\n", CONSOLE_SEQ_TAG, seq);
+  }
+  return rval;
+}
+
+/*
+ * int console_run(const char *cmd, int len);
+ *  Run one console command for a remote caller (UART frame or mailbox RPC)
+ *  with its output kept for console_output() rather than sent to the UART.
+ *  Returns the command's return code.
+ */
+int console_run(const char *cmd, int len) {
+  char msg[CONSOLE_MAX_MESSAGE_LENGTH];
+  uint8_t quiet = _quiet;
+  int rval;
+  if ((len < 1) || (len >= CONSOLE_MAX_MESSAGE_LENGTH)) {
+    return -1;
+  }
+  memcpy(msg, cmd, len);
+  msg[len] = '\0';
+  fflush(stdout);
+  _capture_len = 0;
+  _capturing = 1;
+  _quiet = 1;
+#ifdef SIMULATION
+  sim_console_capture(1);
+#endif
+  rval = console_handle_msg(msg, len);
+  fflush(stdout);
+#ifdef SIMULATION
+  sim_console_capture(0);
+#endif
+  _quiet = quiet;
+  _capturing = 0;
+  return rval;
+}
+
+/*
+ * void console_capture(int ch);
+ *  Called by the low-level output routine for each character it discards
+ *  while console_quiet().  Keeps the output of console_run() commands.
+ */
+void console_capture(int ch) {
+  if (_capturing && (_capture_len < CONSOLE_CAPTURE_SIZE)) {
+    _capture[_capture_len++] = (uint8_t)ch;
+  }
+  return;
+}
+
+/*
+ * int console_output(unsigned int offset, uint8_t *data, int len);
+ *  Copy at most 'len' bytes of the output of the last console_run() command,
+ *  starting at 'offset', to 'data'.  Returns the number of bytes copied.
+ */
+int console_output(unsigned int offset, uint8_t *data, int len) {
+  if ((len <= 0) || (offset >= _capture_len)) {
+    return 0;
+  }
+  if ((unsigned int)len > _capture_len - offset) {
+    len = (int)(_capture_len - offset);
+  }
+  memcpy(data, &_capture[offset], len);
+  return len;
+}
+
+unsigned int console_output_size(void) {
+  return _capture_len;
+}
+
+/*
+ * int console_quiet(void);
+ *  Returns 1 while a sequence-tagged command is executing.  The low-level
+ *  console output routine discards characters while this is set.
+ */
+int console_quiet(void) {
+  return (int)_quiet;
 }
 
 static int handle_mdio_phy_print(const char *rx_msg, int len) {
@@ -324,11 +513,11 @@ static int handle_msg_IP(const char *rx_msg, int len) {
     return rval;
   }
   print_ip(ip);
-  eeprom_store_ip_addr(ip, IP_LENGTH);
+  rval = eeprom_store_ip_addr(ip, IP_LENGTH);
 #ifdef AUTOPUSH
   console_push_fpga_mac_ip();
 #endif
-  return 0;
+  return rval;
 }
 
 static int handle_msg_MAC(const char *rx_msg, int len) {
@@ -344,11 +533,11 @@ static int handle_msg_MAC(const char *rx_msg, int len) {
     return rval;
   }
   print_mac(mac);
-  eeprom_store_mac_addr(mac, MAC_LENGTH);
+  rval = eeprom_store_mac_addr(mac, MAC_LENGTH);
 #ifdef AUTOPUSH
   console_push_fpga_mac_ip();
 #endif
-  return 0;
+  return rval;
 }
 
 static int handle_msg_fan_speed(const char *rx_msg, int len) {
@@ -372,9 +561,11 @@ static int handle_msg_fan_speed(const char *rx_msg, int len) {
   }
   speedPercent = (100 * speed)/FAN_SPEED_MAX;
   printf("Setting fan speed to %d (%d%%)\r\n", speed, speedPercent);
+  if (fanctl_enabled()) {
+    printf("Closed-loop fan control is enabled; this applies once it is disabled\r\n");
+  }
   max6639_set_fans(speed);
-  eeprom_store_fan_speed((uint8_t *)&speed, 1);
-  return 0;
+  return eeprom_store_fan_speed((uint8_t *)&speed, 1);
 }
 
 static int handle_msg_overtemp(const char *rx_msg, int len) {
@@ -401,10 +592,7 @@ static int handle_msg_overtemp(const char *rx_msg, int len) {
   //int rval = max6639_set_overtemp(otbyte);
   max6639_set_overtemp(otbyte); // Discarding return value for now
   LM75_set_overtemp((int)otbyte);
-  //int rval = eeprom_store_overtemp(&otbyte, 1);
-  eeprom_store_overtemp(&otbyte, 1); // Discarding return value for now
-  // int eeprom_read_overtemp(volatile uint8_t *pdata, int len);
-  return 0;
+  return eeprom_store_overtemp(&otbyte, 1);
 }
 
 static int handle_tach_enable(const char *rx_msg, int len) {
@@ -547,7 +735,7 @@ static int handle_msg_MGTMUX(char *rx_msg, int len) {
     printf("E.g. Set all MUXn pin states: h 1=1 2=0 3=0\r\n");
     printf("E.g. Set just MUX2 pin high (ignore others): h 2=1\r\n");
     printf("E.g. Read MGTMUX state: h ?\r\n");
-    return 1;
+    return 0;
   }
   int rval = sscanfMGTMUX(rx_msg, len);
   uint8_t rbyte = 0;
@@ -565,7 +753,8 @@ static int handle_msg_MGTMUX(char *rx_msg, int len) {
     printf("  "); // Indent the line printed by the following function
     marble_MGTMUX_config((uint8_t)rval, 1, 1); // Store nonvolatile, print
   }
-  return rval;
+  // Only a failure to parse is an error
+  return rval == -1 ? -1 : 0;
 }
 #endif
 
@@ -675,6 +864,7 @@ static void ina219_test(void)
     getBusVoltage_V(INA219_0);
     getCurrentAmps(INA219_0);
   }
+  fmc_monitor_print();
 }
 
 static void print_mac(uint8_t *pdata) {
@@ -714,13 +904,16 @@ static void print_this_ip(void) {
 }
 
 void CONSOLE_USART_ISR(void) {
+  uint32_t t0 = marble_get_cycles();
   USART_RXNE_ISR(); // Handle RX interrupts first
+  prof_end(PROF_ISR_USART_RX, t0);
   USART_TXE_ISR();  // Then handle TX interrupts
   return;
 }
 
 void console_pend_msg(void) {
   _msgCount++;
+  event_post(EVENT_CONSOLE);
   return;
 }
 
@@ -735,10 +928,18 @@ int console_service(void) {
   if (_msgCount) {
     len = console_shift_msg(msg);
     _msgCount--;
+    if (_msgCount) {
+      // One line per call; come back for the rest
+      event_post(EVENT_CONSOLE);
+    }
     if (len) {
-      return console_handle_msg((char *)msg, len);
+      return console_handle_batch((char *)msg, len);
     }
   }
+  // Binary frames answer with a frame only; suppress any chatter
+  _quiet = 1;
+  frame_service();
+  _quiet = 0;
   if (_fpgaEnable) {
     enable_fpga();
     _fpgaEnable = 0;
@@ -942,7 +1143,7 @@ static int handle_msg_watchdog(const char *rx_msg, int len) {
     } else {
       printf("Current watchdog timeout: %d seconds\r\n", val);
     }
-    return -1;
+    return 0;
   }
   index = sscanfNext(rx_msg, len);
   val = sscanfUnsignedDecimal((rx_msg + index), len-index);
@@ -952,8 +1153,7 @@ static int handle_msg_watchdog(const char *rx_msg, int len) {
   }
   // Set and peg to limits
   val = FPGAWD_SetPeriod((unsigned int)val);
-  eeprom_store_wd_period((const uint8_t *)&val, 1);
-  return 0;
+  return eeprom_store_wd_period((const uint8_t *)&val, 1);
 }
 
 #define KEY_LEN     (16)
@@ -983,10 +1183,10 @@ static int handle_msg_key(const char *rx_msg, int len) {
     }
   }
   // Store non-volatile
-  eeprom_store_wd_key((const uint8_t *)key, KEY_LEN);
+  rval = eeprom_store_wd_key((const uint8_t *)key, KEY_LEN);
   // Clobber the stack memory before exiting.
   memset(key, 0xaa, KEY_LEN);
-  return 0;
+  return rval;
 }
 
 #ifdef APP_MARBLE
@@ -1212,7 +1412,7 @@ static int handle_msg_fsynth(const char *s, int len) {
     }
     printf("I2C Addr = 0x%x, Freq = %d Hz, Config = 0x%x\r\n", (unsigned) i2c_addr, freq, (unsigned) config);
     FSYNTH_ASSEMBLE(data, i2c_addr, freq, config);
-    eeprom_store_fsynth((const uint8_t *)data, 6);
+    return eeprom_store_fsynth((const uint8_t *)data, 6);
   }
   return 0;
 }
@@ -1296,7 +1496,165 @@ static int handle_pmod_mode(const char *rx_msg, int len) {
   return 0;
 }
 
+/* static int handle_report_mode(const char *rx_msg, int len);
+ *  Query or set the output format of console reports for this session
+ *  (not stored in non-volatile memory).
+ *    "y"      -> Query report mode
+ *    "y 0"    -> Human-readable text (default)
+ *    "y 1"    -> Single-line key=value records
+ *    "y 2"    -> Single-line JSON records
+ */
+static int handle_report_mode(const char *rx_msg, int len) {
+  int query = sscanfQuery(rx_msg, len);
+  if (query) {
+    printf("Current report format: %s\r\n", report_mode_string(report_get_mode()));
+    for (int n=0; n<REPORT_MODE_SIZE; n++) {
+      printf("    %d: %s\r\n", n, report_mode_string((report_mode_t)n));
+    }
+    return 0;
+  }
+  int index = sscanfNext(rx_msg, len);
+  int mode = sscanfUnsignedDecimal(rx_msg+index, len-index);
+  if ((index < 0) || (mode < 0) || (mode >= REPORT_MODE_SIZE)) {
+    printf("Invalid option. Valid choices are (0-%d).\r\n", REPORT_MODE_SIZE-1);
+    return -1;
+  }
+  report_set_mode((report_mode_t)mode);
+  return 0;
+}
+
+/* static void print_i2c_recovery(void);
+ *  Stuck-bus recovery counters of the I2C buses that support it.
+ */
+static void print_i2c_recovery(void) {
+  const char *names[] = {"I2C_PM", "I2C_FPGA"};
+  I2C_BUS buses[] = {I2C_PM, I2C_FPGA};
+  marble_I2C_recovery_t stats;
+  for (unsigned int n = 0; n < sizeof(buses)/sizeof(buses[0]); n++) {
+    if (marble_I2C_get_recovery(buses[n], &stats)) {
+      continue;
+    }
+    if (report_structured()) {
+      report_begin("i2c_recovery");
+      report_str("bus", names[n]);
+      report_uint("recoveries", stats.recoveries);
+      report_uint("failures", stats.failures);
+      report_end();
+    } else {
+      printf("%s recovery: %lu runs, %lu left the bus stuck\r\n", names[n],
+             (unsigned long)stats.recoveries, (unsigned long)stats.failures);
+    }
+  }
+  return;
+}
+
+/* static int handle_msg_busprof(const char *rx_msg, int len);
+ *  'B' shows the bus-occupancy table, 'B 0' clears it.
+ */
+static int handle_msg_busprof(const char *rx_msg, int len) {
+  if (sscanfQuery(rx_msg, len)) {
+    busprof_print();
+    i2c_shadow_print();
+    print_i2c_recovery();
+    return 0;
+  }
+  int index = sscanfNext(rx_msg, len);
+  if ((index < 0) || (sscanfUnsignedDecimal(rx_msg+index, len-index) != 0)) {
+    printf("Invalid option. Use 'B' to show or 'B 0' to clear.\r\n");
+    return -1;
+  }
+  busprof_reset();
+  return 0;
+}
+
+/* static int handle_msg_prof(const char *rx_msg, int len);
+ *  'P' shows the execution-time profile, 'P 0' clears it.
+ */
+static int handle_msg_prof(const char *rx_msg, int len) {
+  if (sscanfQuery(rx_msg, len)) {
+    prof_print();
+    return 0;
+  }
+  int index = sscanfNext(rx_msg, len);
+  if ((index < 0) || (sscanfUnsignedDecimal(rx_msg+index, len-index) != 0)) {
+    printf("Invalid option. Use 'P' to show or 'P 0' to clear.\r\n");
+    return -1;
+  }
+  prof_reset();
+  return 0;
+}
+
+/* static int handle_msg_fanctl(const char *rx_msg, int len);
+ *    "F"                                  -> Show fan control state
+ *    "F en"                               -> Disable (0) or enable (1)
+ *    "F en setpoint kp ki min max slew"   -> Also set the parameters
+ *  All settings are stored in non-volatile memory.
+ */
+static int handle_msg_fanctl(const char *rx_msg, int len) {
+  int args[7];
+  int nargs = 0;
+  int index = 0;
+  int next;
+  if (sscanfQuery(rx_msg, len)) {
+    fanctl_print();
+    return 0;
+  }
+  while (nargs < 7) {
+    next = sscanfNext(rx_msg+index, len-index);
+    if (next < 0) {
+      break;
+    }
+    index += next;
+    args[nargs] = sscanfUnsignedDecimal(rx_msg+index, len-index);
+    if ((args[nargs] < 0) || (args[nargs] > 255)) {
+      break;
+    }
+    nargs++;
+  }
+  if (((nargs != 1) && (nargs != 7)) || (args[0] > 1)) {
+    printf("Usage: F [en [setpoint kp ki min max slew]]\r\n");
+    return -1;
+  }
+  if (nargs == 7) {
+    fanctl_params_t params = {(uint8_t)args[1], (uint8_t)args[2], (uint8_t)args[3],
+                              (uint8_t)args[4], (uint8_t)args[5], (uint8_t)args[6]};
+    if (fanctl_set_params(&params)) {
+      printf("Invalid parameters (need min <= max <= %d).\r\n", FAN_SPEED_MAX);
+      return -1;
+    }
+  }
+  return fanctl_set_enable((uint8_t)args[0]);
+}
+
 #ifdef APP_MARBLE
+/* static int handle_msg_faults(const char *rx_msg, int len);
+ *    "z"      -> Print LTM4673 fault snapshots (newest first)
+ *    "z 0"    -> Clear the fault snapshots
+ */
+static int handle_msg_faults(const char *rx_msg, int len) {
+  if (sscanfQuery(rx_msg, len)) {
+    ltm4673_print_faults();
+    pmlog_print(0);
+    return 0;
+  }
+  int index = sscanfNext(rx_msg, len);
+  int nevents = index < 0 ? -1 : sscanfUnsignedDecimal(rx_msg+index, len-index);
+  if (nevents < 0) {
+    printf("Invalid option. Use 'z' to show, 'z N' to show N power-loss events or 'z 0' to clear.\r\n");
+    return -1;
+  }
+  if (nevents > 0) {
+    pmlog_print((unsigned int)nevents);
+    return 0;
+  }
+  ltm4673_fault_clear();
+  if (pmlog_erase() != 0) {
+    printf("Power-loss log erase failed\r\n");
+    return -1;
+  }
+  return 0;
+}
+
 /* static int handle_msg_pmbridge(const char *s, int len);
  *  Parse a line from the user representing a PMBus transaction
  *  Syntax: x command
@@ -1306,6 +1664,7 @@ static int handle_pmod_mode(const char *rx_msg, int len) {
     ! : Repeated start
     ? : Read 1 byte from the target device
     * : Read 1 byte, then use that as N and read the next N bytes
+    , : End this transaction and start another (see PMBridge_xact_batch)
     0xHH: Use hex value 0xHH as the next transaction byte
     DDD : Use decimal value DDD as the next transaction byte
 */
@@ -1317,7 +1676,8 @@ static int handle_msg_pmbridge(const char *s, int len) {
   int arg;
   int item_index = 0;
   int fail = 0;
-  uint16_t xact[PMBRIDGE_XACT_MAX_ITEMS];
+  int batch = 0;
+  uint16_t xact[PMBRIDGE_BATCH_MAX_ITEMS];
   while (ptr < max_len) {
     if (s[ptr] == '\n') {
       break;
@@ -1330,7 +1690,10 @@ static int handle_msg_pmbridge(const char *s, int len) {
       fail = 1;
       break;
     } else {
-      if (item_index < PMBRIDGE_XACT_MAX_ITEMS) {
+      if (item_index < PMBRIDGE_BATCH_MAX_ITEMS) {
+        if (arg == PMBRIDGE_XACT_SEPARATOR) {
+          batch = 1;
+        }
         xact[item_index++] = (uint16_t)(arg & 0xffff);
       } else {
         printf("ERROR: Exceeded maximum number of bytes per transaction\r\n");
@@ -1355,8 +1718,14 @@ static int handle_msg_pmbridge(const char *s, int len) {
   }
   printf("]\r\n");
   */
-  PMBridge_xact(xact, item_index);
-  return 0;
+  if (batch) {
+    return PMBridge_xact_batch(xact, item_index);
+  }
+  if (item_index > PMBRIDGE_XACT_MAX_ITEMS) {
+    printf("ERROR: Exceeded maximum number of bytes per transaction\r\n");
+    return -1;
+  }
+  return PMBridge_xact(xact, item_index);
 }
 #endif
 
@@ -1364,6 +1733,7 @@ static int handle_msg_pmbridge(const char *s, int len) {
 #define MMC_REPEAT_START      ('!')
 #define MMC_READ_ONE          ('?')
 #define MMC_READ_BLOCK        ('*')
+#define MMC_XACT_SEPARATOR    (',')
 /* static int PMBridgeConsumeArg(const char *s, int len, volatile int *arg);
  *  Consume one whitespace-separated arg from string 's'.
  *  Returns when:
@@ -1409,6 +1779,9 @@ static int PMBridgeConsumeArg(const char *s, int len, volatile int *arg) {
     } else if (c == MMC_READ_BLOCK) {
       state = 4;
       val = PMBRIDGE_XACT_READ_BLOCK;
+    } else if (c == MMC_XACT_SEPARATOR) {
+      state = 4;
+      val = PMBRIDGE_XACT_SEPARATOR;
     } else if (state == 4) {
       // If we get here, then a special char was not properly followed by whitespace. Fail.
       printf("Special not followed by whitespace\r\n");
@@ -24,9 +24,9 @@
 // TODO - Warning! The lv_font_roboto_12 font is not monospace, so ensuring any
 //        future value fits inside the initial bounding box is somewhat tedious.
 // Set to 1 to enable current monitoring of FMC cards.
-// This violates the "don't spam the I2C bus" policy of the MMC, so it's disabled
-// by default and may be removed completely.
-#define ENABLE_FMC_CURRENT_CHECK         (0)
+// The page shows the readings cached by fmc_monitor_service() (one I2C
+// transaction per INA219 per second), so it no longer polls the bus itself.
+#define ENABLE_FMC_CURRENT_CHECK         (1)
 // ==========================================================
 
 extern lv_font_t lv_font_roboto_12, lv_font_roboto_mono_17, lv_font_fa;
@@ -500,7 +500,7 @@ static int update_page_fmc(int refresh) {
   uint8_t mask = (1 << M_FMC_STATUS_FMC1_PWR);
   uint8_t new_fmc = (new_fmc_status & mask) ^ (fmc_status & mask);
   uint16_t new_fmc_current=0;
-  new_fmc_current = ina219_getShuntVoltage(INA219_FMC1);
+  new_fmc_current = (uint16_t)fmc_monitor_shunt(FMC_MONITOR_FMC1);
   if (new_fmc_status & mask) {
     if (refresh || new_fmc || (new_fmc_current != fmc1_current)) {
       float fmc1_current_amps = INA219_SHUNT_VOLTAGE_TO_CURRENT(new_fmc_current);
@@ -519,7 +519,7 @@ static int update_page_fmc(int refresh) {
   // FMC2
   mask = (1 << M_FMC_STATUS_FMC2_PWR);
   new_fmc = (new_fmc_status & mask) ^ (fmc_status & mask);
-  new_fmc_current = ina219_getShuntVoltage(INA219_FMC2);
+  new_fmc_current = (uint16_t)fmc_monitor_shunt(FMC_MONITOR_FMC2);
   if (new_fmc_status & mask) {
     if (refresh || new_fmc || (new_fmc_current != fmc2_current)) {
       float fmc2_current_amps = INA219_SHUNT_VOLTAGE_TO_CURRENT(new_fmc_current);
@@ -572,8 +572,8 @@ static int update_page_temperature(int refresh) {
   }
   // MAX6639 Ch 1
   int new_max6639[2];
-  new_max6639[0] = max6639_get_cached_temp(MAX6639_TEMP_CH1);
-  new_max6639[1] = max6639_get_cached_temp(MAX6639_TEMP_EXT_CH1);
+  new_max6639[0] = max6639_snapshot_reg(MAX6639_TEMP_CH1);
+  new_max6639[1] = max6639_snapshot_reg(MAX6639_TEMP_EXT_CH1);
   if (array_updated_int(max6639_ch1, new_max6639, 2) || refresh) {
     char label[LABEL_TEMPERATURE_MAX6639_1_SIZE];
     snprintf(label, LABEL_TEMPERATURE_MAX6639_1_SIZE, LABEL_TEMPERATURE_MAX6639_1_FMT, MAX6639_GET_TEMP_DOUBLE(new_max6639[0], new_max6639[1]));
@@ -581,8 +581,8 @@ static int update_page_temperature(int refresh) {
     rval = 1;
   }
   // MAX6639 Ch 2
-  new_max6639[0] = max6639_get_cached_temp(MAX6639_TEMP_CH2);
-  new_max6639[1] = max6639_get_cached_temp(MAX6639_TEMP_EXT_CH2);
+  new_max6639[0] = max6639_snapshot_reg(MAX6639_TEMP_CH2);
+  new_max6639[1] = max6639_snapshot_reg(MAX6639_TEMP_EXT_CH2);
   if (array_updated_int(max6639_ch2, new_max6639, 2) || refresh) {
     char label[LABEL_TEMPERATURE_MAX6639_2_SIZE];
     snprintf(label, LABEL_TEMPERATURE_MAX6639_2_SIZE, LABEL_TEMPERATURE_MAX6639_2_FMT, MAX6639_GET_TEMP_DOUBLE(new_max6639[0], new_max6639[1]));
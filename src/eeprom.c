@@ -119,6 +119,36 @@ int eeprom_read_ ## NAME(volatile uint8_t *pdata, int len) { return eeprom_read_
 FOR_ALL_EETAGS()
 #undef X
 
+/* (see eeprom.h)
+ */
+int eeprom_tag_size(ee_tag_t tag) {
+  switch (tag) {
+#define X(N, NAME, TYPE, SIZE, ...) \
+    case ee_ ## NAME: return SIZE;
+  FOR_ALL_EETAGS()
+#undef X
+    default:
+      break;
+  }
+  return -1;
+}
+
+int eeprom_read_tag(ee_tag_t tag, volatile uint8_t *pdata, int len) {
+  int size = eeprom_tag_size(tag);
+  if (size < 0) {
+    return -EINVAL;
+  }
+  return eeprom_read_val((ee_tags_t)tag, pdata, MIN(len, size));
+}
+
+int eeprom_store_tag(ee_tag_t tag, const uint8_t *pdata, int len) {
+  int size = eeprom_tag_size(tag);
+  if (size < 0) {
+    return -EINVAL;
+  }
+  return eeprom_store_val((ee_tags_t)tag, pdata, MIN(len, size));
+}
+
 /* int eeprom_read_wd_key(volatile uint8_t *pdata, int len);
  *  The whole eeprom scheme is built around an 8-byte structure with a 6-byte
  *  payload, so this bespoke hack is necessary for any larger structures.
@@ -0,0 +1,43 @@
+/*
+ * File: event.c
+ * Desc: Events posted from interrupt context to the main loop.  See event.h.
+ */
+
+#include "event.h"
+#include "marble_api.h"
+
+static volatile uint8_t _pending[EVENT_NUM];
+
+void event_post(event_t ev) {
+  if (ev < EVENT_NUM) {
+    _pending[ev] = 1;
+  }
+  return;
+}
+
+int event_take(event_t ev) {
+  if ((ev >= EVENT_NUM) || (!_pending[ev])) {
+    return 0;
+  }
+  _pending[ev] = 0;
+  return 1;
+}
+
+int event_pending(void) {
+  for (int ev = 0; ev < EVENT_NUM; ev++) {
+    if (_pending[ev]) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+void event_wait(void) {
+  INTERRUPTS_DISABLE();
+  if (!event_pending()) {
+    // Wakes on a pending interrupt even while masked; it runs once unmasked
+    marble_wait_for_interrupt();
+  }
+  INTERRUPTS_ENABLE();
+  return;
+}
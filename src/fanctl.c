@@ -0,0 +1,335 @@
+/*
+ * File: fanctl.c
+ * Desc: Closed-loop fan control.  See fanctl.h.
+ */
+
+#include <stdio.h>
+#include "fanctl.h"
+#include "marble_api.h"
+#include "i2c_pm.h"
+#include "max6639.h"
+#include "eeprom.h"
+#include "mailbox.h"
+#include "report.h"
+
+// Full-scale MAX6639 duty (100%)
+#define FANCTL_DUTY_MAX                            (120)
+
+static fanctl_params_t _params = {60, 8, 16, 24, FANCTL_DUTY_MAX, 12};
+static uint8_t _enable = 0;
+static int _started = 0;
+static fanctl_state_t _state = FANCTL_OFF;
+static fanctl_source_t _source = FANCTL_SRC_NONE;
+static int _temp = 0;           // Controlled temperature (1/8 degC)
+static int _duty = 0;           // Duty applied (counts)
+static int32_t _integ = 0;      // Integrator (1/256 counts)
+static int16_t _fpga_temp = 0;  // FPGA die temperature (0.5 degC; 0 = none)
+static uint32_t _t_last = 0;
+
+static const char *fanctl_source_names[FANCTL_NUM_SOURCES] = {
+  "MAX6639_CH1",
+  "MAX6639_CH2",
+  "LM75_0",
+  "LM75_1",
+  "FPGA",
+};
+
+static int fanctl_vet(const fanctl_params_t *params);
+static int fanctl_read_temp(fanctl_source_t src, int *temp);
+static fanctl_source_t fanctl_hottest(int *temp);
+static void fanctl_apply(int duty);
+static void fanctl_step(void);
+static void fanctl_restore_static(void);
+
+static int fanctl_vet(const fanctl_params_t *params) {
+  if ((params->max_duty > FANCTL_DUTY_MAX) || (params->min_duty > params->max_duty)) {
+    return -1;
+  }
+  return 0;
+}
+
+/*
+ * static int fanctl_read_temp(fanctl_source_t src, int *temp);
+ *  Snapshot reading of 'src' in 1/8 degC.  Returns -1 if there is none (no
+ *  snapshot yet, the MAX6639 reports a diode fault or the FPGA
+ *  has not written its temperature).
+ */
+static int fanctl_read_temp(fanctl_source_t src, int *temp) {
+  int t, ext;
+  switch (src) {
+    case FANCTL_SRC_MAX6639_CH1:
+    case FANCTL_SRC_MAX6639_CH2:
+      t = max6639_snapshot_reg(src == FANCTL_SRC_MAX6639_CH1 ? MAX6639_TEMP_CH1 : MAX6639_TEMP_CH2);
+      ext = max6639_snapshot_reg(src == FANCTL_SRC_MAX6639_CH1 ? MAX6639_TEMP_EXT_CH1 : MAX6639_TEMP_EXT_CH2);
+      // Extended temperature bit 0 flags an open/shorted diode
+      if ((t == 0) || (ext & 1)) {
+        return -1;
+      }
+      *temp = (t << 3) | (ext >> 5);
+      break;
+    case FANCTL_SRC_LM75_0:
+    case FANCTL_SRC_LM75_1:
+      t = LM75_get_cached_temperature(src == FANCTL_SRC_LM75_0 ? LM75_0 : LM75_1);
+      if (t == 0) {
+        return -1;
+      }
+      *temp = t*4;
+      break;
+    case FANCTL_SRC_FPGA:
+      if (_fpga_temp == 0) {
+        return -1;
+      }
+      *temp = (int)_fpga_temp*4;
+      break;
+    default:
+      return -1;
+  }
+  return 0;
+}
+
+static fanctl_source_t fanctl_hottest(int *temp) {
+  fanctl_source_t hottest = FANCTL_SRC_NONE;
+  int t;
+  for (int src = 0; src < FANCTL_NUM_SOURCES; src++) {
+    if (fanctl_read_temp((fanctl_source_t)src, &t)) {
+      continue;
+    }
+    if ((hottest == FANCTL_SRC_NONE) || (t > *temp)) {
+      hottest = (fanctl_source_t)src;
+      *temp = t;
+    }
+  }
+  return hottest;
+}
+
+static void fanctl_apply(int duty) {
+  if (duty != _duty) {
+    max6639_set_fans(duty);
+    _duty = duty;
+  }
+  return;
+}
+
+/*
+ * static void fanctl_step(void);
+ *  One controller period.  The integrator stops where the output saturates
+ *  (no wind-up against min/max_duty) and is held while no sensor is valid;
+ *  while running, the duty change per period is limited to 'slew'.
+ */
+static void fanctl_step(void) {
+  int32_t lo = (int32_t)_params.min_duty << 8;
+  int32_t hi = (int32_t)_params.max_duty << 8;
+  int duty;
+  // Without the mailbox nothing refreshes the snapshot
+  if (!mbox_get_enable()) {
+    I2C_PM_monitor_update();
+  }
+  _source = fanctl_hottest(&_temp);
+  if (_source == FANCTL_SRC_NONE) {
+    _state = FANCTL_FAILSAFE;
+    duty = _params.max_duty;
+  } else {
+    _state = FANCTL_RUN;
+    int32_t err = _temp - ((int32_t)_params.setpoint << 3);
+    int32_t p = (int32_t)_params.kp*err*32;
+    int32_t di = (int32_t)_params.ki*err*2*(FANCTL_PERIOD_MS/1000);
+    int32_t integ = _integ + di;
+    // Integrate up to, but not past, the point where the output saturates
+    if ((di > 0) && (p + integ > hi)) {
+      integ = hi - p > _integ ? hi - p : _integ;
+    } else if ((di < 0) && (p + integ < lo)) {
+      integ = lo - p < _integ ? lo - p : _integ;
+    }
+    _integ = integ < lo ? lo : (integ > hi ? hi : integ);
+    int32_t out = p + _integ;
+    out = out < lo ? lo : (out > hi ? hi : out);
+    duty = (int)((out + 128) >> 8);
+  }
+  if ((_state == FANCTL_RUN) && (_params.slew != 0)) {
+    if (duty > _duty + _params.slew) {
+      duty = _duty + _params.slew;
+    } else if (duty < _duty - _params.slew) {
+      duty = _duty - _params.slew;
+    }
+  }
+  fanctl_apply(duty);
+  return;
+}
+
+/*
+ * static void fanctl_restore_static(void);
+ *  Back to the static 'fan_speed' duty.
+ */
+static void fanctl_restore_static(void) {
+  uint8_t val;
+  _state = FANCTL_OFF;
+  if (eeprom_read_fan_speed(&val, 1) == 0) {
+    max6639_set_fans((int)val);
+    _duty = (int)val;
+  }
+  return;
+}
+
+void fanctl_init(void) {
+  uint8_t val[2];
+  fanctl_params_t params = _params;
+  if (eeprom_read_fan_ctl_en(&_enable, 1)) {
+    printf("Could not read fan control enable.\r\n");
+    _enable = 0;
+  }
+  if (eeprom_read_fan_setpoint(val, 1) == 0) {
+    params.setpoint = val[0];
+  }
+  if (eeprom_read_fan_gains(val, 2) == 0) {
+    params.kp = val[0];
+    params.ki = val[1];
+  }
+  if (eeprom_read_fan_duty_lim(val, 2) == 0) {
+    params.min_duty = val[0];
+    params.max_duty = val[1];
+  }
+  if (eeprom_read_fan_slew(val, 1) == 0) {
+    params.slew = val[0];
+  }
+  if (fanctl_vet(&params)) {
+    printf("Invalid fan control parameters; using defaults.\r\n");
+  } else {
+    _params = params;
+  }
+  // Bumpless start from the static duty
+  if (eeprom_read_fan_speed(val, 1) == 0) {
+    _duty = (int)val[0];
+  }
+  _integ = (int32_t)_duty << 8;
+  _state = FANCTL_OFF;
+  _t_last = marble_get_us();
+  _started = 1;
+  return;
+}
+
+void fanctl_service(void) {
+  if (!_started || !_enable) {
+    return;
+  }
+  uint32_t now = marble_get_us();
+  if (now - _t_last < FANCTL_PERIOD_MS*1000) {
+    return;
+  }
+  _t_last = now;
+  fanctl_step();
+  return;
+}
+
+int fanctl_set_enable(uint8_t enable) {
+  enable = enable ? 1 : 0;
+  if (_started && (enable != _enable)) {
+    if (enable) {
+      _integ = (int32_t)_duty << 8;
+      _t_last = marble_get_us() - FANCTL_PERIOD_MS*1000;
+    } else {
+      fanctl_restore_static();
+    }
+  }
+  _enable = enable;
+  return eeprom_store_fan_ctl_en(&enable, 1);
+}
+
+int fanctl_enabled(void) {
+  return (int)_enable;
+}
+
+int fanctl_set_params(const fanctl_params_t *params) {
+  uint8_t val[2];
+  int rc;
+  if (fanctl_vet(params)) {
+    return -1;
+  }
+  _params = *params;
+  rc = eeprom_store_fan_setpoint(&params->setpoint, 1);
+  val[0] = params->kp;
+  val[1] = params->ki;
+  rc |= eeprom_store_fan_gains(val, 2);
+  val[0] = params->min_duty;
+  val[1] = params->max_duty;
+  rc |= eeprom_store_fan_duty_lim(val, 2);
+  rc |= eeprom_store_fan_slew(&params->slew, 1);
+  return rc;
+}
+
+void fanctl_get_params(fanctl_params_t *params) {
+  *params = _params;
+  return;
+}
+
+void fanctl_print(void) {
+  const char *src = _source < FANCTL_NUM_SOURCES ? fanctl_source_names[_source] : "none";
+  int t;
+  if (report_structured()) {
+    report_begin("fanctl");
+    report_uint("enable", _enable);
+    report_uint("state", _state);
+    report_str("source", src);
+    report_int("temp_8", _temp);
+    report_uint("duty", _duty);
+    report_int("integ_256", (int)_integ);
+    report_uint("setpoint", _params.setpoint);
+    report_uint("kp", _params.kp);
+    report_uint("ki", _params.ki);
+    report_uint("min_duty", _params.min_duty);
+    report_uint("max_duty", _params.max_duty);
+    report_uint("slew", _params.slew);
+    report_end();
+    return;
+  }
+  printf("Fan control %s (%s)\r\n", _enable ? "enabled" : "disabled",
+         _state == FANCTL_RUN ? "running" : (_state == FANCTL_FAILSAFE ? "no sensor, max duty" : "static duty"));
+  printf("  setpoint %d degC, kp %d, ki %d/16, duty %d-%d, slew %d/period\r\n",
+         _params.setpoint, _params.kp, _params.ki, _params.min_duty, _params.max_duty, _params.slew);
+  printf("  duty %d (%d%%), integrator %ld/256\r\n", _duty, (100*_duty)/FANCTL_DUTY_MAX, (long)_integ);
+  for (int n = 0; n < FANCTL_NUM_SOURCES; n++) {
+    if (fanctl_read_temp((fanctl_source_t)n, &t)) {
+      printf("  %-12s --\r\n", fanctl_source_names[n]);
+    } else {
+      printf("  %-12s %d.%03d degC%s\r\n", fanctl_source_names[n], t/8, (t < 0 ? -t : t)%8*125,
+             (_state == FANCTL_RUN) && (n == (int)_source) ? " *" : "");
+    }
+  }
+  return;
+}
+
+/* void fanctl_set_fpga_temp(int temp);
+ *  Mailbox input: FPGA die temperature in 0.5 degC (signed 16-bit); 0 leaves
+ *  the FPGA out of the loop.
+ */
+void fanctl_set_fpga_temp(int temp) {
+  _fpga_temp = (int16_t)temp;
+  return;
+}
+
+int fanctl_get_fpga_temp(void) {
+  return (int)_fpga_temp;
+}
+
+uint8_t fanctl_mbox_state(void) {
+  return (uint8_t)_state;
+}
+
+uint8_t fanctl_mbox_source(void) {
+  return (uint8_t)_source;
+}
+
+uint8_t fanctl_mbox_setpoint(void) {
+  return _params.setpoint;
+}
+
+int fanctl_mbox_temp(void) {
+  return _temp;
+}
+
+uint8_t fanctl_mbox_duty(void) {
+  return (uint8_t)_duty;
+}
+
+int fanctl_mbox_integ(void) {
+  return (int)_integ;
+}
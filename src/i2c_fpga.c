@@ -37,13 +37,17 @@ void setCalibration_16V_2A(void);
 uint32_t currentDivider_mA;
 float powerMultiplier_mW;
 
-void switch_i2c_bus(uint8_t i)
+/* int switch_i2c_bus(uint8_t i);
+ *  Select TCA9548 port 'i'.  Always written: the FPGA also masters I2C_FPGA
+ *  and may have selected another port since.
+ */
+int switch_i2c_bus(uint8_t i)
 {
-   if (i > 7) return;
+   if (i > 7) return -1;
    uint8_t addr = TCA9548;
    uint8_t data;
    data = (1 << i);
-   marble_I2C_send(I2C_FPGA, addr, &data, 1);
+   return marble_I2C_send(I2C_FPGA, addr, &data, 1);
 }
 
 void ina219_init()
@@ -60,16 +64,21 @@ static int wireWriteRegister (uint8_t addr, uint8_t reg, uint16_t value)
    return marble_I2C_send(I2C_FPGA, addr, data, 3);
 }
 
+/* static bool wireReadRegister(uint8_t addr, uint8_t reg, uint16_t *value);
+ *  Read a 16-bit register.  The INA219 register pointer is always written
+ *  first: the FPGA also masters I2C_FPGA and may have moved it.
+ */
 static bool wireReadRegister(uint8_t addr, uint8_t reg, uint16_t *value)
 {
    uint8_t buffer[2];
    bool success = 0;
 
    buffer[0] = reg;
-   marble_I2C_send(I2C_FPGA, addr, buffer, 1);
-   buffer[0] = 0xde;
-   buffer[1] = 0xad;
-   success = marble_I2C_recv(I2C_FPGA, addr, buffer, 2) == HAL_OK;
+   if (marble_I2C_send(I2C_FPGA, addr, buffer, 1) == HAL_OK) {
+      buffer[0] = 0xde;
+      buffer[1] = 0xad;
+      success = marble_I2C_recv(I2C_FPGA, addr, buffer, 2) == HAL_OK;
+   }
    if (success) {
       *value = (((uint16_t)buffer[0] << 8) | buffer[1]);
    } else {
@@ -278,6 +287,131 @@ float getCurrentAmps(uint8_t ina)
    return valueDec;
 }
 
+/************
+* FMC power monitor
+************/
+
+// Read back the configuration every this many periods to catch an INA219
+// reset by a load transient (which also silently resets the pointer)
+#define FMC_MONITOR_VERIFY_PERIODS                   (10)
+
+typedef struct {
+   uint8_t addr;
+   uint8_t configured;
+   uint8_t valid;
+   int16_t shunt;       // 10uV
+   uint32_t t_config;   // marble_get_us() of the configuration write
+} fmc_monitor_t;
+
+static fmc_monitor_t fmc_monitor[FMC_MONITOR_NUM] = {
+   {INA219_FMC1, 0, 0, 0, 0},
+   {INA219_FMC2, 0, 0, 0, 0},
+};
+static uint32_t fmc_monitor_t_last = 0;
+static unsigned int fmc_monitor_periods = 0;
+
+static void fmc_monitor_drop(fmc_monitor_t *mon)
+{
+   mon->configured = 0;
+   mon->valid = 0;
+   mon->shunt = 0;
+}
+
+/*
+ * static void fmc_monitor_read(fmc_monitor_t *mon, uint32_t now, int verify);
+ *  Configure the INA219 if needed, else read its shunt voltage once the first
+ *  averaged conversion since the configuration has completed.
+ */
+static void fmc_monitor_read(fmc_monitor_t *mon, uint32_t now, int verify)
+{
+   uint16_t value;
+   if (!mon->configured) {
+      if (wireWriteRegister(mon->addr, INA_REG_CONFIG, FMC_MONITOR_CONFIG) != HAL_OK) {
+         fmc_monitor_drop(mon);
+         return;
+      }
+      mon->configured = 1;
+      mon->t_config = now;
+      return;
+   }
+   if (now - mon->t_config < FMC_MONITOR_CONVERSION_US) {
+      return;
+   }
+   if (verify) {
+      if (!wireReadRegister(mon->addr, INA_REG_CONFIG, &value) || (value != FMC_MONITOR_CONFIG)) {
+         fmc_monitor_drop(mon);
+         return;
+      }
+   }
+   if (!wireReadRegister(mon->addr, INA_REG_SHUNTVOLTAGE, &value)) {
+      fmc_monitor_drop(mon);
+      return;
+   }
+   mon->shunt = (int16_t)value;
+   mon->valid = 1;
+}
+
+void fmc_monitor_service(void)
+{
+   uint32_t now = marble_get_us();
+   if (now - fmc_monitor_t_last < FMC_MONITOR_PERIOD_MS*1000) {
+      return;
+   }
+   fmc_monitor_t_last = now;
+   if (!marble_pwr_good()) {
+      // The INA219s lose their configuration with the board power
+      for (unsigned ch = 0; ch < FMC_MONITOR_NUM; ch++) {
+         fmc_monitor_drop(&fmc_monitor[ch]);
+      }
+      return;
+   }
+   if (switch_i2c_bus(I2C_APP) != HAL_OK) {
+      for (unsigned ch = 0; ch < FMC_MONITOR_NUM; ch++) {
+         fmc_monitor[ch].valid = 0;
+      }
+      return;
+   }
+   int verify = (++fmc_monitor_periods % FMC_MONITOR_VERIFY_PERIODS) == 0;
+   for (unsigned ch = 0; ch < FMC_MONITOR_NUM; ch++) {
+      fmc_monitor_read(&fmc_monitor[ch], now, verify);
+   }
+}
+
+int fmc_monitor_shunt(int ch)
+{
+   if ((ch < 0) || (ch >= FMC_MONITOR_NUM) || !fmc_monitor[ch].valid) {
+      return 0;
+   }
+   return (int)fmc_monitor[ch].shunt;
+}
+
+int fmc_monitor_current_mA(int ch)
+{
+   return (int)INA219_SHUNT_VOLTAGE_TO_MA(fmc_monitor_shunt(ch));
+}
+
+uint8_t fmc_monitor_status(void)
+{
+   uint8_t status = 0;
+   for (unsigned ch = 0; ch < FMC_MONITOR_NUM; ch++) {
+      if (fmc_monitor[ch].valid) {
+         status |= (1 << ch);
+      }
+   }
+   return status;
+}
+
+void fmc_monitor_print(void)
+{
+   for (unsigned ch = 0; ch < FMC_MONITOR_NUM; ch++) {
+      if (fmc_monitor[ch].valid) {
+         printf("FMC%u: %d mA (shunt %d x 10uV)\r\n", ch + 1, fmc_monitor_current_mA(ch), fmc_monitor[ch].shunt);
+      } else {
+         printf("FMC%u: --\r\n", ch + 1);
+      }
+   }
+}
+
 /************
 * ADN4600 interface
 ************/
@@ -8,21 +8,57 @@
 #include "ltm4673.h"
 #include "eeprom.h"
 #include "uart_fifo.h"
+#include "report.h"
+#include "i2c_shadow.h"
+#include "pmbus.h"
 
 /* ============================= Helper Macros ============================== */
+// Reads always follow the command code with PMBRIDGE_XACT_REPEAT_START
+#define PMBRIDGE_XACT_IS_READ(xact, len)  (((len) > 2) && ((xact)[2] == PMBRIDGE_XACT_REPEAT_START))
 /* ============================ Static Variables ============================ */
 extern I2C_BUS I2C_PM;
 static int lm75_0_temperature=0, lm75_1_temperature=0;
-static int max6639_temp_ch1=0, max6639_temp_ext_ch1=0;
-static int max6639_temp_ch2=0, max6639_temp_ext_ch2=0;
+// Last MAX6639 snapshot, indexed by register number
+static uint8_t _max6639_snap[MAX6639_SNAPSHOT_REGS];
+static int _max6639_snap_valid = 0;
+static int _max6639_burst = -1;   // Register auto-increment: -1 = not checked yet
+static const struct {
+  uint8_t first;
+  uint8_t count;
+} max6639_bursts[] = {
+  {MAX6639_TEMP_CH1, 2},          // TEMP_CH1, TEMP_CH2
+  {MAX6639_TEMP_EXT_CH1, 2},      // TEMP_EXT_CH1, TEMP_EXT_CH2
+  {MAX6639_FAN1_TACH_CNT, 8},     // FAN1_TACH_CNT .. FAN2_DUTY
+};
+// Register selected by each LM75's pointer (0xff = unknown)
+static uint8_t lm75_0_pointer = 0xff, lm75_1_pointer = 0xff;
 static uint16_t _telem_data[PM_NUM_TELEM_ENUM];
+static int _pm_pec_en = I2C_PM_PEC_DEFAULT;
+static uint32_t _pm_alert_tick = 0;   // Last PM_AlertService() capture
+
+typedef struct {
+  uint8_t addr;       // 0 = unused slot
+  uint32_t pec_errs;  // Reads that arrived with a bad PEC
+  uint32_t bus_errs;  // NACK/arbitration/timeout from the I2C driver
+  uint32_t retries;   // Attempts beyond the first
+  uint32_t failures;  // Transactions that still failed after all retries
+} pm_err_count_t;
+static pm_err_count_t _pm_errs[PM_ERR_MAX_DEVS];
 
 /* =========================== Static Prototypes ============================ */
 static int max6639_init(void);
+static int max6639_read_burst(uint8_t first, uint8_t *data, int count);
+static void max6639_check_burst(void);
+static uint8_t *LM75_pointer(uint8_t dev);
+static int LM75_update_temperature(uint8_t dev);
 static int set_max6639_reg(int regno, int value);
-static int PMBridge_do_sanitized_xact(uint16_t *xact, int len);
+static int PMBridge_vet_xact(const uint16_t *xact, int len);
+static int PMBridge_do_sanitized_xact(uint16_t *xact, int len, uint8_t *rdata, int verbose);
 static void PMBridge_hook_read(uint8_t addr, uint8_t cmd, const uint8_t *data, int len);
 static void PMBridge_hook_write(uint8_t addr, const uint8_t *data, int len);
+static pm_err_count_t *PM_err_counts(uint8_t dev);
+static int PM_cmdrecv_once(uint8_t dev, uint8_t cmd, uint8_t *data, int len, pm_err_count_t *errs);
+static int PM_cmdsend_once(uint8_t dev, uint8_t cmd, const uint8_t *data, int len, pm_err_count_t *errs);
 
 /* ========================== Function Definitions ========================== */
 void I2C_PM_init(void) {
@@ -85,7 +121,7 @@ static int set_max6639_reg(int regno, int value)
    uint8_t i2c_dat[4];
    i2c_dat[0] = regno;
    i2c_dat[1] = value;
-   int rc = marble_I2C_send(I2C_PM, addr, i2c_dat, 2);
+   int rc = i2c_shadow_send(I2C_PM, addr, i2c_dat, 2);
    return rc;
 }
 
@@ -93,35 +129,100 @@ int get_max6639_reg(int regno, unsigned int *value)
 {
    uint8_t i2c_dat[4];
    uint8_t addr = MAX6639;
-   int rc = marble_I2C_cmdrecv(I2C_PM, addr, regno, i2c_dat, 1);
+   int rc = i2c_shadow_cmdrecv(I2C_PM, addr, regno, i2c_dat, 1);
    if ((rc==0) && value) *value = i2c_dat[0];
    return rc;
 }
 
-int return_max6639_reg(int regno) {
-  uint8_t i2c_dat[4];
-  marble_I2C_cmdrecv(I2C_PM, MAX6639, regno, i2c_dat, 1);
-  int rval = (int)*i2c_dat;
-  // Store values locally so display can pick them up without additional I2C transactions
-  switch (regno) {
-    case MAX6639_TEMP_CH1: max6639_temp_ch1 = rval; break;
-    case MAX6639_TEMP_EXT_CH1: max6639_temp_ext_ch1 = rval; break;
-    case MAX6639_TEMP_CH2: max6639_temp_ch2 = rval; break;
-    case MAX6639_TEMP_EXT_CH2: max6639_temp_ext_ch2 = rval; break;
-    default: break;
+/*
+ * static int max6639_read_burst(uint8_t first, uint8_t *data, int count);
+ *  Read 'count' consecutive registers starting at 'first' in one
+ *  transaction (register pointer auto-increment), or one by one if the
+ *  device turned out not to support it.
+ */
+static int max6639_read_burst(uint8_t first, uint8_t *data, int count) {
+  int rc = 0;
+  if (_max6639_burst) {
+    return marble_I2C_cmdrecv(I2C_PM, MAX6639, first, data, count);
   }
-  return rval;
+  for (int n = 0; n < count; n++) {
+    rc |= marble_I2C_cmdrecv(I2C_PM, MAX6639, first + n, &data[n], 1);
+  }
+  return rc;
 }
 
-int max6639_get_cached_temp(int regno) {
-  switch (regno) {
-    case MAX6639_TEMP_CH1: return max6639_temp_ch1;
-    case MAX6639_TEMP_EXT_CH1: return max6639_temp_ext_ch1;
-    case MAX6639_TEMP_CH2: return max6639_temp_ch2;
-    case MAX6639_TEMP_EXT_CH2: return max6639_temp_ext_ch2;
-    default: break;
+/*
+ * static void max6639_check_burst(void);
+ *  Compare a burst read of the adjacent DEV_ID and MFG_ID registers, which
+ *  hold different constants, with single reads.  A device that does not
+ *  auto-increment returns DEV_ID twice; fall back to single reads then, or
+ *  if the IDs can't tell the two apart.
+ */
+static void max6639_check_burst(void) {
+  uint8_t burst[2], single[2];
+  int rc = marble_I2C_cmdrecv(I2C_PM, MAX6639, MAX6639_DEV_ID, burst, 2);
+  rc |= marble_I2C_cmdrecv(I2C_PM, MAX6639, MAX6639_DEV_ID, &single[0], 1);
+  rc |= marble_I2C_cmdrecv(I2C_PM, MAX6639, MAX6639_MFG_ID, &single[1], 1);
+  if (rc) {
+    return;   // Try again next time
   }
-  return 0;
+  _max6639_burst = ((single[0] != single[1]) && (burst[0] == single[0]) &&
+                    (burst[1] == single[1])) ? 1 : 0;
+  if (!_max6639_burst) {
+    printf("MAX6639: no register auto-increment, using single reads\r\n");
+  }
+  return;
+}
+
+/*
+ * int max6639_snapshot_update(void);
+ *  Fetch all monitored MAX6639 registers (temperatures, tachometers and
+ *  duties) in max6639_bursts[].  STATUS (0x02) sits between the temperature
+ *  registers but clears on read, so those take two bursts.  The snapshot is
+ *  only replaced if all reads succeed.
+ */
+int max6639_snapshot_update(void) {
+  uint8_t snap[MAX6639_SNAPSHOT_REGS];
+  int rc = 0;
+  if (_max6639_burst < 0) {
+    max6639_check_burst();
+  }
+  for (unsigned int n = 0; n < sizeof(max6639_bursts)/sizeof(*max6639_bursts); n++) {
+    rc |= max6639_read_burst(max6639_bursts[n].first, &snap[max6639_bursts[n].first],
+                             max6639_bursts[n].count);
+  }
+  if (rc == 0) {
+    for (unsigned int n = 0; n < sizeof(max6639_bursts)/sizeof(*max6639_bursts); n++) {
+      memcpy(&_max6639_snap[max6639_bursts[n].first], &snap[max6639_bursts[n].first],
+             max6639_bursts[n].count);
+    }
+    _max6639_snap_valid = 1;
+  }
+  return rc;
+}
+
+/*
+ * int max6639_snapshot_reg(int regno);
+ *  Raw value of register 'regno' from the last snapshot (0 if it is not
+ *  part of the snapshot or none has been taken).
+ */
+int max6639_snapshot_reg(int regno) {
+  if ((regno < 0) || (regno >= MAX6639_SNAPSHOT_REGS) || !_max6639_snap_valid) {
+    return 0;
+  }
+  return (int)_max6639_snap[regno];
+}
+
+/*
+ * int I2C_PM_monitor_update(void);
+ *  Refresh the MAX6639 snapshot and both LM75 temperatures.  The mailbox,
+ *  display, console and fan control all read these copies.
+ */
+int I2C_PM_monitor_update(void) {
+  int rc = max6639_snapshot_update();
+  rc |= LM75_update_temperature(LM75_0);
+  rc |= LM75_update_temperature(LM75_1);
+  return rc;
 }
 
 int max6639_set_fans(int speed)
@@ -138,9 +239,37 @@ void print_max6639_decoded(void)
   unsigned int vTemp, vTempExt;
   double temp;
   int rTemp, rTempExt;
-  int rval;
+  // Temperatures come from one fresh snapshot, so both channels are coherent
+  int rval = max6639_snapshot_update();
+  if (report_structured()) {
+    char key[4];
+    report_begin("max6639");
+    if (!rval) {
+      vTemp = max6639_snapshot_reg(MAX6639_TEMP_CH1);
+      vTempExt = max6639_snapshot_reg(MAX6639_TEMP_EXT_CH1);
+      report_float("ch1_temp", (float)MAX6639_GET_TEMP_DOUBLE(vTemp, vTempExt));
+      vTemp = max6639_snapshot_reg(MAX6639_TEMP_CH2);
+      vTempExt = max6639_snapshot_reg(MAX6639_TEMP_EXT_CH2);
+      report_float("ch2_temp", (float)MAX6639_GET_TEMP_DOUBLE(vTemp, vTempExt));
+    }
+#define X(nReg, desc) \
+    do{ \
+      if (get_max6639_reg(nReg, &vTemp) == 0) { \
+        snprintf(key, sizeof(key), "r%02x", (unsigned) nReg); \
+        report_hex(key, vTemp); \
+      } \
+    }while(0);
+    MAX6639_FOR_EACH_REGISTER();
+#undef X
+    report_end();
+    return;
+  }
   printf("MAX6639 Temperatures:\n");
-  // Read/decode temperature for channels 1 and 2
+  if (rval) {
+    printf("I2C fault!\r\n");
+    return;
+  }
+  // Decode temperature for channels 1 and 2
   for (int nChan = 1; nChan < 3; nChan++) {
     if (nChan == 1) {
       rTemp = MAX6639_TEMP_CH1;
@@ -149,12 +278,8 @@ void print_max6639_decoded(void)
       rTemp = MAX6639_TEMP_CH2;
       rTempExt = MAX6639_TEMP_EXT_CH2;
     }
-    rval = get_max6639_reg(rTemp, &vTemp);
-    rval |= get_max6639_reg(rTempExt, &vTempExt);
-    if (rval) {
-      printf("I2C fault!\r\n");
-      return;
-    }
+    vTemp = max6639_snapshot_reg(rTemp);
+    vTempExt = max6639_snapshot_reg(rTempExt);
     temp = MAX6639_GET_TEMP_DOUBLE(vTemp, vTempExt);
     printf("  Ch %d Temp = %.3f\n", nChan, temp);
   }
@@ -174,15 +299,40 @@ void print_max6639_decoded(void)
 * LM75 Register interface
 ************/
 
+static uint8_t *LM75_pointer(uint8_t dev)
+{
+   if (dev == LM75_0) {
+      return &lm75_0_pointer;
+   } else if (dev == LM75_1) {
+      return &lm75_1_pointer;
+   }
+   return NULL;
+}
+
+/*
+ * static int LM75_readwrite(uint8_t dev, LM75_REG reg, int *data, bool rnw);
+ *  Reads first select 'reg' with a pointer write, which is skipped if the
+ *  pointer is known to select it already (i.e. repeated TEMP reads).
+ *  Writes carry the register themselves.
+ */
 static int LM75_readwrite(uint8_t dev, LM75_REG reg, int *data, bool rnw)
 {
    uint8_t i2c_buf[3];
-   int i2c_stat;
+   int i2c_stat = 0;
    short temp;
+   uint8_t *pointer = LM75_pointer(dev);
 
    // Select register
-   i2c_buf[0] = reg;
-   i2c_stat = marble_I2C_send(I2C_PM, dev, i2c_buf, 1);
+   if (rnw && ((pointer == NULL) || (*pointer != (uint8_t)reg))) {
+      i2c_buf[0] = reg;
+      i2c_stat = marble_I2C_send(I2C_PM, dev, i2c_buf, 1);
+      if (i2c_stat) {
+         if (pointer != NULL) {
+            *pointer = 0xff;
+         }
+         return i2c_stat;
+      }
+   }
    switch (reg) {
       case LM75_TEMP:
       case LM75_HYST:
@@ -212,6 +362,9 @@ static int LM75_readwrite(uint8_t dev, LM75_REG reg, int *data, bool rnw)
       default:
          break;
    }
+   if (pointer != NULL) {
+      *pointer = i2c_stat ? 0xff : (uint8_t)reg;
+   }
    return i2c_stat;
 }
 
@@ -247,6 +400,20 @@ void LM75_print(uint8_t dev)
 void LM75_print_decoded(uint8_t dev)
 {
   int vTemp;
+  if (report_structured()) {
+    report_begin("lm75");
+    report_hex("dev", dev);
+#define X(name, val) \
+    do{ \
+      if (LM75_read(dev, (unsigned) val, &vTemp) == 0) { \
+        report_int(#name, vTemp); \
+      } \
+    }while(0);
+    LM75_FOR_EACH_REGISTER()
+#undef X
+    report_end();
+    return;
+  }
   if (dev == LM75_0) {
     // FIXME This non-portable (Marble version-specific) information is nevertheless very helpful.
     printf("LM75_0 (U29) is on the PCB bottom between FPGA and power supply\r\nRegisters:\r\n");
@@ -293,21 +460,31 @@ int LM75_set_overtemp(int ot) {
   return rc;
 }
 
+/*
+ * static int LM75_update_temperature(uint8_t dev);
+ *  Read the temperature of LM75 'dev' into its cached copy (kept on failure).
+ */
+static int LM75_update_temperature(uint8_t dev) {
+  int temp;
+  int rc = LM75_read(dev, LM75_TEMP, &temp);
+  if (rc == 0) {
+    if (dev == LM75_0) {
+      lm75_0_temperature = temp;
+    } else if (dev == LM75_1) {
+      lm75_1_temperature = temp;
+    }
+  }
+  return rc;
+}
+
 /* int LM75_get_temperature(uint8_t dev);
-    Returns temperature from LM75 at address 'dev' in units of 0.5degC
+    Reads and returns temperature from LM75 at address 'dev' in units of 0.5degC
     @params
       uint8_t dev: one of LM75_0, LM75_1
  */
 int LM75_get_temperature(uint8_t dev) {
-  int temp;
-  LM75_read(dev, LM75_TEMP, &temp);
-  // Store copy in RAM for display driver to pick up if needed
-  if (dev == LM75_0) {
-    lm75_0_temperature = temp;
-  } else if (dev == LM75_1) {
-    lm75_1_temperature = temp;
-  }
-  return temp;
+  LM75_update_temperature(dev);
+  return LM75_get_cached_temperature(dev);
 }
 
 int LM75_get_cached_temperature(uint8_t dev) {
@@ -402,6 +579,38 @@ void i2c_pm_hook(uint8_t addr, uint8_t rnw, int cmd, const uint8_t *data, int le
 
 
 int PMBridge_xact(uint16_t *xact, int len) {
+  int rval = PMBridge_xact_recv(xact, len, NULL);
+  return rval < 0 ? rval : 0;
+}
+
+/* int PMBridge_xact_recv(uint16_t *xact, int len, uint8_t *rdata);
+ *  Same as PMBridge_xact() but for read transactions the bytes read back
+ *  are also copied to 'rdata' (if not NULL).  'rdata' must have room for
+ *  one byte per PMBRIDGE_XACT_READ_ONE in 'xact', or PMBRIDGE_BLOCK_MAX+1
+ *  bytes for PMBRIDGE_XACT_READ_BLOCK (the byte count N followed by N bytes).
+ *  Returns the number of bytes read (0 for writes) or negative on error.
+ */
+int PMBridge_xact_recv(uint16_t *xact, int len, uint8_t *rdata) {
+  if (PMBridge_vet_xact(xact, len)) {
+    return -1;
+  }
+  /* ====================== Context-Aware Sanitation ==========================
+   * Limits only enforced for WRITE transactions
+   * This step can be skipped with compile-time macro PMBUS_REMOVE_SAFEGUARDS
+   */
+#ifndef PMBUS_REMOVE_SAFEGUARDS
+  if (!PMBRIDGE_XACT_IS_READ(xact, len)) {
+    ltm4673_apply_limits(xact, len);
+  }
+  // Add more device-specific safeguards here
+#endif
+  return PMBridge_do_sanitized_xact(xact, len, rdata, 1);
+}
+
+/* static int PMBridge_vet_xact(const uint16_t *xact, int len);
+ *  Check the syntax of a single transaction.  Returns 0 if valid.
+ */
+static int PMBridge_vet_xact(const uint16_t *xact, int len) {
   // Msg bytes:
   //  | Addr + rnw | command_code | [data] ... |
   /* ===================== Message Syntax Validation =========================
@@ -411,6 +620,8 @@ int PMBridge_xact(uint16_t *xact, int len) {
    *  if xact[2] is PMBRIDGE_XACT_REPEAT_START: (xact is read)
    *    xact[3] MUST be Addr+r
    *    xact[4] MUST be either PMBRIDGE_XACT_READ_ONE or PMBRIDGE_XACT_READ_BLOCK
+   *    xact[5:] MUST be PMBRIDGE_XACT_READ_ONE (after PMBRIDGE_XACT_READ_ONE)
+   *    or absent (after PMBRIDGE_XACT_READ_BLOCK)
    *  elif xact[2] is PMBRIDGE_XACT_READ_ONE or PMBRIDGE_XACT_READ_BLOCK:
    *    ERROR!
    *  else: (xact is write)
@@ -421,7 +632,6 @@ int PMBridge_xact(uint16_t *xact, int len) {
     return -1;
   }
   unsigned int syntax_invalid = 0;
-  unsigned int read = 0;
   // Recall I2C addresses above 8-bit 0xee (7-bit 0x77) are reserved for 10-bit addressing
   if (xact[0] > 0xee) {
     syntax_invalid |= (1U);
@@ -436,7 +646,6 @@ int PMBridge_xact(uint16_t *xact, int len) {
   }
   if (len > 2) {
     if (xact[2] == PMBRIDGE_XACT_REPEAT_START) {
-      read = 1;
       if (len > 4) {
         if (!(xact[3] & 0x1)) {
           printf("Repeat Start not followed by a read\r\n");
@@ -446,6 +655,13 @@ int PMBridge_xact(uint16_t *xact, int len) {
           printf("Repeat Start not followed by PMBRIDGE_XACT_READ_ONE or PMBRIDGE_XACT_READ_BLOCK\r\n");
           syntax_invalid |= (1U<<4);
         }
+        for (int n = 5; n < len; n++) {
+          if ((xact[4] == PMBRIDGE_XACT_READ_BLOCK) || (xact[n] != PMBRIDGE_XACT_READ_ONE)) {
+            printf("Read must be all PMBRIDGE_XACT_READ_ONE or a single PMBRIDGE_XACT_READ_BLOCK\r\n");
+            syntax_invalid |= (1U<<6);
+            break;
+          }
+        }
       } else {
         printf("Repeat Start not followed by Addr+rd and PMBRIDGE_XACT_READ_ONE or PMBRIDGE_XACT_READ_BLOCK\r\n");
         syntax_invalid |= (1U<<5);
@@ -461,59 +677,62 @@ int PMBridge_xact(uint16_t *xact, int len) {
     printf("Invalid transaction syntax: 0x%x\r\n", syntax_invalid);
     return -1;
   }
-  /* ====================== Context-Aware Sanitation ==========================
-   * Limits only enforced for WRITE transactions
-   * This step can be skipped with compile-time macro PMBUS_REMOVE_SAFEGUARDS
-   */
-#ifndef PMBUS_REMOVE_SAFEGUARDS
-  if (!read) {
-    ltm4673_apply_limits(xact, len);
-  }
-  // Add more device-specific safeguards here
-#endif
-  return PMBridge_do_sanitized_xact(xact, len);
+  return 0;
 }
 
-/* static int PMBridge_do_sanitized_xact(uint16_t *xact, int len);
+/* static int PMBridge_do_sanitized_xact(uint16_t *xact, int len, uint8_t *rdata, int verbose);
  *  NOTE! This function assumes the transaction 'xact' has already been
  *  sanitized (checked for syntax violations), thus certain length checks
  *  are not made here (as they would be redundant).  Make sure to only
  *  use this with sanitized transactions vetted by (e.g.) PMBridge_xact()
+ *  If 'verbose', print the readback and any failures and run the PMBridge
+ *  hooks.  Returns the number of bytes read or the negated HAL error code.
  */
-static int PMBridge_do_sanitized_xact(uint16_t *xact, int len) {
+static int PMBridge_do_sanitized_xact(uint16_t *xact, int len, uint8_t *rdata, int verbose) {
   // Perform I2C transaction
-  int read = 0;
+  int read = PMBRIDGE_XACT_IS_READ(xact, len);
   int rval;
-  uint8_t data[PMBRIDGE_XACT_MAX_ITEMS-2];
-  if (xact[2] == PMBRIDGE_XACT_REPEAT_START) {
-    read = 1;
-    if (xact[4] == PMBRIDGE_XACT_READ_BLOCK) {
-      printf("READ_BLOCK not yet implemented. Discarding transaction.\r\n");
-      return -1;
-    }
-  }
+  int nread = 0;
+  static uint8_t data[PMBRIDGE_BLOCK_MAX+1];
   if (read) {
-    rval = marble_I2C_cmdrecv(I2C_PM, (uint8_t)xact[0], (uint8_t)xact[1], data, len-4);
-    PMBridge_hook_read((uint8_t)xact[0], (uint8_t)xact[1], data, len-4);
-    if (rval != HAL_OK) {
-      printf("Read failed with code: 0x%x\r\n", (unsigned) rval);
+    if (xact[4] == PMBRIDGE_XACT_READ_BLOCK) {
+      // READ_BLOCK: fetch the byte count N, then re-issue the read for all N+1 bytes
+      rval = marble_I2C_cmdrecv(I2C_PM, (uint8_t)xact[0], (uint8_t)xact[1], data, 1);
+      if (rval == HAL_OK) {
+        nread = (int)data[0] + 1;
+        rval = marble_I2C_cmdrecv(I2C_PM, (uint8_t)xact[0], (uint8_t)xact[1], data, nread);
+      }
     } else {
-      // Readback
-      printf("(0x%02x) 0x%02x:", xact[0], xact[1]);
-      for (int n = 0; n < len-4; n++) {
-         printf(" 0x%02x", data[n]);
+      nread = len-4;
+      rval = marble_I2C_cmdrecv(I2C_PM, (uint8_t)xact[0], (uint8_t)xact[1], data, nread);
+    }
+    if (verbose) {
+      PMBridge_hook_read((uint8_t)xact[0], (uint8_t)xact[1], data, nread);
+      if (rval != HAL_OK) {
+        printf("Read failed with code: 0x%x\r\n", (unsigned) rval);
+      } else {
+        // Readback
+        printf("(0x%02x) 0x%02x:", xact[0], xact[1]);
+        for (int n = 0; n < nread; n++) {
+           printf(" 0x%02x", data[n]);
+        }
       }
+      printf("\r\n");
+    }
+    if ((rval == HAL_OK) && rdata) {
+      memcpy(rdata, data, nread);
     }
-    printf("\r\n");
   } else {
     for (int n = 0; n < len-1; n++) {
       // Data to send must be uint8_t, not uint16_t
       data[n] = (uint8_t)(xact[n+1] & 0xff);
     }
     rval = marble_I2C_send(I2C_PM, (uint8_t)xact[0], data, len-1);
-    PMBridge_hook_write((uint8_t)xact[0], data, len-1);
-    if (rval != HAL_OK) {
-      printf("Write failed with code: 0x%x\r\n", (unsigned) rval);
+    if (verbose) {
+      PMBridge_hook_write((uint8_t)xact[0], data, len-1);
+      if (rval != HAL_OK) {
+        printf("Write failed with code: 0x%x\r\n", (unsigned) rval);
+      }
     }
   }
   // READ:
@@ -523,8 +742,99 @@ static int PMBridge_do_sanitized_xact(uint16_t *xact, int len) {
   // SEND_BYTE:
   //  int marble_I2C_send(I2C_BUS I2C_bus, uint8_t addr, const uint8_t *data, int size) {
   //  (may also be able to use marble_I2C_cmdsend() with size=0; not sure)
-  // READ_BLOCK:
-  //  Will need custom driver.  Don't implement for now.
+  if (rval != HAL_OK) {
+    return -rval;
+  }
+  return nread;
+}
+
+/* int PMBridge_xact_batch(uint16_t *items, int len);
+ *  Run a list of transactions separated by PMBRIDGE_XACT_SEPARATOR
+ *  back-to-back on I2C_PM.  The whole list is checked (syntax, number of
+ *  transactions, space for readback) before anything is sent; limits are
+ *  applied to each write just before it runs so PAGE changes earlier in the
+ *  batch are honored.  Execution stops at the first failure.
+ *  Prints a single compact response line:
+ *    "PMB r0 r1 ... OK"  or  "PMB r0 ... ERR index code"
+ *  where rN is '-' for a write or the bytes read in hex (for READ_BLOCK,
+ *  the byte count first) and 'index' is the failing transaction.
+ *  Returns 0 on success or the error code.
+ */
+int PMBridge_xact_batch(uint16_t *items, int len) {
+  static uint8_t rdata[PMBRIDGE_BATCH_RDATA_MAX];
+  int starts[PMBRIDGE_BATCH_MAX_XACTS];
+  int lens[PMBRIDGE_BATCH_MAX_XACTS];
+  int nreads[PMBRIDGE_BATCH_MAX_XACTS];
+  int nxact = 0;
+  int start = 0;
+  int reserved = 0;
+  int rval = 0;
+  int n;
+  // Split and vet every transaction before touching the bus
+  for (n = 0; n <= len; n++) {
+    if ((n < len) && (items[n] != PMBRIDGE_XACT_SEPARATOR)) {
+      continue;
+    }
+    if (nxact == PMBRIDGE_BATCH_MAX_XACTS) {
+      printf("PMB ERR %d -1\r\n", nxact);
+      return -1;
+    }
+    starts[nxact] = start;
+    lens[nxact] = n - start;
+    if ((lens[nxact] > PMBRIDGE_XACT_MAX_ITEMS) || PMBridge_vet_xact(items + start, n - start)) {
+      printf("PMB ERR %d -1\r\n", nxact);
+      return -1;
+    }
+    if (PMBRIDGE_XACT_IS_READ(items + start, n - start)) {
+      if (items[start + 4] == PMBRIDGE_XACT_READ_BLOCK) {
+        reserved += PMBRIDGE_BLOCK_MAX + 1;
+      } else {
+        reserved += lens[nxact] - 4;
+      }
+    }
+    if (reserved > PMBRIDGE_BATCH_RDATA_MAX) {
+      printf("PMB ERR %d -1\r\n", nxact);
+      return -1;
+    }
+    nxact++;
+    start = n + 1;
+  }
+  // Run them
+  int offset = 0;
+  for (n = 0; n < nxact; n++) {
+#ifndef PMBUS_REMOVE_SAFEGUARDS
+    if (!PMBRIDGE_XACT_IS_READ(items + starts[n], lens[n])) {
+      ltm4673_apply_limits(items + starts[n], lens[n]);
+    }
+#endif
+    rval = PMBridge_do_sanitized_xact(items + starts[n], lens[n], rdata + offset, 0);
+    if (rval < 0) {
+      break;
+    }
+    nreads[n] = rval;
+    offset += rval;
+    rval = 0;
+  }
+  // Report
+  int ndone = n;
+  offset = 0;
+  printf("PMB");
+  for (n = 0; n < ndone; n++) {
+    if (PMBRIDGE_XACT_IS_READ(items + starts[n], lens[n])) {
+      printf(" ");
+      for (int m = 0; m < nreads[n]; m++) {
+        printf("%02x", rdata[offset + m]);
+      }
+      offset += nreads[n];
+    } else {
+      printf(" -");
+    }
+  }
+  if (rval) {
+    printf(" ERR %d %d\r\n", ndone, rval);
+  } else {
+    printf(" OK\r\n");
+  }
   return rval;
 }
 
@@ -815,183 +1125,391 @@ static int xrp_pull(uint8_t dev, unsigned len)
 }
 #endif
 
-// See Figures 3 and 4 of ANP-38
-// Figure 3:  cmd is FLASH_PAGE_CLEAR (0x4E),  mode is 1,  dwell is 10
-// Figure 4:  cmd is FLASH_PAGE_ERASE (0x4F),  mode is 5,  dwell is 50
-static int xrp_process_flash(uint8_t dev, int page_no, int cmd, int mode, int dwell)
+// Temporarily abandon hex record concept
+#ifdef APP_MINI
+// Data originally based on python hex2c.py < MarbleMini.hex
+// Pure copy of 7 x 64-byte pages, spanning addresses 0x0000 to 0x01bf
+static const uint8_t xrp_flash_image[] = {
+   "\xFF\xC5\x00\x0A\x03\x41\x00\xFA\x02\xDA\x20\x27\xE1\x28\x33\x0D"
+   "\x00\x00\x03\x00\x56\x00\x12\x02\x69\x97\x4A\x26\x28\x3C\x20\x01"
+   "\x01\x01\x01\x01\x01\x1E\x1E\xCE\x04\xB0\x0D\x00\x40\x00\x40\xCB"
+   "\x00\x12\x6C\x1E\x1E\x0C\x2E\x69\x98\x0A\x4D\x20\x00\x00\x08\xC4"
+   "\xFF\xC5\x00\x0A\x03\x41\x00\xFA\x02\xDA\x20\x13\xE1\x14\x33\x0D"
+   "\x00\x00\x03\x00\x50\x00\x11\x02\x65\x9B\x4E\x24\x26\x3C\x14\x08"
+   "\x08\x08\x08\x08\x08\x1D\x1E\xCE\x04\xB0\x0D\x00\x40\x00\x40\xCB"
+   "\x00\x3E\x64\x7B\x7B\x1D\xF2\x48\x05\x1A\x26\x20\x00\x11\x18\x02"
+   "\xFF\xC5\x00\x0A\x03\x41\x00\xFA\x02\xDA\x20\x09\xE1\x14\x33\x0D"
+   "\x00\x00\x04\x00\x6A\x00\x16\x02\x45\xBB\x5F\x2D\x31\x3C\x1A\x02"
+   "\x02\x02\x02\x02\x02\x1C\x1E\xCE\x04\xB0\x0D\x00\x40\x00\x40\xCB"
+   "\x00\x35\x42\x7B\x7B\x16\x48\x57\xE5\x12\x07\x20\x00\x21\x18\x07"
+   "\xFF\xC5\x00\x0A\x03\x41\x00\xFA\x02\xDA\x20\x27\xE1\x28\x33\x0D"
+   "\x00\x00\x03\x00\x40\x00\x0D\x02\x51\xAF\x58\x3F\x45\x3C\x10\x40"
+   "\x40\x40\x40\x40\x40\x1E\x1E\xCE\x04\xB0\x0D\x00\x40\x00\x40\xCB"
+   "\x00\x43\x50\x1E\x1E\x19\x5C\x4F\x6F\x17\x40\x29\x77\x01\x18\xFC"
+   "\x05\x0F\xFF\x4C\x4F\x4C\x1E\x1C\x00\x30\x01\x9F\x55\x04\x04\x00"
+   "\x10\x16\x04\x0A\x10\x00\x00\x00\x00\x20\x0F\x17\x10\x17\x0F\x6C"
+   "\x64\x42\x50\x30\x18\x0C\x30\x00\x00\x00\x00\x00\x00\x00\x00\xFF"
+   "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\x0F\x00\x00\x00\x71"
+   "\x00\x00\x00\x02\x00\x00\x37\x00\x00\x0F\x04\x02\x06\x02\x0A\x09"
+   "\x0B\x09\x00\x00\x00\x00\x0F\x00\x02\x00\x00\x00\x00\x01\x00\x00"
+   "\x00\x00\x00\x04\x04\x00\x00\x00\x61\x62\x61\x61\x61\x00\x00\x62"
+   "\x01\x62\xFA\x00\x80\x00\x00\xFF\x12\x02\xE2\x00\x1D\x00\x00\xF3"
+   "\x00\x02\x50\x00\x00\xFF\xFF\xFA\x06\xFA\x04\xFA\x02\x96\x01\x00"
+   "\x00\x00\x00\x00\x00\x00\x02\x00\x04\x00\x07\x00\x00\x00\x00\x64"
+   "\x21\x64\x64\x64\x21\x64\x64\x64\x21\x64\x64\x64\x21\x64\x64\x0A"
+   "\x20\x0A\x05\x19\x00\xFF\x00\x00\x00\xFF\xFF\x00\x04\xFF\xFF\xCF"
+};
+#else
+#ifdef APP_MARBLE
+// Data based on python hex2c_linear.py < Marble_flash.hex
+// Pure copy of 7 x 64-byte pages, spanning addresses 0x0000 to 0x01bf
+static const uint8_t xrp_flash_image[] = {
+   "\xFF\xC5\x00\x0A\x03\x41\x00\xFA\x02\xDA\x20\x13\xE1\x14\x33\x0D"
+   "\x00\x00\x03\x00\x50\x00\x11\x02\x15\xEB\x4E\x29\x2B\x3C\x14\x01"
+   "\x01\x01\x01\x01\x01\x1C\x1E\xCE\x04\xB0\x0D\x00\x40\x00\x40\xCB"
+   "\x00\x48\x64\x3D\x3D\x21\x65\x41\x44\x1D\x73\x21\x7F\x11\x18\xA4"
+   "\xFF\xC5\x00\x0A\x03\x41\x00\xFA\x02\xDA\x20\x1D\xE1\x14\x33\x0D"
+   "\x00\x00\x04\x00\x6A\x00\x16\x02\x0D\xF3\x5F\x35\x3A\x3C\x0D\x04"
+   "\x04\x04\x04\x04\x04\x1B\x1E\xCE\x04\xB0\x0D\x00\x40\x00\x40\xCB"
+   "\x00\x76\x42\x7B\x7B\x17\x39\x54\xC7\x14\x1A\x23\x7D\x22\x28\xF7"
+   "\xFF\xC5\x00\x0A\x03\x41\x00\xFA\x02\xDA\x20\x27\xE1\x28\x33\x0D"
+   "\x00\x00\x03\x00\x40\x00\x0D\x02\x11\xEF\x58\x4D\x56\x3C\x10\x80"
+   "\x80\x80\x80\x80\x80\x1D\x1E\xCE\x04\xB0\x0D\x00\x40\x00\x40\xCB"
+   "\x00\x44\x50\x1E\x1E\x17\xD6\x52\x56\x15\xDD\x2A\x76\x01\x18\x76"
+   "\xFF\xC5\x00\x0A\x03\x41\x00\xFA\x02\xDA\x20\x13\xE1\x28\x33\x0D"
+   "\x00\x00\x05\x00\x73\x00\x18\x02\x91\x6F\x5C\x2E\x31\x3C\x16\x40"
+   "\x40\x40\x40\x40\x40\x1D\x1E\xCE\x04\xB0\x0D\x00\x40\x00\x40\xCB"
+   "\x00\x22\x48\x3D\x3D\x22\x27\x41\x68\x1C\xA8\x20\x00\x10\x08\x8F"
+   "\x05\x00\x00\x4C\x4F\x4C\x1E\x1C\x00\x30\x01\x9F\x55\x02\x02\x00"
+   "\x08\x16\x04\x0A\x10\x00\x00\x00\x00\x10\x0F\x17\x10\x17\x0F\x64"
+   "\x42\x50\x48\x18\x0C\x30\x18\x00\x00\x00\x00\x00\x00\x00\x00\xFF"
+   "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\x0F\x00\x00\x00\xE1"
+   "\x00\x00\x00\x02\x00\x00\x37\x00\x00\x0F\x02\x03\x02\x04\x09\x09"
+   "\x09\x0A\x00\x00\x00\x00\x0F\x00\x02\x00\x00\x00\x00\x01\x00\x00"
+   "\x00\x00\x00\x04\x04\x00\x00\x00\x62\x61\x61\x61\x61\x00\x00\x62"
+   "\x01\x62\xFA\x00\x80\x00\x00\xFF\x12\x02\xE1\x00\x1E\x00\x00\xD5"
+   "\x00\x02\x50\x00\x00\xFF\xFF\x32\x04\x32\x06\x32\x00\x00\x03\x00"
+   "\x00\x00\x00\x00\x00\x00\x02\x00\x04\x00\x07\x00\x00\x00\x00\x64"
+   "\x21\x64\x64\x64\x20\x64\x64\x64\x21\x64\x64\x64\x22\x64\x64\x0A"
+   "\x20\x0A\x05\x19\xFF\x00\x00\x00\x00\xFF\xFF\x00\x04\xFF\xFF\x12"
+};
+#endif /* ifdef APP_MARBLE */
+#endif /* ifdef APP_MINI */
+
+#define XRP_FLASH_PAGES        (7)
+#define XRP_FLASH_PAGE_SIZE   (64)
+
+/* Flash programming (ANP-38 Figures 3, 4 and 5) as a state machine, so the
+ * rest of the MMC keeps running during the several seconds it takes.
+ * xrp_flash() starts it and xrp_flash_service(), called from the main loop,
+ * performs at most one step (one or two I2C transactions) per call once the
+ * step's delay has elapsed.
+ */
+typedef enum {
+   XRPF_IDLE = 0,
+   XRPF_PROC_DELAY,     // Fig. 3/4: YFLASHPGMDELAY <= 0xff
+   XRPF_PROC_INIT,      // FLASH_INIT (0x4D) <= mode
+   XRPF_PROC_CMD,       // FLASH_PAGE_CLEAR (0x4E) or FLASH_PAGE_ERASE (0x4F) <= page
+   XRPF_PROC_POLL,      // Until that command's busy byte clears
+   XRPF_PROC_CHECK,     // YFLASHPGMDELAY must still read 0xff
+   XRPF_PGM_DELAY,      // Fig. 5: YFLASHPGMDELAY <= 0xff
+   XRPF_PGM_INIT,       // Check YFLASHPGMDELAY, FLASH_INIT (0x4D) <= 1
+   XRPF_PGM_ADDR,       // FLASH_PROGRAM_ADDRESS (0x40) <= page address
+   XRPF_PGM_ADDR_CHECK,
+   XRPF_PGM_WRITE,      // FLASH_PROGRAM_DATA (0x41) <= one word
+   XRPF_PGM_READ,       // FLASH_PROGRAM_DATA_INC_ADDRESS (0x42) readback
+   XRPF_VFY_ADDR,       // FLASH_PROGRAM_ADDRESS (0x40) <= page address
+   XRPF_VFY_ADDR_CHECK,
+   XRPF_VFY_BLOCK,      // Whole page in one read of 0x42
+   XRPF_VFY_WORD,       // Fallback: one word per read of 0x42
+   XRPF_PGM_DONE,       // YFLASHPGMDELAY must still read 0xff
+   XRPF_DONE,
+   XRPF_FAILED
+} xrpf_state_t;
+
+static const char *xrpf_state_names[] = {
+   "idle", "delay", "init", "cmd", "poll", "check",
+   "pgm delay", "pgm init", "pgm addr", "pgm addr check", "write", "readback",
+   "verify addr", "verify addr check", "verify", "verify word", "page check",
+   "done", "failed"};
+
+// Figure 3: FLASH_PAGE_CLEAR, mode 1, dwell 10 ms
+// Figure 4: FLASH_PAGE_ERASE, mode 5, dwell 50 ms
+static const struct {uint8_t cmd; uint8_t mode; uint8_t dwell; const char *name;} xrpf_phases[] = {
+   {0x4E, 1, 10, "FLASH_PAGE_CLEAR"},
+   {0x4F, 5, 50, "FLASH_PAGE_ERASE"}};
+
+static struct {
+   xrpf_state_t state;
+   uint8_t dev;
+   uint8_t phase;       // Index into xrpf_phases[]
+   uint8_t word_vfy;    // Block verify failed; re-verify one word at a time
+   unsigned page;
+   unsigned retry;      // Of the whole clear/erase sequence, up to 5
+   unsigned outer;      // Commands answered with status 0xff, up to 10
+   unsigned poll;       // Busy polls, up to 20
+   unsigned offset;     // Byte offset within the page
+   uint32_t t_wake;     // marble_get_us() before which the state doesn't run
+   uint32_t t_start;
+} _xf = {XRPF_IDLE};
+
+static void xrpf_next(xrpf_state_t state, unsigned delay_ms);
+static int xrpf_write_check(uint8_t regno, uint16_t d);
+static int xrpf_step(void);
+
+static void xrpf_next(xrpf_state_t state, unsigned delay_ms)
 {
-  if (marble_get_pcb_rev() > Marble_v1_3) {
-    printf("XRP7724 not present; bypassed.\n");
-    return 0;
-  }
+   _xf.state = state;
+   _xf.t_wake = marble_get_us() + delay_ms*1000;
+}
+
+/* static int xrpf_write_check(uint8_t regno, uint16_t d);
+ *  Second half of xrp_reg_write_check(): 0 if r[regno] reads back as 'd'.
+ */
+static int xrpf_write_check(uint8_t regno, uint16_t d)
+{
+   uint8_t i2c_dat[2] = {0xde, 0xad};
+   int rc = marble_I2C_cmdrecv(I2C_PM, _xf.dev, regno, i2c_dat, 2);
+   unsigned value = (((unsigned) i2c_dat[0]) << 8) | i2c_dat[1];
+   if (rc != HAL_OK || value != d) {
+      printf("r[%2.2x] = 0x%4.4x, want 0x%4.4x, rc = %d\r\n", regno, value, d, rc);
+      return 1;
+   }
+   return 0;
+}
+
+/* static int xrpf_step(void);
+ *  Perform the current state's transactions and schedule the next state.
+ *  Returns non-zero if programming has to be abandoned.
+ */
+static int xrpf_step(void)
+{
+   const uint8_t *data = xrp_flash_image + _xf.page*XRP_FLASH_PAGE_SIZE;
+   const uint16_t addr = _xf.page*XRP_FLASH_PAGE_SIZE;
+   uint8_t yflashpgmdelay = 0xff;
+   uint8_t i2c_dat[XRP_FLASH_PAGE_SIZE];
+   unsigned int v;
    int rc;
-   uint8_t i2c_dat[4];
-   for (unsigned retry=0; retry<5; retry++) {
-      xrp_set2(dev, 0x8068, 0xff);  // YFLASHPGMDELAY
-      // FLASH_INIT (0x4D)
-      i2c_dat[0] = 0;  i2c_dat[1] = mode;
-      rc = marble_I2C_cmdsend(I2C_PM, dev, 0x4D, i2c_dat, 2);
-      if (rc != HAL_OK) return 1;
-      marble_SLEEP_ms(50);
-      unsigned int outer, status, busy;
-      for (outer=0; outer < 10; outer++) {
-         i2c_dat[0] = 0;  i2c_dat[1] = page_no;
-         rc = marble_I2C_cmdsend(I2C_PM, dev, cmd, i2c_dat, 2);
+   switch (_xf.state) {
+      case XRPF_PROC_DELAY:
+         printf("%s %u\r\n", xrpf_phases[_xf.phase].name, _xf.page);
+         rc = marble_I2C_cmdsend_a2(I2C_PM, _xf.dev, 0x8068, &yflashpgmdelay, 1);
+         if (rc != HAL_OK) return 1;
+         xrpf_next(XRPF_PROC_INIT, 10);
+         break;
+      case XRPF_PROC_INIT:
+         i2c_dat[0] = 0;  i2c_dat[1] = xrpf_phases[_xf.phase].mode;
+         rc = marble_I2C_cmdsend(I2C_PM, _xf.dev, 0x4D, i2c_dat, 2);
+         if (rc != HAL_OK) return 1;
+         _xf.outer = 0;
+         xrpf_next(XRPF_PROC_CMD, 50);
+         break;
+      case XRPF_PROC_CMD:
+         i2c_dat[0] = 0;  i2c_dat[1] = _xf.page;
+         rc = marble_I2C_cmdsend(I2C_PM, _xf.dev, xrpf_phases[_xf.phase].cmd, i2c_dat, 2);
+         if (rc != HAL_OK) return 1;
+         _xf.poll = 0;
+         xrpf_next(XRPF_PROC_POLL, 500);
+         break;
+      case XRPF_PROC_POLL:
+         rc = marble_I2C_cmdrecv(I2C_PM, _xf.dev, xrpf_phases[_xf.phase].cmd, i2c_dat, 2);
+         if (rc != HAL_OK) return 1;
+         // i2c_dat[0] is status, i2c_dat[1] is busy
+         if ((i2c_dat[1] != 0) && (++_xf.poll < 20)) {
+            xrpf_next(XRPF_PROC_POLL, xrpf_phases[_xf.phase].dwell);
+            break;
+         }
+         printf("page_no %u: %u polls, status 0x%2.2x\r\n", _xf.page, _xf.poll, i2c_dat[0]);
+         if (i2c_dat[1] != 0) {
+            printf("Timeout!\r\n");
+            return 1;
+         }
+         if (i2c_dat[0] != 0xff) {
+            xrpf_next(XRPF_PROC_CHECK, 0);
+         } else if (++_xf.outer < 10) {
+            xrpf_next(XRPF_PROC_CMD, 0);
+         } else {
+            printf("Status stuck at 0xFF!\r\n");
+            return 1;
+         }
+         break;
+      case XRPF_PROC_CHECK:
+         v = xrp_read2(_xf.dev, 0x8068);  // YFLASHPGMDELAY
+         if (v == 0xff) {
+            _xf.retry = 0;
+            if (++_xf.phase < sizeof(xrpf_phases)/sizeof(xrpf_phases[0])) {
+               xrpf_next(XRPF_PROC_DELAY, 0);
+            } else {
+               xrpf_next(XRPF_PGM_DELAY, 0);
+            }
+            break;
+         }
+         printf("YFLASHPGMDELAY = 0x%2.2x after %s; Fault %u!\r\n", v, xrpf_phases[_xf.phase].name, _xf.retry);
+         if (++_xf.retry >= 5) return 1;  // "Abort - Erasing the Flash has failed"
+         xrpf_next(XRPF_PROC_DELAY, 0);
+         break;
+      // On to Figure 5: Program Flash Image
+      case XRPF_PGM_DELAY:
+         rc = marble_I2C_cmdsend_a2(I2C_PM, _xf.dev, 0x8068, &yflashpgmdelay, 1);
          if (rc != HAL_OK) return 1;
-         marble_SLEEP_ms(500);
-         int poll;
-         for (poll=0; poll < 20; poll++) {
-            rc = marble_I2C_cmdrecv(I2C_PM, dev, cmd, i2c_dat, 2);
-            if (rc != HAL_OK) return 1;
-            status = i2c_dat[0];
-            busy = i2c_dat[1];
-            if (busy == 0) break;
-            marble_SLEEP_ms(dwell);
+         xrpf_next(XRPF_PGM_INIT, 12);
+         break;
+      case XRPF_PGM_INIT:
+         v = xrp_read2(_xf.dev, 0x8068);  // YFLASHPGMDELAY
+         if (v != 0xff) {
+            printf("YFLASHPGMDELAY = 0x%2.2x before programming; Fault!\r\n", v);
+            return 1;
          }
-         printf("page_no %d: %d polls, status 0x%2.2x\n", page_no, poll, status);
-         if (busy == 1) {
-            printf("Timeout!\n");
+         if (xrp_reg_write(_xf.dev, 0x4D, 1) != HAL_OK) return 1;  // FLASH_INIT (0x4D), mode=1
+         xrpf_next(XRPF_PGM_ADDR, 10);
+         break;
+      case XRPF_PGM_ADDR:
+      case XRPF_VFY_ADDR:
+         if (xrp_reg_write(_xf.dev, 0x40, addr) != HAL_OK) return 1;  // FLASH_PROGRAM_ADDRESS
+         xrpf_next(_xf.state == XRPF_PGM_ADDR ? XRPF_PGM_ADDR_CHECK : XRPF_VFY_ADDR_CHECK, 10);
+         break;
+      case XRPF_PGM_ADDR_CHECK:
+         if (xrpf_write_check(0x40, addr)) {
+            printf("can't set flash program address\r\n");
             return 1;
          }
-         if (status != 0xff) break;
-      }
-      if (status == 0xff) {
-         printf("Status stuck at 0xFF!\n");
-         return 1;
-      }
-      printf("Status OK\n");
-      // final check
-      unsigned int v = xrp_read2(dev, 0x8068);  // YFLASHPGMDELAY
-      if (v == 0xff) {
-         printf("Page %d complete\n", page_no);
-         return 0;  // Success
-      }
-      printf("YFLASHPGMDELAY = 0x%2.2x after programming; Fault %u!\n", v, retry);
+         _xf.offset = 0;
+         xrpf_next(XRPF_PGM_WRITE, 12);
+         break;
+      case XRPF_PGM_WRITE:
+         // FLASH_PROGRAM_DATA (0x41)
+         rc = marble_I2C_cmdsend(I2C_PM, _xf.dev, 0x41, data + _xf.offset, 2);
+         if (rc != HAL_OK) {
+            printf("Write Fault at 0x%4.4x\r\n", addr + _xf.offset);
+            return 1;
+         }
+         xrpf_next(XRPF_PGM_READ, 12);
+         break;
+      case XRPF_PGM_READ:
+         // FLASH_PROGRAM_DATA_INC_ADDRESS (0x42); N.B.: Read-Write pointer is incremented here
+         rc = marble_I2C_cmdrecv(I2C_PM, _xf.dev, 0x42, i2c_dat, 2);
+         if (rc != HAL_OK || memcmp(i2c_dat, data + _xf.offset, 2)) {
+            printf("readback fail at 0x%4.4x: rc=%d  0x%2.2x:0x%2.2x  0x%2.2x:0x%2.2x\r\n",
+               addr + _xf.offset, rc, i2c_dat[0], data[_xf.offset], i2c_dat[1], data[_xf.offset+1]);
+            return 1;
+         }
+         _xf.offset += 2;
+         _xf.word_vfy = 0;
+         // 12 ms after this read plus 12 ms before the next write
+         xrpf_next(_xf.offset < XRP_FLASH_PAGE_SIZE ? XRPF_PGM_WRITE : XRPF_VFY_ADDR, 24);
+         break;
+      case XRPF_VFY_ADDR_CHECK:
+         if (xrpf_write_check(0x40, addr)) {
+            printf("can't set flash program address\r\n");
+            return 1;
+         }
+         _xf.offset = 0;
+         xrpf_next(_xf.word_vfy ? XRPF_VFY_WORD : XRPF_VFY_BLOCK, 10);
+         break;
+      case XRPF_VFY_BLOCK:
+         // One read of FLASH_PROGRAM_DATA_INC_ADDRESS (0x42) for the whole page
+         rc = marble_I2C_cmdrecv(I2C_PM, _xf.dev, 0x42, i2c_dat, XRP_FLASH_PAGE_SIZE);
+         if (rc == HAL_OK && !memcmp(i2c_dat, data, XRP_FLASH_PAGE_SIZE)) {
+            xrpf_next(XRPF_PGM_DONE, 0);
+            break;
+         }
+         // Not necessarily bad flash: fall back to the word-by-word check
+         printf("block verify of page %u failed (rc=%d); verifying by word\r\n", _xf.page, rc);
+         _xf.word_vfy = 1;
+         xrpf_next(XRPF_VFY_ADDR, 10);
+         break;
+      case XRPF_VFY_WORD:
+         rc = marble_I2C_cmdrecv(I2C_PM, _xf.dev, 0x42, i2c_dat, 2);
+         if (rc != HAL_OK || memcmp(i2c_dat, data + _xf.offset, 2)) {
+            printf("verify fail at 0x%4.4x: rc=%d  0x%2.2x:0x%2.2x  0x%2.2x:0x%2.2x\r\n",
+               addr + _xf.offset, rc, i2c_dat[0], data[_xf.offset], i2c_dat[1], data[_xf.offset+1]);
+            return 1;
+         }
+         _xf.offset += 2;
+         if (_xf.offset < XRP_FLASH_PAGE_SIZE) {
+            xrpf_next(XRPF_VFY_WORD, 10);
+         } else {
+            xrpf_next(XRPF_PGM_DONE, 0);
+         }
+         break;
+      case XRPF_PGM_DONE:
+         v = xrp_read2(_xf.dev, 0x8068);  // YFLASHPGMDELAY
+         if (v != 0xff) {
+            printf("YFLASHPGMDELAY = 0x%2.2x after programming; Fault!\r\n", v);
+            return 1;
+         }
+         printf("Page %u complete\r\n", _xf.page);
+         if (++_xf.page < XRP_FLASH_PAGES) {
+            _xf.phase = 0;
+            _xf.retry = 0;
+            xrpf_next(XRPF_PROC_DELAY, 0);
+         } else {
+            printf("XRP7724 flash programming complete in %lu ms\r\n",
+                   (unsigned long)((marble_get_us() - _xf.t_start)/1000));
+            _xf.state = XRPF_DONE;
+         }
+         break;
+      default:
+         break;
    }
-   return 1;  // "Abort - Erasing the Flash has failed"
+   return 0;
 }
 
-static int xrp_program_page(uint8_t dev, unsigned page_no, uint8_t data[], unsigned len)
+/* void xrp_flash(uint8_t dev);
+ *  Start programming the built-in image into the flash of 'dev'.
+ *  Returns immediately; xrp_flash_service() does the work.
+ */
+void xrp_flash(uint8_t dev)
 {
   if (marble_get_pcb_rev() > Marble_v1_3) {
-    printf("XRP7724 not present. Program bypassed.\n");
-    return 0;
+    printf("XRP7724 not present. Flash bypassed.\n");
+    return;
   }
-   printf("FLASH_PAGE_CLEAR %u\n", page_no);
-   if (xrp_process_flash(dev, page_no, 0x4E, 1, 10)) return 1;
-   printf("FLASH_PAGE_ERASE %u\n", page_no);
-   if (xrp_process_flash(dev, page_no, 0x4F, 5, 50)) return 1;
-   //
-   // On to Figure 5: Program Flash Image
-   xrp_set2(dev, 0x8068, 0xff);  // YFLASHPGMDELAY
-   marble_SLEEP_ms(12);
-   unsigned int v = xrp_read2(dev, 0x8068);  // YFLASHPGMDELAY
-   if (v != 0xff) {
-      printf("YFLASHPGMDELAY = 0x%2.2x before programming; Fault!\n", v);
-      return 1;
+   const unsigned dd_size = sizeof(xrp_flash_image) / sizeof(xrp_flash_image[0]);
+   if (dd_size != XRP_FLASH_PAGES*XRP_FLASH_PAGE_SIZE+1) {  // account for trailing "\0"
+      printf("bad setup, dd_size=%u, pages=%d\r\n", dd_size, XRP_FLASH_PAGES);
+      return;
    }
-   marble_SLEEP_ms(12);
-   int rc = xrp_reg_write(dev, 0x4D, 1);  // FLASH_INIT (0x4D), mode=1
-   if (rc != HAL_OK) return 1;
-   marble_SLEEP_ms(10);
-   if (xrp_push_low(dev, page_no*64, data, len)) return 1;
-   v = xrp_read2(dev, 0x8068);  // YFLASHPGMDELAY
-   if (v != 0xff) {
-      printf("YFLASHPGMDELAY = 0x%2.2x after programming; Fault!\n", v);
-      return 1;
+   if (xrp_flash_busy()) {
+      xrp_flash_progress();
+      return;
    }
-   return 0;  // Success?
+   printf("XRP7724 flash started\r\n");
+   _xf.dev = dev;
+   _xf.page = 0;
+   _xf.phase = 0;
+   _xf.retry = 0;
+   _xf.t_start = marble_get_us();
+   xrpf_next(XRPF_PROC_DELAY, 0);
 }
 
-// Temporarily abandon hex record concept
-void xrp_flash(uint8_t dev)
+void xrp_flash_service(void)
 {
-  if (marble_get_pcb_rev() > Marble_v1_3) {
-    printf("XRP7724 not present. Flash bypassed.\n");
-    return;
-  }
-
-#ifdef APP_MINI
-   // Data originally based on python hex2c.py < MarbleMini.hex
-   // Pure copy of 7 x 64-byte pages, spanning addresses 0x0000 to 0x01bf
-   uint8_t dd[] = {
-      "\xFF\xC5\x00\x0A\x03\x41\x00\xFA\x02\xDA\x20\x27\xE1\x28\x33\x0D"
-      "\x00\x00\x03\x00\x56\x00\x12\x02\x69\x97\x4A\x26\x28\x3C\x20\x01"
-      "\x01\x01\x01\x01\x01\x1E\x1E\xCE\x04\xB0\x0D\x00\x40\x00\x40\xCB"
-      "\x00\x12\x6C\x1E\x1E\x0C\x2E\x69\x98\x0A\x4D\x20\x00\x00\x08\xC4"
-      "\xFF\xC5\x00\x0A\x03\x41\x00\xFA\x02\xDA\x20\x13\xE1\x14\x33\x0D"
-      "\x00\x00\x03\x00\x50\x00\x11\x02\x65\x9B\x4E\x24\x26\x3C\x14\x08"
-      "\x08\x08\x08\x08\x08\x1D\x1E\xCE\x04\xB0\x0D\x00\x40\x00\x40\xCB"
-      "\x00\x3E\x64\x7B\x7B\x1D\xF2\x48\x05\x1A\x26\x20\x00\x11\x18\x02"
-      "\xFF\xC5\x00\x0A\x03\x41\x00\xFA\x02\xDA\x20\x09\xE1\x14\x33\x0D"
-      "\x00\x00\x04\x00\x6A\x00\x16\x02\x45\xBB\x5F\x2D\x31\x3C\x1A\x02"
-      "\x02\x02\x02\x02\x02\x1C\x1E\xCE\x04\xB0\x0D\x00\x40\x00\x40\xCB"
-      "\x00\x35\x42\x7B\x7B\x16\x48\x57\xE5\x12\x07\x20\x00\x21\x18\x07"
-      "\xFF\xC5\x00\x0A\x03\x41\x00\xFA\x02\xDA\x20\x27\xE1\x28\x33\x0D"
-      "\x00\x00\x03\x00\x40\x00\x0D\x02\x51\xAF\x58\x3F\x45\x3C\x10\x40"
-      "\x40\x40\x40\x40\x40\x1E\x1E\xCE\x04\xB0\x0D\x00\x40\x00\x40\xCB"
-      "\x00\x43\x50\x1E\x1E\x19\x5C\x4F\x6F\x17\x40\x29\x77\x01\x18\xFC"
-      "\x05\x0F\xFF\x4C\x4F\x4C\x1E\x1C\x00\x30\x01\x9F\x55\x04\x04\x00"
-      "\x10\x16\x04\x0A\x10\x00\x00\x00\x00\x20\x0F\x17\x10\x17\x0F\x6C"
-      "\x64\x42\x50\x30\x18\x0C\x30\x00\x00\x00\x00\x00\x00\x00\x00\xFF"
-      "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\x0F\x00\x00\x00\x71"
-      "\x00\x00\x00\x02\x00\x00\x37\x00\x00\x0F\x04\x02\x06\x02\x0A\x09"
-      "\x0B\x09\x00\x00\x00\x00\x0F\x00\x02\x00\x00\x00\x00\x01\x00\x00"
-      "\x00\x00\x00\x04\x04\x00\x00\x00\x61\x62\x61\x61\x61\x00\x00\x62"
-      "\x01\x62\xFA\x00\x80\x00\x00\xFF\x12\x02\xE2\x00\x1D\x00\x00\xF3"
-      "\x00\x02\x50\x00\x00\xFF\xFF\xFA\x06\xFA\x04\xFA\x02\x96\x01\x00"
-      "\x00\x00\x00\x00\x00\x00\x02\x00\x04\x00\x07\x00\x00\x00\x00\x64"
-      "\x21\x64\x64\x64\x21\x64\x64\x64\x21\x64\x64\x64\x21\x64\x64\x0A"
-      "\x20\x0A\x05\x19\x00\xFF\x00\x00\x00\xFF\xFF\x00\x04\xFF\xFF\xCF"
-   };
-#else
-#ifdef APP_MARBLE
-   // Data based on python hex2c_linear.py < Marble_flash.hex
-   // Pure copy of 7 x 64-byte pages, spanning addresses 0x0000 to 0x01bf
-   uint8_t dd[] = {
-      "\xFF\xC5\x00\x0A\x03\x41\x00\xFA\x02\xDA\x20\x13\xE1\x14\x33\x0D"
-      "\x00\x00\x03\x00\x50\x00\x11\x02\x15\xEB\x4E\x29\x2B\x3C\x14\x01"
-      "\x01\x01\x01\x01\x01\x1C\x1E\xCE\x04\xB0\x0D\x00\x40\x00\x40\xCB"
-      "\x00\x48\x64\x3D\x3D\x21\x65\x41\x44\x1D\x73\x21\x7F\x11\x18\xA4"
-      "\xFF\xC5\x00\x0A\x03\x41\x00\xFA\x02\xDA\x20\x1D\xE1\x14\x33\x0D"
-      "\x00\x00\x04\x00\x6A\x00\x16\x02\x0D\xF3\x5F\x35\x3A\x3C\x0D\x04"
-      "\x04\x04\x04\x04\x04\x1B\x1E\xCE\x04\xB0\x0D\x00\x40\x00\x40\xCB"
-      "\x00\x76\x42\x7B\x7B\x17\x39\x54\xC7\x14\x1A\x23\x7D\x22\x28\xF7"
-      "\xFF\xC5\x00\x0A\x03\x41\x00\xFA\x02\xDA\x20\x27\xE1\x28\x33\x0D"
-      "\x00\x00\x03\x00\x40\x00\x0D\x02\x11\xEF\x58\x4D\x56\x3C\x10\x80"
-      "\x80\x80\x80\x80\x80\x1D\x1E\xCE\x04\xB0\x0D\x00\x40\x00\x40\xCB"
-      "\x00\x44\x50\x1E\x1E\x17\xD6\x52\x56\x15\xDD\x2A\x76\x01\x18\x76"
-      "\xFF\xC5\x00\x0A\x03\x41\x00\xFA\x02\xDA\x20\x13\xE1\x28\x33\x0D"
-      "\x00\x00\x05\x00\x73\x00\x18\x02\x91\x6F\x5C\x2E\x31\x3C\x16\x40"
-      "\x40\x40\x40\x40\x40\x1D\x1E\xCE\x04\xB0\x0D\x00\x40\x00\x40\xCB"
-      "\x00\x22\x48\x3D\x3D\x22\x27\x41\x68\x1C\xA8\x20\x00\x10\x08\x8F"
-      "\x05\x00\x00\x4C\x4F\x4C\x1E\x1C\x00\x30\x01\x9F\x55\x02\x02\x00"
-      "\x08\x16\x04\x0A\x10\x00\x00\x00\x00\x10\x0F\x17\x10\x17\x0F\x64"
-      "\x42\x50\x48\x18\x0C\x30\x18\x00\x00\x00\x00\x00\x00\x00\x00\xFF"
-      "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\x0F\x00\x00\x00\xE1"
-      "\x00\x00\x00\x02\x00\x00\x37\x00\x00\x0F\x02\x03\x02\x04\x09\x09"
-      "\x09\x0A\x00\x00\x00\x00\x0F\x00\x02\x00\x00\x00\x00\x01\x00\x00"
-      "\x00\x00\x00\x04\x04\x00\x00\x00\x62\x61\x61\x61\x61\x00\x00\x62"
-      "\x01\x62\xFA\x00\x80\x00\x00\xFF\x12\x02\xE1\x00\x1E\x00\x00\xD5"
-      "\x00\x02\x50\x00\x00\xFF\xFF\x32\x04\x32\x06\x32\x00\x00\x03\x00"
-      "\x00\x00\x00\x00\x00\x00\x02\x00\x04\x00\x07\x00\x00\x00\x00\x64"
-      "\x21\x64\x64\x64\x20\x64\x64\x64\x21\x64\x64\x64\x22\x64\x64\x0A"
-      "\x20\x0A\x05\x19\xFF\x00\x00\x00\x00\xFF\xFF\x00\x04\xFF\xFF\x12"
-   };
-#endif /* ifdef APP_MARBLE */
-#endif /* ifdef APP_MINI */
-
-   const unsigned dd_size = sizeof(dd) / sizeof(dd[0]);
-   const unsigned pages = 7;
-   if (dd_size != pages*64+1) {  // account for trailing "\0"
-      printf("bad setup, dd_size=%u, pages=%u\n", dd_size, pages);
+   if (!xrp_flash_busy() || ((int32_t)(marble_get_us() - _xf.t_wake) < 0)) {
       return;
    }
-   printf("XRP7724 flash (WIP)\n");
-   for (unsigned page_no=0; page_no < pages; page_no++) {
-      if (xrp_program_page(dev, page_no, dd+page_no*64, 64)) return;
+   if (xrpf_step()) {
+      printf("XRP7724 flash programming failed on page %u (%s)\r\n",
+             _xf.page, xrpf_state_names[_xf.state]);
+      _xf.state = XRPF_FAILED;
    }
-   printf("flash programming complete!?\n");
+}
+
+int xrp_flash_busy(void)
+{
+   return (_xf.state != XRPF_IDLE) && (_xf.state != XRPF_DONE) && (_xf.state != XRPF_FAILED);
+}
+
+void xrp_flash_progress(void)
+{
+   // Clear and erase are the slow part; count them as half of each page
+   unsigned done = _xf.page*2;
+   if (_xf.state >= XRPF_PGM_DELAY) done++;
+   if (_xf.state == XRPF_DONE) done = XRP_FLASH_PAGES*2;
+   printf("XRP7724 flash: %s, page %u/%d (%u%%), %lu ms\r\n",
+          xrpf_state_names[_xf.state], _xf.page, XRP_FLASH_PAGES,
+          (100*done)/(XRP_FLASH_PAGES*2),
+          (unsigned long)((marble_get_us() - _xf.t_start)/1000));
 }
 
 void xrp_go(uint8_t dev)
@@ -1052,6 +1570,22 @@ void PM_UpdateTelem(void) {
   return;
 }
 
+void PM_AlertService(void) {
+  if (!marble_I2C_PM_get_alert()) {
+    // The interrupt only catches the falling edge.  If SMBALERT is still
+    // asserted (e.g. the ARA or status reads failed) service it again.
+    if (!marble_I2C_PM_alert_asserted() || (BSP_GET_SYSTICK() - _pm_alert_tick < PM_ALERT_RETRY_MS)) {
+      return;
+    }
+  }
+  marble_I2C_PM_clear_alert();
+  _pm_alert_tick = BSP_GET_SYSTICK();
+  if (marble_get_pcb_rev() > Marble_v1_3) {
+    ltm4673_fault_capture(LTM4673);
+  }
+  return;
+}
+
 int PM_GetTelem(PM_telem_enum_t elem) {
   if (elem < PM_NUM_TELEM_ENUM) {
     return (int)_telem_data[elem];
@@ -1059,6 +1593,139 @@ int PM_GetTelem(PM_telem_enum_t elem) {
   return -1;
 }
 
+void PM_set_pec(int enable) {
+  _pm_pec_en = enable ? 1 : 0;
+  return;
+}
+
+int PM_get_pec(void) {
+  return _pm_pec_en;
+}
+
+int PM_cmdrecv(uint8_t dev, uint8_t cmd, uint8_t *data, int len) {
+  pm_err_count_t *errs = PM_err_counts(dev);
+  int rc = 1;
+  if ((len < 1) || (len > PM_MAX_DATA)) {
+    return 1;
+  }
+  for (int ntry = 0; ntry <= PM_RETRIES; ntry++) {
+    if (ntry > 0) {
+      marble_SLEEP_ms(PM_RETRY_BACKOFF_MS << (ntry - 1));
+      if (errs) errs->retries++;
+    }
+    rc = PM_cmdrecv_once(dev, cmd, data, len, errs);
+    if (rc == 0) {
+      return 0;
+    }
+  }
+  if (errs) errs->failures++;
+  return rc;
+}
+
+int PM_cmdsend(uint8_t dev, uint8_t cmd, const uint8_t *data, int len) {
+  pm_err_count_t *errs = PM_err_counts(dev);
+  int rc = 1;
+  if ((len < 0) || (len > PM_MAX_DATA)) {
+    return 1;
+  }
+  for (int ntry = 0; ntry <= PM_RETRIES; ntry++) {
+    if (ntry > 0) {
+      marble_SLEEP_ms(PM_RETRY_BACKOFF_MS << (ntry - 1));
+      if (errs) errs->retries++;
+    }
+    rc = PM_cmdsend_once(dev, cmd, data, len, errs);
+    if (rc == 0) {
+      return 0;
+    }
+  }
+  if (errs) errs->failures++;
+  return rc;
+}
+
+/*
+ * static int PM_cmdrecv_once(uint8_t dev, uint8_t cmd, uint8_t *data, int len, pm_err_count_t *errs);
+ *  Single read attempt.  The PEC covers addr+wr, cmd, addr+rd and the data.
+ */
+static int PM_cmdrecv_once(uint8_t dev, uint8_t cmd, uint8_t *data, int len, pm_err_count_t *errs) {
+  uint8_t buf[PM_MAX_DATA + 1];
+  uint8_t hdr[3] = {dev & 0xfe, cmd, dev | 1};
+  int nread = _pm_pec_en ? len + 1 : len;
+  int rc = marble_I2C_cmdrecv(I2C_PM, dev, cmd, buf, nread);
+  if (rc) {
+    if (errs) errs->bus_errs++;
+    return rc;
+  }
+  if (_pm_pec_en) {
+    uint8_t pec = pmbus_pec(pmbus_pec(0, hdr, 3), buf, len);
+    if (pec != buf[len]) {
+      if (errs) errs->pec_errs++;
+      return -1;
+    }
+  }
+  memcpy(data, buf, len);
+  return 0;
+}
+
+static int PM_cmdsend_once(uint8_t dev, uint8_t cmd, const uint8_t *data, int len, pm_err_count_t *errs) {
+  uint8_t buf[PM_MAX_DATA + 1];
+  uint8_t hdr[2] = {dev & 0xfe, cmd};
+  int nwrite = len;
+  if (len > 0) {
+    memcpy(buf, data, len);
+  }
+  if (_pm_pec_en) {
+    buf[nwrite++] = pmbus_pec(pmbus_pec(0, hdr, 2), data, len);
+  }
+  int rc = marble_I2C_cmdsend(I2C_PM, dev, cmd, buf, nwrite);
+  if (rc && errs) {
+    errs->bus_errs++;
+  }
+  return rc;
+}
+
+/*
+ * static pm_err_count_t *PM_err_counts(uint8_t dev);
+ *  Error counters for 'dev', claiming a free slot on first use.
+ *  Returns NULL if all slots are taken by other devices.
+ */
+static pm_err_count_t *PM_err_counts(uint8_t dev) {
+  dev &= 0xfe;
+  for (int n = 0; n < PM_ERR_MAX_DEVS; n++) {
+    if (_pm_errs[n].addr == dev) {
+      return &_pm_errs[n];
+    }
+    if (_pm_errs[n].addr == 0) {
+      _pm_errs[n].addr = dev;
+      return &_pm_errs[n];
+    }
+  }
+  return NULL;
+}
+
+void PM_print_errors(void) {
+  if (!report_structured()) {
+    printf("PMBus PEC: %s\r\n", _pm_pec_en ? "on" : "off");
+  }
+  for (int n = 0; (n < PM_ERR_MAX_DEVS) && (_pm_errs[n].addr != 0); n++) {
+    pm_err_count_t *errs = &_pm_errs[n];
+    if (report_structured()) {
+      report_begin("pmbus_err");
+      report_hex("addr", errs->addr);
+      report_int("pec", _pm_pec_en);
+      report_uint("pec_errs", errs->pec_errs);
+      report_uint("bus_errs", errs->bus_errs);
+      report_uint("retries", errs->retries);
+      report_uint("failures", errs->failures);
+      report_end();
+    } else {
+      printf("  0x%02x: PEC errs %lu, bus errs %lu, retries %lu, failures %lu\r\n",
+             errs->addr, (unsigned long)errs->pec_errs, (unsigned long)errs->bus_errs,
+             (unsigned long)errs->retries, (unsigned long)errs->failures);
+    }
+  }
+  return;
+}
+
 // Didn't work when tested; why?
 #if 0
 void xrp_halt(uint8_t dev)
@@ -0,0 +1,268 @@
+/*
+ * File: i2c_shadow.c
+ * Desc: Write-through register shadow cache.  See i2c_shadow.h.
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include "i2c_shadow.h"
+#include "i2c_pm.h"
+#include "max6639.h"
+#include "report.h"
+
+extern I2C_BUS I2C_PM;
+
+typedef struct {
+  uint8_t addr;
+  uint8_t n_volatile;
+  const uint8_t *volatile_regs;
+} shadow_dev_t;
+
+typedef struct {
+  uint8_t dev;                  // Index in shadow_devs[]
+  uint8_t reg;
+  uint8_t value;
+} shadow_entry_t;
+
+static const uint8_t max6639_volatile[] = {
+  MAX6639_TEMP_CH1, MAX6639_TEMP_CH2, MAX6639_STATUS,
+  MAX6639_GLOBAL_CONFIG,                        // POR bit self-clears
+  MAX6639_TEMP_EXT_CH1, MAX6639_TEMP_EXT_CH2,
+  MAX6639_FAN1_TACH_CNT, MAX6639_FAN2_TACH_CNT,
+  MAX6639_FAN1_DUTY, MAX6639_FAN2_DUTY,         // Reads back the ramping duty
+};
+
+#define VOLATILE(regs)            (uint8_t)(sizeof(regs)/sizeof(regs[0])), regs
+
+// Devices on I2C_PM only: the FPGA is also a master on I2C_FPGA, so nothing
+// there is guaranteed to stay as the MMC last left it
+static const shadow_dev_t shadow_devs[] = {
+  {MAX6639, VOLATILE(max6639_volatile)},
+};
+
+#define SHADOW_NUM_DEVS           (sizeof(shadow_devs)/sizeof(shadow_devs[0]))
+
+static shadow_entry_t _shadow[I2C_SHADOW_ENTRIES];
+static unsigned int _entries = 0;
+static uint32_t _writes_skipped = 0;
+static uint32_t _reads_served = 0;
+
+static int shadow_find_dev(I2C_BUS I2C_bus, uint8_t addr);
+static int shadow_volatile(int dev, unsigned int reg);
+static shadow_entry_t *shadow_lookup(int dev, unsigned int reg);
+static int shadow_match(int dev, unsigned int reg, const uint8_t *data, int size);
+static int shadow_fill(int dev, unsigned int reg, uint8_t *data, int size);
+static void shadow_update(int dev, unsigned int reg, const uint8_t *data, int size, int rc);
+static void shadow_drop_if(int addr);
+
+static int shadow_find_dev(I2C_BUS I2C_bus, uint8_t addr) {
+  if (I2C_bus != I2C_PM) {
+    return -1;
+  }
+  for (unsigned int n = 0; n < SHADOW_NUM_DEVS; n++) {
+    if (shadow_devs[n].addr == addr) {
+      return (int)n;
+    }
+  }
+  return -1;
+}
+
+static int shadow_volatile(int dev, unsigned int reg) {
+  const shadow_dev_t *pdev = &shadow_devs[dev];
+  if (reg > 0xff) {
+    return 1;
+  }
+  for (unsigned int n = 0; n < pdev->n_volatile; n++) {
+    if (pdev->volatile_regs[n] == reg) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static shadow_entry_t *shadow_lookup(int dev, unsigned int reg) {
+  for (unsigned int n = 0; n < _entries; n++) {
+    if ((_shadow[n].dev == (uint8_t)dev) && (_shadow[n].reg == reg)) {
+      return &_shadow[n];
+    }
+  }
+  return NULL;
+}
+
+/*
+ * static int shadow_match(int dev, unsigned int reg, const uint8_t *data, int size);
+ *  Returns 1 if every register written would keep its shadowed value.
+ */
+static int shadow_match(int dev, unsigned int reg, const uint8_t *data, int size) {
+  shadow_entry_t *entry;
+  if (size <= 0) {
+    return 0;
+  }
+  for (int n = 0; n < size; n++) {
+    if (shadow_volatile(dev, reg + n)) {
+      return 0;
+    }
+    entry = shadow_lookup(dev, reg + n);
+    if ((entry == NULL) || (entry->value != data[n])) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/*
+ * static int shadow_fill(int dev, unsigned int reg, uint8_t *data, int size);
+ *  Returns 1 if every register read is shadowed, with the values in 'data'.
+ */
+static int shadow_fill(int dev, unsigned int reg, uint8_t *data, int size) {
+  shadow_entry_t *entry;
+  if (size <= 0) {
+    return 0;
+  }
+  for (int n = 0; n < size; n++) {
+    if (shadow_volatile(dev, reg + n)) {
+      return 0;
+    }
+    entry = shadow_lookup(dev, reg + n);
+    if (entry == NULL) {
+      return 0;
+    }
+    data[n] = entry->value;
+  }
+  return 1;
+}
+
+/*
+ * static void shadow_update(int dev, unsigned int reg, const uint8_t *data, int size, int rc);
+ *  Record the result of a transfer: the values on success ('rc' = 0),
+ *  otherwise forget the registers it touched.  Registers for which there is
+ *  no room are simply not shadowed.
+ */
+static void shadow_update(int dev, unsigned int reg, const uint8_t *data, int size, int rc) {
+  shadow_entry_t *entry;
+  for (int n = 0; n < size; n++) {
+    if (shadow_volatile(dev, reg + n)) {
+      continue;
+    }
+    entry = shadow_lookup(dev, reg + n);
+    if (rc != 0) {
+      if (entry != NULL) {
+        *entry = _shadow[--_entries];
+      }
+      continue;
+    }
+    if (entry == NULL) {
+      if (_entries >= I2C_SHADOW_ENTRIES) {
+        continue;
+      }
+      entry = &_shadow[_entries++];
+      entry->dev = (uint8_t)dev;
+      entry->reg = (uint8_t)(reg + n);
+    }
+    entry->value = data[n];
+  }
+  return;
+}
+
+/*
+ * static void shadow_drop_if(int addr);
+ *  Forget the entries of the device at 'addr' (-1 = any).
+ */
+static void shadow_drop_if(int addr) {
+  unsigned int n = 0;
+  while (n < _entries) {
+    if ((addr < 0) || (shadow_devs[_shadow[n].dev].addr == addr)) {
+      _shadow[n] = _shadow[--_entries];
+    } else {
+      n++;
+    }
+  }
+  return;
+}
+
+int i2c_shadow_send(I2C_BUS I2C_bus, uint8_t addr, const uint8_t *data, int size) {
+  int dev = shadow_find_dev(I2C_bus, addr);
+  unsigned int reg = 0;
+  const uint8_t *vals = data;
+  int nvals = size;
+  if (dev >= 0) {
+    // Register pointer in the first byte
+    if (size < 2) {
+      return marble_I2C_send(I2C_bus, addr, data, size);
+    }
+    reg = data[0];
+    vals = &data[1];
+    nvals = size - 1;
+  }
+  if ((dev >= 0) && shadow_match(dev, reg, vals, nvals)) {
+    _writes_skipped++;
+    return 0;
+  }
+  int rc = marble_I2C_send(I2C_bus, addr, data, size);
+  if (dev >= 0) {
+    shadow_update(dev, reg, vals, nvals, rc);
+  }
+  return rc;
+}
+
+int i2c_shadow_cmdsend(I2C_BUS I2C_bus, uint8_t addr, uint8_t cmd, const uint8_t *data, int size) {
+  int dev = shadow_find_dev(I2C_bus, addr);
+  if ((dev >= 0) && shadow_match(dev, cmd, data, size)) {
+    _writes_skipped++;
+    return 0;
+  }
+  int rc = marble_I2C_cmdsend(I2C_bus, addr, cmd, data, size);
+  if (dev >= 0) {
+    shadow_update(dev, cmd, data, size, rc);
+  }
+  return rc;
+}
+
+int i2c_shadow_cmdrecv(I2C_BUS I2C_bus, uint8_t addr, uint8_t cmd, uint8_t *data, int size) {
+  int dev = shadow_find_dev(I2C_bus, addr);
+  if ((dev >= 0) && shadow_fill(dev, cmd, data, size)) {
+    _reads_served++;
+    return 0;
+  }
+  int rc = marble_I2C_cmdrecv(I2C_bus, addr, cmd, data, size);
+  // A failed read says nothing about the register contents
+  if ((dev >= 0) && (rc == 0)) {
+    shadow_update(dev, cmd, data, size, rc);
+  }
+  return rc;
+}
+
+void i2c_shadow_invalidate(void) {
+  _entries = 0;
+  return;
+}
+
+void i2c_shadow_invalidate_bus(I2C_BUS I2C_bus) {
+  if (I2C_bus == I2C_PM) {
+    shadow_drop_if(-1);
+  }
+  return;
+}
+
+void i2c_shadow_invalidate_dev(I2C_BUS I2C_bus, uint8_t addr) {
+  int dev = shadow_find_dev(I2C_bus, addr);
+  if (dev >= 0) {
+    shadow_drop_if(shadow_devs[dev].addr);
+  }
+  return;
+}
+
+void i2c_shadow_print(void) {
+  if (report_structured()) {
+    report_begin("i2c_shadow");
+    report_uint("entries", _entries);
+    report_uint("writes_skipped", _writes_skipped);
+    report_uint("reads_served", _reads_served);
+    report_end();
+    return;
+  }
+  printf("I2C shadow: %u/%u registers, %lu writes skipped, %lu reads served\r\n",
+         _entries, (unsigned int)I2C_SHADOW_ENTRIES, (unsigned long)_writes_skipped,
+         (unsigned long)_reads_served);
+  return;
+}
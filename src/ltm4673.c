@@ -3,9 +3,13 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 #include "ltm4673.h"
 #include "pmbus.h"
+#include "i2c_pm.h"
 #include "marble_api.h"
+#include "report.h"
+#include "mbox_fifo.h"
 
 #define LTM4673_DEV_ADDR_8BIT         (0xc0)
 
@@ -16,361 +20,25 @@
 extern I2C_BUS I2C_PM;
 static uint8_t ltm4673_page = 0;
 
-#define FLOAT_LIMITS
-#define PM_LIMITS_COLS 4
-// Linear11 Signed PMBus data format
-#define LTM4673_L16_LIMIT_MV(cmd, min_mv, max_mv) \
-  {cmd, 0xff, min_mv, max_mv}
-
-// Linear16 Unsigned PMBus data format
-#define LTM4673_MV_TO_L11_LO(val_mv)                ((uint8_t)(MV_TO_L11(val_mv) & 0xff))
-#define LTM4673_MV_TO_L11_HI(val_mv)                ((uint8_t)((MV_TO_L11(val_mv) >> 8) & 0xff))
-#define LTM4673_L11_LIMIT_MV(cmd, min_mv, max_mv) \
-  {cmd, 0xff, LTM4673_MV_TO_L11_LO(min_mv), LTM4673_MV_TO_L11_LO(max_mv), 0xff, \
-   LTM4673_MV_TO_L11_HI(min_mv), LTM4673_MV_TO_L11_HI(max_mv)}
-
-// Prevent Writes to this Register
-#define LTM4673_PROTECT(cmd) {cmd, 0, 0, 0}
-// NOTE! I need to operate on the DECODED values (not on their encodings) to properly
-// determine if min <= X <= max for a given value X.
-const uint16_t _ltm4673_pageff_limits [][PM_LIMITS_COLS] = {
-// If pass_mask is 0, prevents writes to the register for the selected page
-//{command_code, pass_mask,  min, max}
-  {LTM4673_PAGE, 0xff, 0x00, 0xff},
-  {LTM4673_VIN_OV_FAULT_LIMIT, 0xffff, V_TO_L11(12.5), V_TO_L11(16.0)}, // 12.5V to 16.0V
-};
-const uint16_t _ltm4673_page0_limits [][PM_LIMITS_COLS] = {
-  //{LTM4673_VOUT_COMMAND, 0xffff, MV_TO_L16(950), MV_TO_L16(1050)},  // 0.95V to 1.05V
-  {LTM4673_VOUT_COMMAND, 0xffff, V_TO_L16(0.95), V_TO_L16(1.05)},  // 0.95V to 1.05V
-};
-const uint16_t _ltm4673_page1_limits [][PM_LIMITS_COLS] = {
-  {LTM4673_VOUT_COMMAND, 0xffff, V_TO_L16(1.75), V_TO_L16(1.85)},  // 1.75V to 1.85V
-};
-const uint16_t _ltm4673_page2_limits [][PM_LIMITS_COLS] = {
-  {LTM4673_VOUT_COMMAND, 0xffff, V_TO_L16(2.45), V_TO_L16(2.55)},  // 2.45V to 2.55V
-};
-const uint16_t _ltm4673_page3_limits [][PM_LIMITS_COLS] = {
-  {LTM4673_VOUT_COMMAND, 0xffff, V_TO_L16(3.25), V_TO_L16(3.35)},  // 3.25V to 3.35V
-};
-
-typedef struct {
-  unsigned int nrows;
-  const uint16_t (*array)[PM_LIMITS_COLS];
-} _ltm4673_limits_t;
-static const _ltm4673_limits_t ltm4673_pageff_limits = {
-  .nrows = sizeof(_ltm4673_pageff_limits)/(sizeof(uint16_t)*PM_LIMITS_COLS),
-  .array = _ltm4673_pageff_limits
-};
-static const _ltm4673_limits_t ltm4673_page0_limits = {
-  .nrows = sizeof(_ltm4673_page0_limits)/(sizeof(uint16_t)*PM_LIMITS_COLS),
-  .array = _ltm4673_page0_limits
-};
-static const _ltm4673_limits_t ltm4673_page1_limits = {
-  .nrows = sizeof(_ltm4673_page1_limits)/(sizeof(uint16_t)*PM_LIMITS_COLS),
-  .array = _ltm4673_page1_limits
-};
-static const _ltm4673_limits_t ltm4673_page2_limits = {
-  .nrows = sizeof(_ltm4673_page2_limits)/(sizeof(uint16_t)*PM_LIMITS_COLS),
-  .array = _ltm4673_page2_limits
-};
-static const _ltm4673_limits_t ltm4673_page3_limits = {
-  .nrows = sizeof(_ltm4673_page3_limits)/(sizeof(uint16_t)*PM_LIMITS_COLS),
-  .array = _ltm4673_page3_limits
-};
-static const _ltm4673_limits_t ltm4673_limits[] = {
-  ltm4673_page0_limits,
-  ltm4673_page1_limits,
-  ltm4673_page2_limits,
-  ltm4673_page3_limits,
-  ltm4673_pageff_limits,
-};
-#define LTM4673_PAGE_INDEX(page)                        (page > 3 ? 4 : page)
-#define LTM4673_NPAGES_CHECK  sizeof(ltm4673_limits)/sizeof(_ltm4673_limits_t)
-#define LTM4673_NPAGES  (5)
-#define LTM4673_LIMIT_GET_COMMAND(page, row) \
-  (uint8_t)ltm4673_limits[LTM4673_PAGE_INDEX(page)].array[row][0]
-#define LTM4673_LIMIT_GET_MASK(page, row) \
-  ltm4673_limits[LTM4673_PAGE_INDEX(page)].array[row][1]
-#define LTM4673_LIMIT_GET_MIN(page, row) \
-  ltm4673_limits[LTM4673_PAGE_INDEX(page)].array[row][2]
-#define LTM4673_LIMIT_GET_MAX(page, row) \
-  ltm4673_limits[LTM4673_PAGE_INDEX(page)].array[row][3]
+// Limits are compared exactly in fixed point; define FLOAT_LIMITS to decode
+// to float instead (pulls in soft-float on the Cortex-M3)
+//#define FLOAT_LIMITS
+
+// Encodings and write limits are generated from ltm4673.def by mkltm4673.py.
+// The limit (if any) for a given page and command is found in O(1) via
+// ltm4673_limit_slot[] -> ltm4673_limit_table[][LTM4673_PAGE_INDEX(page)].
+#include "ltm4673_def.h"
 
 static uint8_t ltm4673_addrs[] = {0xb8, 0xba, 0xbc, 0xbe, 0xc0, 0xc2, 0xc4, 0xc6, 0xc8};
 #define LTM4673_MATCH_ADDRS     (sizeof(ltm4673_addrs)/sizeof(uint8_t))
 
 #define HAL_OK (0)
 
-#define LTM4673_ENCODING_RAW  (0)
-#define LTM4673_ENCODING_L11  (1)
-#define LTM4673_ENCODING_L16  (2)
-#define LTM4673_UNUSED     (0xff)
-
-static const uint8_t ltm4673_encodings[256] = {
-  LTM4673_ENCODING_RAW, // LTM4673_PAGE
-  LTM4673_ENCODING_RAW, // LTM4673_OPERATION
-  LTM4673_ENCODING_RAW, // LTM4673_ON_OFF_CONFIG
-  LTM4673_ENCODING_RAW, // LTM4673_CLEAR_FAULTS
-  LTM4673_UNUSED, // 0x04
-  LTM4673_UNUSED, // 0x05
-  LTM4673_UNUSED, // 0x06
-  LTM4673_UNUSED, // 0x07
-  LTM4673_UNUSED, // 0x08
-  LTM4673_UNUSED, // 0x09
-  LTM4673_UNUSED, // 0x0a
-  LTM4673_UNUSED, // 0x0b
-  LTM4673_UNUSED, // 0x0c
-  LTM4673_UNUSED, // 0x0d
-  LTM4673_UNUSED, // 0x0e
-  LTM4673_UNUSED, // 0x0f
-  LTM4673_ENCODING_RAW, // LTM4673_WRITE_PROTECT
-  LTM4673_UNUSED, // 0x11
-  LTM4673_UNUSED, // 0x12
-  LTM4673_UNUSED, // 0x13
-  LTM4673_UNUSED, // 0x14
-  LTM4673_ENCODING_RAW, // LTM4673_STORE_USER_ALL
-  LTM4673_ENCODING_RAW, // LTM4673_RESTORE_USER_ALL
-  LTM4673_UNUSED, // 0x17
-  LTM4673_UNUSED, // 0x18
-  LTM4673_ENCODING_RAW, // LTM4673_CAPABILITY
-  LTM4673_UNUSED, // 0x1a
-  LTM4673_UNUSED, // 0x1b
-  LTM4673_UNUSED, // 0x1c
-  LTM4673_UNUSED, // 0x1d
-  LTM4673_UNUSED, // 0x1e
-  LTM4673_UNUSED, // 0x1f
-  LTM4673_ENCODING_RAW, // LTM4673_VOUT_MODE
-  LTM4673_ENCODING_L16, // LTM4673_VOUT_COMMAND
-  LTM4673_UNUSED, // 0x22
-  LTM4673_UNUSED, // 0x23
-  LTM4673_ENCODING_L16, // LTM4673_VOUT_MAX
-  LTM4673_ENCODING_L16, // LTM4673_VOUT_MARGIN_HIGH
-  LTM4673_ENCODING_L16, // LTM4673_VOUT_MARGIN_LOW
-  LTM4673_UNUSED, // 0x27
-  LTM4673_UNUSED, // 0x28
-  LTM4673_UNUSED, // 0x29
-  LTM4673_UNUSED, // 0x2a
-  LTM4673_UNUSED, // 0x2b
-  LTM4673_UNUSED, // 0x2c
-  LTM4673_UNUSED, // 0x2d
-  LTM4673_UNUSED, // 0x2e
-  LTM4673_UNUSED, // 0x2f
-  LTM4673_UNUSED, // 0x30
-  LTM4673_UNUSED, // 0x31
-  LTM4673_UNUSED, // 0x32
-  LTM4673_UNUSED, // 0x33
-  LTM4673_UNUSED, // 0x34
-  LTM4673_ENCODING_L11, // LTM4673_VIN_ON
-  LTM4673_ENCODING_L11, // LTM4673_VIN_OFF
-  LTM4673_UNUSED, // 0x37
-  LTM4673_ENCODING_L11, // LTM4673_IOUT_CAL_GAIN
-  LTM4673_UNUSED, // 0x39
-  LTM4673_UNUSED, // 0x3a
-  LTM4673_UNUSED, // 0x3b
-  LTM4673_UNUSED, // 0x3c
-  LTM4673_UNUSED, // 0x3d
-  LTM4673_UNUSED, // 0x3e
-  LTM4673_UNUSED, // 0x3f
-  LTM4673_ENCODING_L16, // LTM4673_VOUT_OV_FAULT_LIMIT
-  LTM4673_ENCODING_RAW, // LTM4673_VOUT_OV_FAULT_RESPONSE
-  LTM4673_ENCODING_L16, // LTM4673_VOUT_OV_WARN_LIMIT
-  LTM4673_ENCODING_L16, // LTM4673_VOUT_UV_WARN_LIMIT
-  LTM4673_ENCODING_L16, // LTM4673_VOUT_UV_FAULT_LIMIT
-  LTM4673_ENCODING_RAW, // LTM4673_VOUT_UV_FAULT_RESPONSE
-  LTM4673_ENCODING_L11, // LTM4673_IOUT_OC_FAULT_LIMIT
-  LTM4673_ENCODING_RAW, // LTM4673_IOUT_OC_FAULT_RESPONSE
-  LTM4673_UNUSED, // 0x48
-  LTM4673_UNUSED, // 0x49
-  LTM4673_ENCODING_L11, // LTM4673_IOUT_OC_WARN_LIMIT
-  LTM4673_ENCODING_L11, // LTM4673_IOUT_UC_FAULT_LIMIT
-  LTM4673_ENCODING_RAW, // LTM4673_IOUT_UC_FAULT_RESPONSE
-  LTM4673_UNUSED, // 0x4d
-  LTM4673_UNUSED, // 0x4e
-  LTM4673_ENCODING_L11, // LTM4673_OT_FAULT_LIMIT
-  LTM4673_ENCODING_RAW, // LTM4673_OT_FAULT_RESPONSE
-  LTM4673_ENCODING_L11, // LTM4673_OT_WARN_LIMIT
-  LTM4673_ENCODING_L11, // LTM4673_UT_WARN_LIMIT
-  LTM4673_ENCODING_L11, // LTM4673_UT_FAULT_LIMIT
-  LTM4673_ENCODING_RAW, // LTM4673_UT_FAULT_RESPONSE
-  LTM4673_ENCODING_L11, // LTM4673_VIN_OV_FAULT_LIMIT
-  LTM4673_ENCODING_RAW, // LTM4673_VIN_OV_FAULT_RESPONSE
-  LTM4673_ENCODING_L11, // LTM4673_VIN_OV_WARN_LIMIT
-  LTM4673_ENCODING_L11, // LTM4673_VIN_UV_WARN_LIMIT
-  LTM4673_ENCODING_L11, // LTM4673_VIN_UV_FAULT_LIMIT
-  LTM4673_ENCODING_RAW, // LTM4673_VIN_UV_FAULT_RESPONSE
-  LTM4673_UNUSED, // 0x5b
-  LTM4673_UNUSED, // 0x5c
-  LTM4673_UNUSED, // 0x5d
-  LTM4673_ENCODING_L16, // LTM4673_POWER_GOOD_ON
-  LTM4673_ENCODING_L16, // LTM4673_POWER_GOOD_OFF
-  LTM4673_ENCODING_L11, // LTM4673_TON_DELAY
-  LTM4673_ENCODING_L11, // LTM4673_TON_RISE
-  LTM4673_ENCODING_L11, // LTM4673_TON_MAX_FAULT_LIMIT
-  LTM4673_ENCODING_RAW, // LTM4673_TON_MAX_FAULT_RESPONSE
-  LTM4673_ENCODING_L11, // LTM4673_TOFF_DELAY
-  LTM4673_UNUSED, // 0x65
-  LTM4673_UNUSED, // 0x66
-  LTM4673_UNUSED, // 0x67
-  LTM4673_UNUSED, // 0x68
-  LTM4673_UNUSED, // 0x69
-  LTM4673_UNUSED, // 0x6a
-  LTM4673_UNUSED, // 0x6b
-  LTM4673_UNUSED, // 0x6c
-  LTM4673_UNUSED, // 0x6d
-  LTM4673_UNUSED, // 0x6e
-  LTM4673_UNUSED, // 0x6f
-  LTM4673_UNUSED, // 0x70
-  LTM4673_UNUSED, // 0x71
-  LTM4673_UNUSED, // 0x72
-  LTM4673_UNUSED, // 0x73
-  LTM4673_UNUSED, // 0x74
-  LTM4673_UNUSED, // 0x75
-  LTM4673_UNUSED, // 0x76
-  LTM4673_UNUSED, // 0x77
-  LTM4673_ENCODING_RAW, // LTM4673_STATUS_BYTE
-  LTM4673_ENCODING_RAW, // LTM4673_STATUS_WORD
-  LTM4673_ENCODING_RAW, // LTM4673_STATUS_VOUT
-  LTM4673_ENCODING_RAW, // LTM4673_STATUS_IOUT
-  LTM4673_ENCODING_RAW, // LTM4673_STATUS_INPUT
-  LTM4673_ENCODING_RAW, // LTM4673_STATUS_TEMPERATURE
-  LTM4673_ENCODING_RAW, // LTM4673_STATUS_CML
-  LTM4673_UNUSED, // 0x7f
-  LTM4673_ENCODING_RAW, // LTM4673_STATUS_MFR_SPECIFIC
-  LTM4673_UNUSED, // 0x81
-  LTM4673_UNUSED, // 0x82
-  LTM4673_UNUSED, // 0x83
-  LTM4673_UNUSED, // 0x84
-  LTM4673_UNUSED, // 0x85
-  LTM4673_UNUSED, // 0x86
-  LTM4673_UNUSED, // 0x87
-  LTM4673_ENCODING_L11, // LTM4673_READ_VIN
-  LTM4673_ENCODING_L11, // LTM4673_READ_IIN
-  LTM4673_UNUSED, // 0x8a
-  LTM4673_ENCODING_L16, // LTM4673_READ_VOUT
-  LTM4673_ENCODING_L11, // LTM4673_READ_IOUT
-  LTM4673_ENCODING_L11, // LTM4673_READ_TEMPERATURE_1
-  LTM4673_ENCODING_L11, // LTM4673_READ_TEMPERATURE_2
-  LTM4673_UNUSED, // 0x8f
-  LTM4673_UNUSED, // 0x90
-  LTM4673_UNUSED, // 0x91
-  LTM4673_UNUSED, // 0x92
-  LTM4673_UNUSED, // 0x93
-  LTM4673_UNUSED, // 0x94
-  LTM4673_UNUSED, // 0x95
-  LTM4673_ENCODING_L11, // LTM4673_READ_POUT
-  LTM4673_ENCODING_L11, // LTM4673_READ_PIN
-  LTM4673_ENCODING_RAW, // LTM4673_PMBUS_REVISION
-  LTM4673_UNUSED, // 0x99
-  LTM4673_UNUSED, // 0x9a
-  LTM4673_UNUSED, // 0x9b
-  LTM4673_UNUSED, // 0x9c
-  LTM4673_UNUSED, // 0x9d
-  LTM4673_UNUSED, // 0x9e
-  LTM4673_UNUSED, // 0x9f
-  LTM4673_UNUSED, // 0xa0
-  LTM4673_UNUSED, // 0xa1
-  LTM4673_UNUSED, // 0xa2
-  LTM4673_UNUSED, // 0xa3
-  LTM4673_UNUSED, // 0xa4
-  LTM4673_UNUSED, // 0xa5
-  LTM4673_UNUSED, // 0xa6
-  LTM4673_UNUSED, // 0xa7
-  LTM4673_UNUSED, // 0xa8
-  LTM4673_UNUSED, // 0xa9
-  LTM4673_UNUSED, // 0xaa
-  LTM4673_UNUSED, // 0xab
-  LTM4673_UNUSED, // 0xac
-  LTM4673_UNUSED, // 0xad
-  LTM4673_UNUSED, // 0xae
-  LTM4673_UNUSED, // 0xaf
-  LTM4673_ENCODING_RAW, // LTM4673_USER_DATA_00
-  LTM4673_ENCODING_RAW, // LTM4673_USER_DATA_01
-  LTM4673_ENCODING_RAW, // LTM4673_USER_DATA_02
-  LTM4673_ENCODING_RAW, // LTM4673_USER_DATA_03
-  LTM4673_ENCODING_RAW, // LTM4673_USER_DATA_04
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_LTC_RESERVED_1
-  LTM4673_UNUSED, // 0xb6
-  LTM4673_UNUSED, // 0xb7
-  LTM4673_ENCODING_L11, // LTM4673_MFR_T_SELF_HEAT
-  LTM4673_ENCODING_L11, // LTM4673_MFR_IOUT_CAL_GAIN_TAU_INV
-  LTM4673_ENCODING_L11, // LTM4673_MFR_IOUT_CAL_GAIN_THETA
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_READ_IOUT
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_LTC_RESERVED_2
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_EE_UNLOCK
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_EE_ERASE
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_EE_DATA
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_EIN
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_EIN_CONFIG
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_SPECIAL_LOT
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_IIN_CAL_GAIN_TC
-  LTM4673_ENCODING_L11, // LTM4673_MFR_IIN_PEAK
-  LTM4673_ENCODING_L11, // LTM4673_MFR_IIN_MIN
-  LTM4673_ENCODING_L11, // LTM4673_MFR_PIN_PEAK
-  LTM4673_ENCODING_L11, // LTM4673_MFR_PIN_MIN
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_COMMAND_PLUS
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_DATA_PLUS0
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_DATA_PLUS1
-  LTM4673_UNUSED, // 0xcb
-  LTM4673_UNUSED, // 0xcc
-  LTM4673_UNUSED, // 0xcd
-  LTM4673_UNUSED, // 0xce
-  LTM4673_UNUSED, // 0xcf
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_CONFIG_LTM4673
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_CONFIG_ALL_LTM4673
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_FAULTB0_PROPAGATE
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_FAULTB1_PROPAGATE
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_PWRGD_EN
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_FAULTB0_RESPONSE
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_FAULTB1_RESPONSE
-  LTM4673_ENCODING_L11, // LTM4673_MFR_IOUT_PEAK
-  LTM4673_ENCODING_L11, // LTM4673_MFR_IOUT_MIN
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_CONFIG2_LTM4673
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_CONFIG3_LTM4673
-  LTM4673_ENCODING_L11, // LTM4673_MFR_RETRY_DELAY
-  LTM4673_ENCODING_L11, // LTM4673_MFR_RESTART_DELAY
-  LTM4673_ENCODING_L16, // LTM4673_MFR_VOUT_PEAK
-  LTM4673_ENCODING_L11, // LTM4673_MFR_VIN_PEAK
-  LTM4673_ENCODING_L11, // LTM4673_MFR_TEMPERATURE_1_PEAK
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_DAC
-  LTM4673_ENCODING_L11, // LTM4673_MFR_POWERGOOD_ASSERTION_DELAY
-  LTM4673_ENCODING_L11, // LTM4673_MFR_WATCHDOG_T_FIRST
-  LTM4673_ENCODING_L11, // LTM4673_MFR_WATCHDOG_T
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_PAGE_FF_MASK
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_PADS
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_I2C_BASE_ADDRESS
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_SPECIAL_ID
-  LTM4673_ENCODING_L11, // LTM4673_MFR_IIN_CAL_GAIN
-  LTM4673_ENCODING_L11, // LTM4673_MFR_VOUT_DISCHARGE_THRESHOLD
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_FAULT_LOG_STORE
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_FAULT_LOG_RESTORE
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_FAULT_LOG_CLEAR
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_FAULT_LOG_STATUS
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_FAULT_LOG
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_COMMON
-  LTM4673_UNUSED, // 0xf0
-  LTM4673_UNUSED, // 0xf1
-  LTM4673_UNUSED, // 0xf2
-  LTM4673_UNUSED, // 0xf3
-  LTM4673_UNUSED, // 0xf4
-  LTM4673_UNUSED, // 0xf5
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_IOUT_CAL_GAIN_TC
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_RETRY_COUNT
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_TEMP_1_GAIN
-  LTM4673_ENCODING_L11, // LTM4673_MFR_TEMP_1_OFFSET
-  LTM4673_ENCODING_RAW, // LTM4673_MFR_IOUT_SENSE_VOLTAGE
-  LTM4673_ENCODING_L16, // LTM4673_MFR_VOUT_MIN
-  LTM4673_ENCODING_L11, // LTM4673_MFR_VIN_MIN
-  LTM4673_ENCODING_L11, // LTM4673_MFR_TEMPERATURE_1_MIN
-  LTM4673_UNUSED, // 0xfe
-  LTM4673_UNUSED, // 0xff
-};
-
 #ifdef FLOAT_LIMITS
 static float ltm4673_decode_float(uint8_t cmd, uint16_t data);
 static uint16_t ltm4673_encode_float(uint8_t cmd, float val);
 #else
-static int ltm4673_decode(uint8_t cmd, uint16_t data);
-static uint16_t ltm4673_encode(uint8_t cmd, int val);
+static int64_t ltm4673_decode_q16(uint8_t cmd, uint16_t data);
 #endif
 
 static uint16_t ltm4673_apply_limits_cmd(uint8_t cmd, uint16_t val_enc, uint16_t mask,
@@ -422,32 +90,18 @@ static uint16_t ltm4673_encode_float(uint8_t cmd, float val) {
 }
 
 #else
-static int ltm4673_decode(uint8_t cmd, uint16_t data) {
-  uint8_t encoding = ltm4673_encodings[cmd];
-  int val = 0;
-  if (encoding == LTM4673_ENCODING_RAW) {
-    val = (int)data;
-  } else if (encoding == LTM4673_ENCODING_L11) {
-    // Defaulting to mV encoding
-    val = l11_to_mv_int(data);
-  } else if (encoding == LTM4673_ENCODING_L16) {
-    val = L16_TO_MV(data);
-  }
-  return val;
-}
-
-static uint16_t ltm4673_encode(uint8_t cmd, int val) {
-  uint16_t data = 0;
+/* static int64_t ltm4673_decode_q16(uint8_t cmd, uint16_t data);
+ *  Decoded value*2^16 (raw values are scaled too so all encodings compare
+ *  the same way).
+ */
+static int64_t ltm4673_decode_q16(uint8_t cmd, uint16_t data) {
   uint8_t encoding = ltm4673_encodings[cmd];
-  if (encoding == LTM4673_ENCODING_RAW) {
-    data = (uint16_t)val;
-  } else if (encoding == LTM4673_ENCODING_L11) {
-    // Defaulting to mV encoding
-    data = mv_to_l11_int(val);
+  if (encoding == LTM4673_ENCODING_L11) {
+    return l11_to_q16(data);
   } else if (encoding == LTM4673_ENCODING_L16) {
-    data = MV_TO_L16(val);
+    return l16_to_q16(data);
   }
-  return data;
+  return (int64_t)data << 16;
 }
 #endif
 
@@ -496,38 +150,46 @@ static int ltm4673_vet_status_word(uint16_t stat) {
 }
 
 void ltm4673_read_telem(uint8_t dev) {
-   struct {int b; const char *m;} r_table[] = {
+   struct {int b; const char *u; const char *m;} r_table[] = {
       // see page 105
-      {LTM4673_READ_VIN,              "V     READ_VIN"},
-      {LTM4673_READ_IIN,              "A     READ_IIN"},
-      {LTM4673_READ_PIN,              "W     READ_PIN"},
-      {LTM4673_READ_VOUT,             "V     READ_VOUT"},
-      {LTM4673_READ_IOUT,             "A     READ_IOUT"},
-      {LTM4673_READ_TEMPERATURE_1,    "degC  READ_TEMPERATURE_1"},
-      {LTM4673_READ_TEMPERATURE_2,    "degC  READ_TEMPERATURE_2"},
-      {LTM4673_READ_POUT,             "W     READ_POUT"},
-      {LTM4673_MFR_READ_IOUT,         "mA    MFR_READ_IOUT"},
-      {LTM4673_MFR_IIN_PEAK,          "A     MFR_IIN_PEAK"},
-      {LTM4673_MFR_IIN_MIN,           "A     MFR_IIN_MIN"},
-      {LTM4673_MFR_PIN_PEAK,          "W     MFR_PIN_PEAK"},
-      {LTM4673_MFR_PIN_MIN,           "W     MFR_PIN_MIN"},
-      {LTM4673_MFR_IOUT_SENSE_VOLTAGE,"V     MFR_IOUT_SENSE_VOLTAGE"},
-      {LTM4673_MFR_VIN_PEAK,          "V     MFR_VIN_PEAK"},
-      {LTM4673_MFR_VOUT_PEAK,         "V     MFR_VOUT_PEAK"},
-      {LTM4673_MFR_IOUT_PEAK,         "A     MFR_IOUT_PEAK"},
-      {LTM4673_MFR_TEMPERATURE_1_PEAK,"degC  MFR_TEMPERATURE_1_PEAK"},
-      {LTM4673_MFR_VIN_MIN,           "V     MFR_VIN_MIN"},
-      {LTM4673_MFR_VOUT_MIN,          "V     MFR_VOUT_MIN"},
-      {LTM4673_MFR_IOUT_MIN,          "A     MFR_IOUT_MIN"},
-      {LTM4673_MFR_TEMPERATURE_1_MIN, "degC  MFR_TEMPERATURE_1_MIN"}};
-   printf("LTM4673 Telemetry register dump:\n");
+      {LTM4673_READ_VIN,              "V",     "READ_VIN"},
+      {LTM4673_READ_IIN,              "A",     "READ_IIN"},
+      {LTM4673_READ_PIN,              "W",     "READ_PIN"},
+      {LTM4673_READ_VOUT,             "V",     "READ_VOUT"},
+      {LTM4673_READ_IOUT,             "A",     "READ_IOUT"},
+      {LTM4673_READ_TEMPERATURE_1,    "degC",  "READ_TEMPERATURE_1"},
+      {LTM4673_READ_TEMPERATURE_2,    "degC",  "READ_TEMPERATURE_2"},
+      {LTM4673_READ_POUT,             "W",     "READ_POUT"},
+      {LTM4673_MFR_READ_IOUT,         "mA",    "MFR_READ_IOUT"},
+      {LTM4673_MFR_IIN_PEAK,          "A",     "MFR_IIN_PEAK"},
+      {LTM4673_MFR_IIN_MIN,           "A",     "MFR_IIN_MIN"},
+      {LTM4673_MFR_PIN_PEAK,          "W",     "MFR_PIN_PEAK"},
+      {LTM4673_MFR_PIN_MIN,           "W",     "MFR_PIN_MIN"},
+      {LTM4673_MFR_IOUT_SENSE_VOLTAGE,"V",     "MFR_IOUT_SENSE_VOLTAGE"},
+      {LTM4673_MFR_VIN_PEAK,          "V",     "MFR_VIN_PEAK"},
+      {LTM4673_MFR_VOUT_PEAK,         "V",     "MFR_VOUT_PEAK"},
+      {LTM4673_MFR_IOUT_PEAK,         "A",     "MFR_IOUT_PEAK"},
+      {LTM4673_MFR_TEMPERATURE_1_PEAK,"degC",  "MFR_TEMPERATURE_1_PEAK"},
+      {LTM4673_MFR_VIN_MIN,           "V",     "MFR_VIN_MIN"},
+      {LTM4673_MFR_VOUT_MIN,          "V",     "MFR_VOUT_MIN"},
+      {LTM4673_MFR_IOUT_MIN,          "A",     "MFR_IOUT_MIN"},
+      {LTM4673_MFR_TEMPERATURE_1_MIN, "degC",  "MFR_TEMPERATURE_1_MIN"}};
+   int structured = report_structured();
+   if (!structured) {
+      printf("LTM4673 Telemetry register dump:\n");
+   }
    //float L16 = 0.0001220703125;  // 2**(-13)
    for (unsigned jx = 0; jx < 4; jx++) {
       // start selecting channel/page 0 until you finish reading
       // telemetry data for all 4 channels
       uint8_t page = 0x00 + jx;
       marble_I2C_cmdsend(I2C_PM, dev, 0x00, &page, 1);
-      printf("> Read page/channel: %x\n", page);
+      if (structured) {
+         report_begin("ltm4673");
+         report_uint("page", page);
+      } else {
+         printf("> Read page/channel: %x\n", page);
+      }
       const unsigned tlen = sizeof(r_table)/sizeof(r_table[0]);
       for (unsigned ix=0; ix<tlen; ix++) {
           uint8_t i2c_dat[4];
@@ -548,11 +210,18 @@ void ltm4673_read_telem(uint8_t dev) {
               } else {
                   phys_unit = (float)word0;
               }
-              printf("r[%2.2x] = 0x%4.4x = %5d = %7.3f %s\r\n", (unsigned) regno, word0, word0, phys_unit, r_table[ix].m);
-          } else {
-              printf("r[%2.2x]    unread          (%s)\r\n", (unsigned) regno, r_table[ix].m);
+              if (structured) {
+                  report_float(r_table[ix].m, phys_unit);
+              } else {
+                  printf("r[%2.2x] = 0x%4.4x = %5d = %7.3f %-6s%s\r\n", (unsigned) regno, word0, word0, phys_unit, r_table[ix].u, r_table[ix].m);
+              }
+          } else if (!structured) {
+              printf("r[%2.2x]    unread          (%-6s%s)\r\n", (unsigned) regno, r_table[ix].u, r_table[ix].m);
           }
       }
+      if (structured) {
+         report_end();
+      }
    }
    return;
 }
@@ -562,35 +231,44 @@ void ltm4673_update_telem(uint8_t dev, volatile uint16_t *pdata) {
   uint8_t page;
   uint8_t i2c_dat[4];
   uint16_t rval;
+  // Reads go through PM_cmdrecv() which verifies PEC (if enabled) and retries.
+  // A value that still can't be read keeps its previous (stale) value rather
+  // than being overwritten with garbage.
   // Recall:  LTM4673_READ_VOUT is LTM4673_ENCODING_L16
   //          LTM4673_READ_IOUT is LTM4673_ENCODING_L11
   // For each page
   for (unsigned int npage = 0; npage < 4; npage++) {
     page = (uint8_t)(npage & 0xff);
-    marble_I2C_cmdsend(I2C_PM, dev, 0x00, &page, 1);
+    if (PM_cmdsend(dev, 0x00, &page, 1)) {
+      continue;
+    }
     // Read voltage
-    marble_I2C_cmdrecv(I2C_PM, dev, LTM4673_READ_VOUT, i2c_dat, 2);
-    rval = COMBINE_BYTES16(i2c_dat);
-    // Recall: LTM4673_READ_VOUT is LTM4673_ENCODING_L16
-    rval = (uint16_t)(l16_to_mv_int(rval) & 0xffff);
-    *(&pdata[2*npage]) = rval;
+    if (!PM_cmdrecv(dev, LTM4673_READ_VOUT, i2c_dat, 2)) {
+      rval = COMBINE_BYTES16(i2c_dat);
+      // Recall: LTM4673_READ_VOUT is LTM4673_ENCODING_L16
+      rval = (uint16_t)(l16_to_mv_int(rval) & 0xffff);
+      *(&pdata[2*npage]) = rval;
+    }
     // Read current
-    marble_I2C_cmdrecv(I2C_PM, dev, LTM4673_READ_IOUT, i2c_dat, 2);
-    rval = COMBINE_BYTES16(i2c_dat);
-    // Recall: LTM4673_READ_IOUT is LTM4673_ENCODING_L11
-    rval = (uint16_t)(l11_to_mv_int(rval) & 0xffff);
-    *(&pdata[2*npage+1]) = rval;
+    if (!PM_cmdrecv(dev, LTM4673_READ_IOUT, i2c_dat, 2)) {
+      rval = COMBINE_BYTES16(i2c_dat);
+      // Recall: LTM4673_READ_IOUT is LTM4673_ENCODING_L11
+      rval = (uint16_t)(l11_to_mv_int(rval) & 0xffff);
+      *(&pdata[2*npage+1]) = rval;
+    }
   }
   // LTM4673_READ_VIN, LTM4673_READ_IIN are identical on all pages
   // They are both LTM4673_ENCODING_L11
-  marble_I2C_cmdrecv(I2C_PM, dev, LTM4673_READ_VIN, i2c_dat, 2);
-  rval = COMBINE_BYTES16(i2c_dat);
-  rval = (uint16_t)(l11_to_mv_int(rval) & 0xffff);
-  *(&pdata[8]) = rval;
-  marble_I2C_cmdrecv(I2C_PM, dev, LTM4673_READ_IIN, i2c_dat, 2);
-  rval = COMBINE_BYTES16(i2c_dat);
-  rval = (uint16_t)(l11_to_mv_int(rval) & 0xffff);
-  *(&pdata[9]) = rval;
+  if (!PM_cmdrecv(dev, LTM4673_READ_VIN, i2c_dat, 2)) {
+    rval = COMBINE_BYTES16(i2c_dat);
+    rval = (uint16_t)(l11_to_mv_int(rval) & 0xffff);
+    *(&pdata[8]) = rval;
+  }
+  if (!PM_cmdrecv(dev, LTM4673_READ_IIN, i2c_dat, 2)) {
+    rval = COMBINE_BYTES16(i2c_dat);
+    rval = (uint16_t)(l11_to_mv_int(rval) & 0xffff);
+    *(&pdata[9]) = rval;
+  }
   #undef COMBINE_BYTES
   return;
 }
@@ -751,11 +429,22 @@ int ltm4673_pmbridge_hook_read(uint8_t addr, int cmd, const uint8_t *data, int l
   return matched;
 }
 
+/* static const ltm4673_limit_t *ltm4673_get_limit(uint8_t page, uint8_t cmd);
+ *  Returns the limit on command 'cmd' for page 'page' or NULL if unlimited.
+ */
+static const ltm4673_limit_t *ltm4673_get_limit(uint8_t page, uint8_t cmd) {
+  uint8_t slot = ltm4673_limit_slot[cmd];
+  if (slot == 0) {
+    return NULL;
+  }
+  const ltm4673_limit_t *limit = &ltm4673_limit_table[slot - 1][LTM4673_PAGE_INDEX(page)];
+  return limit->active ? limit : NULL;
+}
+
 int ltm4673_apply_limits(uint16_t *xact, int len) {
   uint16_t val_enc;
   int matched = 0;
-  unsigned int row;
-  uint16_t mask, min_enc, max_enc;
+  const ltm4673_limit_t *limit;
   uint8_t command_code = xact[1] & 0xff;
   // Look for LTM4673 writes
   for (unsigned int n = 0; n < LTM4673_MATCH_ADDRS; n++) {
@@ -764,29 +453,27 @@ int ltm4673_apply_limits(uint16_t *xact, int len) {
       break;
     }
   }
-  if (matched) {
-    // Compare with limits on the current page
-    for (row = 0; row < ltm4673_limits[LTM4673_PAGE_INDEX(ltm4673_page)].nrows; row++) {
-      if (command_code == LTM4673_LIMIT_GET_COMMAND(ltm4673_page, row)) {
-        mask = LTM4673_LIMIT_GET_MASK(ltm4673_page, row);
-        if (mask == 0) {
-          printf("Vetoing write to protected register 0x%02x\r\n", command_code);
-          return 0;
-        }
-        val_enc = (uint16_t)xact[2];
-        if (len > 3) {
-          val_enc |= ((uint16_t)xact[3] << 8);
-        }
-        min_enc = LTM4673_LIMIT_GET_MIN(ltm4673_page, row);
-        max_enc = LTM4673_LIMIT_GET_MAX(ltm4673_page, row);
-        val_enc = ltm4673_apply_limits_cmd(command_code, val_enc, mask, min_enc, max_enc);
-        // Clobber old data
-        xact[2] = (uint8_t)(val_enc & 0xff);
-        if (len > 3) {
-          xact[3] = (uint8_t)((val_enc >> 8) & 0xff);
-        }
-      }
-    }
+  if (!matched) {
+    return 0;
+  }
+  // Compare with limits on the current page
+  limit = ltm4673_get_limit(ltm4673_page, command_code);
+  if (limit == NULL) {
+    return 0;
+  }
+  if (limit->mask == 0) {
+    printf("Vetoing write to protected register 0x%02x\r\n", command_code);
+    return 0;
+  }
+  val_enc = (uint16_t)xact[2];
+  if (len > 3) {
+    val_enc |= ((uint16_t)xact[3] << 8);
+  }
+  val_enc = ltm4673_apply_limits_cmd(command_code, val_enc, limit->mask, limit->min, limit->max);
+  // Clobber old data
+  xact[2] = (uint8_t)(val_enc & 0xff);
+  if (len > 3) {
+    xact[3] = (uint8_t)((val_enc >> 8) & 0xff);
   }
   return 0;
 }
@@ -823,48 +510,358 @@ static uint16_t ltm4673_apply_limits_cmd(uint8_t cmd, uint16_t val_enc, uint16_t
     // Encode the bytes before storing
     val_enc = ltm4673_encode_float(cmd, val_dec);
 #else
-    int val_dec, lim_dec;
-    // Decode the set value and limits before comparing
-    val_dec = ltm4673_decode(cmd, val_enc);
+    // Compare exactly in fixed point; a clipped value takes the limit's own
+    // encoding so nothing is re-encoded (or rounded)
+    int64_t val_q16 = ltm4673_decode_q16(cmd, val_enc);
     // FIXME DEBUG
-    printf("  [Limits] %d ->", val_dec);
-    // Clip at lower limit
-    lim_dec = ltm4673_decode(cmd, min_enc);
+    printf("  [Limits] 0x%04x", val_enc);
     printf(" (min_enc = 0x%04x)", min_enc);
-    printf(" (min_dec = %d)", lim_dec);
-    val_dec = val_dec < lim_dec ? lim_dec : val_dec;
-    // Clip at upper limit
-    lim_dec = ltm4673_decode(cmd, max_enc);
     printf(" (max_enc = 0x%04x)", max_enc);
-    printf(" (max_dec = %d)", lim_dec);
-    val_dec = val_dec > lim_dec ? lim_dec : val_dec;
+    if (val_q16 < ltm4673_decode_q16(cmd, min_enc)) {
+      val_enc = min_enc;
+    } else if (val_q16 > ltm4673_decode_q16(cmd, max_enc)) {
+      val_enc = max_enc;
+    }
     // FIXME DEBUG
-    printf(" -> %d\r\n", val_dec);
-    // Encode the bytes before storing
-    val_enc = ltm4673_encode(cmd, val_dec);
+    printf(" -> 0x%04x\r\n", val_enc);
 #endif
   }
   return val_enc;
 }
 
 void ltm4673_print_limits(void) {
-  uint8_t cmd;
-  uint16_t mask, min, max;
-  unsigned int page, row;
+  const ltm4673_limit_t *limit;
+  unsigned int page, cmd;
   for (page = 0; page < LTM4673_NPAGES; page++) {
-    if (page > 3) {
+    if (page >= LTM4673_NCHANNELS) {
       printf("Page 0xff\r\n");
     } else {
       printf("Page 0x%x\r\n", page);
     }
     printf("cmd   mask  min   max\r\n");
-    for (row = 0; row < ltm4673_limits[LTM4673_PAGE_INDEX(page)].nrows; row++) {
-      cmd  = LTM4673_LIMIT_GET_COMMAND(page, row);
-      mask = LTM4673_LIMIT_GET_MASK(page, row);
-      min  = LTM4673_LIMIT_GET_MIN(page, row);
-      max  = LTM4673_LIMIT_GET_MAX(page, row);
-      printf("0x%02x  0x%04x  0x%04x  0x%04x\r\n", cmd, mask, min, max);
+    for (cmd = 0; cmd < 0x100; cmd++) {
+      limit = ltm4673_get_limit((uint8_t)page, (uint8_t)cmd);
+      if (limit != NULL) {
+        printf("0x%02x  0x%04x  0x%04x  0x%04x\r\n", cmd, limit->mask, limit->min, limit->max);
+      }
+    }
+  }
+  return;
+}
+
+// ============================ SMBALERT Fault Capture ============================
+static ltm4673_fault_t _faults[LTM4673_FAULT_RING_SIZE];
+static unsigned int _fault_head = 0;  // Index of the next slot to write
+static uint16_t _fault_count = 0;     // Total captured (saturating)
+static uint8_t _fault_pending = 0;
+
+int ltm4673_fault_capture(uint8_t dev) {
+  ltm4673_fault_t *fault = &_faults[_fault_head];
+  uint8_t restore_page = ltm4673_page;
+  uint8_t i2c_dat[2];
+  int rc = 0;
+  memset(fault, 0, sizeof(ltm4673_fault_t));
+  fault->tick = marble_get_tick();
+  // The ARA read makes the alerting device release SMBALERT and identify itself
+  if (marble_I2C_recv(I2C_PM, SMBUS_ARA_ADDR_8BIT, i2c_dat, 1) == HAL_OK) {
+    fault->ara_addr = i2c_dat[0] & 0xfe;
+  }
+  for (unsigned int npage = 0; npage < 4; npage++) {
+    uint8_t page = (uint8_t)npage;
+    int prc = PM_cmdsend(dev, LTM4673_PAGE, &page, 1);
+    int wrc = PM_cmdrecv(dev, LTM4673_STATUS_WORD, i2c_dat, 2);
+    // Left at 0 (and the page not flagged in read_ok) if the read failed
+    if (wrc == 0) {
+      fault->status_word[npage] = ((uint16_t)i2c_dat[1] << 8) | i2c_dat[0];
+    }
+    prc |= wrc;
+    prc |= PM_cmdrecv(dev, LTM4673_STATUS_VOUT, &fault->status_vout[npage], 1);
+    prc |= PM_cmdrecv(dev, LTM4673_STATUS_IOUT, &fault->status_iout[npage], 1);
+    prc |= PM_cmdrecv(dev, LTM4673_STATUS_TEMPERATURE, &fault->status_temp[npage], 1);
+    prc |= PM_cmdrecv(dev, LTM4673_STATUS_MFR_SPECIFIC, &fault->status_mfr[npage], 1);
+    if (prc == 0) {
+      fault->read_ok |= (1 << npage);
+    }
+    rc |= prc;
+  }
+  rc |= PM_cmdrecv(dev, LTM4673_STATUS_INPUT, &fault->status_input, 1);
+  rc |= PM_cmdrecv(dev, LTM4673_STATUS_CML, &fault->status_cml, 1);
+  if ((restore_page < 4) || (restore_page == 0xff)) {
+    PM_cmdsend(dev, LTM4673_PAGE, &restore_page, 1);
+  }
+  _fault_head = (_fault_head + 1) % LTM4673_FAULT_RING_SIZE;
+  if (_fault_count < 0xffff) {
+    _fault_count++;
+  }
+  _fault_pending = 1;
+  mbox_fifo_put(MBOX_FIFO_REC_FAULT, (const uint8_t *)fault, sizeof(ltm4673_fault_t));
+  return rc;
+}
+
+int ltm4673_get_fault(unsigned int n, ltm4673_fault_t *fault) {
+  unsigned int stored = _fault_count < LTM4673_FAULT_RING_SIZE ? _fault_count : LTM4673_FAULT_RING_SIZE;
+  if (n >= stored) {
+    return -1;
+  }
+  unsigned int index = (_fault_head + LTM4673_FAULT_RING_SIZE - 1 - n) % LTM4673_FAULT_RING_SIZE;
+  memcpy(fault, &_faults[index], sizeof(ltm4673_fault_t));
+  return 0;
+}
+
+uint16_t ltm4673_fault_count(void) {
+  return _fault_count;
+}
+
+uint8_t ltm4673_fault_flag(void) {
+  return _fault_pending ? LTM4673_FAULT_FLAG_PENDING : 0;
+}
+
+/* void ltm4673_fault_ack(uint8_t val);
+ *  Mailbox input.  The page is read back before it is rewritten, so only the
+ *  explicit LTM4673_FAULT_FLAG_ACK value (never output by the MMC) clears the
+ *  pending flag.
+ */
+void ltm4673_fault_ack(uint8_t val) {
+  if (val == LTM4673_FAULT_FLAG_ACK) {
+    _fault_pending = 0;
+  }
+  return;
+}
+
+/* uint16_t ltm4673_fault_status_word(unsigned int page);
+ *  STATUS_WORD of 'page' from the most recent snapshot (0 if none or if
+ *  the page could not be read).
+ */
+uint16_t ltm4673_fault_status_word(unsigned int page) {
+  if ((_fault_count == 0) || (page > 3)) {
+    return 0;
+  }
+  unsigned int index = (_fault_head + LTM4673_FAULT_RING_SIZE - 1) % LTM4673_FAULT_RING_SIZE;
+  if (!(_faults[index].read_ok & (1 << page))) {
+    return 0;
+  }
+  return _faults[index].status_word[page];
+}
+
+void ltm4673_fault_clear(void) {
+  _fault_head = 0;
+  _fault_count = 0;
+  _fault_pending = 0;
+  return;
+}
+
+void ltm4673_print_faults(void) {
+  ltm4673_fault_t fault;
+  if (!report_structured()) {
+    printf("LTM4673 faults captured: %u%s\r\n", _fault_count, _fault_pending ? " (new)" : "");
+  }
+  for (unsigned int n = 0; ltm4673_get_fault(n, &fault) == 0; n++) {
+    if (report_structured()) {
+      report_begin("ltm4673_fault");
+      report_uint("n", n);
+      report_uint("tick", fault.tick);
+      report_hex("ara", fault.ara_addr);
+      report_hex("read_ok", fault.read_ok);
+      report_hex("input", fault.status_input);
+      report_hex("cml", fault.status_cml);
+      report_bytes("word", (const uint8_t *)fault.status_word, sizeof(fault.status_word));
+      report_bytes("vout", fault.status_vout, 4);
+      report_bytes("iout", fault.status_iout, 4);
+      report_bytes("temp", fault.status_temp, 4);
+      report_bytes("mfr", fault.status_mfr, 4);
+      report_end();
+      continue;
+    }
+    printf("[%u] t=%lu ms ARA=0x%02x INPUT=0x%02x CML=0x%02x\r\n", n,
+           (unsigned long)fault.tick, fault.ara_addr, fault.status_input, fault.status_cml);
+    for (unsigned int npage = 0; npage < 4; npage++) {
+      if (!(fault.read_ok & (1 << npage))) {
+        printf("  page %u: read failed\r\n", npage);
+        continue;
+      }
+      printf("  page %u: WORD=0x%04x VOUT=0x%02x IOUT=0x%02x TEMP=0x%02x MFR=0x%02x\r\n",
+             npage, fault.status_word[npage], fault.status_vout[npage],
+             fault.status_iout[npage], fault.status_temp[npage], fault.status_mfr[npage]);
     }
   }
   return;
 }
+
+int ltm4673_read_fault_log(uint8_t dev, uint8_t *data, int len) {
+  // One block read (no PEC): byte count + up to 255 bytes
+  if (len > 256) {
+    len = 256;
+  }
+  if (marble_I2C_cmdrecv(I2C_PM, dev, LTM4673_MFR_FAULT_LOG, data, len) != HAL_OK) {
+    return -1;
+  }
+  if (data[0] + 1 < len) {
+    len = data[0] + 1;
+  }
+  return len;
+}
+
+// ========================= Bulk Configuration Image =========================
+static uint8_t _image[LTM4673_IMAGE_MAX];
+static unsigned int _image_len = 0;
+
+static int ltm4673_image_vet(void);
+static int ltm4673_image_run(uint8_t dev, uint8_t flags, unsigned int start, unsigned int end,
+                             ltm4673_image_result_t *result);
+
+void ltm4673_image_clear(void) {
+  _image_len = 0;
+  return;
+}
+
+int ltm4673_image_put(unsigned int offset, const uint8_t *data, int len) {
+  if ((len < 0) || (offset > _image_len) || (offset + len > LTM4673_IMAGE_MAX)) {
+    return -1;
+  }
+  memcpy(_image + offset, data, len);
+  if (offset + len > _image_len) {
+    _image_len = offset + len;
+  }
+  return (int)_image_len;
+}
+
+/*
+ * static int ltm4673_image_vet(void);
+ *  Check every record of the image.  Returns the number of records or -1.
+ */
+static int ltm4673_image_vet(void) {
+  unsigned int offset = 0;
+  int nrec = 0;
+  while (offset < _image_len) {
+    if (offset + LTM4673_IMAGE_REC_HEADER > _image_len) {
+      printf("LTM4673 image: truncated record at %u\r\n", offset);
+      return -1;
+    }
+    uint8_t page = _image[offset];
+    uint8_t cmd = _image[offset + 1];
+    uint8_t len = _image[offset + 2];
+    if (((page >= LTM4673_NCHANNELS) && (page != 0xff)) || (cmd == LTM4673_PAGE)
+        || (len < 1) || (len > 2) || (offset + LTM4673_IMAGE_REC_HEADER + len > _image_len)) {
+      printf("LTM4673 image: bad record at %u (page 0x%02x cmd 0x%02x len %u)\r\n",
+             offset, page, cmd, len);
+      return -1;
+    }
+    offset += LTM4673_IMAGE_REC_HEADER + len;
+    nrec++;
+  }
+  return nrec;
+}
+
+/*
+ * static int ltm4673_image_run(uint8_t dev, uint8_t flags, unsigned int start, unsigned int end,
+ *                              ltm4673_image_result_t *result);
+ *  Program the records between offsets 'start' and 'end', which all share
+ *  one page: select it, read all of them, write those which differ, then
+ *  read those back.  Records for registers PMBridge protects are counted as
+ *  failed and never written.
+ */
+static int ltm4673_image_run(uint8_t dev, uint8_t flags, unsigned int start, unsigned int end,
+                             ltm4673_image_result_t *result) {
+  static uint16_t want[LTM4673_IMAGE_MAX_RECORDS];
+  static uint8_t differs[LTM4673_IMAGE_MAX_RECORDS];
+  const ltm4673_limit_t *limit;
+  uint8_t i2c_dat[2];
+  uint8_t page = _image[start];
+  unsigned int offset;
+  unsigned int nrec;
+  int rc = 0;
+  if (PM_cmdsend(dev, LTM4673_PAGE, &page, 1)) {
+    printf("LTM4673 image: failed to select page 0x%02x\r\n", page);
+    return 1;
+  }
+  // Read back the whole run first
+  for (offset = start, nrec = 0; offset < end; offset += LTM4673_IMAGE_REC_HEADER + _image[offset + 2], nrec++) {
+    uint8_t cmd = _image[offset + 1];
+    uint8_t len = _image[offset + 2];
+    want[nrec] = (uint16_t)(len > 1 ? (_image[offset + 4] << 8) | _image[offset + 3] : _image[offset + 3]);
+    // What a PMBridge write of this record would actually put in the register
+    limit = ltm4673_get_limit(page, cmd);
+    if ((limit != NULL) && (limit->mask == 0)) {
+      printf("LTM4673 image: protected register, page 0x%02x cmd 0x%02x\r\n", page, cmd);
+      differs[nrec] = 0;
+      result->failed++;
+      rc = 1;
+      continue;
+    }
+    if (limit != NULL) {
+      want[nrec] = ltm4673_apply_limits_cmd(cmd, want[nrec], limit->mask, limit->min, limit->max);
+    }
+    differs[nrec] = 1;
+    i2c_dat[1] = 0;
+    if (PM_cmdrecv(dev, cmd, i2c_dat, len) == 0) {
+      differs[nrec] = ((uint16_t)((i2c_dat[1] << 8) | i2c_dat[0]) != want[nrec]);
+    }
+    result->changed += differs[nrec];
+  }
+  if (flags & LTM4673_IMAGE_DRY_RUN) {
+    return rc;
+  }
+  // Write only the differences
+  for (offset = start, nrec = 0; offset < end; offset += LTM4673_IMAGE_REC_HEADER + _image[offset + 2], nrec++) {
+    if (!differs[nrec]) {
+      continue;
+    }
+    i2c_dat[0] = (uint8_t)(want[nrec] & 0xff);
+    i2c_dat[1] = (uint8_t)(want[nrec] >> 8);
+    if (PM_cmdsend(dev, _image[offset + 1], i2c_dat, _image[offset + 2])) {
+      printf("LTM4673 image: write failed, page 0x%02x cmd 0x%02x\r\n", page, _image[offset + 1]);
+      differs[nrec] = 0;
+      result->failed++;
+      rc = 1;
+    }
+  }
+  // Verify what was written
+  for (offset = start, nrec = 0; offset < end; offset += LTM4673_IMAGE_REC_HEADER + _image[offset + 2], nrec++) {
+    if (!differs[nrec]) {
+      continue;
+    }
+    i2c_dat[0] = 0;
+    i2c_dat[1] = 0;
+    int rrc = PM_cmdrecv(dev, _image[offset + 1], i2c_dat, _image[offset + 2]);
+    uint16_t got = (uint16_t)((i2c_dat[1] << 8) | i2c_dat[0]);
+    if ((rrc != 0) || (got != want[nrec])) {
+      printf("LTM4673 image: verify failed, page 0x%02x cmd 0x%02x want 0x%04x read 0x%04x\r\n",
+             page, _image[offset + 1], want[nrec], got);
+      result->failed++;
+      rc = 1;
+    }
+  }
+  return rc;
+}
+
+int ltm4673_image_program(uint8_t dev, uint8_t flags, ltm4673_image_result_t *result) {
+  uint8_t restore_page = ltm4673_page;
+  unsigned int start = 0;
+  unsigned int offset = 0;
+  int rc = 0;
+  memset(result, 0, sizeof(ltm4673_image_result_t));
+  int nrec = ltm4673_image_vet();
+  if (nrec < 0) {
+    return -1;
+  }
+  result->records = (uint16_t)nrec;
+  while (offset < _image_len) {
+    offset += LTM4673_IMAGE_REC_HEADER + _image[offset + 2];
+    if ((offset == _image_len) || (_image[offset] != _image[start])) {
+      rc |= ltm4673_image_run(dev, flags, start, offset, result);
+      start = offset;
+    }
+  }
+  if ((restore_page < LTM4673_NCHANNELS) || (restore_page == 0xff)) {
+    PM_cmdsend(dev, LTM4673_PAGE, &restore_page, 1);
+  }
+  if ((flags & LTM4673_IMAGE_STORE) && !(flags & LTM4673_IMAGE_DRY_RUN)
+      && (result->changed > 0) && (rc == 0)) {
+    if (PM_cmdsend(dev, LTM4673_STORE_USER_ALL, NULL, 0)) {
+      printf("LTM4673 image: STORE_USER_ALL failed\r\n");
+      return 1;
+    }
+    result->stored = 1;
+  }
+  return rc;
+}
@@ -1,11 +1,18 @@
 #include "marble_api.h"
 #include <stdio.h>
 #include "i2c_pm.h"
+#include "ltm4673.h"
+#include "pmlog.h"
 #include "mailbox.h"
 #include "max6639.h"
 #include "watchdog.h"
 #include "rev.h"
 #include "eeprom.h"
+#include "mbox_rpc.h"
+#include "mbox_fifo.h"
+#include "busprof.h"
+#include "fanctl.h"
+#include "i2c_fpga.h"
 
 /* ============================= Helper Macros ============================== */
 // Define SPI_SWITCH to re-route SPI bound for FPGA to Pmod for debugging
@@ -21,9 +28,24 @@ extern SSP_PORT SSP_FPGA;
 extern SSP_PORT SSP_PMOD;
 uint16_t update_count = 0;
 static uint8_t mbox_is_enabled = 1;
+static uint8_t mbox_boot_pending = 1;
+static uint32_t mbox_medium_tick = 0;
+static uint32_t mbox_slow_tick = 0;
+#ifdef MBOX_SEQ_PAGE
+// Sequence counters of the "seqlock" pages, indexed by entry in MBOX_SEQ_PAGE
+static uint8_t mbox_seq[MBOX_PAGE_SIZE] = {0};
+// Last contents written to each "seqlock" page and the mask of entries known
+static uint8_t mbox_seq_shadow[MBOX_PAGE_SIZE][MBOX_PAGE_SIZE];
+static uint16_t mbox_seq_known[MBOX_PAGE_SIZE] = {0};
+#endif
 
 /* =========================== Static Prototypes ============================ */
 static void mbox_handleI2CBusStatusMsg(uint8_t msg);
+#ifdef MBOX_SEQ_PAGE
+static int mbox_seq_changed(uint8_t entry_no, uint8_t first, uint8_t count, const uint8_t page[]);
+static void mbox_seq_begin(uint8_t entry_no);
+static void mbox_seq_end(uint8_t entry_no);
+#endif
 
 // XXX Including auto-generated source file! This is atypical, but works nicely.
 #include "mailbox_def.c"
@@ -32,6 +54,7 @@ static void mbox_handleI2CBusStatusMsg(uint8_t msg);
 
 void mbox_enable(void) {
   mbox_is_enabled = 1;
+  mbox_boot_pending = 1;
   eeprom_store_mbox_en(&mbox_is_enabled, 1);
   return;
 }
@@ -52,6 +75,7 @@ void mbox_disable(void) {
 void mbox_set_enable(int enabled) {
   if (enabled) {
     mbox_is_enabled = 1;
+    mbox_boot_pending = 1;
   } else {
     mbox_is_enabled = 0;
   }
@@ -84,38 +108,168 @@ uint8_t mbox_read_entry(uint8_t entry_no) {
 }
 
 void mbox_write_page(uint8_t page_no, uint8_t page_sz, const uint8_t page[]) {
+   mbox_write_entries(page_no, 0, page_sz, page);
+}
+
+void mbox_read_page(uint8_t page_no, uint8_t page_sz, uint8_t *page) {
+   mbox_read_entries(page_no, 0, page_sz, page);
+}
+
+void mbox_write_entries(uint8_t page_no, uint8_t first, uint8_t count, const uint8_t page[]) {
    // Write at most 16 bytes to page
-   if (page_sz > 16) page_sz = 16;
+   if (first + count > MBOX_PAGE_SIZE) count = MBOX_PAGE_SIZE - first;
    mbox_set_page(page_no);
-   //printf("write_page %d, size %d\r\n", page_no, page_sz);
-   for (unsigned jx=0; jx<page_sz; jx++) {
+   //printf("write_page %d, %d..%d\r\n", page_no, first, first + count - 1);
+   for (unsigned jx=first; jx<(unsigned)(first + count); jx++) {
       mbox_write_entry(jx, page[jx]);
    }
 }
 
-void mbox_read_page(uint8_t page_no, uint8_t page_sz, uint8_t *page) {
-   // Write at most 16 bytes to page
-   if (page_sz > 16) page_sz = 16;
+void mbox_read_entries(uint8_t page_no, uint8_t first, uint8_t count, uint8_t *page) {
+   // Read at most 16 bytes from page
+   if (first + count > MBOX_PAGE_SIZE) count = MBOX_PAGE_SIZE - first;
    mbox_set_page(page_no);
-   //printf("read_page %d, size %d\r\n", page_no, page_sz);
-   for (unsigned jx=0; jx<page_sz; jx++) {
+   //printf("read_page %d, %d..%d\r\n", page_no, first, first + count - 1);
+   for (unsigned jx=first; jx<(unsigned)(first + count); jx++) {
       page[jx] = mbox_read_entry(jx);
    }
 }
 
+void mbox_request_boot_update(void) {
+  mbox_boot_pending = 1;
+#ifdef MBOX_SEQ_PAGE
+  // The FPGA's copy of the "seqlock" pages may be gone; rewrite them all
+  for (unsigned int n = 0; n < MBOX_PAGE_SIZE; n++) {
+    mbox_seq_known[n] = 0;
+  }
+#endif
+  return;
+}
+
+#ifdef MBOX_SEQ_PAGE
+/* static int mbox_seq_changed(uint8_t entry_no, uint8_t first, uint8_t count, const uint8_t page[]);
+ *  Called by the generated update functions before writing entries
+ *  'first'..'first'+'count'-1 of the "seqlock" page whose counter is entry
+ *  'entry_no' of MBOX_SEQ_PAGE.  Returns 1 (and remembers the new contents)
+ *  if any of them differs from what was last written, 0 if the write (and
+ *  the counter update) can be skipped.
+ */
+static int mbox_seq_changed(uint8_t entry_no, uint8_t first, uint8_t count, const uint8_t page[]) {
+  int changed = 0;
+  uint16_t bit;
+  if (first + count > MBOX_PAGE_SIZE) count = MBOX_PAGE_SIZE - first;
+  for (unsigned int jx = first; jx < (unsigned int)(first + count); jx++) {
+    bit = (uint16_t)(1 << jx);
+    if (!(mbox_seq_known[entry_no] & bit) || (mbox_seq_shadow[entry_no][jx] != page[jx])) {
+      mbox_seq_shadow[entry_no][jx] = page[jx];
+      mbox_seq_known[entry_no] |= bit;
+      changed = 1;
+    }
+  }
+  return changed;
+}
+
+/* static void mbox_seq_begin(uint8_t entry_no);
+ *  Called by the generated update functions before writing a "seqlock" page.
+ *  Makes the page's sequence counter (entry 'entry_no' of MBOX_SEQ_PAGE) odd.
+ */
+static void mbox_seq_begin(uint8_t entry_no) {
+  mbox_seq[entry_no]++;
+  mbox_set_page(MBOX_SEQ_PAGE);
+  mbox_write_entry(entry_no, mbox_seq[entry_no]);
+  return;
+}
+
+/* static void mbox_seq_end(uint8_t entry_no);
+ *  Called after the page is written.  Makes the counter even again (and
+ *  different from its value before mbox_seq_begin()).
+ */
+static void mbox_seq_end(uint8_t entry_no) {
+  mbox_seq[entry_no]++;
+  mbox_set_page(MBOX_SEQ_PAGE);
+  mbox_write_entry(entry_no, mbox_seq[entry_no]);
+  return;
+}
+#endif
+
+/* uint32_t mbox_doorbell_service(void);
+ *  Call from the main loop.  If the FPGA rang the doorbell (FPGA_INT), reads
+ *  the input pages flagged in the DOORBELL mask right away instead of waiting
+ *  for their periodic update.  The mask is cleared before the pages are read;
+ *  a bit the FPGA sets in between is lost, but the page is still read at its
+ *  next periodic update.  Returns the mask of pages read.
+ */
+uint32_t mbox_doorbell_service(void) {
+  uint32_t mask = 0;
+#ifdef MBOX_DOORBELL_PAGE
+  // DOORBELL is the 4-byte (MSB first) entry 0 of MBOX_DOORBELL_PAGE
+  uint8_t db[4];
+  const uint8_t zero[4] = {0, 0, 0, 0};
+  if (!marble_FPGAint_get_doorbell()) {
+    return 0;
+  }
+  marble_FPGAint_clear_doorbell();
+  if (!mbox_is_enabled) {
+    return 0;
+  }
+  mbox_read_entries(MBOX_DOORBELL_PAGE, 0, 4, db);
+  mbox_write_entries(MBOX_DOORBELL_PAGE, 0, 4, zero);
+  mask = ((uint32_t)db[0] << 24) | ((uint32_t)db[1] << 16) | ((uint32_t)db[2] << 8) | db[3];
+  mask &= MBOX_INPUT_PAGES;
+  for (uint8_t npage = 0; npage < 32; npage++) {
+    if (mask & (1UL << npage)) {
+      mailbox_update_input_page(npage);
+    }
+  }
+#endif
+  return mask;
+}
+
+/* void mbox_update(bool verbose);
+ *  Call every MBOX_FAST_PERIOD_MS.  Updates the "fast" rate class pages every
+ *  call and the others when their period has elapsed (or on request for "boot").
+ */
 void mbox_update(bool verbose)
 {
   if (!mbox_is_enabled) {
     return;
   }
+  uint32_t now = marble_get_tick();
+  unsigned int rates = MBOX_RATE_FAST;
+  if (now - mbox_medium_tick >= MBOX_MEDIUM_PERIOD_MS) {
+    rates |= MBOX_RATE_MEDIUM;
+    mbox_medium_tick = now;
+  }
+  if (now - mbox_slow_tick >= SPI_MAILBOX_PERIOD_MS) {
+    rates |= MBOX_RATE_SLOW;
+    mbox_slow_tick = now;
+  }
+  if (mbox_boot_pending) {
+    rates |= MBOX_RATE_BOOT;
+    mbox_boot_pending = 0;
+  }
   PM_UpdateTelem();
-  FPGAWD_Poll();
+  // One MAX6639/LM75 snapshot per "medium" period (pages 3 and 4 read it)
+  if (rates & MBOX_RATE_MEDIUM) {
+    I2C_PM_monitor_update();
+  }
+  // The watchdog timeout counts SPI_MAILBOX_PERIOD_MS periods
+  if (rates & MBOX_RATE_SLOW) {
+    FPGAWD_Poll();
+  }
   _UNUSED(verbose);
   update_count++;
-  // Note! Input function must come before output function or any input values will
+  // Note! Input functions must come before output functions or any input values will
   // be clobbered by their output value before reading.
-  mailbox_update_input();   // This function is auto-generated in src/mailbox_def.c
-  mailbox_update_output();  // This function is auto-generated in src/mailbox_def.c
+  // These functions are auto-generated in src/mailbox_def.c
+  if (rates & MBOX_RATE_FAST) mailbox_update_input_fast();
+  if (rates & MBOX_RATE_MEDIUM) mailbox_update_input_medium();
+  if (rates & MBOX_RATE_SLOW) mailbox_update_input_slow();
+  if (rates & MBOX_RATE_BOOT) mailbox_update_input_boot();
+  if (rates & MBOX_RATE_FAST) mailbox_update_output_fast();
+  if (rates & MBOX_RATE_MEDIUM) mailbox_update_output_medium();
+  if (rates & MBOX_RATE_SLOW) mailbox_update_output_slow();
+  if (rates & MBOX_RATE_BOOT) mailbox_update_output_boot();
   return;
 }
 
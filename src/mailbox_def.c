@@ -0,0 +1,749 @@
+/* File: src/mailbox_def.c
+ * Desc: Auto-generated by scripts/mkmbox.py
+ */
+
+/* ============= DO NOT EDIT THIS AUTO-GENERATED FILE DIRECTLY ============== */
+/* ============== Define mailbox structure in scripts/mbox.def ============== */
+
+#include "mailbox_def.h"
+
+uint32_t mailbox_get_hash(void) {
+  return 0x0011c41a;
+}
+
+void mailbox_update_output_fast(void) {
+  {
+    // Page 3
+    uint8_t page[MB3_SIZE];
+    int val;
+    val = mbox_get_update_count();
+    page[MB3_COUNT_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB3_COUNT_0] = (uint8_t)((val >> 0) & 0xff);
+    // Write page data
+    if (mbox_seq_changed(MB15_SEQ3, 0, 2, page)) {
+      mbox_seq_begin(MB15_SEQ3);
+      mbox_write_entries(3, 0, 2, page);
+      mbox_seq_end(MB15_SEQ3);
+    }
+  }
+  {
+    // Page 7
+    uint8_t page[MB7_SIZE];
+    FPGAWD_GetNonce(&page[MB7_WD_NONCE_7]);
+    // Write page data
+    if (mbox_seq_changed(MB15_SEQ7, 0, 8, page)) {
+      mbox_seq_begin(MB15_SEQ7);
+      mbox_write_page(7, MB7_SIZE, page);
+      mbox_seq_end(MB15_SEQ7);
+    }
+  }
+  {
+    // Page 9
+    uint8_t page[MB9_SIZE];
+    int val;
+    val = PM_GetTelem(VOUT_1V0);
+    page[MB9_VOUT_1V0_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB9_VOUT_1V0_0] = (uint8_t)((val >> 0) & 0xff);
+    val = PM_GetTelem(IOUT_1V0);
+    page[MB9_IOUT_1V0_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB9_IOUT_1V0_0] = (uint8_t)((val >> 0) & 0xff);
+    val = PM_GetTelem(VOUT_1V8);
+    page[MB9_VOUT_1V8_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB9_VOUT_1V8_0] = (uint8_t)((val >> 0) & 0xff);
+    val = PM_GetTelem(IOUT_1V8);
+    page[MB9_IOUT_1V8_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB9_IOUT_1V8_0] = (uint8_t)((val >> 0) & 0xff);
+    val = PM_GetTelem(VOUT_2V5);
+    page[MB9_VOUT_2V5_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB9_VOUT_2V5_0] = (uint8_t)((val >> 0) & 0xff);
+    val = PM_GetTelem(IOUT_2V5);
+    page[MB9_IOUT_2V5_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB9_IOUT_2V5_0] = (uint8_t)((val >> 0) & 0xff);
+    val = PM_GetTelem(VOUT_3V3);
+    page[MB9_VOUT_3V3_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB9_VOUT_3V3_0] = (uint8_t)((val >> 0) & 0xff);
+    val = PM_GetTelem(IOUT_3V3);
+    page[MB9_IOUT_3V3_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB9_IOUT_3V3_0] = (uint8_t)((val >> 0) & 0xff);
+    // Write page data
+    if (mbox_seq_changed(MB15_SEQ9, 0, 16, page)) {
+      mbox_seq_begin(MB15_SEQ9);
+      mbox_write_page(9, MB9_SIZE, page);
+      mbox_seq_end(MB15_SEQ9);
+    }
+  }
+  {
+    // Page 11
+    uint8_t page[MB11_SIZE];
+    page[MB11_PM_FAULT_FLAG] = ltm4673_fault_flag();
+    int val;
+    val = ltm4673_fault_count();
+    page[MB11_PM_FAULT_COUNT_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB11_PM_FAULT_COUNT_0] = (uint8_t)((val >> 0) & 0xff);
+    val = ltm4673_fault_status_word(0);
+    page[MB11_PM_STATUS_WORD0_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB11_PM_STATUS_WORD0_0] = (uint8_t)((val >> 0) & 0xff);
+    val = ltm4673_fault_status_word(1);
+    page[MB11_PM_STATUS_WORD1_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB11_PM_STATUS_WORD1_0] = (uint8_t)((val >> 0) & 0xff);
+    val = ltm4673_fault_status_word(2);
+    page[MB11_PM_STATUS_WORD2_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB11_PM_STATUS_WORD2_0] = (uint8_t)((val >> 0) & 0xff);
+    val = ltm4673_fault_status_word(3);
+    page[MB11_PM_STATUS_WORD3_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB11_PM_STATUS_WORD3_0] = (uint8_t)((val >> 0) & 0xff);
+    // Write page data
+    if (mbox_seq_changed(MB15_SEQ11, 2, 10, page)) {
+      mbox_seq_begin(MB15_SEQ11);
+      mbox_write_page(11, MB11_SIZE, page);
+      mbox_seq_end(MB15_SEQ11);
+    } else {
+      mbox_write_entries(11, 0, 1, page);
+    }
+  }
+  return;
+}
+
+void mailbox_update_input_fast(void) {
+  {
+    // Page 8
+    uint8_t page[MB8_SIZE];
+    mbox_read_page(8, MB8_SIZE, page);
+    FPGAWD_HandleHash(&page[MB8_WD_HASH_7]);
+  }
+  {
+    // Page 11
+    uint8_t page[MB11_SIZE];
+    mbox_read_page(11, MB11_SIZE, page);
+    ltm4673_fault_ack(page[MB11_PM_FAULT_FLAG]);
+  }
+  {
+    // Page 16
+    uint8_t page[MB16_SIZE];
+    mbox_read_page(16, MB16_SIZE, page);
+    mbox_rpc_service(page[MB16_RPC_REQ_SEQ]);
+  }
+  {
+    // Page 20
+    uint8_t page[MB20_SIZE];
+    mbox_read_page(20, MB20_SIZE, page);
+    int val;
+    val = (int)((page[MB20_FIFO_TAIL_1] << 8) | (page[MB20_FIFO_TAIL_0] << 0));
+    mbox_fifo_update((uint16_t)val);
+  }
+  return;
+}
+
+void mailbox_update_output_medium(void) {
+  {
+    // Page 3
+    uint8_t page[MB3_SIZE];
+    page[MB3_WD_STATE] = (int)FPGAWD_GetState();
+    int val;
+    val = LM75_get_cached_temperature(LM75_0);
+    page[MB3_LM75_0_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB3_LM75_0_0] = (uint8_t)((val >> 0) & 0xff);
+    val = LM75_get_cached_temperature(LM75_1);
+    page[MB3_LM75_1_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB3_LM75_1_0] = (uint8_t)((val >> 0) & 0xff);
+    page[MB3_FMC_ST] = marble_FMC_status();
+    page[MB3_PWR_ST] = marble_PWR_status();
+    page[MB3_MGTMUX_ST] = marble_MGTMUX_status();
+    // Write page data
+    if (mbox_seq_changed(MB15_SEQ3, 2, 1, page) | mbox_seq_changed(MB15_SEQ3, 4, 7, page)) {
+      mbox_seq_begin(MB15_SEQ3);
+      mbox_write_entries(3, 2, 1, page);
+      mbox_write_entries(3, 4, 7, page);
+      mbox_seq_end(MB15_SEQ3);
+    }
+  }
+  {
+    // Page 4
+    uint8_t page[MB4_SIZE];
+    page[MB4_MAX_T1_HI] = max6639_snapshot_reg(MAX6639_TEMP_CH1);
+    page[MB4_MAX_T1_LO] = max6639_snapshot_reg(MAX6639_TEMP_EXT_CH1);
+    page[MB4_MAX_T2_HI] = max6639_snapshot_reg(MAX6639_TEMP_CH2);
+    page[MB4_MAX_T2_LO] = max6639_snapshot_reg(MAX6639_TEMP_EXT_CH2);
+    page[MB4_MAX_F1_TACH] = max6639_snapshot_reg(MAX6639_FAN1_TACH_CNT);
+    page[MB4_MAX_F2_TACH] = max6639_snapshot_reg(MAX6639_FAN2_TACH_CNT);
+    page[MB4_MAX_F1_DUTY] = max6639_snapshot_reg(MAX6639_FAN1_DUTY);
+    page[MB4_MAX_F2_DUTY] = max6639_snapshot_reg(MAX6639_FAN2_DUTY);
+    int val;
+    val = mbox_get_update_count();
+    page[MB4_COUNT_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB4_COUNT_0] = (uint8_t)((val >> 0) & 0xff);
+    // Write page data
+    if (mbox_seq_changed(MB15_SEQ4, 0, 8, page) | mbox_seq_changed(MB15_SEQ4, 10, 2, page)) {
+      mbox_seq_begin(MB15_SEQ4);
+      mbox_write_entries(4, 0, 8, page);
+      mbox_write_entries(4, 10, 2, page);
+      mbox_seq_end(MB15_SEQ4);
+    }
+  }
+  {
+    // Page 24
+    uint8_t page[MB24_SIZE];
+    page[MB24_BUSPROF_SEL] = busprof_mbox_selected();
+    page[MB24_BUSPROF_ENTRIES] = busprof_count();
+    page[MB24_BUSPROF_BUS] = busprof_mbox_bus();
+    page[MB24_BUSPROF_ADDR] = busprof_mbox_addr();
+    int val;
+    val = busprof_mbox_errors();
+    page[MB24_BUSPROF_ERRORS_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB24_BUSPROF_ERRORS_0] = (uint8_t)((val >> 0) & 0xff);
+    val = busprof_mbox_timeouts();
+    page[MB24_BUSPROF_TIMEOUTS_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB24_BUSPROF_TIMEOUTS_0] = (uint8_t)((val >> 0) & 0xff);
+    val = busprof_mbox_max_us();
+    page[MB24_BUSPROF_MAX_US_3] = (uint8_t)((val >> 24) & 0xff);
+    page[MB24_BUSPROF_MAX_US_2] = (uint8_t)((val >> 16) & 0xff);
+    page[MB24_BUSPROF_MAX_US_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB24_BUSPROF_MAX_US_0] = (uint8_t)((val >> 0) & 0xff);
+    val = busprof_elapsed_ms();
+    page[MB24_BUSPROF_ELAPSED_MS_3] = (uint8_t)((val >> 24) & 0xff);
+    page[MB24_BUSPROF_ELAPSED_MS_2] = (uint8_t)((val >> 16) & 0xff);
+    page[MB24_BUSPROF_ELAPSED_MS_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB24_BUSPROF_ELAPSED_MS_0] = (uint8_t)((val >> 0) & 0xff);
+    // Write page data
+    if (mbox_seq_changed(MB15_SEQ24, 1, 15, page)) {
+      mbox_seq_begin(MB15_SEQ24);
+      mbox_write_page(24, MB24_SIZE, page);
+      mbox_seq_end(MB15_SEQ24);
+    } else {
+      mbox_write_entries(24, 0, 1, page);
+    }
+  }
+  {
+    // Page 25
+    uint8_t page[MB25_SIZE];
+    int val;
+    val = busprof_mbox_count();
+    page[MB25_BUSPROF_COUNT_3] = (uint8_t)((val >> 24) & 0xff);
+    page[MB25_BUSPROF_COUNT_2] = (uint8_t)((val >> 16) & 0xff);
+    page[MB25_BUSPROF_COUNT_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB25_BUSPROF_COUNT_0] = (uint8_t)((val >> 0) & 0xff);
+    val = busprof_mbox_bytes();
+    page[MB25_BUSPROF_BYTES_3] = (uint8_t)((val >> 24) & 0xff);
+    page[MB25_BUSPROF_BYTES_2] = (uint8_t)((val >> 16) & 0xff);
+    page[MB25_BUSPROF_BYTES_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB25_BUSPROF_BYTES_0] = (uint8_t)((val >> 0) & 0xff);
+    val = busprof_mbox_us();
+    page[MB25_BUSPROF_US_3] = (uint8_t)((val >> 24) & 0xff);
+    page[MB25_BUSPROF_US_2] = (uint8_t)((val >> 16) & 0xff);
+    page[MB25_BUSPROF_US_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB25_BUSPROF_US_0] = (uint8_t)((val >> 0) & 0xff);
+    // Write page data
+    if (mbox_seq_changed(MB15_SEQ25, 0, 12, page)) {
+      mbox_seq_begin(MB15_SEQ25);
+      mbox_write_page(25, MB25_SIZE, page);
+      mbox_seq_end(MB15_SEQ25);
+    }
+  }
+  {
+    // Page 26
+    uint8_t page[MB26_SIZE];
+    int val;
+    val = fanctl_get_fpga_temp();
+    page[MB26_FAN_FPGA_TEMP_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB26_FAN_FPGA_TEMP_0] = (uint8_t)((val >> 0) & 0xff);
+    page[MB26_FAN_CTL_STATE] = fanctl_mbox_state();
+    page[MB26_FAN_CTL_SOURCE] = fanctl_mbox_source();
+    page[MB26_FAN_CTL_SETPOINT] = fanctl_mbox_setpoint();
+    val = fanctl_mbox_temp();
+    page[MB26_FAN_CTL_TEMP_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB26_FAN_CTL_TEMP_0] = (uint8_t)((val >> 0) & 0xff);
+    page[MB26_FAN_CTL_DUTY] = fanctl_mbox_duty();
+    val = fanctl_mbox_integ();
+    page[MB26_FAN_CTL_INTEG_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB26_FAN_CTL_INTEG_0] = (uint8_t)((val >> 0) & 0xff);
+    // Write page data
+    if (mbox_seq_changed(MB15_SEQ26, 2, 8, page)) {
+      mbox_seq_begin(MB15_SEQ26);
+      mbox_write_page(26, MB26_SIZE, page);
+      mbox_seq_end(MB15_SEQ26);
+    } else {
+      mbox_write_entries(26, 0, 2, page);
+    }
+  }
+  {
+    // Page 27
+    uint8_t page[MB27_SIZE];
+    page[MB27_FMC_MON_STATUS] = fmc_monitor_status();
+    int val;
+    val = fmc_monitor_current_mA(FMC_MONITOR_FMC1);
+    page[MB27_FMC1_CURRENT_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB27_FMC1_CURRENT_0] = (uint8_t)((val >> 0) & 0xff);
+    val = fmc_monitor_current_mA(FMC_MONITOR_FMC2);
+    page[MB27_FMC2_CURRENT_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB27_FMC2_CURRENT_0] = (uint8_t)((val >> 0) & 0xff);
+    val = fmc_monitor_shunt(FMC_MONITOR_FMC1);
+    page[MB27_FMC1_SHUNT_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB27_FMC1_SHUNT_0] = (uint8_t)((val >> 0) & 0xff);
+    val = fmc_monitor_shunt(FMC_MONITOR_FMC2);
+    page[MB27_FMC2_SHUNT_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB27_FMC2_SHUNT_0] = (uint8_t)((val >> 0) & 0xff);
+    // Write page data
+    if (mbox_seq_changed(MB15_SEQ27, 0, 9, page)) {
+      mbox_seq_begin(MB15_SEQ27);
+      mbox_write_page(27, MB27_SIZE, page);
+      mbox_seq_end(MB15_SEQ27);
+    }
+  }
+  return;
+}
+
+void mailbox_update_input_medium(void) {
+  {
+    // Page 24
+    uint8_t page[MB24_SIZE];
+    mbox_read_page(24, MB24_SIZE, page);
+    busprof_mbox_select(page[MB24_BUSPROF_SEL]);
+  }
+  {
+    // Page 26
+    uint8_t page[MB26_SIZE];
+    mbox_read_page(26, MB26_SIZE, page);
+    int val;
+    val = (int)((page[MB26_FAN_FPGA_TEMP_1] << 8) | (page[MB26_FAN_FPGA_TEMP_0] << 0));
+    fanctl_set_fpga_temp(val);
+  }
+  return;
+}
+
+void mailbox_update_output_slow(void) {
+  {
+    // Page 5
+    uint8_t page[MB5_SIZE];
+    page[MB5_I2C_BUS_STATUS] = (uint8_t)getI2CBusStatus();
+    // Write page data
+    mbox_write_page(5, MB5_SIZE, page);
+  }
+  {
+    // Page 6
+    uint8_t page[MB6_SIZE];
+    page[MB6_FSYNTH_I2C_ADDR] = (uint8_t)fsynthGetAddr();
+    page[MB6_FSYNTH_CONFIG] = (uint8_t)fsynthGetConfig();
+    int val;
+    val = fsynthGetFreq();
+    page[MB6_FSYNTH_FREQ_3] = (uint8_t)((val >> 24) & 0xff);
+    page[MB6_FSYNTH_FREQ_2] = (uint8_t)((val >> 16) & 0xff);
+    page[MB6_FSYNTH_FREQ_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB6_FSYNTH_FREQ_0] = (uint8_t)((val >> 0) & 0xff);
+    // Write page data
+    if (mbox_seq_changed(MB15_SEQ6, 0, 6, page)) {
+      mbox_seq_begin(MB15_SEQ6);
+      mbox_write_page(6, MB6_SIZE, page);
+      mbox_seq_end(MB15_SEQ6);
+    }
+  }
+  {
+    // Page 12
+    uint8_t page[MB12_SIZE];
+    page[MB12_PMLOG_SEL] = pmlog_mbox_selected();
+    page[MB12_PMLOG_COUNT] = pmlog_count();
+    page[MB12_PMLOG_FREE] = pmlog_free_slots();
+    int val;
+    val = pmlog_mbox_seq();
+    page[MB12_PMLOG_SEQ_3] = (uint8_t)((val >> 24) & 0xff);
+    page[MB12_PMLOG_SEQ_2] = (uint8_t)((val >> 16) & 0xff);
+    page[MB12_PMLOG_SEQ_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB12_PMLOG_SEQ_0] = (uint8_t)((val >> 0) & 0xff);
+    val = pmlog_mbox_tick();
+    page[MB12_PMLOG_TICK_3] = (uint8_t)((val >> 24) & 0xff);
+    page[MB12_PMLOG_TICK_2] = (uint8_t)((val >> 16) & 0xff);
+    page[MB12_PMLOG_TICK_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB12_PMLOG_TICK_0] = (uint8_t)((val >> 0) & 0xff);
+    val = pmlog_mbox_telem(VIN);
+    page[MB12_PMLOG_VIN_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB12_PMLOG_VIN_0] = (uint8_t)((val >> 0) & 0xff);
+    val = pmlog_mbox_telem(IIN);
+    page[MB12_PMLOG_IIN_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB12_PMLOG_IIN_0] = (uint8_t)((val >> 0) & 0xff);
+    // Write page data
+    if (mbox_seq_changed(MB15_SEQ12, 1, 2, page) | mbox_seq_changed(MB15_SEQ12, 4, 12, page)) {
+      mbox_seq_begin(MB15_SEQ12);
+      mbox_write_page(12, MB12_SIZE, page);
+      mbox_seq_end(MB15_SEQ12);
+    } else {
+      mbox_write_entries(12, 0, 1, page);
+    }
+  }
+  {
+    // Page 13
+    uint8_t page[MB13_SIZE];
+    int val;
+    val = pmlog_mbox_telem(VOUT_1V0);
+    page[MB13_PMLOG_VOUT_1V0_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB13_PMLOG_VOUT_1V0_0] = (uint8_t)((val >> 0) & 0xff);
+    val = pmlog_mbox_telem(IOUT_1V0);
+    page[MB13_PMLOG_IOUT_1V0_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB13_PMLOG_IOUT_1V0_0] = (uint8_t)((val >> 0) & 0xff);
+    val = pmlog_mbox_telem(VOUT_1V8);
+    page[MB13_PMLOG_VOUT_1V8_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB13_PMLOG_VOUT_1V8_0] = (uint8_t)((val >> 0) & 0xff);
+    val = pmlog_mbox_telem(IOUT_1V8);
+    page[MB13_PMLOG_IOUT_1V8_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB13_PMLOG_IOUT_1V8_0] = (uint8_t)((val >> 0) & 0xff);
+    val = pmlog_mbox_telem(VOUT_2V5);
+    page[MB13_PMLOG_VOUT_2V5_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB13_PMLOG_VOUT_2V5_0] = (uint8_t)((val >> 0) & 0xff);
+    val = pmlog_mbox_telem(IOUT_2V5);
+    page[MB13_PMLOG_IOUT_2V5_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB13_PMLOG_IOUT_2V5_0] = (uint8_t)((val >> 0) & 0xff);
+    val = pmlog_mbox_telem(VOUT_3V3);
+    page[MB13_PMLOG_VOUT_3V3_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB13_PMLOG_VOUT_3V3_0] = (uint8_t)((val >> 0) & 0xff);
+    val = pmlog_mbox_telem(IOUT_3V3);
+    page[MB13_PMLOG_IOUT_3V3_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB13_PMLOG_IOUT_3V3_0] = (uint8_t)((val >> 0) & 0xff);
+    // Write page data
+    if (mbox_seq_changed(MB15_SEQ13, 0, 16, page)) {
+      mbox_seq_begin(MB15_SEQ13);
+      mbox_write_page(13, MB13_SIZE, page);
+      mbox_seq_end(MB15_SEQ13);
+    }
+  }
+  return;
+}
+
+void mailbox_update_input_slow(void) {
+  {
+    // Page 2
+    uint8_t page[MB2_SIZE];
+    mbox_read_page(2, MB2_SIZE, page);
+    marble_MGTMUX_config(page[MB2_FMC_MGT_CTL], 0, 0);
+    mbox_write_entry(MB2_FMC_MGT_CTL, page[MB2_FMC_MGT_CTL] & 0x55);
+  }
+  {
+    // Page 5
+    uint8_t page[MB5_SIZE];
+    mbox_read_page(5, MB5_SIZE, page);
+    mbox_handleI2CBusStatusMsg(page[MB5_I2C_BUS_STATUS]);
+  }
+  if (system_pmod_leds_enabled()) {
+    // Page 10
+    uint8_t page[MB10_SIZE];
+    mbox_read_page(10, MB10_SIZE, page);
+    system_handle_pmod_led(page[MB10_PMOD_LED_0], 0);
+    system_handle_pmod_led(page[MB10_PMOD_LED_1], 1);
+    system_handle_pmod_led(page[MB10_PMOD_LED_2], 2);
+    system_handle_pmod_led(page[MB10_PMOD_LED_3], 3);
+    system_handle_pmod_led(page[MB10_PMOD_LED_4], 4);
+    system_handle_pmod_led(page[MB10_PMOD_LED_5], 5);
+    system_handle_pmod_led(page[MB10_PMOD_LED_6], 6);
+    system_handle_pmod_led(page[MB10_PMOD_LED_7], 7);
+  }
+  {
+    // Page 12
+    uint8_t page[MB12_SIZE];
+    mbox_read_page(12, MB12_SIZE, page);
+    pmlog_mbox_select(page[MB12_PMLOG_SEL]);
+  }
+  return;
+}
+
+void mailbox_update_output_boot(void) {
+  {
+    // Page 0
+    uint8_t page[MB0_SIZE];
+    int val;
+    val = 0xA15B;
+    page[MB0_MAGIC_NUMBER_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB0_MAGIC_NUMBER_0] = (uint8_t)((val >> 0) & 0xff);
+    page[MB0_VERSION_MAJOR] = 1;
+    page[MB0_VERSION_MINOR] = 0;
+    // Write page data
+    mbox_write_page(0, MB0_SIZE, page);
+  }
+  {
+    // Page 3
+    uint8_t page[MB3_SIZE];
+    int val;
+    val = GIT_REV_32BIT;
+    page[MB3_GIT32_3] = (uint8_t)((val >> 24) & 0xff);
+    page[MB3_GIT32_2] = (uint8_t)((val >> 16) & 0xff);
+    page[MB3_GIT32_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB3_GIT32_0] = (uint8_t)((val >> 0) & 0xff);
+    // Write page data
+    if (mbox_seq_changed(MB15_SEQ3, 12, 4, page)) {
+      mbox_seq_begin(MB15_SEQ3);
+      mbox_write_entries(3, 12, 4, page);
+      mbox_seq_end(MB15_SEQ3);
+    }
+  }
+  {
+    // Page 4
+    uint8_t page[MB4_SIZE];
+    page[MB4_PCB_REV] = marble_get_board_id();
+    int val;
+    val = mailbox_get_hash();
+    page[MB4_HASH_3] = (uint8_t)((val >> 24) & 0xff);
+    page[MB4_HASH_2] = (uint8_t)((val >> 16) & 0xff);
+    page[MB4_HASH_1] = (uint8_t)((val >> 8) & 0xff);
+    page[MB4_HASH_0] = (uint8_t)((val >> 0) & 0xff);
+    // Write page data
+    if (mbox_seq_changed(MB15_SEQ4, 8, 1, page) | mbox_seq_changed(MB15_SEQ4, 12, 4, page)) {
+      mbox_seq_begin(MB15_SEQ4);
+      mbox_write_entries(4, 8, 1, page);
+      mbox_write_entries(4, 12, 4, page);
+      mbox_seq_end(MB15_SEQ4);
+    }
+  }
+  return;
+}
+
+void mailbox_update_input_boot(void) {
+  return;
+}
+
+int mailbox_update_input_page(uint8_t npage) {
+  if (npage == 2) {
+    // Page 2
+    uint8_t page[MB2_SIZE];
+    mbox_read_page(2, MB2_SIZE, page);
+    marble_MGTMUX_config(page[MB2_FMC_MGT_CTL], 0, 0);
+    mbox_write_entry(MB2_FMC_MGT_CTL, page[MB2_FMC_MGT_CTL] & 0x55);
+    return 0;
+  }
+  if (npage == 5) {
+    // Page 5
+    uint8_t page[MB5_SIZE];
+    mbox_read_page(5, MB5_SIZE, page);
+    mbox_handleI2CBusStatusMsg(page[MB5_I2C_BUS_STATUS]);
+    return 0;
+  }
+  if (npage == 8) {
+    // Page 8
+    uint8_t page[MB8_SIZE];
+    mbox_read_page(8, MB8_SIZE, page);
+    FPGAWD_HandleHash(&page[MB8_WD_HASH_7]);
+    return 0;
+  }
+  if ((npage == 10) && (system_pmod_leds_enabled())) {
+    // Page 10
+    uint8_t page[MB10_SIZE];
+    mbox_read_page(10, MB10_SIZE, page);
+    system_handle_pmod_led(page[MB10_PMOD_LED_0], 0);
+    system_handle_pmod_led(page[MB10_PMOD_LED_1], 1);
+    system_handle_pmod_led(page[MB10_PMOD_LED_2], 2);
+    system_handle_pmod_led(page[MB10_PMOD_LED_3], 3);
+    system_handle_pmod_led(page[MB10_PMOD_LED_4], 4);
+    system_handle_pmod_led(page[MB10_PMOD_LED_5], 5);
+    system_handle_pmod_led(page[MB10_PMOD_LED_6], 6);
+    system_handle_pmod_led(page[MB10_PMOD_LED_7], 7);
+    return 0;
+  }
+  if (npage == 11) {
+    // Page 11
+    uint8_t page[MB11_SIZE];
+    mbox_read_page(11, MB11_SIZE, page);
+    ltm4673_fault_ack(page[MB11_PM_FAULT_FLAG]);
+    return 0;
+  }
+  if (npage == 12) {
+    // Page 12
+    uint8_t page[MB12_SIZE];
+    mbox_read_page(12, MB12_SIZE, page);
+    pmlog_mbox_select(page[MB12_PMLOG_SEL]);
+    return 0;
+  }
+  if (npage == 16) {
+    // Page 16
+    uint8_t page[MB16_SIZE];
+    mbox_read_page(16, MB16_SIZE, page);
+    mbox_rpc_service(page[MB16_RPC_REQ_SEQ]);
+    return 0;
+  }
+  if (npage == 20) {
+    // Page 20
+    uint8_t page[MB20_SIZE];
+    mbox_read_page(20, MB20_SIZE, page);
+    int val;
+    val = (int)((page[MB20_FIFO_TAIL_1] << 8) | (page[MB20_FIFO_TAIL_0] << 0));
+    mbox_fifo_update((uint16_t)val);
+    return 0;
+  }
+  if (npage == 24) {
+    // Page 24
+    uint8_t page[MB24_SIZE];
+    mbox_read_page(24, MB24_SIZE, page);
+    busprof_mbox_select(page[MB24_BUSPROF_SEL]);
+    return 0;
+  }
+  if (npage == 26) {
+    // Page 26
+    uint8_t page[MB26_SIZE];
+    mbox_read_page(26, MB26_SIZE, page);
+    int val;
+    val = (int)((page[MB26_FAN_FPGA_TEMP_1] << 8) | (page[MB26_FAN_FPGA_TEMP_0] << 0));
+    fanctl_set_fpga_temp(val);
+    return 0;
+  }
+  return -1;
+}
+
+void mailbox_read_print_all(void) {
+  {
+    // Page 0
+    uint8_t page[MB0_SIZE];
+    mbox_read_page(0, MB0_SIZE, page);
+    MBOX_PRINT_PAGE(0);
+  }
+  {
+    // Page 2
+    uint8_t page[MB2_SIZE];
+    mbox_read_page(2, MB2_SIZE, page);
+    MBOX_PRINT_PAGE(2);
+  }
+  {
+    // Page 3
+    uint8_t page[MB3_SIZE];
+    mbox_read_page(3, MB3_SIZE, page);
+    MBOX_PRINT_PAGE(3);
+  }
+  {
+    // Page 4
+    uint8_t page[MB4_SIZE];
+    mbox_read_page(4, MB4_SIZE, page);
+    MBOX_PRINT_PAGE(4);
+  }
+  {
+    // Page 5
+    uint8_t page[MB5_SIZE];
+    mbox_read_page(5, MB5_SIZE, page);
+    MBOX_PRINT_PAGE(5);
+  }
+  {
+    // Page 6
+    uint8_t page[MB6_SIZE];
+    mbox_read_page(6, MB6_SIZE, page);
+    MBOX_PRINT_PAGE(6);
+  }
+  {
+    // Page 7
+    uint8_t page[MB7_SIZE];
+    mbox_read_page(7, MB7_SIZE, page);
+    MBOX_PRINT_PAGE(7);
+  }
+  {
+    // Page 8
+    uint8_t page[MB8_SIZE];
+    mbox_read_page(8, MB8_SIZE, page);
+    MBOX_PRINT_PAGE(8);
+  }
+  {
+    // Page 9
+    uint8_t page[MB9_SIZE];
+    mbox_read_page(9, MB9_SIZE, page);
+    MBOX_PRINT_PAGE(9);
+  }
+  {
+    // Page 10
+    uint8_t page[MB10_SIZE];
+    mbox_read_page(10, MB10_SIZE, page);
+    MBOX_PRINT_PAGE(10);
+  }
+  {
+    // Page 11
+    uint8_t page[MB11_SIZE];
+    mbox_read_page(11, MB11_SIZE, page);
+    MBOX_PRINT_PAGE(11);
+  }
+  {
+    // Page 12
+    uint8_t page[MB12_SIZE];
+    mbox_read_page(12, MB12_SIZE, page);
+    MBOX_PRINT_PAGE(12);
+  }
+  {
+    // Page 13
+    uint8_t page[MB13_SIZE];
+    mbox_read_page(13, MB13_SIZE, page);
+    MBOX_PRINT_PAGE(13);
+  }
+  {
+    // Page 16
+    uint8_t page[MB16_SIZE];
+    mbox_read_page(16, MB16_SIZE, page);
+    MBOX_PRINT_PAGE(16);
+  }
+  {
+    // Page 17
+    uint8_t page[MB17_SIZE];
+    mbox_read_page(17, MB17_SIZE, page);
+    MBOX_PRINT_PAGE(17);
+  }
+  {
+    // Page 18
+    uint8_t page[MB18_SIZE];
+    mbox_read_page(18, MB18_SIZE, page);
+    MBOX_PRINT_PAGE(18);
+  }
+  {
+    // Page 19
+    uint8_t page[MB19_SIZE];
+    mbox_read_page(19, MB19_SIZE, page);
+    MBOX_PRINT_PAGE(19);
+  }
+  {
+    // Page 20
+    uint8_t page[MB20_SIZE];
+    mbox_read_page(20, MB20_SIZE, page);
+    MBOX_PRINT_PAGE(20);
+  }
+  {
+    // Page 21
+    uint8_t page[MB21_SIZE];
+    mbox_read_page(21, MB21_SIZE, page);
+    MBOX_PRINT_PAGE(21);
+  }
+  {
+    // Page 22
+    uint8_t page[MB22_SIZE];
+    mbox_read_page(22, MB22_SIZE, page);
+    MBOX_PRINT_PAGE(22);
+  }
+  {
+    // Page 23
+    uint8_t page[MB23_SIZE];
+    mbox_read_page(23, MB23_SIZE, page);
+    MBOX_PRINT_PAGE(23);
+  }
+  {
+    // Page 24
+    uint8_t page[MB24_SIZE];
+    mbox_read_page(24, MB24_SIZE, page);
+    MBOX_PRINT_PAGE(24);
+  }
+  {
+    // Page 25
+    uint8_t page[MB25_SIZE];
+    mbox_read_page(25, MB25_SIZE, page);
+    MBOX_PRINT_PAGE(25);
+  }
+  {
+    // Page 26
+    uint8_t page[MB26_SIZE];
+    mbox_read_page(26, MB26_SIZE, page);
+    MBOX_PRINT_PAGE(26);
+  }
+  {
+    // Page 27
+    uint8_t page[MB27_SIZE];
+    mbox_read_page(27, MB27_SIZE, page);
+    MBOX_PRINT_PAGE(27);
+  }
+  {
+    // Page 15
+    uint8_t page[MB15_SIZE];
+    mbox_read_page(15, MB15_SIZE, page);
+    MBOX_PRINT_PAGE(15);
+  }
+  {
+    // Page 14
+    uint8_t page[MB14_SIZE];
+    mbox_read_page(14, MB14_SIZE, page);
+    MBOX_PRINT_PAGE(14);
+  }
+  return;
+}
@@ -2,10 +2,13 @@
 #include <stdio.h>
 #include "marble_api.h"
 #include "uart_fifo.h"
+#include "console.h"
 #include "i2c_pm.h"
 #include "i2c_fpga.h"
 #include "ltm4673.h"
 #include "watchdog.h"
+#include "prof.h"
+#include "event.h"
 
 #define LED_SNAKE
 
@@ -55,14 +58,25 @@ int main(void) {
    // Send demo string over UART at 115200 BAUD
    marble_UART_send(DEMO_STRING, strlen(DEMO_STRING));
 
+   uint32_t t_loop, t0;
+   int board_exit;
    while (1) {
+      t_loop = marble_get_cycles();
       // Service system (application logic)
+      t0 = t_loop;
       system_service();
+      prof_end(PROF_SYSTEM_SERVICE, t0);
       // Service platform-specific functionality
-      if (board_service()) {
+      t0 = marble_get_cycles();
+      board_exit = board_service();
+      prof_end(PROF_BOARD_SERVICE, t0);
+      prof_end(PROF_MAIN_LOOP, t_loop);
+      if (board_exit) {
         // This exit is only used in simulation
         break;
       }
+      // Sleep until the next interrupt if there is nothing left to do
+      event_wait();
    }
    cleanup(); // Only used for simulation
 }
@@ -71,6 +85,12 @@ int main(void) {
 int __io_putchar(int ch);
 int __io_putchar(int ch)
 {
+  // Output of sequence-tagged console commands is replaced by a compact ack;
+  // that of remotely run commands is returned to the caller
+  if (console_quiet()) {
+    console_capture(ch);
+    return ch;
+  }
   marble_UART_send((const char *)&ch, 1);
   return ch;
 }
@@ -0,0 +1,120 @@
+/*
+ * File: mbox_fifo.c
+ * Desc: Mailbox-mapped FIFO for event records and telemetry history.
+ *       See mbox_fifo.h.
+ */
+
+#include <string.h>
+#include "mbox_fifo.h"
+#include "marble_api.h"
+#include "mailbox.h"
+#include "uart_frame.h"
+
+#define RING_MASK                  (MBOX_FIFO_RING_SIZE - 1)
+
+static uint8_t _ring[MBOX_FIFO_RING_SIZE];
+// Stream offsets (bytes since boot); _tail is always at a record boundary
+static uint16_t _head = 0;
+static uint16_t _tail = 0;
+static uint16_t _dropped = 0;
+// Window currently published in the mailbox
+static uint16_t _win_start = 0;
+static uint8_t _win_len = 0;
+static uint16_t _pub_head = 0;
+static uint16_t _pub_dropped = 0;
+static uint8_t _published = 0;
+static uint32_t _telem_tick = 0;
+
+static uint8_t ring_peek(uint16_t offset);
+static void mbox_fifo_publish(void);
+
+static uint8_t ring_peek(uint16_t offset) {
+  return _ring[offset & RING_MASK];
+}
+
+int mbox_fifo_put(uint8_t type, const uint8_t *data, int len) {
+  if ((len < 0) || (len > MBOX_FIFO_MAX_PAYLOAD)) {
+    return -1;
+  }
+  uint16_t need = (uint16_t)(MBOX_FIFO_REC_HEADER + len);
+  // Make room by dropping whole records from the old end
+  while ((uint16_t)(MBOX_FIFO_RING_SIZE - (uint16_t)(_head - _tail)) < need) {
+    _tail += MBOX_FIFO_REC_HEADER + ring_peek(_tail + 1);
+    _dropped++;
+  }
+  _ring[_head++ & RING_MASK] = type;
+  _ring[_head++ & RING_MASK] = (uint8_t)len;
+  for (int n = 0; n < len; n++) {
+    _ring[_head++ & RING_MASK] = data[n];
+  }
+  return 0;
+}
+
+/*
+ * static void mbox_fifo_publish(void);
+ *  Fill the window with as many whole records from _tail as fit and write
+ *  it, then the header, if either changed since the last call.
+ */
+static void mbox_fifo_publish(void) {
+  uint8_t win[MBOX_FIFO_WIN_SIZE];
+  uint8_t hdr[MBOX_PAGE_SIZE];
+  uint16_t used = (uint16_t)(_head - _tail);
+  uint16_t len = 0;
+  uint16_t rec_len;
+  while (len < used) {
+    rec_len = MBOX_FIFO_REC_HEADER + ring_peek(_tail + len + 1);
+    if (len + rec_len > MBOX_FIFO_WIN_SIZE) {
+      break;
+    }
+    len += rec_len;
+  }
+  if (_published && (_win_start == _tail) && (_win_len == len)) {
+    if ((_pub_head == _head) && (_pub_dropped == _dropped)) {
+      return;
+    }
+    // Same window; only HEAD and/or DROPPED moved
+  } else {
+    memset(win, 0, sizeof(win));
+    for (uint16_t n = 0; n < len; n++) {
+      win[n] = ring_peek(_tail + n);
+    }
+    // Window first, header last
+    for (int npage = 0; npage < MBOX_FIFO_WIN_PAGES; npage++) {
+      mbox_write_page(MBOX_FIFO_WIN_PAGE + npage, MBOX_PAGE_SIZE, win + npage*MBOX_PAGE_SIZE);
+    }
+  }
+  _win_start = _tail;
+  _win_len = (uint8_t)len;
+  _pub_head = _head;
+  _pub_dropped = _dropped;
+  _published = 1;
+  hdr[MBOX_FIFO_HEAD] = (uint8_t)(_pub_head >> 8);
+  hdr[MBOX_FIFO_HEAD + 1] = (uint8_t)_pub_head;
+  hdr[MBOX_FIFO_WIN_START] = (uint8_t)(_win_start >> 8);
+  hdr[MBOX_FIFO_WIN_START + 1] = (uint8_t)_win_start;
+  hdr[MBOX_FIFO_WIN_LEN] = _win_len;
+  hdr[MBOX_FIFO_DROPPED] = (uint8_t)(_pub_dropped >> 8);
+  hdr[MBOX_FIFO_DROPPED + 1] = (uint8_t)_pub_dropped;
+  mbox_write_entries(MBOX_FIFO_PAGE, MBOX_FIFO_HEAD, MBOX_FIFO_HEADER_END - MBOX_FIFO_HEAD, hdr);
+  return;
+}
+
+void mbox_fifo_update(uint16_t tail) {
+  uint8_t rec[4 + FRAME_TELEM_SIZE];
+  uint32_t now = marble_get_tick();
+  if (_published && (_win_len > 0) && (tail == (uint16_t)(_win_start + _win_len))
+      && (_win_start == _tail)) {
+    // The reader consumed the published window
+    _tail = tail;
+  }
+  if ((uint32_t)(now - _telem_tick) >= MBOX_FIFO_TELEM_PERIOD_MS) {
+    _telem_tick = now;
+    rec[0] = (uint8_t)(now & 0xff);
+    rec[1] = (uint8_t)((now >> 8) & 0xff);
+    rec[2] = (uint8_t)((now >> 16) & 0xff);
+    rec[3] = (uint8_t)((now >> 24) & 0xff);
+    mbox_fifo_put(MBOX_FIFO_REC_TELEM, rec, 4 + frame_telem(rec + 4));
+  }
+  mbox_fifo_publish();
+  return;
+}
@@ -0,0 +1,44 @@
+/*
+ * File: mbox_rpc.c
+ * Desc: Request/response channel in the FPGA mailbox.  See mbox_rpc.h.
+ */
+
+#include <string.h>
+#include "mbox_rpc.h"
+#include "marble_api.h"
+#include "mailbox.h"
+#include "uart_frame.h"
+
+int mbox_rpc_service(uint8_t seq) {
+  uint8_t req[2*MBOX_PAGE_SIZE];
+  uint8_t rsp[MBOX_RPC_HEADER_SIZE + FRAME_MAX_PAYLOAD];
+  int rsp_len = 0;
+  frame_status_t status;
+  memset(rsp, 0, sizeof(rsp));
+  mbox_read_entries(MBOX_RPC_RSP_PAGE, MBOX_RPC_SEQ, 1, rsp);
+  if (rsp[MBOX_RPC_SEQ] == seq) {
+    // Nothing pending
+    return 0;
+  }
+  mbox_read_page(MBOX_RPC_REQ_PAGE, MBOX_PAGE_SIZE, req);
+  mbox_read_page(MBOX_RPC_REQ_PAGE + 1, MBOX_PAGE_SIZE, req + MBOX_PAGE_SIZE);
+  int len = req[MBOX_RPC_LEN];
+  if (len > MBOX_RPC_MAX_PAYLOAD) {
+    status = FRAME_STATUS_BAD_LEN;
+  } else {
+    status = frame_dispatch(req[MBOX_RPC_OP], req + MBOX_RPC_HEADER_SIZE, len,
+                            rsp + MBOX_RPC_HEADER_SIZE, &rsp_len, MBOX_RPC_MAX_PAYLOAD);
+  }
+  if (rsp_len > MBOX_RPC_MAX_PAYLOAD) {
+    rsp_len = 0;
+    status = FRAME_STATUS_BAD_LEN;
+  }
+  rsp[MBOX_RPC_OP] = (uint8_t)status;
+  rsp[MBOX_RPC_LEN] = (uint8_t)rsp_len;
+  // Everything but SEQ first, so the host never sees a partial response
+  mbox_write_page(MBOX_RPC_RSP_PAGE + 1, MBOX_PAGE_SIZE, rsp + MBOX_PAGE_SIZE);
+  mbox_write_entries(MBOX_RPC_RSP_PAGE, MBOX_RPC_OP, MBOX_PAGE_SIZE - MBOX_RPC_OP, rsp);
+  rsp[MBOX_RPC_SEQ] = seq;
+  mbox_write_entries(MBOX_RPC_RSP_PAGE, MBOX_RPC_SEQ, 1, rsp);
+  return 1;
+}
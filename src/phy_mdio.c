@@ -1,11 +1,18 @@
 #include "marble_api.h"
 #include "phy_mdio.h"
+#include "report.h"
 #include <stdio.h>
 #include <string.h>
 
+static void mdio_phy_report(int verbose);
+
 void mdio_phy_print(int verbose)
 {
   uint32_t value;
+  if (report_structured()) {
+    mdio_phy_report(verbose);
+    return;
+  }
   value = marble_MDIO_read(MDIO_PHY_REG_CU_SP_STAT_1);
   printf("MDIO PHY Status:\r\n");
   if (verbose) printf( "  reg[%2.2x] = %4.4lx\r\n", (unsigned)MDIO_PHY_REG_CU_SP_STAT_1, (long unsigned)value);
@@ -55,6 +62,43 @@ void mdio_phy_print(int verbose)
   return;
 }
 
+/*
+ * static void mdio_phy_report(int verbose);
+ *  Structured-output counterpart of mdio_phy_print() (see report.h)
+ */
+static void mdio_phy_report(int verbose) {
+  static const uint16_t regs[] = {
+    MDIO_PHY_REG_CU_LP_ABL,
+    MDIO_PHY_REG_CU_LP_NP,
+    MDIO_PHY_REG_EXT_STAT,
+    MDIO_PHY_REG_1000BASET_STAT
+  };
+  static const unsigned int speeds[] = {10, 100, 1000, 0};
+  char key[8];
+  reg_cu_sp_stat sp_stat;
+  reg_cu_ctrl cu_stat;
+  sp_stat.val = (unsigned short)marble_MDIO_read(MDIO_PHY_REG_CU_SP_STAT_1);
+  cu_stat.val = (unsigned short)marble_MDIO_read(MDIO_PHY_REG_CU_STAT);
+  report_begin("mdio_phy");
+  report_int("link", (sp_stat.bits.copper_link & sp_stat.bits.global_link_status) ? 1 : 0);
+  if (sp_stat.bits.speed_duplex_resolved) {
+    report_uint("speed", speeds[sp_stat.bits.speed]);
+  } else {
+    report_uint("speed", 0);
+  }
+  report_int("remote_fault", cu_stat.bits.cu_remote_fault ? 1 : 0);
+  if (verbose) {
+    report_hex("r11", sp_stat.val);
+    report_hex("r01", cu_stat.val);
+    for (unsigned int n=0; n<(sizeof(regs)/sizeof(uint16_t)); n++) {
+      snprintf(key, sizeof(key), "r%02x", regs[n]);
+      report_hex(key, marble_MDIO_read(regs[n]));
+    }
+  }
+  report_end();
+  return;
+}
+
 void mdio_phy_reset(void) {
   uint32_t value = marble_MDIO_read(MDIO_PHY_REG_CU_CTRL);
   value |= (1<<15); // Copper Reset
@@ -1,38 +1,26 @@
 /* A set of Power Management Bus (PMBus) format conversion utilities
  * See pmbus.h for detailed description.
+ *
+ * The integer conversions use integer arithmetic only (no soft-float on the
+ * Cortex-M3) and are exact: decoders round toward -infinity and saturate at
+ * the int range, encoders follow the rounding of V_TO_L11()/MV_TO_L11() in
+ * scripts/ltm4673.py.  See tests/pmbus for the bit-exactness check.
  */
 
+#include <limits.h>
 #include "pmbus.h"
 
-static double _shift(double f, int ord);
-
-#ifndef INT_MAX
-//#define INT_MAX 0x7fffffff
-// Silly little two-step hack to keep the compiler from warning about
-// -0x80000000 rolling over to 0x7fffffff with the -1 step
-#define INT_MAX   ((((1 << (8*sizeof(int)-2)) - 1) << 1) | 1)
-#endif
-#ifndef INT_MIN
-//#define INT_MIN -0x80000000
-#define INT_MIN   (1 << (8*sizeof(int)-1))
-#endif
+static int _l11_mantissa(uint16_t l);
+static int _l11_exponent(uint16_t l);
+static int _l11_scaled(uint16_t l, int scale);
+static int64_t _floor_div(int64_t num, int64_t den);
+static uint16_t _l11_encode_trunc(int64_t q16);
+static uint16_t _l11_encode_floor(int64_t q16);
+static uint16_t _l16_encode(int64_t num, int64_t den);
 
 // ================================ V to L11 =================================
 uint16_t v_to_l11_int(int v) {
-  // Start most-negative exponent (largest mantissa) possible
-  int n = 0;
-  while ((v < INT_MAX/2) && (v > INT_MIN/2)) {
-    v = v << 1;
-    n--;
-  }
-  //v = v << 16;
-  while ((v > 1023) || (v < -1024)) {
-    v = v >> 1;
-    if (++n > 14) { // Enforce clipping in case too large v
-      break;
-    }
-  }
-  return (uint16_t)(((n & 0x1f) << 11) | (v & 0x7ff));
+  return _l11_encode_trunc((int64_t)v*(1 << 16));
 }
 
 uint16_t v_to_l11_float(float v) {
@@ -61,20 +49,7 @@ uint16_t v_to_l11_double(double v) {
 
 // =============================== mV to L11 =================================
 uint16_t mv_to_l11_int(int mv) {
-  // Start most-negative exponent (largest mantissa) possible
-  int n = 0;
-  while ((mv < INT_MAX/2) && (mv > INT_MIN/2)) {
-    mv = mv << 1;
-    n--;
-  }
-  mv = mv/1000;
-  while ((mv > 1023) || (mv < -1024)) {
-    mv = mv >> 1;
-    if (++n > 14) { // Enforce clipping in case too large v
-      break;
-    }
-  }
-  return (uint16_t)(((n & 0x1f) << 11) | (mv & 0x7ff));
+  return _l11_encode_floor(_floor_div((int64_t)mv*(1 << 16), 1000));
 }
 
 uint16_t mv_to_l11_float(float mv) {
@@ -103,20 +78,7 @@ uint16_t mv_to_l11_double(double mv) {
 
 // =============================== uV to L11 =================================
 uint16_t uv_to_l11_int(int uv) {
-  // Start most-negative exponent (largest mantissa) possible
-  int n = 0;
-  while ((uv < INT_MAX/2) && (uv > INT_MIN/2)) {
-    uv = uv << 1;
-    n--;
-  }
-  uv = uv/1000000;
-  while ((uv > 1023) || (uv < -1024)) {
-    uv = uv >> 1;
-    if (++n > 14) { // Enforce clipping in case too large v
-      break;
-    }
-  }
-  return (uint16_t)(((n & 0x1f) << 11) | (uv & 0x7ff));
+  return _l11_encode_floor(_floor_div((int64_t)uv*(1 << 16), 1000000));
 }
 
 uint16_t uv_to_l11_float(float uv) {
@@ -145,17 +107,7 @@ uint16_t uv_to_l11_double(double uv) {
 
 // ================================ L11 to V =================================
 int l11_to_v_int(uint16_t l) {
-  int a, n;
-  // Avoid relying on platform-dependent sign-extension
-  n = ((l >> 11) & 0xf);
-  a = (l & 0x3ff);
-  if (l & 0x400) {
-    a -= 0x400;
-  }
-  if (l & 0x8000) {
-    return (a >> (16-n));
-  }
-  return (a << n);
+  return _l11_scaled(l, 1);
 }
 
 float l11_to_v_float(uint16_t l) {
@@ -163,33 +115,17 @@ float l11_to_v_float(uint16_t l) {
 }
 
 double l11_to_v_double(uint16_t l) {
-  double a;
-  int n;
-  // Avoid relying on platform-dependent sign-extension
-  n = ((l >> 11) & 0xf);
-  a = (double)(l & 0x3ff);
-  if (l & 0x400) {
-    a -= 0x400;
-  }
-  if (l & 0x8000) {
-    return _shift(a, n-16);
+  int n = _l11_exponent(l);
+  double a = (double)_l11_mantissa(l);
+  if (n < 0) {
+    return a/(double)(1 << -n);  // Exact; no loop
   }
-  return (a*(1 << n));
+  return a*(double)(1 << n);
 }
 
 // =============================== L11 to mV =================================
 int l11_to_mv_int(uint16_t l) {
-  int a, n;
-  // Avoid relying on platform-dependent sign-extension
-  n = ((l >> 11) & 0xf);
-  a = (l & 0x3ff);
-  if (l & 0x400) {
-    a -= 0x400;
-  }
-  if (l & 0x8000) {
-    return ((1000*a) >> (16-n));
-  }
-  return ((1000*a) << n);
+  return _l11_scaled(l, 1000);
 }
 
 float l11_to_mv_float(uint16_t l) {
@@ -197,33 +133,12 @@ float l11_to_mv_float(uint16_t l) {
 }
 
 double l11_to_mv_double(uint16_t l) {
-  double a;
-  int n;
-  // Avoid relying on platform-dependent sign-extension
-  n = ((l >> 11) & 0xf);
-  a = (double)(l & 0x3ff);
-  if (l & 0x400) {
-    a -= 0x400;
-  }
-  if (l & 0x8000) {
-    return _shift(1000*a, n-16);
-  }
-  return (1000*a*(1 << n));
+  return 1000*l11_to_v_double(l);
 }
 
 // =============================== L11 to uV =================================
 int l11_to_uv_int(uint16_t l) {
-  int a, n;
-  // Avoid relying on platform-dependent sign-extension
-  n = ((l >> 11) & 0xf);
-  a = (l & 0x3ff);
-  if (l & 0x400) {
-    a -= 0x400;
-  }
-  if (l & 0x8000) {
-    return ((1000000*a) >> (16-n));
-  }
-  return ((1000000*a) << n);
+  return _l11_scaled(l, 1000000);
 }
 
 float l11_to_uv_float(uint16_t l) {
@@ -231,23 +146,12 @@ float l11_to_uv_float(uint16_t l) {
 }
 
 double l11_to_uv_double(uint16_t l) {
-  double a;
-  int n;
-  // Avoid relying on platform-dependent sign-extension
-  n = ((l >> 11) & 0xf);
-  a = (double)(l & 0x3ff);
-  if (l & 0x400) {
-    a -= 0x400;
-  }
-  if (l & 0x8000) {
-    return _shift(1000000*a, n-16);
-  }
-  return (1000000*a*(1 << n));
+  return 1000000*l11_to_v_double(l);
 }
 
 // ================================ V to L16 =================================
 uint16_t v_to_l16_int(int v) {
-  return (uint16_t)((v*8192) & 0xffff);
+  return _l16_encode(v, 1);
 }
 
 uint16_t v_to_l16_float(float v) {
@@ -260,7 +164,7 @@ uint16_t v_to_l16_double(double v) {
 
 // =============================== mV to L16 =================================
 uint16_t mv_to_l16_int(int mv) {
-  return (uint16_t)(((mv*8192)/1000) & 0xffff);
+  return _l16_encode(mv, 1000);
 }
 
 uint16_t mv_to_l16_float(float mv) {
@@ -273,7 +177,7 @@ uint16_t mv_to_l16_double(double mv) {
 
 // =============================== uV to L16 =================================
 uint16_t uv_to_l16_int(int uv) {
-  return (uint16_t)(((uv*8192)/1000000) & 0xffff);
+  return _l16_encode(uv, 1000000);
 }
 
 uint16_t uv_to_l16_float(float uv) {
@@ -302,7 +206,8 @@ double l16_to_v_double(uint16_t l) {
 
 // =============================== L16 to mV =================================
 int l16_to_mv_int(uint16_t l) {
-  return (1000*((int)l)>>13);
+  // 1000/2^13 = 125/2^10
+  return (int)((125*(uint32_t)l) >> 10);
 }
 
 float l16_to_mv_float(uint16_t l) {
@@ -315,7 +220,8 @@ double l16_to_mv_double(uint16_t l) {
 
 // =============================== L16 to uV =================================
 int l16_to_uv_int(uint16_t l) {
-  return (1000000*((int)l)>>13);
+  // 10^6/2^13 = 15625/2^7 (keeps the product within 32 bits)
+  return (int)((15625*(uint32_t)l) >> 7);
 }
 
 float l16_to_uv_float(uint16_t l) {
@@ -326,15 +232,141 @@ double l16_to_uv_double(uint16_t l) {
   return 1000000*l16_to_v_double(l);
 }
 
+// ============================== Fixed Point ================================
+int64_t l11_to_q16(uint16_t l) {
+  // Y*2^(N+16) with 0 <= N+16 <= 31
+  return (int64_t)_l11_mantissa(l)*((int64_t)1 << (_l11_exponent(l) + 16));
+}
+
+int64_t l16_to_q16(uint16_t l) {
+  return (int64_t)l << (16 - _L16_EXPONENT);
+}
+
+// ================================= PEC =====================================
+// CRC-8 lookup table for polynomial 0x07 (kept in flash)
+static const uint8_t _pec_table[256] = {
+  0x00, 0x07, 0x0e, 0x09, 0x1c, 0x1b, 0x12, 0x15, 0x38, 0x3f, 0x36, 0x31, 0x24, 0x23, 0x2a, 0x2d,
+  0x70, 0x77, 0x7e, 0x79, 0x6c, 0x6b, 0x62, 0x65, 0x48, 0x4f, 0x46, 0x41, 0x54, 0x53, 0x5a, 0x5d,
+  0xe0, 0xe7, 0xee, 0xe9, 0xfc, 0xfb, 0xf2, 0xf5, 0xd8, 0xdf, 0xd6, 0xd1, 0xc4, 0xc3, 0xca, 0xcd,
+  0x90, 0x97, 0x9e, 0x99, 0x8c, 0x8b, 0x82, 0x85, 0xa8, 0xaf, 0xa6, 0xa1, 0xb4, 0xb3, 0xba, 0xbd,
+  0xc7, 0xc0, 0xc9, 0xce, 0xdb, 0xdc, 0xd5, 0xd2, 0xff, 0xf8, 0xf1, 0xf6, 0xe3, 0xe4, 0xed, 0xea,
+  0xb7, 0xb0, 0xb9, 0xbe, 0xab, 0xac, 0xa5, 0xa2, 0x8f, 0x88, 0x81, 0x86, 0x93, 0x94, 0x9d, 0x9a,
+  0x27, 0x20, 0x29, 0x2e, 0x3b, 0x3c, 0x35, 0x32, 0x1f, 0x18, 0x11, 0x16, 0x03, 0x04, 0x0d, 0x0a,
+  0x57, 0x50, 0x59, 0x5e, 0x4b, 0x4c, 0x45, 0x42, 0x6f, 0x68, 0x61, 0x66, 0x73, 0x74, 0x7d, 0x7a,
+  0x89, 0x8e, 0x87, 0x80, 0x95, 0x92, 0x9b, 0x9c, 0xb1, 0xb6, 0xbf, 0xb8, 0xad, 0xaa, 0xa3, 0xa4,
+  0xf9, 0xfe, 0xf7, 0xf0, 0xe5, 0xe2, 0xeb, 0xec, 0xc1, 0xc6, 0xcf, 0xc8, 0xdd, 0xda, 0xd3, 0xd4,
+  0x69, 0x6e, 0x67, 0x60, 0x75, 0x72, 0x7b, 0x7c, 0x51, 0x56, 0x5f, 0x58, 0x4d, 0x4a, 0x43, 0x44,
+  0x19, 0x1e, 0x17, 0x10, 0x05, 0x02, 0x0b, 0x0c, 0x21, 0x26, 0x2f, 0x28, 0x3d, 0x3a, 0x33, 0x34,
+  0x4e, 0x49, 0x40, 0x47, 0x52, 0x55, 0x5c, 0x5b, 0x76, 0x71, 0x78, 0x7f, 0x6a, 0x6d, 0x64, 0x63,
+  0x3e, 0x39, 0x30, 0x37, 0x22, 0x25, 0x2c, 0x2b, 0x06, 0x01, 0x08, 0x0f, 0x1a, 0x1d, 0x14, 0x13,
+  0xae, 0xa9, 0xa0, 0xa7, 0xb2, 0xb5, 0xbc, 0xbb, 0x96, 0x91, 0x98, 0x9f, 0x8a, 0x8d, 0x84, 0x83,
+  0xde, 0xd9, 0xd0, 0xd7, 0xc2, 0xc5, 0xcc, 0xcb, 0xe6, 0xe1, 0xe8, 0xef, 0xfa, 0xfd, 0xf4, 0xf3,
+};
+
+uint8_t pmbus_pec(uint8_t crc, const uint8_t *data, int len) {
+  for (int n = 0; n < len; n++) {
+    crc = _pec_table[crc ^ data[n]];
+  }
+  return crc;
+}
+
+
 // ================================= static ==================================
-static double _shift(double f, int ord) {
-  while (ord > 0) {
-    f = f*2;
-    --ord;
-  };
-  while (ord < 0) {
-    f = f/2;
-    ++ord;
-  };
-  return f;
+// Sign-extended 11-bit mantissa Y; avoids relying on platform-dependent
+// sign-extension
+static int _l11_mantissa(uint16_t l) {
+  int a = (l & 0x3ff);
+  if (l & 0x400) {
+    a -= 0x400;
+  }
+  return a;
+}
+
+// Sign-extended 5-bit exponent N
+static int _l11_exponent(uint16_t l) {
+  int n = ((l >> 11) & 0xf);
+  if (l & 0x8000) {
+    n -= 16;
+  }
+  return n;
+}
+
+/* static int _l11_scaled(uint16_t l, int scale);
+ *  floor(scale*Y*2^N) for scale <= 10^6, saturated to the int range.
+ *  32-bit integer arithmetic only.
+ */
+static int _l11_scaled(uint16_t l, int scale) {
+  int a = scale*_l11_mantissa(l);  // |a| <= 1024*10^6 < 2^31
+  int n = _l11_exponent(l);
+  if (n < 0) {
+    if (a < 0) {
+      return -(int)(((unsigned int)(-a) + (1u << -n) - 1) >> -n);
+    }
+    return a >> -n;
+  }
+  if (a > INT_MAX/(1 << n)) {
+    return INT_MAX;
+  }
+  if (a < INT_MIN/(1 << n)) {
+    return INT_MIN;
+  }
+  return a*(1 << n);
+}
+
+static int64_t _floor_div(int64_t num, int64_t den) {
+  int64_t q = num/den;
+  if ((num % den != 0) && (num < 0)) {
+    q--;
+  }
+  return q;
+}
+
+/* static uint16_t _l11_encode_trunc(int64_t q16);
+ *  Encode q16/2^16 with the smallest exponent N >= -16 for which the exact
+ *  value of Y = q16/2^(N+16) lies in [-1024, 1023], truncating Y toward zero
+ *  (as V_TO_L11() in scripts/ltm4673.py).  Clips at N = 15.
+ */
+static uint16_t _l11_encode_trunc(int64_t q16) {
+  int n = -16;
+  int64_t hi = 1023;
+  int64_t lo = -1024;
+  while ((q16 > hi) || (q16 < lo)) {
+    if (n == 15) {
+      return (uint16_t)(((n & 0x1f) << 11) | ((q16 < 0 ? -1024 : 1023) & 0x7ff));
+    }
+    hi *= 2;
+    lo *= 2;
+    n++;
+  }
+  int shift = n + 16;
+  int y = (int)(q16 < 0 ? -((-q16) >> shift) : (q16 >> shift));
+  return (uint16_t)(((n & 0x1f) << 11) | (y & 0x7ff));
+}
+
+/* static uint16_t _l11_encode_floor(int64_t q16);
+ *  As _l11_encode_trunc() but with q16 halved (rounding toward -infinity)
+ *  until it fits, as MV_TO_L11() in scripts/ltm4673.py.
+ */
+static uint16_t _l11_encode_floor(int64_t q16) {
+  int n = -16;
+  while ((q16 > 1023) || (q16 < -1024)) {
+    if (n == 15) {
+      q16 = q16 < 0 ? -1024 : 1023;
+      break;
+    }
+    q16 = _floor_div(q16, 2);
+    n++;
+  }
+  return (uint16_t)(((n & 0x1f) << 11) | ((int)q16 & 0x7ff));
+}
+
+/* static uint16_t _l16_encode(int64_t num, int64_t den);
+ *  trunc(2^13*num/den), clipped to [0, 0xffff].
+ */
+static uint16_t _l16_encode(int64_t num, int64_t den) {
+  if (num <= 0) {
+    return 0;
+  }
+  num = (num << _L16_EXPONENT)/den;
+  return num > 0xffff ? 0xffff : (uint16_t)num;
 }
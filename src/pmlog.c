@@ -0,0 +1,230 @@
+/*
+ * File: pmlog.c
+ * Desc: Power-loss event log in flash.  See pmlog.h.
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include "pmlog.h"
+#include "ltm4673.h"
+#include "marble_api.h"
+#include "report.h"
+#include "mbox_fifo.h"
+
+#ifdef APP_MARBLE
+#include "flash.h"
+
+#ifdef SIMULATION
+#include "sim_api.h"
+#define PMLOG_SLOTS                          (SIM_PMLOG_SLOTS)
+#else
+// Start and size of the region are defined in the linker script
+extern const char pmlog_size;
+#define PMLOG_SLOTS ((unsigned int)((size_t)&pmlog_size/sizeof(pmlog_record_t)))
+#endif
+extern pmlog_record_t pmlog_base[];   // Defined in linker file or sim/sim_flash.c
+
+// Flash sector holding the log (0x0800c000 on STM32F207)
+#define PMLOG_SECTOR                                (3)
+
+static unsigned int _next_slot = 0;   // First free slot
+static uint32_t _next_seq = 1;
+static uint8_t _mbox_sel = 0;
+static pmlog_record_t _capture;
+
+static int pmlog_slot_blank(unsigned int slot);
+static int pmlog_slot_valid(unsigned int slot);
+
+/*
+ * static int pmlog_slot_blank(unsigned int slot);
+ *  Returns 1 if every word of the slot is erased.
+ */
+static int pmlog_slot_blank(unsigned int slot) {
+  const uint32_t *p = (const uint32_t *)&pmlog_base[slot];
+  for (unsigned int n = 0; n < sizeof(pmlog_record_t)/sizeof(uint32_t); n++) {
+    if (p[n] != PMLOG_FREE) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+static int pmlog_slot_valid(unsigned int slot) {
+  return (pmlog_base[slot].seq != PMLOG_FREE) && (pmlog_base[slot].commit == PMLOG_COMMIT);
+}
+
+int pmlog_init(void) {
+  unsigned int slot;
+  int valid = 0;
+  for (slot = 0; slot < PMLOG_SLOTS; slot++) {
+    if (pmlog_slot_blank(slot)) {
+      break;
+    }
+    if (pmlog_slot_valid(slot)) {
+      _next_seq = pmlog_base[slot].seq + 1;
+      valid++;
+    }
+  }
+  _next_slot = slot;
+  // Records are only ever appended, so anything past the first blank slot
+  // (or a region without a single valid record, e.g. left over from an
+  // older firmware image) means the sector does not hold a log.
+  for (; slot < PMLOG_SLOTS; slot++) {
+    if (!pmlog_slot_blank(slot)) {
+      break;
+    }
+  }
+  if ((slot < PMLOG_SLOTS) || ((_next_slot > 0) && (valid == 0))) {
+    printf("Power-loss log corrupt; erasing\r\n");
+    pmlog_erase();
+    return 0;
+  }
+  return valid;
+}
+
+int pmlog_capture(void) {
+  pmlog_record_t *rec = &_capture;
+  if (_next_slot >= PMLOG_SLOTS) {
+    printf("Power-loss log full; event not recorded\r\n");
+    return -1;
+  }
+  memset(rec, 0xff, sizeof(pmlog_record_t));
+  rec->seq = _next_seq;
+  rec->tick = marble_get_tick();
+  for (int elem = 0; elem < PM_NUM_TELEM_ENUM; elem++) {
+    rec->telem[elem] = (uint16_t)PM_GetTelem((PM_telem_enum_t)elem);
+  }
+  int len = ltm4673_read_fault_log(LTM4673, rec->fault_log, PMLOG_FAULT_LOG_MAX);
+  rec->fault_log_len = len < 0 ? 0 : (uint16_t)len;
+  rec->reserved = 0;
+  // Body first, then the commit word; a torn record is never valid
+  pmlog_record_t *dst = &pmlog_base[_next_slot++];
+  int rc = fmc_flash_program(dst, rec, offsetof(pmlog_record_t, commit));
+  if (rc == 0) {
+    uint32_t commit = PMLOG_COMMIT;
+    rc = fmc_flash_program(&dst->commit, &commit, sizeof(commit));
+  }
+  if (rc != 0) {
+    printf("Power-loss log write failed\r\n");
+    return -1;
+  }
+  _next_seq++;
+  mbox_fifo_put(MBOX_FIFO_REC_PMLOG, (const uint8_t *)rec, PMLOG_HEADER_SIZE);
+  printf("Power-loss event %lu logged\r\n", (unsigned long)rec->seq);
+  return 0;
+}
+
+const pmlog_record_t *pmlog_get(unsigned int n) {
+  for (unsigned int slot = _next_slot; slot > 0; slot--) {
+    if (pmlog_slot_valid(slot - 1)) {
+      if (n == 0) {
+        return &pmlog_base[slot - 1];
+      }
+      n--;
+    }
+  }
+  return NULL;
+}
+
+int pmlog_count(void) {
+  int count = 0;
+  for (unsigned int slot = 0; slot < _next_slot; slot++) {
+    if (pmlog_slot_valid(slot)) {
+      count++;
+    }
+  }
+  return count;
+}
+
+int pmlog_free_slots(void) {
+  return (int)(PMLOG_SLOTS - _next_slot);
+}
+
+int pmlog_erase(void) {
+  int rc = fmc_flash_erase_sector(PMLOG_SECTOR);
+  fmc_flash_cache_flush_all();
+  _next_slot = 0;
+  _mbox_sel = 0;
+  // Sequence numbers keep counting until reset
+  return rc;
+}
+
+#else /* !APP_MARBLE */
+// No power-loss log on Marble-Mini; stubs keep the mailbox map shared
+int pmlog_init(void) { return 0; }
+int pmlog_capture(void) { return -1; }
+const pmlog_record_t *pmlog_get(unsigned int n) { (void)n; return NULL; }
+int pmlog_count(void) { return 0; }
+int pmlog_free_slots(void) { return 0; }
+int pmlog_erase(void) { return 0; }
+static uint8_t _mbox_sel = 0;
+#endif /* APP_MARBLE */
+
+void pmlog_print(unsigned int n) {
+  const pmlog_record_t *rec;
+  if (report_structured()) {
+    report_begin("pmlog");
+    report_uint("count", pmlog_count());
+    report_uint("free", pmlog_free_slots());
+    report_end();
+  } else {
+    printf("Power-loss events logged: %d (%d free slots%s)\r\n", pmlog_count(),
+           pmlog_free_slots(), pmlog_free_slots() == 0 ? ", full" : "");
+  }
+  for (unsigned int k = 0; (k < n) && ((rec = pmlog_get(k)) != NULL); k++) {
+    if (report_structured()) {
+      report_begin("pmlog_event");
+      report_uint("n", k);
+      report_uint("seq", rec->seq);
+      report_uint("tick", rec->tick);
+      report_bytes("telem", (const uint8_t *)rec->telem, sizeof(rec->telem));
+      report_bytes("fault_log", rec->fault_log, rec->fault_log_len);
+      report_end();
+      continue;
+    }
+    printf("[%u] event %lu t=%lu ms\r\n", k, (unsigned long)rec->seq, (unsigned long)rec->tick);
+    printf("  telem:");
+    for (int elem = 0; elem < PM_NUM_TELEM_ENUM; elem++) {
+      printf(" %04x", rec->telem[elem]);
+    }
+    printf("\r\n");
+    if (rec->fault_log_len == 0) {
+      printf("  MFR_FAULT_LOG: read failed\r\n");
+      continue;
+    }
+    printf("  MFR_FAULT_LOG (%u bytes):", rec->fault_log_len);
+    for (unsigned int b = 0; b < rec->fault_log_len; b++) {
+      if ((b % 16) == 0) {
+        printf("\r\n   ");
+      }
+      printf(" %02x", rec->fault_log[b]);
+    }
+    printf("\r\n");
+  }
+  return;
+}
+
+void pmlog_mbox_select(uint8_t n) {
+  _mbox_sel = n;
+  return;
+}
+
+uint8_t pmlog_mbox_selected(void) {
+  return _mbox_sel;
+}
+
+uint32_t pmlog_mbox_seq(void) {
+  const pmlog_record_t *rec = pmlog_get(_mbox_sel);
+  return rec ? rec->seq : 0;
+}
+
+uint32_t pmlog_mbox_tick(void) {
+  const pmlog_record_t *rec = pmlog_get(_mbox_sel);
+  return rec ? rec->tick : 0;
+}
+
+uint16_t pmlog_mbox_telem(PM_telem_enum_t elem) {
+  const pmlog_record_t *rec = pmlog_get(_mbox_sel);
+  return rec ? rec->telem[elem] : 0;
+}
@@ -0,0 +1,108 @@
+/*
+ * File: prof.c
+ * Desc: Main-loop and ISR execution-time profiler.  See prof.h.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "prof.h"
+#include "marble_api.h"
+#include "report.h"
+
+static prof_entry_t _prof[PROF_NUM_TASKS];
+
+static const char *prof_task_names[PROF_NUM_TASKS] = {
+  "main_loop",
+  "system_service",
+  "board_service",
+  "mbox_update",
+  "console_service",
+  "pmod_service",
+  "eeprom_update",
+  "isr_usart_rx",
+  "isr_systick",
+  "isr_tim2",
+};
+
+static unsigned int prof_bin(uint32_t cycles);
+
+/*
+ * static unsigned int prof_bin(uint32_t cycles);
+ *  Histogram bin: the number of significant bits, clamped to the last bin.
+ */
+static unsigned int prof_bin(uint32_t cycles) {
+  unsigned int bin = 0;
+  while ((cycles != 0) && (bin < PROF_HIST_BINS - 1)) {
+    cycles >>= 1;
+    bin++;
+  }
+  return bin;
+}
+
+void prof_end(prof_task_t task, uint32_t t0) {
+  uint32_t dt = marble_get_cycles() - t0;
+  prof_entry_t *entry = &_prof[task];
+  if ((entry->count == 0) || (dt < entry->min)) {
+    entry->min = dt;
+  }
+  if (dt > entry->max) {
+    entry->max = dt;
+  }
+  entry->count++;
+  entry->sum += dt;
+  entry->hist[prof_bin(dt)]++;
+  return;
+}
+
+const prof_entry_t *prof_get(prof_task_t task) {
+  return task < PROF_NUM_TASKS ? &_prof[task] : NULL;
+}
+
+void prof_reset(void) {
+  memset(_prof, 0, sizeof(_prof));
+  return;
+}
+
+void prof_print(void) {
+  uint32_t cpu = marble_cycles_per_us();
+  const prof_entry_t *entry;
+  if (!report_structured()) {
+    printf("Task             count      min_us     avg_us     max_us\r\n");
+  }
+  for (int task = 0; task < PROF_NUM_TASKS; task++) {
+    entry = &_prof[task];
+    if (entry->count == 0) {
+      continue;
+    }
+    uint32_t avg = (uint32_t)(entry->sum/entry->count);
+    if (report_structured()) {
+      report_begin("prof");
+      report_str("task", prof_task_names[task]);
+      report_uint("count", entry->count);
+      report_uint("cycles_per_us", cpu);
+      report_uint("min", entry->min);
+      report_uint("avg", avg);
+      report_uint("max", entry->max);
+      report_bytes("hist", (const uint8_t *)entry->hist, sizeof(entry->hist));
+      report_end();
+      continue;
+    }
+    printf("%-16s %-10lu %-10lu %-10lu %lu\r\n", prof_task_names[task],
+           (unsigned long)entry->count, (unsigned long)(entry->min/cpu),
+           (unsigned long)(avg/cpu), (unsigned long)(entry->max/cpu));
+    // Non-empty bins as "<upper bound in cycles>:count"
+    printf("  hist:");
+    for (unsigned int bin = 0; bin < PROF_HIST_BINS; bin++) {
+      if (entry->hist[bin] == 0) {
+        continue;
+      }
+      if (bin == PROF_HIST_BINS - 1) {
+        printf(" >=2^%u:%lu", bin - 1, (unsigned long)entry->hist[bin]);
+      } else {
+        printf(" <2^%u:%lu", bin, (unsigned long)entry->hist[bin]);
+      }
+    }
+    printf("\r\n");
+  }
+  return;
+}
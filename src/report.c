@@ -0,0 +1,119 @@
+/*
+ * File: report.c
+ * Desc: Shared emitter for console reports (see report.h)
+ */
+
+#include <stdio.h>
+#include "report.h"
+
+static report_mode_t report_mode = REPORT_MODE_TEXT;
+
+static void report_key(const char *key);
+
+void report_set_mode(report_mode_t mode) {
+  if (mode < REPORT_MODE_SIZE) {
+    report_mode = mode;
+  }
+  return;
+}
+
+report_mode_t report_get_mode(void) {
+  return report_mode;
+}
+
+const char *report_mode_string(report_mode_t mode) {
+  switch (mode) {
+    case REPORT_MODE_TEXT:
+      return "Text";
+    case REPORT_MODE_KV:
+      return "Key=value records";
+    case REPORT_MODE_JSON:
+      return "JSON records";
+    default:
+      break;
+  }
+  return "Unknown";
+}
+
+int report_structured(void) {
+  return report_mode != REPORT_MODE_TEXT;
+}
+
+void report_begin(const char *name) {
+  if (report_mode == REPORT_MODE_JSON) {
+    printf("{\"report\":\"%s\"", name);
+  } else {
+    printf("%s", name);
+  }
+  return;
+}
+
+/*
+ * static void report_key(const char *key);
+ *  Print the separator and key which precede every field value.
+ */
+static void report_key(const char *key) {
+  if (report_mode == REPORT_MODE_JSON) {
+    printf(",\"%s\":", key);
+  } else {
+    printf(" %s=", key);
+  }
+  return;
+}
+
+void report_int(const char *key, int val) {
+  report_key(key);
+  printf("%d", val);
+  return;
+}
+
+void report_uint(const char *key, unsigned int val) {
+  report_key(key);
+  printf("%u", val);
+  return;
+}
+
+void report_hex(const char *key, unsigned int val) {
+  report_key(key);
+  // JSON has no hex literals
+  if (report_mode == REPORT_MODE_JSON) {
+    printf("%u", val);
+  } else {
+    printf("0x%x", val);
+  }
+  return;
+}
+
+void report_float(const char *key, float val) {
+  report_key(key);
+  printf("%.3f", (double)val);
+  return;
+}
+
+void report_str(const char *key, const char *val) {
+  report_key(key);
+  printf("\"%s\"", val);
+  return;
+}
+
+/*
+ * void report_bytes(const char *key, const uint8_t *data, int len);
+ *  Emit a byte array as a quoted hex string (MSB first as stored).
+ */
+void report_bytes(const char *key, const uint8_t *data, int len) {
+  report_key(key);
+  printf("\"");
+  for (int n = 0; n < len; n++) {
+    printf("%02x", data[n]);
+  }
+  printf("\"");
+  return;
+}
+
+void report_end(void) {
+  if (report_mode == REPORT_MODE_JSON) {
+    printf("}");
+  }
+  printf("\r\n");
+  return;
+}
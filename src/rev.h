@@ -0,0 +1,3 @@
+#define GIT_REV "0c6f0bc2"
+#define GIT_DIRTY 1
+#define GIT_REV_32BIT 0x0c6f0bc2
@@ -11,6 +11,12 @@
 #include "console.h"
 #include "ltm4673.h"
 #include "watchdog.h"
+#include "report.h"
+#include "pmlog.h"
+#include "prof.h"
+#include "event.h"
+#include "fanctl.h"
+#include "i2c_fpga.h"
 
 #undef UI_BOARD_SUPPORTED
 
@@ -67,7 +73,6 @@ static unsigned int fpga_net_prog_pend=0;
 static uint32_t fpga_disabled_time = 0;
 static int fpga_reset = 0;
 static void (*fpga_reset_callback)(void) = NULL;
-static volatile bool spi_update = false;
 static uint32_t systimer_ms=1; // System timer interrupt period
 
 static pmod_mode_t pmod_mode = PMOD_MODE_DISABLED;
@@ -115,6 +120,7 @@ static void pmod_led_counts(uint8_t val, volatile pmod_led_t *pled);
 void system_init(void) {
   // Initialize non-volatile memory
   eeprom_init();
+  pmlog_init();
 
   // Apply parameters from non-volatile memory
   system_apply_internal_params();
@@ -155,17 +161,43 @@ void system_off_chip_init(void) {
   return;
 }
 
+/* void system_service(void);
+ *  Dispatch the events posted since the last call (see event.h).  Timed
+ *  deadlines and polled work run once per system timer tick.
+ */
 void system_service(void) {
+  uint32_t t0;
+  bool tick = event_take(EVENT_TICK);
   // Run all system update/monitoring tasks and only then handle console
   // Handle Mailbox Updates
-  if (spi_update) {
+  if (event_take(EVENT_MBOX_UPDATE)) {
+     t0 = marble_get_cycles();
      mbox_update(false);
-     spi_update = false; // Clear flag
+     prof_end(PROF_MBOX_UPDATE, t0);
+  }
+  // Read input pages flagged by the FPGA's mailbox doorbell right away
+  if (event_take(EVENT_DOORBELL)) {
+    mbox_doorbell_service();
+  }
+  // Capture power supply faults signalled on SMBALERT; also polled as the
+  // interrupt only catches the falling edge
+  if (event_take(EVENT_PM_ALERT) || tick) {
+    PM_AlertService();
+  }
+  if (event_take(EVENT_CONSOLE) || tick) {
+    t0 = marble_get_cycles();
+    console_service();
+    prof_end(PROF_CONSOLE_SERVICE, t0);
+  }
+  if (!tick) {
+    return;
   }
   // Handle delayed action in response to FPGA's DONE pin asserting
   if ((fpga_net_prog_pend) && (BSP_GET_SYSTICK() > fpga_done_tickval + FPGA_PUSH_DELAY_MS)) {
     console_print_mac_ip();
     console_push_fpga_mac_ip();
+    // Freshly configured FPGA; rewrite build identifiers, etc
+    mbox_request_boot_update();
     printf("DONE\r\n");
     fpga_net_prog_pend=0;
   }
@@ -179,11 +211,20 @@ void system_service(void) {
     }
     fpga_reset = 0;
   }
-  console_service();
-
+  // XRP7724 flash programming in progress, if any
+  xrp_flash_service();
+  // Closed-loop fan control (runs every FANCTL_PERIOD_MS)
+  fanctl_service();
+  // FMC current telemetry (runs every FMC_MONITOR_PERIOD_MS)
+  fmc_monitor_service();
+
+  t0 = marble_get_cycles();
   pmod_subsystem_service();
+  prof_end(PROF_PMOD_SERVICE, t0);
 
+  t0 = marble_get_cycles();
   eeprom_update();
+  prof_end(PROF_EEPROM_UPDATE, t0);
   return;
 }
 
@@ -206,6 +247,8 @@ void system_apply_params(void) {
     max6639_set_overtemp(val);
     LM75_set_overtemp((int)val);
   }
+  // Closed-loop fan control (overrides fan_speed if enabled)
+  fanctl_init();
   // MGT MUX
   if (eeprom_read_mgt_mux(&val, 1)) {
     printf("Could not read MGT MUX config.\r\n");
@@ -279,6 +322,8 @@ static void system_apply_external_params(void) {
     max6639_set_overtemp(val);
     LM75_set_overtemp((int)val);
   }
+  // Closed-loop fan control (overrides fan_speed if enabled)
+  fanctl_init();
   return;
 }
 
@@ -291,6 +336,21 @@ void reset_fpga_with_callback(void (*cb)(void)) {
 }
 
 void print_status_counters(void) {
+  if (report_structured()) {
+    report_begin("status");
+    report_int("board", (int)marble_get_status());
+    report_uint("live_cnt", live_cnt);
+    report_uint("fpga_prog_cnt", fpga_prog_cnt);
+    report_hex("fmc", marble_FMC_status());
+    report_hex("pwr", marble_PWR_status());
+#ifdef MARBLE_V2
+    report_hex("mgtmux", marble_MGTMUX_status());
+#endif
+    report_end();
+    FPGAWD_ShowState();
+    PM_print_errors();
+    return;
+  }
   marble_print_status();
   printf("Live counter: %u\r\n", live_cnt);
   printf("FPGA prog counter: %u\r\n", fpga_prog_cnt);
@@ -300,6 +360,7 @@ void print_status_counters(void) {
 #ifdef MARBLE_V2
   printf("MGT CLK Mux: %x\r\n", marble_MGTMUX_status());
 #endif
+  PM_print_errors();
   return;
 }
 
@@ -531,14 +592,20 @@ static void fpga_done_handler(void)
 static void timer_int_handler(void)
 {
    static uint32_t spi_ms_cnt=0;
+   static uint32_t led_ms_cnt=0;
 
    // SPI mailbox update flag; soft-realtime
+   // mbox_update() decides which rate classes are due
    spi_ms_cnt += systimer_ms;
    //printf("%d\r\n", spi_ms_cnt);
-   if (spi_ms_cnt > SPI_MAILBOX_PERIOD_MS) {
-      spi_update = true;
+   if (spi_ms_cnt >= MBOX_FAST_PERIOD_MS) {
+      event_post(EVENT_MBOX_UPDATE);
       spi_ms_cnt = 0;
-      // Use LED2 for SPI heartbeat
+   }
+   // Use LED2 for SPI heartbeat
+   led_ms_cnt += systimer_ms;
+   if (led_ms_cnt > SPI_MAILBOX_PERIOD_MS) {
+      led_ms_cnt = 0;
       marble_LED_toggle(2);
    }
 
@@ -552,6 +619,8 @@ static void timer_int_handler(void)
    led_cnt = (led_cnt + 1) % 1000;
 #endif /* LED_SNAKE */
    live_cnt++;
+   // Deadlines and polled work in system_service()
+   event_post(EVENT_TICK);
 }
 
 static void pmod_subsystem_service(void) {
@@ -5,6 +5,7 @@
 #include "uart_fifo.h"
 #include "marble_api.h"
 #include "console.h"
+#include "uart_frame.h"
 
 #define UART_ECHO
 #define BLOCK_TX_ON_FULL
@@ -343,6 +344,10 @@ void USART_RXNE_ISR(void) {
   if (CONSOLE_USART_RX_DATA_AVAILABLE()) {
     // Don't clear flags; the RXNE flag is cleared automatically by read from DR
     c = CONSOLE_USART_GET_RX_CHAR();
+    // Binary frames bypass line processing and echo
+    if (frame_rx_byte(c)) {
+      return;
+    }
     // Look for control characters first
     if (c == UART_MSG_ABORT) {
 #ifdef UART_ECHO
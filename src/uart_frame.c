@@ -0,0 +1,438 @@
+/*
+ * File: uart_frame.c
+ * Desc: Binary framed request/response protocol on the console UART.
+ *       See uart_frame.h for the frame layout.
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include "uart_frame.h"
+#include "uart_fifo.h"
+#include "marble_api.h"
+#include "mailbox.h"
+#include "eeprom.h"
+#include "i2c_pm.h"
+#include "ltm4673.h"
+#include "pmlog.h"
+#include "console.h"
+#include "event.h"
+
+// Receive state (filled in by frame_rx_byte() from the UART RX ISR)
+static volatile uint8_t _rx_buf[FRAME_MAX_SIZE];
+static volatile int _rx_count;
+static volatile int _rx_ready;
+static volatile int _rx_skip;
+static volatile uint32_t _rx_start;
+
+static uint8_t _tx_buf[FRAME_MAX_SIZE];
+
+static int frame_expected_size(void);
+static void frame_reply(uint8_t seq, uint8_t op, frame_status_t status, const uint8_t *payload, int len);
+#ifdef APP_MARBLE
+static frame_status_t frame_pmbus_xact(const uint8_t *req, int len, uint8_t *rsp, int *rsp_len);
+static frame_status_t frame_ltm4673_image(const uint8_t *req, int len, uint8_t *rsp, int *rsp_len);
+#endif
+static frame_status_t frame_eeprom_read(const uint8_t *req, int len, uint8_t *rsp, int *rsp_len);
+static frame_status_t frame_eeprom_write(const uint8_t *req, int len);
+static frame_status_t frame_pmlog_read(const uint8_t *req, int len, uint8_t *rsp, int *rsp_len, int rsp_max);
+static frame_status_t frame_console(const uint8_t *req, int len, uint8_t *rsp, int *rsp_len, int rsp_max);
+static frame_status_t frame_console_output(const uint8_t *req, int len, uint8_t *rsp, int *rsp_len, int rsp_max);
+
+/*
+ * static int frame_expected_size(void);
+ *  Total size of the frame being received, or 0 if the header is not yet
+ *  complete.
+ */
+static int frame_expected_size(void) {
+  if (_rx_count < FRAME_HEADER_SIZE) {
+    return 0;
+  }
+  return FRAME_HEADER_SIZE + _rx_buf[4] + FRAME_CRC_SIZE;
+}
+
+int frame_rx_byte(uint8_t c) {
+  if (_rx_skip > 0) {
+    // Rest of a frame whose LEN was rejected
+    _rx_skip--;
+    return 1;
+  }
+  if (_rx_ready) {
+    // Previous frame not yet handled; the host must wait for a response
+    return 1;
+  }
+  if (_rx_count == 0) {
+    // A frame can only start at the beginning of a line
+    if ((c != FRAME_MAGIC) || (UARTQUEUE_Status() != UART_QUEUE_EMPTY)) {
+      return 0;
+    }
+    _rx_start = marble_get_tick();
+  }
+  if (_rx_count >= FRAME_MAX_SIZE) {
+    // Cannot happen as frames complete at their expected size; never overrun
+    _rx_count = 0;
+    return 1;
+  }
+  _rx_buf[_rx_count++] = c;
+  if (_rx_count == FRAME_HEADER_SIZE) {
+    if (_rx_buf[4] > FRAME_MAX_PAYLOAD) {
+      // Report the bad length straight away and drop the rest of the frame
+      _rx_skip = _rx_buf[4] + FRAME_CRC_SIZE;
+      _rx_ready = 1;
+    }
+  } else if (_rx_count == frame_expected_size()) {
+    _rx_ready = 1;
+  }
+  if (_rx_ready) {
+    event_post(EVENT_CONSOLE);
+  }
+  return 1;
+}
+
+int frame_service(void) {
+  uint8_t req[FRAME_MAX_SIZE];
+  uint8_t rsp[FRAME_MAX_PAYLOAD];
+  int rsp_len = 0;
+  int len;
+  frame_status_t status;
+  if (!_rx_ready) {
+    if (((_rx_count > 0) || (_rx_skip > 0)) && ((marble_get_tick() - _rx_start) > FRAME_RX_TIMEOUT_MS)) {
+      _rx_count = 0;
+      _rx_skip = 0;
+    }
+    return 0;
+  }
+  len = _rx_count;
+  if (len > (int)sizeof(req)) {
+    len = (int)sizeof(req);
+  }
+  for (int n = 0; n < len; n++) {
+    req[n] = _rx_buf[n];
+  }
+  _rx_count = 0;
+  _rx_ready = 0;
+  if (len < FRAME_HEADER_SIZE) {
+    return 0;
+  }
+  uint8_t seq = req[1];
+  uint8_t op = req[2];
+  int plen = req[4];
+  if ((plen > FRAME_MAX_PAYLOAD) || (len != FRAME_HEADER_SIZE + plen + FRAME_CRC_SIZE)) {
+    frame_reply(seq, op, FRAME_STATUS_BAD_LEN, NULL, 0);
+    return 1;
+  }
+  uint16_t crc = ((uint16_t)req[len-2] << 8) | req[len-1];
+  if (crc != frame_crc16(req + 1, len - 1 - FRAME_CRC_SIZE)) {
+    frame_reply(seq, op, FRAME_STATUS_BAD_CRC, NULL, 0);
+    return 1;
+  }
+  status = frame_dispatch(op, req + FRAME_HEADER_SIZE, plen, rsp, &rsp_len, FRAME_MAX_PAYLOAD);
+  frame_reply(seq, op, status, rsp, rsp_len);
+  return 1;
+}
+
+/*
+ * static void frame_reply(uint8_t seq, uint8_t op, frame_status_t status, const uint8_t *payload, int len);
+ *  Assemble a response frame and queue it on the UART.
+ */
+static void frame_reply(uint8_t seq, uint8_t op, frame_status_t status, const uint8_t *payload, int len) {
+  _tx_buf[0] = FRAME_MAGIC;
+  _tx_buf[1] = seq;
+  _tx_buf[2] = op | FRAME_OP_RESPONSE;
+  _tx_buf[3] = (uint8_t)status;
+  _tx_buf[4] = (uint8_t)len;
+  if (len > 0) {
+    memcpy(_tx_buf + FRAME_HEADER_SIZE, payload, len);
+  }
+  uint16_t crc = frame_crc16(_tx_buf + 1, FRAME_HEADER_SIZE - 1 + len);
+  _tx_buf[FRAME_HEADER_SIZE + len] = (uint8_t)(crc >> 8);
+  _tx_buf[FRAME_HEADER_SIZE + len + 1] = (uint8_t)(crc & 0xff);
+  marble_UART_send((const char *)_tx_buf, FRAME_HEADER_SIZE + len + FRAME_CRC_SIZE);
+  return;
+}
+
+frame_status_t frame_dispatch(uint8_t op, const uint8_t *req, int len, uint8_t *rsp, int *rsp_len, int rsp_max) {
+  switch (op) {
+    case FRAME_OP_PING:
+      if (len > rsp_max) {
+        return FRAME_STATUS_BAD_LEN;
+      }
+      memcpy(rsp, req, len);
+      *rsp_len = len;
+      return FRAME_STATUS_OK;
+#ifdef APP_MARBLE
+    case FRAME_OP_PMBUS_XACT:
+      return frame_pmbus_xact(req, len, rsp, rsp_len);
+    case FRAME_OP_LTM4673_IMAGE:
+      return frame_ltm4673_image(req, len, rsp, rsp_len);
+#endif
+    case FRAME_OP_MBOX_READ:
+      if (len != 1) {
+        return FRAME_STATUS_BAD_LEN;
+      }
+      if (req[0] >= MBOX_NPAGES) {
+        return FRAME_STATUS_BAD_ARG;
+      }
+      mbox_read_page(req[0], MBOX_PAGE_SIZE, rsp);
+      *rsp_len = MBOX_PAGE_SIZE;
+      return FRAME_STATUS_OK;
+    case FRAME_OP_MBOX_WRITE:
+      if ((len < 2) || (len > MBOX_PAGE_SIZE + 1)) {
+        return FRAME_STATUS_BAD_LEN;
+      }
+      if (req[0] >= MBOX_NPAGES) {
+        return FRAME_STATUS_BAD_ARG;
+      }
+      mbox_write_page(req[0], (uint8_t)(len - 1), req + 1);
+      return FRAME_STATUS_OK;
+    case FRAME_OP_EEPROM_READ:
+      return frame_eeprom_read(req, len, rsp, rsp_len);
+    case FRAME_OP_EEPROM_WRITE:
+      return frame_eeprom_write(req, len);
+    case FRAME_OP_TELEM:
+      *rsp_len = frame_telem(rsp);
+      return FRAME_STATUS_OK;
+    case FRAME_OP_PMLOG_READ:
+      return frame_pmlog_read(req, len, rsp, rsp_len, rsp_max);
+    case FRAME_OP_CONSOLE:
+      return frame_console(req, len, rsp, rsp_len, rsp_max);
+    case FRAME_OP_CONSOLE_OUTPUT:
+      return frame_console_output(req, len, rsp, rsp_len, rsp_max);
+    default:
+      break;
+  }
+  return FRAME_STATUS_BAD_OP;
+}
+
+#ifdef APP_MARBLE
+/*
+ * static frame_status_t frame_pmbus_xact(const uint8_t *req, int len, uint8_t *rsp, int *rsp_len);
+ *  Request payload: | addr_wr | cmd | nread | wdata ... |
+ *  nread > 0 performs a read of nread bytes (no wdata allowed); otherwise
+ *  wdata (possibly empty, i.e. SEND_BYTE) is written.  The transaction is
+ *  vetted and limited exactly as with the console 't' command.
+ */
+static frame_status_t frame_pmbus_xact(const uint8_t *req, int len, uint8_t *rsp, int *rsp_len) {
+  uint16_t xact[PMBRIDGE_XACT_MAX_ITEMS];
+  int nitems = 0;
+  if (len < 3) {
+    return FRAME_STATUS_BAD_LEN;
+  }
+  int nread = req[2];
+  int nwrite = len - 3;
+  xact[nitems++] = req[0];
+  xact[nitems++] = req[1];
+  if (nread > 0) {
+    if ((nwrite > 0) || (4 + nread > PMBRIDGE_XACT_MAX_ITEMS)) {
+      return FRAME_STATUS_BAD_LEN;
+    }
+    xact[nitems++] = PMBRIDGE_XACT_REPEAT_START;
+    xact[nitems++] = req[0] | 1;
+    for (int n = 0; n < nread; n++) {
+      xact[nitems++] = PMBRIDGE_XACT_READ_ONE;
+    }
+  } else {
+    if (2 + nwrite > PMBRIDGE_XACT_MAX_ITEMS) {
+      return FRAME_STATUS_BAD_LEN;
+    }
+    for (int n = 0; n < nwrite; n++) {
+      xact[nitems++] = req[3 + n];
+    }
+  }
+  int rval = PMBridge_xact_recv(xact, nitems, rsp);
+  if (rval < 0) {
+    return FRAME_STATUS_FAIL;
+  }
+  *rsp_len = rval;
+  return FRAME_STATUS_OK;
+}
+
+/*
+ * static frame_status_t frame_ltm4673_image(const uint8_t *req, int len, uint8_t *rsp, int *rsp_len);
+ *  Stream a configuration image to the MCU, then program the LTM4673 from
+ *  it in one request.  A failed register still returns FRAME_STATUS_OK;
+ *  the counts in the response tell the host what happened.
+ */
+static frame_status_t frame_ltm4673_image(const uint8_t *req, int len, uint8_t *rsp, int *rsp_len) {
+  ltm4673_image_result_t result;
+  int rval;
+  if (len < 1) {
+    return FRAME_STATUS_BAD_LEN;
+  }
+  switch (req[0]) {
+    case FRAME_IMAGE_CLEAR:
+      ltm4673_image_clear();
+      return FRAME_STATUS_OK;
+    case FRAME_IMAGE_DATA:
+      if (len < 3) {
+        return FRAME_STATUS_BAD_LEN;
+      }
+      rval = ltm4673_image_put(((unsigned int)req[1] << 8) | req[2], req + 3, len - 3);
+      if (rval < 0) {
+        return FRAME_STATUS_BAD_ARG;
+      }
+      rsp[0] = (uint8_t)(rval >> 8);
+      rsp[1] = (uint8_t)(rval & 0xff);
+      *rsp_len = 2;
+      return FRAME_STATUS_OK;
+    case FRAME_IMAGE_PROGRAM:
+      if (len != 2) {
+        return FRAME_STATUS_BAD_LEN;
+      }
+      if (marble_get_pcb_rev() <= Marble_v1_3) {
+        return FRAME_STATUS_DENIED;
+      }
+      if (ltm4673_image_program(LTM4673, req[1], &result) < 0) {
+        return FRAME_STATUS_BAD_ARG;
+      }
+      rsp[0] = (uint8_t)(result.records >> 8);
+      rsp[1] = (uint8_t)(result.records & 0xff);
+      rsp[2] = (uint8_t)(result.changed >> 8);
+      rsp[3] = (uint8_t)(result.changed & 0xff);
+      rsp[4] = (uint8_t)(result.failed >> 8);
+      rsp[5] = (uint8_t)(result.failed & 0xff);
+      rsp[6] = result.stored;
+      *rsp_len = 7;
+      return FRAME_STATUS_OK;
+    default:
+      break;
+  }
+  return FRAME_STATUS_BAD_ARG;
+}
+#endif
+
+/*
+ * static frame_status_t frame_eeprom_read(const uint8_t *req, int len, uint8_t *rsp, int *rsp_len);
+ *  The watchdog key is write-only, so its tags cannot be read back.
+ */
+static frame_status_t frame_eeprom_read(const uint8_t *req, int len, uint8_t *rsp, int *rsp_len) {
+  if (len != 1) {
+    return FRAME_STATUS_BAD_LEN;
+  }
+  ee_tag_t tag = req[0];
+  int size = eeprom_tag_size(tag);
+  if (size < 0) {
+    return FRAME_STATUS_BAD_ARG;
+  }
+  if ((tag == ee_wd_key_0) || (tag == ee_wd_key_1) || (tag == ee_wd_key_2)) {
+    return FRAME_STATUS_DENIED;
+  }
+  if (eeprom_read_tag(tag, rsp, size)) {
+    return FRAME_STATUS_FAIL;
+  }
+  *rsp_len = size;
+  return FRAME_STATUS_OK;
+}
+
+static frame_status_t frame_eeprom_write(const uint8_t *req, int len) {
+  if (len < 1) {
+    return FRAME_STATUS_BAD_LEN;
+  }
+  ee_tag_t tag = req[0];
+  int size = eeprom_tag_size(tag);
+  if (size < 0) {
+    return FRAME_STATUS_BAD_ARG;
+  }
+  if (len - 1 != size) {
+    return FRAME_STATUS_BAD_LEN;
+  }
+  if (eeprom_store_tag(tag, req + 1, size)) {
+    return FRAME_STATUS_FAIL;
+  }
+  return FRAME_STATUS_OK;
+}
+
+int frame_telem(uint8_t *rsp) {
+  int n = 0;
+  int val;
+  for (int elem = 0; elem < PM_NUM_TELEM_ENUM; elem++) {
+    val = PM_GetTelem((PM_telem_enum_t)elem);
+    rsp[n++] = (uint8_t)(val & 0xff);
+    rsp[n++] = (uint8_t)((val >> 8) & 0xff);
+  }
+  val = LM75_get_cached_temperature(LM75_0);
+  rsp[n++] = (uint8_t)(val & 0xff);
+  rsp[n++] = (uint8_t)((val >> 8) & 0xff);
+  val = LM75_get_cached_temperature(LM75_1);
+  rsp[n++] = (uint8_t)(val & 0xff);
+  rsp[n++] = (uint8_t)((val >> 8) & 0xff);
+  return n;
+}
+
+/*
+ * static frame_status_t frame_pmlog_read(const uint8_t *req, int len, uint8_t *rsp, int *rsp_len, int rsp_max);
+ *  Request payload: | n | offset_hi | offset_lo |
+ *  Returns up to 'rsp_max' bytes of the n-th most recent power-loss
+ *  record (pmlog_record_t, 0 = newest) starting at 'offset'.
+ */
+static frame_status_t frame_pmlog_read(const uint8_t *req, int len, uint8_t *rsp, int *rsp_len, int rsp_max) {
+  if (len != 3) {
+    return FRAME_STATUS_BAD_LEN;
+  }
+  const pmlog_record_t *rec = pmlog_get(req[0]);
+  int offset = ((int)req[1] << 8) | req[2];
+  if ((rec == NULL) || (offset > (int)sizeof(pmlog_record_t))) {
+    return FRAME_STATUS_BAD_ARG;
+  }
+  int size = (int)sizeof(pmlog_record_t) - offset;
+  if (size > rsp_max) {
+    size = rsp_max;
+  }
+  memcpy(rsp, (const uint8_t *)rec + offset, size);
+  *rsp_len = size;
+  return FRAME_STATUS_OK;
+}
+
+/*
+ * static frame_status_t frame_console(const uint8_t *req, int len, uint8_t *rsp, int *rsp_len, int rsp_max);
+ *  Request payload: console command text (e.g. "p 50%").
+ *  Response payload: | rc (int8) | size_hi | size_lo | output ... |
+ *  The command's output is kept (see console_run()) rather than printed;
+ *  'size' is its total length, of which as much as fits follows.  The rest
+ *  is read with FRAME_OP_CONSOLE_OUTPUT.
+ */
+static frame_status_t frame_console(const uint8_t *req, int len, uint8_t *rsp, int *rsp_len, int rsp_max) {
+  if (len < 1) {
+    return FRAME_STATUS_BAD_LEN;
+  }
+  int rval = console_run((const char *)req, len);
+  unsigned int size = console_output_size();
+  rsp[0] = (uint8_t)rval;
+  rsp[1] = (uint8_t)(size >> 8);
+  rsp[2] = (uint8_t)(size & 0xff);
+  *rsp_len = 3 + console_output(0, rsp + 3, rsp_max - 3);
+  return rval == 0 ? FRAME_STATUS_OK : FRAME_STATUS_FAIL;
+}
+
+/*
+ * static frame_status_t frame_console_output(const uint8_t *req, int len, uint8_t *rsp, int *rsp_len, int rsp_max);
+ *  Request payload: | offset_hi | offset_lo |
+ *  Returns up to 'rsp_max' bytes of the output of the last FRAME_OP_CONSOLE
+ *  command starting at 'offset' (none past the end).
+ */
+static frame_status_t frame_console_output(const uint8_t *req, int len, uint8_t *rsp, int *rsp_len, int rsp_max) {
+  if (len != 2) {
+    return FRAME_STATUS_BAD_LEN;
+  }
+  unsigned int offset = ((unsigned int)req[0] << 8) | req[1];
+  *rsp_len = console_output(offset, rsp, rsp_max);
+  return FRAME_STATUS_OK;
+}
+
+/*
+ * uint16_t frame_crc16(const uint8_t *data, int len);
+ *  CRC-16/CCITT-FALSE (poly 0x1021, init 0xffff), bitwise to save flash.
+ */
+uint16_t frame_crc16(const uint8_t *data, int len) {
+  uint16_t crc = 0xffff;
+  for (int n = 0; n < len; n++) {
+    crc ^= (uint16_t)data[n] << 8;
+    for (int bit = 0; bit < 8; bit++) {
+      if (crc & 0x8000) {
+        crc = (uint16_t)((crc << 1) ^ 0x1021);
+      } else {
+        crc = (uint16_t)(crc << 1);
+      }
+    }
+  }
+  return crc;
+}
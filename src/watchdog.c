@@ -10,6 +10,7 @@
 #include "common.h"
 #include "string.h"
 #include "eeprom.h"
+#include "report.h"
 #include <stdio.h>
 
 //#define DEBUG_PRINT
@@ -210,6 +211,20 @@ void FPGAWD_ShowState(void) {
   uint8_t desired_mac[HASH_SIZE];
   //const unsigned char *key = get_auth_key();
   unsigned char key[KEY_SIZE];
+  if (report_structured()) {
+    report_begin("watchdog");
+    report_uint("poll_counter", poll_counter);
+    report_str("state", state_str(fpga_state));
+    report_bytes("local_nonce", local_nonce, HASH_SIZE);
+    if (eeprom_read_wd_key((volatile uint8_t *)key, KEY_SIZE) == 0) {
+      core_siphash((unsigned char *) desired_mac, (unsigned char *) local_nonce, 8, key);
+      memset(key, 0xcc, KEY_SIZE);  // Clobber key in RAM
+      report_bytes("desired_mac", desired_mac, HASH_SIZE);
+    }
+    report_bytes("remote_hash", remote_hash, HASH_SIZE);
+    report_end();
+    return;
+  }
   printf("poll_counter = %u\r\n", poll_counter);
   printf("FPGA state  = %s\r\n", state_str(fpga_state));
   print64("local_nonce = ", local_nonce, HASH_SIZE);
@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+# Run the simulated MMC and play the FPGA's part on mailbox page 11 over the
+# framed protocol: ack PM_FAULT_FLAG while no fault is pending, then raise
+# SMBALERT (SIGUSR1) and check that the new fault is flagged, i.e. the stale
+# ack was overwritten rather than applied to the new fault.
+
+import fcntl
+import os
+import signal
+import subprocess
+import sys
+import time
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "../../scripts"))
+import mmcframe  # noqa: E402
+
+PAGE = 11
+FLAG_PENDING = 0x80
+FLAG_ACK = 0x01
+BOOT_S = 3.5
+SETTLE_S = 1.5
+
+
+class SimPipe():
+    """pyserial-like read()/write() on the simulator's stdio"""
+    def __init__(self, proc):
+        self.proc = proc
+
+    def read(self, n):
+        time.sleep(0.001)
+        try:
+            return os.read(self.proc.stdout.fileno(), n) or b''
+        except BlockingIOError:
+            return b''
+
+    def write(self, data):
+        self.proc.stdin.write(data)
+        self.proc.stdin.flush()
+
+
+def main(argv):
+    sim = argv[1] if len(argv) > 1 else "../../out_sim/marble_mmc_sim"
+    proc = subprocess.Popen(["stdbuf", "-o0", sim], stdin=subprocess.PIPE,
+                            stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+    flags = fcntl.fcntl(proc.stdout, fcntl.F_GETFL)
+    fcntl.fcntl(proc.stdout, fcntl.F_SETFL, flags | os.O_NONBLOCK)
+    fail = 0
+    try:
+        time.sleep(BOOT_S)
+        mmc = mmcframe.MMCFrame(SimPipe(proc))
+        page = mmc.mbox_read(PAGE)
+        if page[0] != 0:
+            print("Flag 0x{:02x} before any fault".format(page[0]))
+            fail += 1
+        count = (page[2] << 8) | page[3]
+        # Ack with nothing pending
+        mmc.mbox_write(PAGE, bytes((FLAG_ACK,)))
+        time.sleep(SETTLE_S)
+        page = mmc.mbox_read(PAGE)
+        if page[0] != 0:
+            print("Stale ack 0x{:02x} left in the mailbox".format(page[0]))
+            fail += 1
+        proc.send_signal(signal.SIGUSR1)
+        time.sleep(SETTLE_S)
+        page = mmc.mbox_read(PAGE)
+        if ((page[2] << 8) | page[3]) != count + 1:
+            print("Fault not captured")
+            fail += 1
+        if page[0] != FLAG_PENDING:
+            print("Flag 0x{:02x} after a new fault, expected 0x{:02x}".format(page[0], FLAG_PENDING))
+            fail += 1
+    finally:
+        proc.send_signal(signal.SIGINT)
+        proc.wait()
+    print("FAIL" if fail else "PASS")
+    return 1 if fail else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
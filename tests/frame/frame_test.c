@@ -0,0 +1,128 @@
+/* Feed malformed and back-to-back request frames to the receive path of
+ * src/uart_frame.c and check the responses.  Build with -fsanitize=address
+ * to catch any overrun of the receive buffers.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "uart_frame.h"
+#include "uart_fifo.h"
+#include "marble_api.h"
+#include "mailbox.h"
+#include "eeprom.h"
+#include "i2c_pm.h"
+#include "pmlog.h"
+#include "console.h"
+#include "event.h"
+
+static uint32_t _tick = 0;
+static uint8_t _sent[4*FRAME_MAX_SIZE];
+static int _nsent = 0;
+static int _nreplies = 0;
+
+// Stubs for what uart_frame.c needs from the rest of the firmware
+uint32_t marble_get_tick(void) { return _tick; }
+uint8_t UARTQUEUE_Status(void) { return UART_QUEUE_EMPTY; }
+void event_post(event_t ev) { (void)ev; }
+int marble_UART_send(const char *str, int size) {
+  if (_nsent + size <= (int)sizeof(_sent)) {
+    memcpy(_sent + _nsent, str, size);
+    _nsent += size;
+  }
+  _nreplies++;
+  return size;
+}
+void mbox_read_page(uint8_t page_no, uint8_t page_sz, uint8_t *page) { (void)page_no; memset(page, 0, page_sz); }
+void mbox_write_page(uint8_t page_no, uint8_t page_sz, const uint8_t page[]) { (void)page_no; (void)page_sz; (void)page; }
+int eeprom_read_tag(ee_tag_t tag, volatile uint8_t *pdata, int len) { (void)tag; (void)pdata; (void)len; return -1; }
+int eeprom_store_tag(ee_tag_t tag, const uint8_t *pdata, int len) { (void)tag; (void)pdata; (void)len; return -1; }
+int eeprom_tag_size(ee_tag_t tag) { (void)tag; return -1; }
+int PM_GetTelem(PM_telem_enum_t elem) { (void)elem; return 0; }
+int LM75_get_cached_temperature(uint8_t dev) { (void)dev; return 0; }
+const pmlog_record_t *pmlog_get(unsigned int n) { (void)n; return NULL; }
+int console_run(const char *cmd, int len) { (void)cmd; (void)len; return 0; }
+int console_output(unsigned int offset, uint8_t *data, int len) { (void)offset; (void)data; (void)len; return 0; }
+unsigned int console_output_size(void) { return 0; }
+
+static int feed(const uint8_t *data, int len) {
+  int consumed = 0;
+  for (int n = 0; n < len; n++) {
+    consumed += frame_rx_byte(data[n]);
+  }
+  return consumed;
+}
+
+// Build a PING request carrying 'plen' bytes of payload
+static int make_ping(uint8_t *buf, uint8_t seq, int plen) {
+  buf[0] = FRAME_MAGIC;
+  buf[1] = seq;
+  buf[2] = FRAME_OP_PING;
+  buf[3] = 0;
+  buf[4] = (uint8_t)plen;
+  for (int n = 0; n < plen; n++) {
+    buf[FRAME_HEADER_SIZE + n] = (uint8_t)n;
+  }
+  uint16_t crc = frame_crc16(buf + 1, FRAME_HEADER_SIZE - 1 + plen);
+  buf[FRAME_HEADER_SIZE + plen] = (uint8_t)(crc >> 8);
+  buf[FRAME_HEADER_SIZE + plen + 1] = (uint8_t)(crc & 0xff);
+  return FRAME_HEADER_SIZE + plen + FRAME_CRC_SIZE;
+}
+
+// Check that the replies so far are exactly one with 'seq' and 'status'
+static int expect_reply(const char *name, uint8_t seq, frame_status_t status) {
+  int fail = 0;
+  if (_nreplies != 1) {
+    printf("FAIL: %s: %d replies\n", name, _nreplies);
+    fail = 1;
+  } else if ((_sent[1] != seq) || (_sent[3] != (uint8_t)status)) {
+    printf("FAIL: %s: seq %u status %u\n", name, _sent[1], _sent[3]);
+    fail = 1;
+  }
+  _nsent = 0;
+  _nreplies = 0;
+  return fail;
+}
+
+int main(void) {
+  uint8_t buf[2*FRAME_MAX_SIZE + 300];
+  int len;
+  int fails = 0;
+  // Oversize LEN followed by more bytes than the receive buffer holds
+  memset(buf, 0, sizeof(buf));
+  memcpy(buf, "\xa5\x01\x00\x00\xff", FRAME_HEADER_SIZE);
+  feed(buf, FRAME_HEADER_SIZE + 200);
+  frame_service();
+  fails += expect_reply("oversize", 0x01, FRAME_STATUS_BAD_LEN);
+  // The rest of that frame is still swallowed rather than parsed
+  feed(buf + FRAME_HEADER_SIZE, 57);
+  frame_service();
+  if (_nreplies != 0) {
+    printf("FAIL: oversize tail: %d replies\n", _nreplies);
+    fails++;
+  }
+  // After the receive timeout the parser is back in sync
+  _tick += FRAME_RX_TIMEOUT_MS + 1;
+  frame_service();
+  len = make_ping(buf, 0x02, 4);
+  feed(buf, len);
+  frame_service();
+  fails += expect_reply("ping after oversize", 0x02, FRAME_STATUS_OK);
+  // Back-to-back maximum size frames before the first is serviced
+  len = make_ping(buf, 0x03, FRAME_MAX_PAYLOAD);
+  len += make_ping(buf + len, 0x04, FRAME_MAX_PAYLOAD);
+  len += make_ping(buf + len, 0x05, FRAME_MAX_PAYLOAD);
+  feed(buf, len);
+  frame_service();
+  frame_service();
+  fails += expect_reply("back-to-back", 0x03, FRAME_STATUS_OK);
+  len = make_ping(buf, 0x06, 0);
+  feed(buf, len);
+  frame_service();
+  fails += expect_reply("ping after back-to-back", 0x06, FRAME_STATUS_OK);
+  if (fails == 0) {
+    printf("PASS\n");
+    return 0;
+  }
+  printf("%d tests failed\n", fails);
+  return 1;
+}
@@ -0,0 +1,64 @@
+#!/usr/bin/env python3
+# Run the simulated MMC against its emulated MAX6639 and check the decoded
+# channel temperatures ('7' console command).  With SIM_MAX6639_NO_AUTOINC
+# set, the emulated device ignores register auto-increment, so the firmware
+# must detect that and fall back to single-register reads.
+
+import fcntl
+import os
+import re
+import subprocess
+import sys
+import time
+
+TEMPS = {1: 40.125, 2: 50.25}
+NOTICE = "MAX6639: no register auto-increment"
+BOOT_S = 3.5
+TIMEOUT_S = 5.0
+
+
+def read_until(proc, pattern, timeout):
+    out = ""
+    t0 = time.time()
+    while time.time() - t0 < timeout:
+        try:
+            chunk = os.read(proc.stdout.fileno(), 4096)
+        except BlockingIOError:
+            chunk = b""
+        out += chunk.decode(errors="replace")
+        if re.search(pattern, out):
+            break
+        time.sleep(0.05)
+    return out
+
+
+def main(argv):
+    sim = argv[1] if len(argv) > 1 else "../../out_sim/marble_mmc_sim"
+    no_autoinc = "SIM_MAX6639_NO_AUTOINC" in os.environ
+    proc = subprocess.Popen(["stdbuf", "-o0", sim], stdin=subprocess.PIPE,
+                            stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+    flags = fcntl.fcntl(proc.stdout, fcntl.F_GETFL)
+    fcntl.fcntl(proc.stdout, fcntl.F_SETFL, flags | os.O_NONBLOCK)
+    try:
+        out = read_until(proc, "(?!)", BOOT_S)
+        proc.stdin.write(b"7\r\n")
+        proc.stdin.flush()
+        out += read_until(proc, r"Ch 2 Temp = [-0-9.]+\n", TIMEOUT_S)
+    finally:
+        proc.send_signal(2)
+        proc.wait()
+    fail = 0
+    for chan, temp in TEMPS.items():
+        m = re.search(r"Ch %d Temp = ([-0-9.]+)" % chan, out)
+        if m is None or float(m.group(1)) != temp:
+            print("Ch {}: expected {}, got {}".format(chan, temp, m.group(1) if m else None))
+            fail += 1
+    if (NOTICE in out) != no_autoinc:
+        print("Auto-increment detection: expected {}".format("off" if no_autoinc else "on"))
+        fail += 1
+    print("FAIL" if fail else "PASS")
+    return 1 if fail else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,80 @@
+#! /usr/bin/python3
+
+# Check the output of pmbus_test against the reference conversions in
+# scripts/ltm4673.py.  Decoders must be bit-exact with L11_TO_V()/L16_TO_V()
+# (rounded toward -infinity and saturated for the int variants).
+
+import sys
+from fractions import Fraction
+sys.path.insert(0, "../../scripts")
+import ltm4673
+
+INT_MAX = (1 << 31) - 1
+INT_MIN = -(1 << 31)
+
+
+def _floor_sat(x):
+    n = x.numerator // x.denominator
+    return max(INT_MIN, min(INT_MAX, n))
+
+
+def _l16(x):
+    return max(0, min(0xffff, int(x)))
+
+
+def check(line):
+    f = line.split()
+    kind = f[0]
+    if kind in ("l11", "l16"):
+        code = int(f[1])
+        if kind == "l11":
+            val = Fraction(ltm4673.L11_TO_V(code))
+        else:
+            val = Fraction(ltm4673.L16_TO_V(code))
+        want = [_floor_sat(val), _floor_sat(val*1000), _floor_sat(val*1000000), val*(1 << 16)]
+        return [int(x) for x in f[2:]] == want
+    if kind == "v_to_l11":
+        return int(f[2]) == ltm4673.V_TO_L11(int(f[1]))
+    if kind == "mv_to_l11":
+        return int(f[2]) == ltm4673.MV_TO_L11(int(f[1]))
+    if kind == "uv_to_l11":
+        # Same rounding as MV_TO_L11, one more factor of 1000
+        uv = int(f[1])
+        n = -16
+        val = (uv << 16)//1000000
+        while (val > 1023) or (val < -1024):
+            val = val >> 1
+            n += 1
+        return int(f[2]) == ((n & 0x1f) << 11) + (val & 0x7ff)
+    if kind == "mv_to_l16":
+        return int(f[2]) == _l16(Fraction(int(f[1]), 1000)*(1 << ltm4673._L16_EXPONENT))
+    if kind == "uv_to_l16":
+        return int(f[2]) == _l16(Fraction(int(f[1]), 1000000)*(1 << ltm4673._L16_EXPONENT))
+    if kind == "V_TO_L11":
+        return int(f[2]) == ltm4673.V_TO_L11(float(f[1]))
+    if kind == "V_TO_L16":
+        return int(f[2]) == ltm4673.V_TO_L16(float(f[1]))
+    if kind == "MV_TO_L11":
+        return int(f[2]) == ltm4673.MV_TO_L11(int(f[1]))
+    print("Unknown line: " + line.strip())
+    return False
+
+
+def main():
+    nlines = 0
+    fails = 0
+    for line in sys.stdin:
+        nlines += 1
+        if not check(line):
+            fails += 1
+            if fails <= 10:
+                print("FAIL: " + line.strip())
+    if fails or nlines == 0:
+        print("{} of {} conversions differ from scripts/ltm4673.py".format(fails, nlines))
+        return 1
+    print("PASS ({} conversions)".format(nlines))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
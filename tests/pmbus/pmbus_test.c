@@ -0,0 +1,57 @@
+/* Dump the PMBus format conversions of src/pmbus.c for pmbus_check.py,
+ * which checks them against the reference implementation in
+ * scripts/ltm4673.py.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include "pmbus.h"
+
+// Literals used in the limit tables of src/ltm4673.c (resolved at compile time)
+#define FOR_EACH_V_LITERAL() \
+  X(12.5) X(16.0) X(0.95) X(1.05) X(1.75) X(1.85) X(2.45) X(2.55) X(3.25) X(3.35) \
+  X(0.001) X(1.5) X(2.25) X(3.3) X(-12.0) X(600.0) X(1000.0) X(-0.25) X(33000.0)
+
+// L16 covers [0, 8) only
+#define FOR_EACH_L16_LITERAL() \
+  X(0.95) X(1.05) X(1.75) X(1.85) X(2.45) X(2.55) X(3.25) X(3.35) X(0.0) X(7.999)
+
+#define FOR_EACH_MV_LITERAL() \
+  X(0) X(1) X(950) X(1050) X(3300) X(12500) X(16000) X(20000)
+
+int main(void) {
+  // Decoders: every code
+  for (unsigned int l = 0; l < 0x10000; l++) {
+    uint16_t code = (uint16_t)l;
+    printf("l11 %u %d %d %d %lld\n", l, l11_to_v_int(code), l11_to_mv_int(code),
+           l11_to_uv_int(code), (long long)l11_to_q16(code));
+    printf("l16 %u %d %d %d %lld\n", l, l16_to_v_int(code), l16_to_mv_int(code),
+           l16_to_uv_int(code), (long long)l16_to_q16(code));
+  }
+  // Encoders
+  for (int v = -70000; v <= 70000; v += 7) {
+    printf("v_to_l11 %d %u\n", v, v_to_l11_int(v));
+  }
+  for (int mv = -2000000; mv <= 2000000; mv += 37) {
+    printf("mv_to_l11 %d %u\n", mv, mv_to_l11_int(mv));
+  }
+  for (int uv = -20000000; uv <= 20000000; uv += 997) {
+    printf("uv_to_l11 %d %u\n", uv, uv_to_l11_int(uv));
+  }
+  for (int mv = 0; mv < 8000; mv++) {
+    printf("mv_to_l16 %d %u\n", mv, mv_to_l16_int(mv));
+  }
+  for (int uv = 0; uv < 8000000; uv += 61) {
+    printf("uv_to_l16 %d %u\n", uv, uv_to_l16_int(uv));
+  }
+  // Compile-time macros
+#define X(v) printf("V_TO_L11 %s %u\n", #v, (unsigned int)(uint16_t)V_TO_L11(v));
+  FOR_EACH_V_LITERAL()
+#undef X
+#define X(v) printf("V_TO_L16 %s %u\n", #v, (unsigned int)(uint16_t)V_TO_L16(v));
+  FOR_EACH_L16_LITERAL()
+#undef X
+#define X(v) printf("MV_TO_L11 %s %u\n", #v, (unsigned int)(uint16_t)MV_TO_L11(v));
+  FOR_EACH_MV_LITERAL()
+#undef X
+  return 0;
+}